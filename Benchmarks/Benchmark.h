@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Helpers shared by the benchmarks. Every benchmark is its own executable (see CMakeLists.txt)
+// and prints one line per measurement. "--quick" shrinks the workloads so ctest can run them as a
+// smoke test, the numbers are only meaningful from a full run of a release build.
+
+inline bool IsQuickRun(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// seconds of the fastest of "repeats" calls of "function", the minimum is the run least disturbed
+// by the os and other processes
+template <typename Function>
+double MeasureBest(int repeats, Function function)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeats; ++i)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        function();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = seconds < best ? seconds : best;
+    }
+    return best;
+}
+
+// keeps the compiler from dropping a computation whose result is otherwise unused
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+    volatile char sink = *(const volatile char*)&value;
+    (void)sink;
+#endif
+}
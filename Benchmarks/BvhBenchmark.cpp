@@ -0,0 +1,127 @@
+// Bvh over 100k and 1M random boxes in a 1000^3 volume: Build and Refit times, the SAH cost after
+// each, and query throughput. Frustum queries (a camera inside the volume seeing about one percent of
+// it) are compared with culling every box with CullAabbs, box queries (50^3 regions) and rays
+// (random origins and directions, no distance limit) are reported per second.
+
+#include "Benchmark.h"
+#include "Bvh.h"
+#include <DirectXMath.h>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    AabbArrays RandomBoxes(uint32_t count)
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> position(0.0f, 1000.0f), extent(0.5f, 2.0f);
+        AabbArrays boxes;
+        boxes.Resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            boxes.centerX[i] = position(random);
+            boxes.centerY[i] = position(random);
+            boxes.centerZ[i] = position(random);
+            boxes.extentX[i] = extent(random);
+            boxes.extentY[i] = extent(random);
+            boxes.extentZ[i] = extent(random);
+        }
+        return boxes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t counts[] = { 100000, 1000000 };
+    const int repeats = quick ? 1 : 5;
+    const uint32_t queryCount = quick ? 100 : 10000;
+
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, XMMatrixLookAtLH(XMVectorSet(500.0f, 500.0f, 0.0f, 0.0f), XMVectorSet(500.0f, 500.0f, 1.0f, 0.0f),
+        XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * XMMatrixPerspectiveFovLH(0.785398f, 4.0f / 3.0f, 0.1f, 300.0f));
+    Frustum frustum;
+    ExtractFrustum(&viewProj.m[0][0], &frustum);
+
+    for (uint32_t c = 0; c < 2; ++c)
+    {
+        const uint32_t count = quick ? counts[c] / 100 : counts[c];
+        AabbArrays boxes = RandomBoxes(count);
+        Bvh bvh;
+        double build = MeasureBest(repeats, [&]() { bvh.Build(boxes); });
+        BvhStats stats = bvh.GetStats();
+        printf("%u boxes: build %.2f ms, %u nodes, depth %u, sah cost %.1f\n", count, build * 1e3, stats.nodeCount, stats.depth,
+            stats.sahCost);
+
+        // one frame of movement, up to a box size in every direction
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+        AabbArrays moved = boxes;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            moved.centerX[i] += offset(random);
+            moved.centerY[i] += offset(random);
+            moved.centerZ[i] += offset(random);
+        }
+        double refit = MeasureBest(repeats, [&]() { bvh.Refit(moved); });
+        printf("  refit %.2f ms, sah cost %.1f\n", refit * 1e3, bvh.GetSahCost());
+
+        std::vector<uint32_t> items;
+        items.reserve(count);
+        double frustumQuery = MeasureBest(repeats, [&]()
+        {
+            items.clear();
+            bvh.QueryFrustum(frustum, &items);
+        });
+        std::vector<uint32_t> visible(count);
+        uint32_t visibleCount = 0;
+        double flat = MeasureBest(repeats, [&]() { visibleCount = CullAabbs(frustum, moved, 0, count, visible.data()); });
+        printf("  frustum query %.3f ms, %zu visible (CullAabbs over every box %.3f ms, %u visible)\n", frustumQuery * 1e3,
+            items.size(), flat * 1e3, visibleCount);
+
+        std::uniform_real_distribution<float> position(0.0f, 1000.0f), direction(-1.0f, 1.0f);
+        std::vector<float> regions(queryCount * 3), rays(queryCount * 6);
+        for (size_t i = 0; i < regions.size(); ++i)
+        {
+            regions[i] = position(random);
+        }
+        for (uint32_t i = 0; i < queryCount; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                rays[i * 6 + k] = position(random);
+                rays[i * 6 + 3 + k] = direction(random);
+            }
+        }
+
+        size_t found = 0;
+        double boxQueries = MeasureBest(repeats, [&]()
+        {
+            found = 0;
+            for (uint32_t i = 0; i < queryCount; ++i)
+            {
+                const float* minimum = &regions[i * 3];
+                const float maximum[3] = { minimum[0] + 50.0f, minimum[1] + 50.0f, minimum[2] + 50.0f };
+                items.clear();
+                bvh.QueryAabb(minimum, maximum, &items);
+                found += items.size();
+            }
+        });
+        printf("  box queries %.2f M/s, %.1f boxes each\n", queryCount / boxQueries / 1e6, (double)found / queryCount);
+
+        uint32_t hits = 0;
+        double rayQueries = MeasureBest(repeats, [&]()
+        {
+            hits = 0;
+            for (uint32_t i = 0; i < queryCount; ++i)
+            {
+                BvhRayHit hit;
+                hits += bvh.Raycast(&rays[i * 6], &rays[i * 6 + 3], 1e9f, &hit) ? 1 : 0;
+            }
+        });
+        printf("  rays %.2f M/s, %.0f%% hit\n", queryCount / rayQueries / 1e6, 100.0 * hits / queryCount);
+    }
+    return 0;
+}
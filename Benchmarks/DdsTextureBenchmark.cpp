@@ -0,0 +1,211 @@
+// DdsTexture on a generated corpus of dds files (bc1 and rgba8 mip chains, a bc3 cube), written to
+// the working directory and removed at the end:
+//   parse         ParseDds of every header and subresource, files per second
+//   load all      Open + LoadAll of every file, GB/s made resident through the mapping (the pages
+//                 are faulted in, nothing is copied)
+//   read copy     the whole file read into a heap buffer with ifstream, what loading used to do
+//   first mip     StreamAsync until the smallest mip is resident and the texture is usable, and
+//                 until mip 0 is, per file
+// The files are in the os file cache after writing them, so these are warm cache numbers; drop the
+// cache between writing and measuring for cold ones.
+
+#include "Benchmark.h"
+#include "DdsTexture.h"
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const uint32_t FormatR8G8B8A8Unorm = 28;
+    const uint32_t FormatBC1Unorm = 71;
+    const uint32_t FormatBC3Unorm = 77;
+
+    struct CorpusFile
+    {
+        uint32_t format;
+        uint32_t size; // width and height
+        bool cube;
+    };
+
+    void Put(std::vector<uint8_t>* bytes, uint32_t value)
+    {
+        const uint8_t* p = (const uint8_t*)&value;
+        bytes->insert(bytes->end(), p, p + 4);
+    }
+
+    // a DX10 dds of a full mip chain, the data is a pattern
+    std::vector<uint8_t> MakeDds(const CorpusFile& desc)
+    {
+        uint32_t mipCount = 1;
+        while (desc.size >> mipCount)
+        {
+            ++mipCount;
+        }
+        const uint32_t slices = desc.cube ? 6 : 1;
+        const bool blocks = desc.format != FormatR8G8B8A8Unorm;
+        const uint32_t blockBytes = desc.format == FormatBC1Unorm ? 8 : 16;
+
+        std::vector<uint8_t> bytes;
+        Put(&bytes, 0x20534444);
+        Put(&bytes, 124);
+        Put(&bytes, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000);
+        Put(&bytes, desc.size);
+        Put(&bytes, desc.size);
+        Put(&bytes, 0);
+        Put(&bytes, 0);
+        Put(&bytes, mipCount);
+        for (int i = 0; i < 11; ++i)
+        {
+            Put(&bytes, 0);
+        }
+        Put(&bytes, 32);
+        Put(&bytes, 0x4);
+        Put(&bytes, 'D' | ('X' << 8) | ('1' << 16) | ('0' << 24));
+        for (int i = 0; i < 5; ++i)
+        {
+            Put(&bytes, 0);
+        }
+        Put(&bytes, 0x1000);
+        for (int i = 0; i < 4; ++i)
+        {
+            Put(&bytes, 0);
+        }
+        Put(&bytes, desc.format);
+        Put(&bytes, 3);
+        Put(&bytes, desc.cube ? 0x4 : 0);
+        Put(&bytes, 1);
+        Put(&bytes, 0);
+
+        uint64_t dataSize = 0;
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            uint64_t size = desc.size >> mip ? desc.size >> mip : 1;
+            dataSize += blocks ? ((size + 3) / 4) * ((size + 3) / 4) * blockBytes : size * size * 4;
+        }
+        size_t headerSize = bytes.size();
+        bytes.resize(headerSize + (size_t)(dataSize * slices));
+        for (size_t i = headerSize; i < bytes.size(); ++i)
+        {
+            bytes[i] = (uint8_t)(i * 7);
+        }
+        return bytes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int repeats = quick ? 1 : 5;
+
+    std::vector<CorpusFile> descs;
+    const uint32_t scale = quick ? 16 : 1;
+    for (uint32_t i = 0; i < (quick ? 2u : 8u); ++i)
+    {
+        descs.push_back(CorpusFile{ FormatBC1Unorm, 4096 / scale, false });
+        descs.push_back(CorpusFile{ FormatR8G8B8A8Unorm, 1024 / scale, false });
+    }
+    descs.push_back(CorpusFile{ FormatBC3Unorm, 1024 / scale, true });
+
+    // the corpus, kept in memory too for the parse benchmark
+    std::vector<std::string> paths;
+    std::vector<std::vector<uint8_t>> files;
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < descs.size(); ++i)
+    {
+        files.push_back(MakeDds(descs[i]));
+        paths.push_back("DdsTextureBenchmark" + std::to_string(i) + ".dds");
+        std::ofstream out(paths.back().c_str(), std::ios::binary);
+        out.write((const char*)files.back().data(), (std::streamsize)files.back().size());
+        totalBytes += files.back().size();
+    }
+    const uint32_t fileCount = (uint32_t)files.size();
+    printf("%u files, %.1f MB\n", fileCount, totalBytes / 1e6);
+
+    // parse
+    const int parseRounds = quick ? 10 : 1000;
+    DdsInfo info;
+    double parse = MeasureBest(repeats, [&]()
+    {
+        for (int round = 0; round < parseRounds; ++round)
+        {
+            for (uint32_t i = 0; i < fileCount; ++i)
+            {
+                ByteSpan span = { files[i].data(), files[i].size() };
+                if (!ParseDds(span, &info))
+                {
+                    printf("parse failed\n");
+                }
+            }
+        }
+        DoNotOptimize(info);
+    });
+    printf("parse      %10.0f files/s\n", parseRounds * fileCount / parse);
+
+    // every mip of every file through the map
+    double loadAll = MeasureBest(repeats, [&]()
+    {
+        for (uint32_t i = 0; i < fileCount; ++i)
+        {
+            DdsTexture texture;
+            if (!texture.Open(paths[i].c_str()))
+            {
+                printf("open failed\n");
+                continue;
+            }
+            texture.LoadAll();
+            ByteSpan data;
+            texture.GetSubresource(0, 0, &data);
+            DoNotOptimize(data);
+        }
+    });
+    printf("load all   %10.2f GB/s\n", totalBytes / loadAll / 1e9);
+
+    std::vector<char> copy;
+    double readCopy = MeasureBest(repeats, [&]()
+    {
+        for (uint32_t i = 0; i < fileCount; ++i)
+        {
+            std::ifstream in(paths[i].c_str(), std::ios::binary);
+            copy.resize(files[i].size());
+            in.read(copy.data(), (std::streamsize)copy.size());
+            DoNotOptimize(copy[0]);
+        }
+    });
+    printf("read copy  %10.2f GB/s, %.3f ms per file\n", totalBytes / readCopy / 1e9, readCopy * 1e3 / fileCount);
+
+    // time to the first usable mip and to the last one, one file at a time. the calling thread only
+    // polls, so the system needs a worker besides it
+    JobSystem jobs(2);
+    double firstMip = 1e30, lastMip = 1e30;
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        double first = 0.0, last = 0.0;
+        for (uint32_t i = 0; i < fileCount; ++i)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            DdsTexture texture;
+            texture.Open(paths[i].c_str());
+            const uint32_t mipCount = texture.GetInfo().mipCount;
+            JobCounter counter;
+            texture.StreamAsync(&jobs, &counter);
+            while (texture.GetResidentMip() == mipCount)
+            {
+                std::this_thread::yield();
+            }
+            first += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            jobs.Wait(&counter);
+            last += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        firstMip = first < firstMip ? first : firstMip;
+        lastMip = last < lastMip ? last : lastMip;
+    }
+    printf("first mip  %10.3f ms per file, mip 0 after %.3f ms\n", firstMip * 1e3 / fileCount, lastMip * 1e3 / fileCount);
+
+    for (uint32_t i = 0; i < fileCount; ++i)
+    {
+        remove(paths[i].c_str());
+    }
+    return 0;
+}
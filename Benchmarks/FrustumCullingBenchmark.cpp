@@ -0,0 +1,68 @@
+// Frustum culling of 1M boxes in millions of boxes per second: CullAabbs with every kernel, then
+// CullAabbsParallel on 1..N threads. The boxes are scattered around the scene's camera so about one in
+// twenty is visible and many cross a plane. TransformAabbs (world bounds from the matrices,
+// run every frame before culling) is measured on its own.
+
+#include "Benchmark.h"
+#include "FrustumCulling.h"
+#include <DirectXMath.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t count = quick ? 10000 : 1000000;
+    const int repeats = quick ? 1 : 10;
+
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, -4.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f),
+        XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * XMMatrixPerspectiveFovLH(0.785398f, 4.0f / 3.0f, 0.1f, 1000.0f));
+    Frustum frustum;
+    ExtractFrustum(&viewProj.m[0][0], &frustum);
+
+    // unit cubes under random translations and scales
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f), scale(0.1f, 4.0f);
+    std::vector<XMFLOAT4X4> world(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        XMStoreFloat4x4(&world[i], XMMatrixScaling(scale(random), scale(random), scale(random)) *
+            XMMatrixTranslation(position(random), position(random) * 0.1f, position(random)));
+    }
+    const float center[3] = { 0.0f, 0.0f, 0.0f };
+    const float extent[3] = { 1.0f, 1.0f, 1.0f };
+    AabbArrays boxes;
+    boxes.Resize(count);
+    double transform = MeasureBest(repeats, [&]()
+    {
+        TransformAabbs(center, extent, &world[0].m[0][0], nullptr, 0, count, &boxes);
+        DoNotOptimize(boxes.centerX[0]);
+    });
+    printf("%u boxes, best level on this cpu: %s\n", count, GetSimdLevelName(GetSimdLevel()));
+    printf("transform     %8.1f M boxes/s\n", count / transform / 1e6);
+
+    std::vector<uint32_t> visible(count);
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); ++l)
+    {
+        uint32_t visibleCount = 0;
+        double seconds = MeasureBest(repeats, [&]() { visibleCount = CullAabbs(frustum, boxes, 0, count, visible.data(), levels[l]); });
+        printf("cull %-8s %8.1f M boxes/s, %u visible\n", GetSimdLevelName(levels[l]), count / seconds / 1e6, visibleCount);
+    }
+
+    uint32_t maxThreads = std::thread::hardware_concurrency();
+    maxThreads = maxThreads < 1 ? 1 : maxThreads;
+    maxThreads = quick && maxThreads > 2 ? 2 : maxThreads;
+    for (uint32_t threads = 1; threads <= maxThreads; ++threads)
+    {
+        JobSystem jobs(threads);
+        uint32_t visibleCount = 0;
+        double seconds = MeasureBest(repeats, [&]() { visibleCount = CullAabbsParallel(&jobs, frustum, boxes, visible.data()); });
+        printf("parallel on %u threads: %8.1f M boxes/s, %u visible\n", threads, count / seconds / 1e6, visibleCount);
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+// NarrowIndices and GetMaxIndex in GB/s of 32 bit indices read, for every kernel, over 16M indices.
+// Then BuildIndexBuffer16 on meshes past 65536 vertices (a 600 x 600 vertex grid in grid order and
+// with its vertices shuffled): the time it takes, the submeshes it cuts and the memory of the
+// index and vertex buffers against the 32 bit ones.
+
+#include "Benchmark.h"
+#include "IndexNarrowing.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t count = quick ? 1 << 16 : 1 << 24;
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    const int repeats = quick ? 1 : 10;
+
+    std::mt19937 random(1);
+    std::vector<uint32_t> indices(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        indices[i] = random() % 65536;
+    }
+    std::vector<uint16_t> narrowed(count);
+
+    printf("best level on this cpu: %s\n", GetSimdLevelName(GetSimdLevel()));
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); ++l)
+    {
+        double narrow = MeasureBest(repeats, [&]()
+        {
+            NarrowIndices(narrowed.data(), indices.data(), count, 0, levels[l]);
+            DoNotOptimize(narrowed[0]);
+        });
+        uint32_t maxIndex = 0;
+        double max = MeasureBest(repeats, [&]() { maxIndex = GetMaxIndex(indices.data(), count, levels[l]); });
+        DoNotOptimize(maxIndex);
+        printf("%-6s narrow %6.2f GB/s, max %6.2f GB/s\n", GetSimdLevelName(levels[l]), count * 4.0 / narrow / 1e9,
+            count * 4.0 / max / 1e9);
+    }
+
+    // 28 byte vertices, like the scene's
+    struct Vertex
+    {
+        float values[7];
+    };
+    const uint32_t side = quick ? 300 : 600;
+    for (int shuffle = 0; shuffle < 2; ++shuffle)
+    {
+        const uint32_t vertexCount = side * side;
+        std::vector<uint32_t> order(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            order[i] = i;
+        }
+        if (shuffle)
+        {
+            std::shuffle(order.begin(), order.end(), random);
+        }
+        std::vector<Vertex> vertices(vertexCount);
+        std::vector<uint32_t> mesh;
+        for (uint32_t y = 0; y + 1 < side; ++y)
+        {
+            for (uint32_t x = 0; x + 1 < side; ++x)
+            {
+                uint32_t a = order[y * side + x], b = order[y * side + x + 1];
+                uint32_t c = order[(y + 1) * side + x], d = order[(y + 1) * side + x + 1];
+                const uint32_t quad[6] = { a, b, c, b, d, c };
+                mesh.insert(mesh.end(), quad, quad + 6);
+            }
+        }
+
+        std::vector<uint16_t> indices16;
+        std::vector<uint8_t> vertices16;
+        std::vector<Submesh> submeshes;
+        double build = MeasureBest(repeats, [&]()
+        {
+            BuildIndexBuffer16(mesh.data(), (uint32_t)mesh.size(), vertices.data(), vertexCount, sizeof(Vertex), &indices16,
+                &vertices16, &submeshes);
+        });
+        const double bytes32 = mesh.size() * 4.0 + vertexCount * (double)sizeof(Vertex);
+        const double bytes16 = indices16.size() * 2.0 + (double)vertices16.size();
+        printf("%s grid, %u vertices: %.1f ms, %zu submeshes, %.1f%% of the vertices stored twice\n", shuffle ? "shuffled" : "ordered",
+            vertexCount, build * 1e3, submeshes.size(), 100.0 * (vertices16.size() / sizeof(Vertex) - vertexCount) / vertexCount);
+        printf("  indices %.1f -> %.1f MB, indices + vertices %.1f -> %.1f MB\n", mesh.size() * 4.0 / 1e6, indices16.size() * 2.0 / 1e6,
+            bytes32 / 1e6, bytes16 / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+// The scene with 100k grid cubes on the null backend, drawn one DrawIndexedInstanced per cube (a
+// 256 byte constant buffer each) and instanced (every wvp packed into one 64 byte per instance
+// buffer, one draw). Per frame: the draw calls and commands recorded, the cpu time of UpdateScene
+// (culling and packing the matrices) and of RecordScene, and the constant buffer bytes written.
+// Only the cubes inside the frustum are packed, so the visible count is printed as well.
+// The second table takes culling out: all 100k matrices packed with ComputeWvpBatch at either
+// stride and the draws recorded into a null command list, the way RecordScene records them.
+
+#include "Benchmark.h"
+#include "NullRenderBackend.h"
+#include "Scene.h"
+#include "WvpBatch.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct FrameCost
+    {
+        double updateSeconds;
+        double recordSeconds;
+        uint32_t drawCount;
+        uint32_t visibleCount; // instances drawn
+        size_t commandCount;
+        uint64_t uploadBytes;
+    };
+
+    FrameCost MeasureScene(JobSystem* jobs, bool instanced, uint32_t cubeCount, uint32_t frames)
+    {
+        FrameCost cost = {};
+        NullRenderBackend backend;
+        SceneSettings settings = { cubeCount, instanced, false, 0, false, nullptr, nullptr };
+        if (!backend.Init(800, 600) || !InitScene(&backend, jobs, 800, 600, settings))
+        {
+            printf("scene init failed\n");
+            return cost;
+        }
+
+        cost.updateSeconds = 1e30;
+        cost.recordSeconds = 1e30;
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            SimulateScene(1.0f / 120.0f);
+            backend.ClearCommands();
+            if (!backend.BeginFrame())
+            {
+                break;
+            }
+            double update = MeasureBest(1, [&]() { UpdateScene(&backend, 0.5f); });
+            double record = MeasureBest(1, [&]() { RecordScene(&backend); });
+            backend.EndFrame();
+            cost.updateSeconds = update < cost.updateSeconds ? update : cost.updateSeconds;
+            cost.recordSeconds = record < cost.recordSeconds ? record : cost.recordSeconds;
+        }
+
+        const std::vector<RenderCommand>& commands = backend.GetCommands();
+        cost.commandCount = commands.size();
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            if (commands[i].type == RenderCommandType::DrawIndexedInstanced)
+            {
+                ++cost.drawCount;
+                cost.visibleCount += commands[i].draw.instanceCount;
+            }
+        }
+        cost.uploadBytes = GetSceneUploadStats().lastFrameBytes;
+        ShutdownScene();
+        backend.Shutdown();
+        return cost;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t cubeCount = quick ? 1000 : 100000;
+    const uint32_t frames = quick ? 3 : 30;
+
+    JobSystem jobs;
+    printf("%u grid cubes, %u threads, best of %u frames\n", cubeCount, jobs.GetThreadCount(), frames);
+    printf("%-10s %8s %8s %10s %10s %10s %12s\n", "", "draws", "visible", "commands", "update ms", "record ms", "cb bytes");
+    for (int instanced = 0; instanced < 2; ++instanced)
+    {
+        FrameCost cost = MeasureScene(&jobs, instanced != 0, cubeCount, frames);
+        printf("%-10s %8u %8u %10zu %10.3f %10.3f %12llu\n", instanced ? "instanced" : "per draw", cost.drawCount,
+            cost.visibleCount, cost.commandCount, cost.updateSeconds * 1e3, cost.recordSeconds * 1e3,
+            (unsigned long long)cost.uploadBytes);
+    }
+
+    // every instance drawn
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<float> world((size_t)cubeCount * 16);
+    for (size_t i = 0; i < world.size(); ++i)
+    {
+        world[i] = value(random);
+    }
+    float viewProj[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        viewProj[i] = value(random);
+    }
+    std::vector<uint8_t> constants((size_t)cubeCount * 256);
+    std::vector<RenderCommand> stream;
+    stream.reserve((size_t)cubeCount * 2);
+    NullCommandList commandList(&stream);
+    const int repeats = quick ? 1 : 10;
+
+    printf("\n%u instances, all drawn\n", cubeCount);
+    printf("%-10s %8s %10s %10s %12s\n", "", "draws", "pack ms", "record ms", "cb bytes");
+    for (int instanced = 0; instanced < 2; ++instanced)
+    {
+        const uint32_t stride = instanced ? 64 : 256;
+        double pack = MeasureBest(repeats, [&]()
+        {
+            ComputeWvpBatch(world.data(), nullptr, cubeCount, nullptr, viewProj, constants.data(), stride);
+            DoNotOptimize(constants[0]);
+        });
+        double record = MeasureBest(repeats, [&]()
+        {
+            stream.clear();
+            if (instanced)
+            {
+                commandList.SetGraphicsRootShaderResourceView(0, 0);
+                commandList.DrawIndexedInstanced(36, cubeCount, 0, 0, 0);
+                return;
+            }
+            for (uint32_t i = 0; i < cubeCount; ++i)
+            {
+                commandList.SetGraphicsRootConstantBufferView(0, (uint64_t)i * stride);
+                commandList.DrawIndexedInstanced(36, 1, 0, 0, 0);
+            }
+        });
+        printf("%-10s %8u %10.3f %10.3f %12llu\n", instanced ? "instanced" : "per draw", instanced ? 1 : cubeCount,
+            pack * 1e3, record * 1e3, (unsigned long long)cubeCount * stride);
+    }
+    return 0;
+}
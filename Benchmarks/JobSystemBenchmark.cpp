@@ -0,0 +1,105 @@
+// JobSystem scaling from 1 to N threads (one per core by default, --threads N to change it):
+//   compute    ParallelFor over items that each do a fixed amount of arithmetic, the best case
+//   memory     ParallelFor summing a buffer larger than the caches, bound by memory bandwidth
+//   jobs       single jobs queued with Run and drained with Wait, the per job overhead
+// speedups are against the same work on a 1 thread system.
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    float Compute(uint32_t item)
+    {
+        float x = (float)item;
+        for (int i = 0; i < 256; ++i)
+        {
+            x = x * 0.999f + 1.0f;
+        }
+        return x;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    uint32_t maxThreads = std::thread::hardware_concurrency();
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (strcmp(argv[i], "--threads") == 0)
+        {
+            maxThreads = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        }
+    }
+    maxThreads = maxThreads < 1 ? 1 : maxThreads;
+    if (quick)
+    {
+        maxThreads = maxThreads > 2 ? 2 : maxThreads;
+    }
+
+    const uint32_t computeItems = quick ? 10000 : 1000000;
+    const uint32_t memoryItems = quick ? 100000 : 64 * 1024 * 1024; // 256MB of floats
+    const uint32_t jobCount = quick ? 1000 : 200000;
+    const int repeats = quick ? 1 : 5;
+
+    std::vector<float> buffer(memoryItems, 1.0f);
+    double computeBase = 0.0, memoryBase = 0.0, jobsBase = 0.0;
+
+    printf("threads    compute (speedup)      memory (speedup)        jobs/s (speedup)\n");
+    for (uint32_t threads = 1; threads <= maxThreads; ++threads)
+    {
+        JobSystem jobs(threads);
+
+        std::vector<float> results(computeItems);
+        double compute = MeasureBest(repeats, [&]()
+        {
+            jobs.ParallelFor(computeItems, 1024, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    results[i] = Compute(i);
+                }
+            });
+            DoNotOptimize(results[0]);
+        });
+
+        std::atomic<uint64_t> total(0);
+        double memory = MeasureBest(repeats, [&]()
+        {
+            jobs.ParallelFor(memoryItems, 64 * 1024, [&](uint32_t begin, uint32_t end)
+            {
+                float sum = 0.0f;
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    sum += buffer[i];
+                }
+                total.fetch_add((uint64_t)sum);
+            });
+        });
+
+        std::atomic<uint32_t> ran(0);
+        double single = MeasureBest(repeats, [&]()
+        {
+            JobCounter counter;
+            for (uint32_t i = 0; i < jobCount; ++i)
+            {
+                jobs.Run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            jobs.Wait(&counter);
+        });
+
+        if (threads == 1)
+        {
+            computeBase = compute;
+            memoryBase = memory;
+            jobsBase = single;
+        }
+        printf("%7u %9.2f ms (%4.2fx) %9.2f ms (%4.2fx) %11.0f (%4.2fx)\n", threads, compute * 1e3, computeBase / compute,
+            memory * 1e3, memoryBase / memory, jobCount / single, jobsBase / single);
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Loading a mesh from its .obj text against loading it from a MeshFile, on a uv sphere of 800 x 400
+// segments (640k triangles, vertex colors, its triangles shuffled like an exported mesh). Both
+// files are written first, and both writes are timed. From the .obj it is what a loader without
+// the converter would do: read the text, ParseObj (the parser MeshConverter uses), then the cache,
+// overdraw and fetch optimizers, quantization and 16 bit indices, and the upload. From the mesh
+// file it is Open (map and validate) and CreateBuffers. The uploads are submitted on the null
+// backend, the file cache is warm since the files were just written.
+
+#include "Benchmark.h"
+#include "FrustumCulling.h"
+#include "IndexNarrowing.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "NullRenderBackend.h"
+#include "ObjParser.h"
+#include "VertexQuantization.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // what MeshConverter writes into the mesh file, built from a parsed .obj
+    struct BuiltMesh
+    {
+        std::vector<uint16_t> indices;
+        std::vector<uint8_t> vertices;
+        std::vector<Submesh> submeshes;
+        float center[3];
+        float extent[3];
+    };
+
+    bool WriteObj(const char* path, const std::vector<ObjVertex>& vertices, const std::vector<uint32_t>& indices)
+    {
+        // back to right handed, the parser negates z again
+        FILE* file = fopen(path, "wb");
+        if (!file)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const ObjVertex& v = vertices[i];
+            fprintf(file, "v %.6f %.6f %.6f %.6f %.6f %.6f\n", v.position[0], v.position[1], -v.position[2], v.color[0], v.color[1],
+                v.color[2]);
+        }
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            fprintf(file, "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1);
+        }
+        return fclose(file) == 0;
+    }
+
+    bool LoadObj(const char* path, std::vector<ObjVertex>* vertices, std::vector<uint32_t>* indices)
+    {
+        std::ifstream input(path, std::ios::binary);
+        std::stringstream text;
+        text << input.rdbuf();
+        vertices->clear();
+        indices->clear();
+        return input && ParseObj(text.str().c_str(), vertices, indices) && !indices->empty();
+    }
+
+    // the converter's pipeline, "indices" is reordered in place
+    void BuildMesh(const std::vector<ObjVertex>& vertices, std::vector<uint32_t>* indices, BuiltMesh* mesh)
+    {
+        const uint32_t indexCount = (uint32_t)indices->size();
+        const uint32_t vertexCount = (uint32_t)vertices.size();
+        std::vector<uint32_t> ordered(indexCount);
+        std::vector<ObjVertex> fetched(vertexCount);
+        OptimizeVertexCache(indices->data(), indices->data(), indexCount, vertexCount);
+        OptimizeOverdraw(ordered.data(), indices->data(), indexCount, vertices[0].position, sizeof(ObjVertex), vertexCount, 1.05f);
+        uint32_t usedVertexCount = OptimizeVertexFetch(fetched.data(), ordered.data(), indexCount, vertices.data(), vertexCount,
+            sizeof(ObjVertex));
+        ComputeAabb(fetched[0].position, usedVertexCount, sizeof(ObjVertex), mesh->center, mesh->extent);
+        std::vector<QuantizedVertex> quantized(usedVertexCount);
+        QuantizeVertices(quantized.data(), fetched[0].position, sizeof(ObjVertex), fetched[0].color, sizeof(ObjVertex), usedVertexCount,
+            mesh->center, mesh->extent);
+        BuildIndexBuffer16(ordered.data(), indexCount, quantized.data(), usedVertexCount, sizeof(QuantizedVertex), &mesh->indices,
+            &mesh->vertices, &mesh->submeshes);
+    }
+
+    uint64_t FileSize(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        return file ? (uint64_t)file.tellg() : 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t segments = quick ? 40 : 400;
+    const int repeats = quick ? 1 : 5;
+    const char* objPath = "MeshFileBenchmark.obj";
+    const char* meshPath = "MeshFileBenchmark.zwmesh";
+
+    // front faces outside for clockwise triangles in a left handed space
+    std::vector<ObjVertex> sphereVertices;
+    std::vector<uint32_t> sphereIndices;
+    const float pi = 3.14159265f;
+    const uint32_t columns = 2 * segments;
+    for (uint32_t y = 0; y <= segments; ++y)
+    {
+        for (uint32_t x = 0; x <= columns; ++x)
+        {
+            float theta = pi * y / segments, phi = 2.0f * pi * x / columns;
+            ObjVertex vertex = { { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) },
+                { (float)x / columns, (float)y / segments, 0.5f, 1.0f } };
+            sphereVertices.push_back(vertex);
+        }
+    }
+    std::vector<uint32_t> quads;
+    for (uint32_t y = 0; y < segments; ++y)
+    {
+        for (uint32_t x = 0; x < columns; ++x)
+        {
+            quads.push_back(y * (columns + 1) + x);
+        }
+    }
+    std::mt19937 random(1);
+    std::shuffle(quads.begin(), quads.end(), random);
+    for (size_t i = 0; i < quads.size(); ++i)
+    {
+        uint32_t a = quads[i], b = a + 1, c = a + columns + 1, d = c + 1;
+        const uint32_t quad[6] = { a, b, c, b, d, c };
+        sphereIndices.insert(sphereIndices.end(), quad, quad + 6);
+    }
+    const uint32_t indexCount = (uint32_t)sphereIndices.size();
+
+    NullRenderBackend backend;
+    if (!backend.Init(800, 600))
+    {
+        fprintf(stderr, "the null backend failed to initialize\n");
+        return 1;
+    }
+
+    bool ok = true;
+    double writeObj = MeasureBest(repeats, [&]() { ok = ok && WriteObj(objPath, sphereVertices, sphereIndices); });
+
+    // the text read and parsed, then built and uploaded the way the converter would
+    std::vector<ObjVertex> vertices;
+    std::vector<uint32_t> indices;
+    BuiltMesh mesh;
+    double parse = MeasureBest(repeats, [&]() { ok = ok && LoadObj(objPath, &vertices, &indices); });
+    double loadObj = MeasureBest(repeats, [&]()
+    {
+        ok = ok && LoadObj(objPath, &vertices, &indices);
+        BuildMesh(vertices, &indices, &mesh);
+        StaticBuffer vertexBuffer, indexBuffer;
+        ok = ok && backend.CreateStaticBuffer(mesh.vertices.data(), mesh.vertices.size(), ResourceState::VertexAndConstantBuffer,
+            &vertexBuffer) && backend.CreateStaticBuffer(mesh.indices.data(), mesh.indices.size() * sizeof(uint16_t),
+            ResourceState::IndexBuffer, &indexBuffer) && backend.FlushUploads();
+    });
+    if (!ok || vertices.size() != sphereVertices.size() || indices.size() != indexCount)
+    {
+        fprintf(stderr, "the .obj didn't load back\n");
+        return 1;
+    }
+
+    MeshFileInfo info;
+    info.vertexLayout = VertexLayout::PositionColorQuantized;
+    info.vertexStride = sizeof(QuantizedVertex);
+    info.vertexCount = (uint32_t)(mesh.vertices.size() / sizeof(QuantizedVertex));
+    info.indexFormat = IndexFormat::UInt16;
+    info.indexCount = (uint32_t)mesh.indices.size();
+    memcpy(info.boundsCenter, mesh.center, sizeof(mesh.center));
+    memcpy(info.boundsExtent, mesh.extent, sizeof(mesh.extent));
+    info.vertices.data = mesh.vertices.data();
+    info.vertices.size = mesh.vertices.size();
+    info.indices.data = (const uint8_t*)mesh.indices.data();
+    info.indices.size = mesh.indices.size() * sizeof(uint16_t);
+    info.submeshes = mesh.submeshes.data();
+    info.submeshCount = (uint32_t)mesh.submeshes.size();
+    double writeMesh = MeasureBest(repeats, [&]() { ok = ok && WriteMeshFile(meshPath, info); });
+
+    MeshFile file;
+    double loadMesh = MeasureBest(repeats, [&]()
+    {
+        StaticBuffer vertexBuffer, indexBuffer;
+        ok = ok && file.Open(meshPath) && file.CreateBuffers(&backend, &vertexBuffer, &indexBuffer) && backend.FlushUploads();
+        file.Close();
+    });
+
+    // of that, mapping the file and checking the header and sections
+    double open = MeasureBest(repeats, [&]()
+    {
+        ok = ok && file.Open(meshPath);
+        file.Close();
+    });
+    const uint64_t objSize = FileSize(objPath), meshSize = FileSize(meshPath);
+    remove(objPath);
+    remove(meshPath);
+    backend.Shutdown();
+
+    if (!ok)
+    {
+        fprintf(stderr, "writing or loading the mesh file failed\n");
+        return 1;
+    }
+    printf("sphere, %u triangles, %zu vertices, %zu submeshes in the mesh file\n", indexCount / 3, sphereVertices.size(),
+        mesh.submeshes.size());
+    printf(".obj text:  %6.1f MB, written in %7.2f ms, loaded in %7.2f ms (%.2f ms of it reading and parsing)\n", objSize / 1e6,
+        writeObj * 1e3, loadObj * 1e3, parse * 1e3);
+    printf("mesh file:  %6.1f MB, written in %7.2f ms, loaded in %7.2f ms (%.0fx faster, %.2f GB/s, open %.3f ms)\n",
+        meshSize / 1e6, writeMesh * 1e3, loadMesh * 1e3, loadObj / loadMesh, meshSize / loadMesh / 1e9, open * 1e3);
+    return 0;
+}
@@ -0,0 +1,148 @@
+// The MeshOptimizer pipeline over large generated meshes: a 1000 x 1000 quad grid (2M triangles)
+// and a sphere of 1000 x 500 segments (1M triangles), both with their triangles and vertices
+// shuffled. For each mesh the ACMR / ATVR on a 16 and a 32 entry fifo cache as authored, after
+// OptimizeVertexCache and after OptimizeOverdraw, and how fast every stage runs.
+
+#include "Benchmark.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct Vertex
+    {
+        float position[3];
+        float color[4];
+    };
+
+    struct Mesh
+    {
+        const char* name;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // (columns + 1) x (rows + 1) vertices, "place" puts vertex (u, v) in 0..1
+    template <typename Place>
+    Mesh MakePatch(const char* name, uint32_t columns, uint32_t rows, Place place)
+    {
+        Mesh mesh;
+        mesh.name = name;
+        for (uint32_t y = 0; y <= rows; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+            {
+                Vertex vertex = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+                place((float)x / columns, (float)y / rows, vertex.position);
+                mesh.vertices.push_back(vertex);
+            }
+        }
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                uint32_t a = y * (columns + 1) + x, b = a + 1, c = a + columns + 1, d = c + 1;
+                const uint32_t quad[6] = { a, c, b, b, c, d };
+                mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+            }
+        }
+        return mesh;
+    }
+
+    void Shuffle(Mesh* mesh)
+    {
+        std::mt19937 random(1);
+        const uint32_t triangleCount = (uint32_t)mesh->indices.size() / 3;
+        std::vector<uint32_t> triangles(triangleCount), order(mesh->vertices.size());
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            triangles[i] = i;
+        }
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::shuffle(triangles.begin(), triangles.end(), random);
+        std::shuffle(order.begin(), order.end(), random);
+
+        std::vector<Vertex> vertices(mesh->vertices.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            vertices[order[i]] = mesh->vertices[i];
+        }
+        std::vector<uint32_t> indices(mesh->indices.size());
+        for (uint32_t t = 0; t < triangleCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                indices[t * 3 + k] = order[mesh->indices[triangles[t] * 3 + k]];
+            }
+        }
+        mesh->vertices.swap(vertices);
+        mesh->indices.swap(indices);
+    }
+
+    void PrintStats(const char* stage, const std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        VertexCacheStats small = AnalyzeVertexCache(indices.data(), (uint32_t)indices.size(), vertexCount, 16);
+        VertexCacheStats large = AnalyzeVertexCache(indices.data(), (uint32_t)indices.size(), vertexCount, 32);
+        printf("  %-10s acmr %.3f / %.3f, atvr %.3f / %.3f\n", stage, small.acmr, large.acmr, small.atvr, large.atvr);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t size = quick ? 100 : 1000;
+
+    std::vector<Mesh> meshes;
+    meshes.push_back(MakePatch("grid", size, size, [](float u, float v, float* p)
+    {
+        p[0] = u;
+        p[1] = v;
+        p[2] = 0.05f * sinf(u * 40.0f) * cosf(v * 40.0f);
+    }));
+    meshes.push_back(MakePatch("sphere", size, size / 2, [](float u, float v, float* p)
+    {
+        const float pi = 3.14159265f;
+        p[0] = sinf(v * pi) * cosf(u * 2.0f * pi);
+        p[1] = cosf(v * pi);
+        p[2] = sinf(v * pi) * sinf(u * 2.0f * pi);
+    }));
+
+    printf("acmr / atvr on a 16 / 32 entry fifo\n");
+    for (size_t m = 0; m < meshes.size(); ++m)
+    {
+        Mesh& mesh = meshes[m];
+        Shuffle(&mesh);
+        const uint32_t indexCount = (uint32_t)mesh.indices.size();
+        const uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+        const double triangles = indexCount / 3.0;
+        printf("%s, %u triangles, %u vertices\n", mesh.name, indexCount / 3, vertexCount);
+        PrintStats("authored", mesh.indices, vertexCount);
+
+        std::vector<uint32_t> cacheOrder(indexCount);
+        double cache = MeasureBest(1, [&]() { OptimizeVertexCache(cacheOrder.data(), mesh.indices.data(), indexCount, vertexCount); });
+        PrintStats("cache", cacheOrder, vertexCount);
+
+        std::vector<uint32_t> overdrawOrder(indexCount);
+        double overdraw = MeasureBest(1, [&]()
+        {
+            OptimizeOverdraw(overdrawOrder.data(), cacheOrder.data(), indexCount, mesh.vertices[0].position, sizeof(Vertex),
+                vertexCount, 1.05f);
+        });
+        PrintStats("overdraw", overdrawOrder, vertexCount);
+
+        std::vector<Vertex> vertices(vertexCount);
+        double fetch = MeasureBest(1, [&]()
+        {
+            OptimizeVertexFetch(vertices.data(), overdrawOrder.data(), indexCount, mesh.vertices.data(), vertexCount, sizeof(Vertex));
+        });
+        printf("  M triangles/s: cache %.2f, overdraw %.2f, fetch %.2f\n", triangles / cache / 1e6, triangles / overdraw / 1e6,
+            triangles / fetch / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+// BuildMeshlets and CullMeshlets on a uv sphere of 1000 x 500 segments (1M triangles), its triangles
+// shuffled and then put in vertex cache order the way the scene does it. For a few vertex /
+// triangle limits: how long the build takes, how full the meshlets are, how many meshlets per
+// second CullMeshlets gets through, and how much of the mesh it removes from 200 cameras around the
+// sphere, by frustum and by normal cone.
+
+#include "Benchmark.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t segments = quick ? 50 : 500;
+    const int repeats = quick ? 1 : 3;
+    const int cameraCount = quick ? 20 : 200;
+
+    // front faces outside for clockwise triangles in a left handed space
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    const float pi = 3.14159265f;
+    const uint32_t columns = 2 * segments;
+    for (uint32_t y = 0; y <= segments; ++y)
+    {
+        for (uint32_t x = 0; x <= columns; ++x)
+        {
+            float theta = pi * y / segments, phi = 2.0f * pi * x / columns;
+            const float p[3] = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+            positions.insert(positions.end(), p, p + 3);
+        }
+    }
+    for (uint32_t y = 0; y < segments; ++y)
+    {
+        for (uint32_t x = 0; x < columns; ++x)
+        {
+            uint32_t a = y * (columns + 1) + x, b = a + 1, c = a + columns + 1, d = c + 1;
+            const uint32_t quad[6] = { a, b, c, b, d, c };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    const uint32_t vertexCount = (uint32_t)(positions.size() / 3);
+    const uint32_t indexCount = (uint32_t)indices.size();
+
+    std::mt19937 random(1);
+    std::vector<uint32_t> triangles(indexCount / 3), shuffled(indexCount);
+    for (uint32_t i = 0; i < triangles.size(); ++i)
+    {
+        triangles[i] = i;
+    }
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    for (uint32_t t = 0; t < triangles.size(); ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            shuffled[t * 3 + k] = indices[triangles[t] * 3 + k];
+        }
+    }
+    OptimizeVertexCache(indices.data(), shuffled.data(), indexCount, vertexCount);
+    printf("sphere, %u triangles, %u vertices\n", indexCount / 3, vertexCount);
+
+    // cameras 1.5 to 5 radii out, looking near the middle
+    std::vector<Frustum> frustums(cameraCount);
+    std::vector<XMFLOAT3> eyes(cameraCount);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (int c = 0; c < cameraCount; ++c)
+    {
+        XMVECTOR direction;
+        do
+        {
+            direction = XMVectorSet(unit(random), unit(random), unit(random), 0.0f);
+        } while (XMVectorGetX(XMVector3Length(direction)) < 0.1f || XMVectorGetX(XMVector3Length(direction)) > 1.0f);
+        XMVECTOR eye = XMVectorScale(XMVector3Normalize(direction), 1.5f + 3.5f * (c % 8) / 7.0f);
+        XMVECTOR target = XMVectorSet(0.3f * unit(random), 0.3f * unit(random), 0.3f * unit(random), 1.0f);
+        XMMATRIX view = XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, view * XMMatrixPerspectiveFovLH(0.6f, 4.0f / 3.0f, 0.1f, 100.0f));
+        ExtractFrustum(&viewProj.m[0][0], &frustums[c]);
+        XMStoreFloat3(&eyes[c], eye);
+    }
+
+    const uint32_t limits[][2] = { { 64, 124 }, { 64, 64 }, { 128, 256 }, { 256, 256 } };
+    for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); ++l)
+    {
+        MeshletData data;
+        double build = MeasureBest(repeats, [&]()
+        {
+            BuildMeshlets(indices.data(), indexCount, positions.data(), 3 * sizeof(float), vertexCount, limits[l][0], limits[l][1], &data);
+        });
+        const uint32_t meshletCount = (uint32_t)data.meshlets.size();
+        double fill = 0.0;
+        for (uint32_t m = 0; m < meshletCount; ++m)
+        {
+            fill += (double)data.meshlets[m].primitiveCount / limits[l][1];
+        }
+
+        std::vector<uint32_t> visible(meshletCount);
+        uint64_t frustumCulled = 0, coneCulled = 0, drawnTriangles = 0;
+        double cull = 0.0;
+        for (int c = 0; c < cameraCount; ++c)
+        {
+            MeshletCullStats stats;
+            uint32_t visibleCount = 0;
+            cull += MeasureBest(1, [&]()
+            {
+                visibleCount = CullMeshlets(data.bounds.data(), meshletCount, frustums[c], &eyes[c].x, visible.data(), &stats);
+            });
+            frustumCulled += stats.frustumCulled;
+            coneCulled += stats.coneCulled;
+            for (uint32_t i = 0; i < visibleCount; ++i)
+            {
+                drawnTriangles += data.meshlets[visible[i]].primitiveCount;
+            }
+        }
+        const double tested = (double)meshletCount * cameraCount;
+        printf("%3u vertices / %3u triangles: %u meshlets, %.1f%% full, build %.1f ms (%.2f M triangles/s)\n", limits[l][0],
+            limits[l][1], meshletCount, 100.0 * fill / meshletCount, build * 1e3, indexCount / 3.0 / build / 1e6);
+        printf("  cull %.1f M meshlets/s: %.1f%% outside the frustum, %.1f%% facing away, %.1f%% of the triangles drawn\n",
+            tested / cull / 1e6, 100.0 * frustumCulled / tested, 100.0 * coneCulled / tested,
+            100.0 * drawnTriangles / ((double)indexCount / 3.0 * cameraCount));
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Frame times of the scene drawn by SoftwareRenderBackend at the window size (800x600): the two
+// big cubes alone, which is what the game shows, and with 400 grid cubes under them. One frame is
+// all of it, simulation, UpdateScene, RecordScene and EndFrame rasterizing into the back buffer,
+// for 1 rasterizer thread and for every core. p50 / p99 / max over the frames, and the frame rate
+// at the median; 60 fps and more is interactive.
+
+#include "Benchmark.h"
+#include "FrameTimeHistogram.h"
+#include "JobSystem.h"
+#include "Scene.h"
+#include "SoftwareRenderBackend.h"
+#include <thread>
+
+namespace
+{
+    bool MeasureFrames(uint32_t threadCount, uint32_t gridCubeCount, int width, int height, uint32_t frames,
+        FrameTimeHistogram* histogram)
+    {
+        JobSystem jobs(threadCount);
+        SoftwareRenderBackend backend(&jobs);
+        SceneSettings settings = { gridCubeCount, true, false, 0, true, nullptr, nullptr };
+        if (!backend.Init(width, height) || !InitScene(&backend, &jobs, width, height, settings))
+        {
+            return false;
+        }
+
+        // a few frames first, so every back buffer and upload page exists
+        bool ok = true;
+        for (uint32_t frame = 0; frame < frames + 5 && ok; ++frame)
+        {
+            double seconds = MeasureBest(1, [&]()
+            {
+                SimulateScene(1.0f / 120.0f);
+                ok = backend.BeginFrame() && UpdateScene(&backend, 1.0f) && RecordScene(&backend) && backend.EndFrame();
+                backend.ClearCommands();
+            });
+            if (frame >= 5)
+            {
+                histogram->AddSample(seconds);
+            }
+        }
+        ShutdownScene();
+        backend.Shutdown();
+        return ok;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int width = quick ? 200 : 800;
+    const int height = quick ? 150 : 600;
+    const uint32_t frames = quick ? 5 : 300;
+
+    uint32_t cores = std::thread::hardware_concurrency();
+    cores = cores > 0 ? cores : 1;
+    const uint32_t threadCounts[] = { 1, cores };
+    const uint32_t gridCubeCounts[] = { 0, 400 };
+
+    printf("software backend, %dx%d, %u frames\n", width, height, frames);
+    for (uint32_t gridCubeCount : gridCubeCounts)
+    {
+        for (int t = 0; t < (cores > 1 ? 2 : 1); ++t)
+        {
+            FrameTimeHistogram histogram(frames);
+            if (!MeasureFrames(threadCounts[t], gridCubeCount, width, height, frames, &histogram))
+            {
+                fprintf(stderr, "a frame failed\n");
+                return 1;
+            }
+            FrameTimeStats stats = histogram.Stats();
+            printf("%-27s %2u threads: p50 %6.2f ms, p99 %6.2f ms, max %6.2f ms, %6.0f fps\n",
+                gridCubeCount ? "two cubes + 400 grid cubes," : "two cubes,", threadCounts[t],
+                stats.p50 * 1e3, stats.p99 * 1e3, stats.max * 1e3, 1.0 / stats.p50);
+        }
+    }
+    return 0;
+}
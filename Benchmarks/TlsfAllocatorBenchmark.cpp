@@ -0,0 +1,236 @@
+// TlsfAllocator against a first fit allocator over an address ordered free list (std::map), the
+// usual simple way to place resources in a heap:
+//   churn         random allocations (1B..64KB, a quarter up to 4MB, aligned 256B..64KB) and frees
+//                 in a 1GB range, millions of operations per second. allocations win slightly, so
+//                 the range runs full and the requests that no longer fit are counted
+//   defragment    half of a full 256MB range freed at random, then PlanDefragmentation passes are
+//                 executed: every move is copied in a real 256MB buffer and its source freed.
+//                 reports the fragmentation before and after and the GB/s of the copies
+
+#include "Benchmark.h"
+#include "TlsfAllocator.h"
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // first fit in address order, neighbours merged on free
+    class FirstFitAllocator
+    {
+    public:
+        void Init(uint64_t size)
+        {
+            mFree.clear();
+            mFree[0] = size;
+        }
+
+        bool Allocate(uint64_t size, uint64_t alignment, uint64_t* offset)
+        {
+            for (std::map<uint64_t, uint64_t>::iterator it = mFree.begin(); it != mFree.end(); ++it)
+            {
+                uint64_t start = (it->first + alignment - 1) & ~(alignment - 1);
+                uint64_t end = it->first + it->second;
+                if (start + size > end)
+                {
+                    continue;
+                }
+                uint64_t blockStart = it->first;
+                mFree.erase(it);
+                if (start > blockStart)
+                {
+                    mFree[blockStart] = start - blockStart;
+                }
+                if (end > start + size)
+                {
+                    mFree[start + size] = end - start - size;
+                }
+                *offset = start;
+                return true;
+            }
+            return false;
+        }
+
+        void Free(uint64_t offset, uint64_t size)
+        {
+            std::map<uint64_t, uint64_t>::iterator next = mFree.lower_bound(offset);
+            if (next != mFree.end() && offset + size == next->first)
+            {
+                size += next->second;
+                next = mFree.erase(next);
+            }
+            if (next != mFree.begin())
+            {
+                std::map<uint64_t, uint64_t>::iterator prev = next;
+                --prev;
+                if (prev->first + prev->second == offset)
+                {
+                    prev->second += size;
+                    return;
+                }
+            }
+            mFree[offset] = size;
+        }
+
+    private:
+        std::map<uint64_t, uint64_t> mFree; // offset -> size
+    };
+
+    struct Request
+    {
+        bool allocate;
+        uint64_t size;
+        uint64_t alignment;
+        uint32_t victim; // random number picking the allocation to free
+    };
+
+    // the same sequence for both allocators, allocations win slightly so the range fills up
+    std::vector<Request> MakeRequests(uint32_t count)
+    {
+        std::mt19937_64 random(1);
+        std::vector<Request> requests(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Request& request = requests[i];
+            request.allocate = random() % 100 < 52;
+            request.size = random() % 4 == 0 ? random() % (4 << 20) + 1 : random() % 65536 + 1;
+            request.alignment = 1ull << (8 + random() % 9);
+            request.victim = (uint32_t)random();
+        }
+        return requests;
+    }
+
+    struct Live
+    {
+        TlsfHandle handle;
+        uint64_t offset;
+        uint64_t size;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int repeats = quick ? 1 : 3;
+    const uint64_t rangeSize = 1ull << 30;
+
+    // churn
+    const std::vector<Request> requests = MakeRequests(quick ? 20000 : 200000);
+    std::vector<Live> live;
+    uint64_t failures = 0;
+    TlsfAllocator tlsf;
+    double tlsfSeconds = MeasureBest(repeats, [&]()
+    {
+        tlsf.Init(rangeSize, 256);
+        live.clear();
+        failures = 0;
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            const Request& request = requests[i];
+            TlsfAllocation allocation;
+            if (request.allocate || live.empty())
+            {
+                if (tlsf.Allocate(request.size, request.alignment, &allocation))
+                {
+                    live.push_back(Live{ allocation.handle, allocation.offset, allocation.size });
+                }
+                else
+                {
+                    ++failures;
+                }
+            }
+            else
+            {
+                size_t victim = request.victim % live.size();
+                tlsf.Free(live[victim].handle);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+    });
+    TlsfStats tlsfStats = tlsf.GetStats();
+    printf("tlsf       %8.2f Mops/s, %zu live, %llu failed, %.1f%% used, %u free blocks, fragmentation %.3f\n",
+        requests.size() / tlsfSeconds / 1e6, live.size(), (unsigned long long)failures, 100.0 * tlsfStats.usedSize / tlsfStats.size,
+        tlsfStats.freeBlockCount, tlsfStats.fragmentation);
+
+    FirstFitAllocator firstFit;
+    double firstFitSeconds = MeasureBest(repeats, [&]()
+    {
+        firstFit.Init(rangeSize);
+        live.clear();
+        failures = 0;
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            const Request& request = requests[i];
+            if (request.allocate || live.empty())
+            {
+                uint64_t size = (request.size + 255) & ~255ull;
+                uint64_t offset;
+                if (firstFit.Allocate(size, request.alignment, &offset))
+                {
+                    live.push_back(Live{ 0, offset, size });
+                }
+                else
+                {
+                    ++failures;
+                }
+            }
+            else
+            {
+                size_t victim = request.victim % live.size();
+                firstFit.Free(live[victim].offset, live[victim].size);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+    });
+    printf("first fit  %8.2f Mops/s, %zu live, %llu failed\n", requests.size() / firstFitSeconds / 1e6, live.size(),
+        (unsigned long long)failures);
+
+    // defragment, executed on real memory
+    const uint64_t heapSize = quick ? 16ull << 20 : 256ull << 20;
+    std::vector<uint8_t> memory((size_t)heapSize, 1);
+    std::mt19937_64 random(2);
+    TlsfAllocator heap;
+    heap.Init(heapSize, 256);
+    live.clear();
+    TlsfAllocation allocation;
+    while (heap.Allocate(random() % 65536 + 1, 256, &allocation))
+    {
+        live.push_back(Live{ allocation.handle, allocation.offset, allocation.size });
+    }
+    for (size_t i = 0; i < live.size(); ++i)
+    {
+        if (random() % 2 == 0)
+        {
+            heap.Free(live[i].handle);
+        }
+    }
+    TlsfStats before = heap.GetStats();
+
+    std::vector<TlsfMove> moves;
+    uint64_t movedBytes = 0;
+    uint32_t passes = 0, moveCount = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    do
+    {
+        moves.clear();
+        heap.PlanDefragmentation(quick ? 1000 : 100000, &moves);
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            memcpy(&memory[(size_t)moves[i].destination.offset], &memory[(size_t)moves[i].source.offset], (size_t)moves[i].source.size);
+            heap.Free(moves[i].source.handle);
+            movedBytes += moves[i].source.size;
+        }
+        moveCount += (uint32_t)moves.size();
+        ++passes;
+    } while (!moves.empty() && passes < 100);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    DoNotOptimize(memory[0]);
+    TlsfStats after = heap.GetStats();
+    printf("defragment %u MB: %u free blocks, fragmentation %.3f -> %u free blocks, fragmentation %.3f\n",
+        (uint32_t)(heapSize >> 20), before.freeBlockCount, before.fragmentation, after.freeBlockCount, after.fragmentation);
+    printf("           %u moves in %u passes, %.1f MB moved in %.3f ms, %.2f GB/s including planning\n", moveCount, passes,
+        movedBytes / 1e6, seconds * 1e3, movedBytes / seconds / 1e9);
+    return 0;
+}
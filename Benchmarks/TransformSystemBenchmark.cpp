@@ -0,0 +1,74 @@
+// TransformSystem::UpdateWorld and Integrate over a scene shaped like the demo's grid (many spinning
+// children of one anchor, plus a few deeper chains), against building every world matrix on its
+// own by walking up the parent chain, the way the per object globals did it.
+
+#include "Benchmark.h"
+#include "TransformSystem.h"
+#include <vector>
+using namespace DirectX;
+
+namespace
+{
+    // every object's world matrix computed independently, parents included each time
+    XMMATRIX XM_CALLCONV ComputeWorldRecursive(const TransformSystem& transforms, TransformHandle transform)
+    {
+        const XMFLOAT3& p = transforms.GetPosition(transform);
+        const XMFLOAT4& r = transforms.GetRotation(transform);
+        const XMFLOAT3& s = transforms.GetScale(transform);
+        XMMATRIX local = XMMatrixAffineTransformation(XMLoadFloat3(&s), XMVectorZero(), XMLoadFloat4(&r), XMLoadFloat3(&p));
+        TransformHandle parent = transforms.GetParent(transform);
+        return parent == InvalidTransform ? local : local * ComputeWorldRecursive(transforms, parent);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t counts[] = { 1000, 10000, 100000 };
+    const int repeats = quick ? 1 : 20;
+
+    for (uint32_t c = 0; c < (quick ? 1u : 3u); ++c)
+    {
+        const uint32_t count = counts[c];
+
+        TransformSystem transforms;
+        transforms.Reserve(count);
+        const XMFLOAT4 identity(0.0f, 0.0f, 0.0f, 1.0f);
+        TransformHandle anchor = transforms.Create(InvalidTransform, XMFLOAT3(0.0f, 0.0f, 0.0f), identity, XMFLOAT3(1.0f, 1.0f, 1.0f));
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            // every 16th object hangs off the previous one, the rest off the anchor
+            TransformHandle parent = i % 16 == 0 ? i - 1 : anchor;
+            TransformHandle t = transforms.Create(parent, XMFLOAT3((float)(i % 100), -1.5f, (float)(i / 100)), identity,
+                XMFLOAT3(0.2f, 0.2f, 0.2f));
+            transforms.SetAngularVelocity(t, XMFLOAT3(0.0f, 0.5f + 0.25f * (i % 7), 0.0f));
+        }
+
+        double integrate = MeasureBest(repeats, [&]()
+        {
+            transforms.BeginStep();
+            transforms.Integrate(1.0f / 120.0f);
+        });
+        double update = MeasureBest(repeats, [&]()
+        {
+            transforms.UpdateWorld(0.5f);
+            DoNotOptimize(*transforms.WorldMatrices());
+        });
+
+        // the old way, interpolation left out in its favour
+        std::vector<XMFLOAT4X4> world(count);
+        double recursive = MeasureBest(repeats, [&]()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                XMStoreFloat4x4(&world[i], ComputeWorldRecursive(transforms, i));
+            }
+            DoNotOptimize(world[count - 1]);
+        });
+
+        printf("%7u transforms: Integrate %7.3f ms (%6.1f M/s), UpdateWorld %7.3f ms (%6.1f M/s), per object %7.3f ms (%6.1f M/s)\n",
+            count, integrate * 1e3, count / integrate * 1e-6, update * 1e3, count / update * 1e-6, recursive * 1e3,
+            count / recursive * 1e-6);
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// UploadPacker throughput in GB/s of source data, against what UpdateSubresources does (a memcpy per
+// row, MemcpySubresource) and a plain memcpy of the whole thing:
+//   buffer          one 64MB row, the static buffer case
+//   rgba8 4096      a mip chain whose rows are already 256 byte multiples, copied in one piece
+//   rgba8 1000      a mip chain with 4000 byte rows padded to 4096 in the footprint
+//   bc1 4096        block rows of a compressed mip chain
+// and the rgba8 4096 chain packed with PackSubresources on 1..N threads.
+// The staging memory here is ordinary cached memory; on a real upload heap (write combined) the
+// streaming stores matter more, regular stores there go through the few write combining buffers.
+
+#include "Benchmark.h"
+#include "UploadPacker.h"
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Chain
+    {
+        const char* name;
+        std::vector<uint32_t> rowSizes;
+        std::vector<uint32_t> rowCounts;
+        std::vector<uint32_t> depths;
+        std::vector<UploadFootprint> footprints;
+        std::vector<SubresourceSource> sources;
+        std::vector<uint8_t> data; // every subresource tightly packed
+        uint64_t dataSize;
+        uint64_t stagingSize;
+    };
+
+    // a full mip chain of "size" x "size", "blockBytes" 0 for 4 byte pixels
+    Chain MakeChain(const char* name, uint32_t size, uint32_t blockBytes)
+    {
+        Chain chain;
+        chain.name = name;
+        for (uint32_t mip = 0; size >> mip; ++mip)
+        {
+            uint32_t width = size >> mip;
+            chain.rowSizes.push_back(blockBytes ? (width + 3) / 4 * blockBytes : width * 4);
+            chain.rowCounts.push_back(blockBytes ? (width + 3) / 4 : width);
+            chain.depths.push_back(1);
+        }
+        const uint32_t count = (uint32_t)chain.rowSizes.size();
+        chain.footprints.resize(count);
+        chain.stagingSize = UploadPacker::ComputeFootprints(count, chain.rowSizes.data(), chain.rowCounts.data(),
+            chain.depths.data(), 0, chain.footprints.data());
+
+        chain.dataSize = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            chain.dataSize += (uint64_t)chain.rowSizes[i] * chain.rowCounts[i];
+        }
+        chain.data.resize((size_t)chain.dataSize);
+        for (size_t i = 0; i < chain.data.size(); ++i)
+        {
+            chain.data[i] = (uint8_t)(i * 13);
+        }
+
+        uint64_t offset = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SubresourceSource source;
+            source.data = chain.data.data() + offset;
+            source.rowPitch = chain.rowSizes[i];
+            source.slicePitch = (uint64_t)chain.rowSizes[i] * chain.rowCounts[i];
+            chain.sources.push_back(source);
+            offset += source.slicePitch;
+        }
+        return chain;
+    }
+
+    // MemcpySubresource: every row on its own
+    void CopyRows(const Chain& chain, uint8_t* staging)
+    {
+        for (size_t i = 0; i < chain.footprints.size(); ++i)
+        {
+            const UploadFootprint& footprint = chain.footprints[i];
+            const uint8_t* src = (const uint8_t*)chain.sources[i].data;
+            for (uint32_t row = 0; row < footprint.rowCount; ++row)
+            {
+                memcpy(staging + footprint.offset + (uint64_t)row * footprint.rowPitch, src + (uint64_t)row * footprint.rowSize,
+                    footprint.rowSize);
+            }
+        }
+    }
+
+    void Pack(const Chain& chain, uint8_t* staging, SimdLevel level)
+    {
+        for (size_t i = 0; i < chain.footprints.size(); ++i)
+        {
+            UploadPacker::PackSubresource(chain.sources[i], chain.footprints[i], staging, level);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int repeats = quick ? 1 : 10;
+    const uint32_t scale = quick ? 16 : 1;
+
+    std::vector<Chain> chains;
+    chains.push_back(MakeChain("rgba8 4096", 4096 / scale, 0));
+    chains.push_back(MakeChain("rgba8 1000", 1000 / scale, 0));
+    chains.push_back(MakeChain("bc1 4096", 4096 / scale, 8));
+
+    // the buffer is a chain of one row
+    Chain buffer;
+    buffer.name = "buffer";
+    buffer.dataSize = quick ? 1024 * 1024 : 64 * 1024 * 1024;
+    buffer.data.assign((size_t)buffer.dataSize, 7);
+    buffer.rowSizes.push_back((uint32_t)buffer.dataSize);
+    buffer.rowCounts.push_back(1);
+    buffer.depths.push_back(1);
+    UploadFootprint bufferFootprint = { 0, (uint32_t)buffer.dataSize, (uint32_t)buffer.dataSize, 1, 1 };
+    buffer.footprints.push_back(bufferFootprint);
+    SubresourceSource bufferSource = { buffer.data.data(), buffer.dataSize, buffer.dataSize };
+    buffer.sources.push_back(bufferSource);
+    buffer.stagingSize = buffer.dataSize;
+    chains.insert(chains.begin(), buffer);
+
+    printf("%-12s %10s %10s %10s %10s\n", "GB/s", "memcpy", "rows", "scalar", "streaming");
+    for (size_t c = 0; c < chains.size(); ++c)
+    {
+        const Chain& chain = chains[c];
+        std::vector<uint8_t> staging((size_t)chain.stagingSize);
+        memset(staging.data(), 0, staging.size()); // fault the pages in before timing
+
+        std::vector<uint8_t> flat((size_t)chain.dataSize);
+        double whole = MeasureBest(repeats, [&]() { memcpy(flat.data(), chain.data.data(), flat.size()); DoNotOptimize(flat[0]); });
+        double rows = MeasureBest(repeats, [&]() { CopyRows(chain, staging.data()); DoNotOptimize(staging[0]); });
+        double scalar = MeasureBest(repeats, [&]() { Pack(chain, staging.data(), SimdLevel::Scalar); DoNotOptimize(staging[0]); });
+        double streaming = MeasureBest(repeats, [&]() { Pack(chain, staging.data(), GetSimdLevel()); DoNotOptimize(staging[0]); });
+        const double bytes = (double)chain.dataSize;
+        printf("%-12s %10.2f %10.2f %10.2f %10.2f\n", chain.name, bytes / whole / 1e9, bytes / rows / 1e9, bytes / scalar / 1e9,
+            bytes / streaming / 1e9);
+    }
+
+    // the whole chain split over the job system
+    uint32_t maxThreads = std::thread::hardware_concurrency();
+    maxThreads = maxThreads < 1 ? 1 : maxThreads;
+    maxThreads = quick && maxThreads > 2 ? 2 : maxThreads;
+    const Chain& chain = chains[1];
+    std::vector<uint8_t> staging((size_t)chain.stagingSize, 0);
+    for (uint32_t threads = 1; threads <= maxThreads; ++threads)
+    {
+        JobSystem jobs(threads);
+        double seconds = MeasureBest(repeats, [&]()
+        {
+            UploadPacker::PackSubresources(&jobs, (uint32_t)chain.footprints.size(), chain.sources.data(),
+                chain.footprints.data(), staging.data());
+            DoNotOptimize(staging[0]);
+        });
+        printf("%s on %u threads: %.2f GB/s\n", chain.name, threads, chain.dataSize / seconds / 1e9);
+    }
+    return 0;
+}
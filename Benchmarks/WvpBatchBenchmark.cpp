@@ -0,0 +1,62 @@
+// ComputeWvpBatch in matrices per second for every kernel, at the instance buffer stride (64 bytes)
+// and the constant buffer stride (256 bytes), with and without the dequantization matrix. The batch
+// sizes go from cache resident to well past the last level cache.
+
+#include "Benchmark.h"
+#include "WvpBatch.h"
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t counts[] = { 1000, 100000, 1000000 };
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    const uint32_t strides[] = { 64, 256 };
+    const int repeats = quick ? 1 : 10;
+
+    printf("best level on this cpu: %s\n", GetSimdLevelName(GetSimdLevel()));
+
+    const uint32_t maxCount = quick ? counts[0] : counts[2];
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<float> world((size_t)maxCount * 16);
+    for (size_t i = 0; i < world.size(); ++i)
+    {
+        world[i] = value(random);
+    }
+    float viewProj[16], local[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        viewProj[i] = value(random);
+        local[i] = value(random);
+    }
+    std::vector<uint8_t> output((size_t)maxCount * 256);
+
+    for (uint32_t c = 0; c < 3 && counts[c] <= maxCount; ++c)
+    {
+        const uint32_t count = counts[c];
+        for (uint32_t s = 0; s < 2; ++s)
+        {
+            for (int withLocal = 0; withLocal < 2; ++withLocal)
+            {
+                printf("%8u matrices, stride %3u%s:", count, strides[s], withLocal ? ", local" : "       ");
+                for (uint32_t l = 0; l < 3; ++l)
+                {
+                    if (levels[l] > GetSimdLevel())
+                    {
+                        continue; // would run the best level there is again
+                    }
+                    double seconds = MeasureBest(repeats, [&]()
+                    {
+                        ComputeWvpBatch(world.data(), nullptr, count, withLocal ? local : nullptr, viewProj, output.data(), strides[s], levels[l]);
+                        DoNotOptimize(output[0]);
+                    });
+                    printf("  %s %7.1f M/s", GetSimdLevelName(levels[l]), count / seconds * 1e-6);
+                }
+                printf("\n");
+            }
+        }
+    }
+    return 0;
+}
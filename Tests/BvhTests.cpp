@@ -0,0 +1,246 @@
+#include "TestFramework.h"
+#include "Bvh.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// every query against a brute force loop over the boxes, before and after a refit
+
+namespace
+{
+    AabbArrays RandomBoxes(uint32_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(0.0f, 1000.0f), extent(0.5f, 8.0f);
+        AabbArrays boxes;
+        boxes.Resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            boxes.centerX[i] = position(random);
+            boxes.centerY[i] = position(random);
+            boxes.centerZ[i] = position(random);
+            boxes.extentX[i] = extent(random);
+            boxes.extentY[i] = extent(random);
+            boxes.extentZ[i] = extent(random);
+        }
+        return boxes;
+    }
+
+    void GetBox(const AabbArrays& boxes, uint32_t i, float minimum[3], float maximum[3])
+    {
+        minimum[0] = boxes.centerX[i] - boxes.extentX[i];
+        minimum[1] = boxes.centerY[i] - boxes.extentY[i];
+        minimum[2] = boxes.centerZ[i] - boxes.extentZ[i];
+        maximum[0] = boxes.centerX[i] + boxes.extentX[i];
+        maximum[1] = boxes.centerY[i] + boxes.extentY[i];
+        maximum[2] = boxes.centerZ[i] + boxes.extentZ[i];
+    }
+
+    // the inside of an axis aligned box as six inward planes
+    Frustum BoxFrustum(const float minimum[3], const float maximum[3])
+    {
+        Frustum frustum = {};
+        for (int c = 0; c < 3; ++c)
+        {
+            frustum.planes[2 * c][c] = 1.0f;
+            frustum.planes[2 * c][3] = -minimum[c];
+            frustum.planes[2 * c + 1][c] = -1.0f;
+            frustum.planes[2 * c + 1][3] = maximum[c];
+        }
+        return frustum;
+    }
+
+    std::vector<uint32_t> Sorted(std::vector<uint32_t> items)
+    {
+        std::sort(items.begin(), items.end());
+        return items;
+    }
+
+    std::vector<uint32_t> CullAll(const Frustum& frustum, const AabbArrays& boxes)
+    {
+        std::vector<uint32_t> visible(boxes.Size());
+        visible.resize(CullAabbs(frustum, boxes, 0, boxes.Size(), visible.data(), SimdLevel::Scalar));
+        return visible;
+    }
+
+    std::vector<uint32_t> OverlapAll(const AabbArrays& boxes, const float minimum[3], const float maximum[3])
+    {
+        std::vector<uint32_t> overlapping;
+        for (uint32_t i = 0; i < boxes.Size(); ++i)
+        {
+            float boxMinimum[3], boxMaximum[3];
+            GetBox(boxes, i, boxMinimum, boxMaximum);
+            bool overlaps = true;
+            for (int c = 0; c < 3; ++c)
+            {
+                overlaps = overlaps && boxMinimum[c] <= maximum[c] && boxMaximum[c] >= minimum[c];
+            }
+            if (overlaps)
+            {
+                overlapping.push_back(i);
+            }
+        }
+        return overlapping;
+    }
+
+    // closest entry distance of the slab test over every box, negative for a miss
+    float RaycastAll(const AabbArrays& boxes, const float origin[3], const float direction[3], float maxDistance)
+    {
+        float closest = -1.0f;
+        for (uint32_t i = 0; i < boxes.Size(); ++i)
+        {
+            float minimum[3], maximum[3];
+            GetBox(boxes, i, minimum, maximum);
+            float enter = 0.0f, leave = maxDistance;
+            for (int c = 0; c < 3; ++c)
+            {
+                float t0 = (minimum[c] - origin[c]) / direction[c];
+                float t1 = (maximum[c] - origin[c]) / direction[c];
+                enter = std::max(enter, std::min(t0, t1));
+                leave = std::min(leave, std::max(t0, t1));
+            }
+            if (enter <= leave && (closest < 0.0f || enter < closest))
+            {
+                closest = enter;
+            }
+        }
+        return closest;
+    }
+
+    AabbArrays AabbSubset(const AabbArrays& boxes, uint32_t i)
+    {
+        AabbArrays one;
+        one.Resize(1);
+        one.centerX[0] = boxes.centerX[i];
+        one.centerY[0] = boxes.centerY[i];
+        one.centerZ[0] = boxes.centerZ[i];
+        one.extentX[0] = boxes.extentX[i];
+        one.extentY[0] = boxes.extentY[i];
+        one.extentZ[0] = boxes.extentZ[i];
+        return one;
+    }
+
+    // queries that hit a few, many and none of the boxes
+    void CheckQueries(const Bvh& bvh, const AabbArrays& boxes)
+    {
+        const float regions[3][2][3] = {
+            { { 100.0f, 100.0f, 100.0f }, { 150.0f, 160.0f, 170.0f } },
+            { { 200.0f, 100.0f, 300.0f }, { 500.0f, 600.0f, 700.0f } },
+            { { -50.0f, -50.0f, -50.0f }, { -10.0f, -10.0f, -10.0f } },
+        };
+        for (int r = 0; r < 3; ++r)
+        {
+            std::vector<uint32_t> items;
+            bvh.QueryFrustum(BoxFrustum(regions[r][0], regions[r][1]), &items);
+            ZW_CHECK(Sorted(items) == CullAll(BoxFrustum(regions[r][0], regions[r][1]), boxes));
+
+            items.clear();
+            bvh.QueryAabb(regions[r][0], regions[r][1], &items);
+            ZW_CHECK(Sorted(items) == OverlapAll(boxes, regions[r][0], regions[r][1]));
+        }
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> position(0.0f, 1000.0f), direction(-1.0f, 1.0f);
+        uint32_t hits = 0, mismatches = 0;
+        for (int r = 0; r < 200; ++r)
+        {
+            const float origin[3] = { position(random), position(random), position(random) };
+            const float rayDirection[3] = { direction(random), direction(random), direction(random) };
+            const float maxDistance = r % 2 ? 1e9f : 100.0f;
+            BvhRayHit hit;
+            bool found = bvh.Raycast(origin, rayDirection, maxDistance, &hit);
+            float expected = RaycastAll(boxes, origin, rayDirection, maxDistance);
+            if (found != (expected >= 0.0f))
+            {
+                ++mismatches;
+                continue;
+            }
+            if (found)
+            {
+                ++hits;
+                // the reported box must be hit at the reported distance, ties may pick either box
+                float itemDistance = RaycastAll(AabbSubset(boxes, hit.item), origin, rayDirection, maxDistance);
+                mismatches += fabsf(hit.distance - expected) > 1e-3f * std::max(1.0f, expected) ||
+                    fabsf(itemDistance - hit.distance) > 1e-3f * std::max(1.0f, expected) ? 1 : 0;
+            }
+        }
+        ZW_CHECK(hits > 20);
+        ZW_CHECK_EQUAL(mismatches, 0u);
+    }
+}
+
+ZW_TEST(QueriesMatchBruteForce)
+{
+    AabbArrays boxes = RandomBoxes(20000, 1);
+    Bvh bvh;
+    bvh.Build(boxes);
+    ZW_CHECK_EQUAL(bvh.GetItemCount(), 20000u);
+    CheckQueries(bvh, boxes);
+}
+
+ZW_TEST(RefitKeepsQueriesExactAndRebuildRestoresTheCost)
+{
+    AabbArrays boxes = RandomBoxes(20000, 2);
+    Bvh bvh;
+    bvh.Build(boxes);
+    const float builtCost = bvh.GetSahCost();
+
+    // everything drifts far enough to spoil the tree, like the orbiting cubes over many frames
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+    for (uint32_t i = 0; i < boxes.Size(); ++i)
+    {
+        boxes.centerX[i] += offset(random);
+        boxes.centerY[i] += offset(random);
+        boxes.centerZ[i] += offset(random);
+    }
+    bvh.Refit(boxes);
+    CheckQueries(bvh, boxes);
+    const float refitCost = bvh.GetSahCost();
+    ZW_CHECK(refitCost > builtCost * 1.2f);
+
+    bvh.Build(boxes);
+    CheckQueries(bvh, boxes);
+    ZW_CHECK(bvh.GetSahCost() < refitCost);
+}
+
+ZW_TEST(StatsDescribeABinaryTree)
+{
+    AabbArrays boxes = RandomBoxes(5000, 4);
+    Bvh bvh;
+    bvh.Build(boxes);
+    BvhStats stats = bvh.GetStats();
+    ZW_CHECK_EQUAL(stats.nodeCount, 2 * stats.leafCount - 1);
+    // at most 4 items per leaf unless splitting doesn't pay, and roughly balanced
+    ZW_CHECK(stats.leafCount >= 5000 / 4 / 2);
+    ZW_CHECK(stats.depth >= 10 && stats.depth <= 48);
+    ZW_CHECK(stats.sahCost > 1.0f);
+    ZW_CHECK_EQUAL(stats.sahCost, bvh.GetSahCost());
+}
+
+ZW_TEST(EmptyAndSingleBoxTrees)
+{
+    AabbArrays boxes;
+    Bvh bvh;
+    bvh.Build(boxes);
+    std::vector<uint32_t> items;
+    const float minimum[3] = { -1e9f, -1e9f, -1e9f }, maximum[3] = { 1e9f, 1e9f, 1e9f };
+    bvh.QueryAabb(minimum, maximum, &items);
+    bvh.QueryFrustum(BoxFrustum(minimum, maximum), &items);
+    ZW_CHECK(items.empty());
+    const float origin[3] = { 0.0f, 0.0f, -10.0f }, direction[3] = { 0.0f, 0.0f, 1.0f };
+    BvhRayHit hit;
+    ZW_CHECK(!bvh.Raycast(origin, direction, 1e9f, &hit));
+
+    boxes = RandomBoxes(1, 5);
+    boxes.centerX[0] = boxes.centerY[0] = boxes.centerZ[0] = 0.0f;
+    boxes.extentX[0] = boxes.extentY[0] = boxes.extentZ[0] = 1.0f;
+    bvh.Build(boxes);
+    ZW_CHECK_EQUAL(bvh.GetStats().nodeCount, 1u);
+    bvh.QueryFrustum(BoxFrustum(minimum, maximum), &items);
+    ZW_CHECK(items.size() == 1 && items[0] == 0);
+    ZW_CHECK(bvh.Raycast(origin, direction, 1e9f, &hit));
+    ZW_CHECK_EQUAL(hit.item, 0u);
+    ZW_CHECK_NEAR(hit.distance, 9.0f, 1e-5f);
+    ZW_CHECK(!bvh.Raycast(origin, direction, 8.0f, &hit));
+}
@@ -0,0 +1,193 @@
+#include "TestFramework.h"
+#include "DdsTexture.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// dds files are built in memory, the parser sees exactly the bytes a test wants it to
+
+namespace
+{
+    const uint32_t FormatR32G32B32A32Float = 2;
+    const uint32_t FormatR8G8B8A8Unorm = 28;
+    const uint32_t FormatBC1Unorm = 71;
+
+    struct DdsFile
+    {
+        std::vector<uint8_t> bytes;
+
+        void Put(uint32_t value)
+        {
+            const uint8_t* p = (const uint8_t*)&value;
+            bytes.insert(bytes.end(), p, p + 4);
+        }
+
+        ByteSpan Span() const
+        {
+            ByteSpan span = { bytes.data(), bytes.size() };
+            return span;
+        }
+    };
+
+    // magic, header and the DX10 extension, "dataSize" bytes of a counting pattern after them
+    DdsFile MakeDx10(uint32_t format, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t arraySize, bool cube,
+        uint64_t dataSize)
+    {
+        DdsFile file;
+        file.Put(0x20534444); // "DDS "
+        file.Put(124); // header size
+        file.Put(0x1 | 0x2 | 0x4 | 0x1000 | 0x20000); // caps, height, width, pixel format, mip count
+        file.Put(height);
+        file.Put(width);
+        file.Put(0); // pitch
+        file.Put(0); // depth
+        file.Put(mipCount);
+        for (int i = 0; i < 11; ++i)
+        {
+            file.Put(0);
+        }
+        file.Put(32); // pixel format size
+        file.Put(0x4); // fourcc
+        file.Put('D' | ('X' << 8) | ('1' << 16) | ('0' << 24));
+        for (int i = 0; i < 5; ++i)
+        {
+            file.Put(0); // bit count and masks
+        }
+        file.Put(0x1000); // caps
+        for (int i = 0; i < 4; ++i)
+        {
+            file.Put(0); // caps2..4, reserved
+        }
+
+        file.Put(format);
+        file.Put(3); // texture 2d
+        file.Put(cube ? 0x4 : 0);
+        file.Put(arraySize);
+        file.Put(0);
+
+        for (uint64_t i = 0; i < dataSize; ++i)
+        {
+            file.bytes.push_back((uint8_t)i);
+        }
+        return file;
+    }
+
+    const uint64_t HeaderSize = 4 + 124 + 20;
+}
+
+ZW_TEST(MipChainIsLaidOutInFileOrder)
+{
+    // 8x4 rgba8: 128 + 32 + 8 + 4 bytes
+    DdsFile file = MakeDx10(FormatR8G8B8A8Unorm, 8, 4, 4, 1, false, 172);
+    DdsInfo info;
+    ZW_CHECK(ParseDds(file.Span(), &info));
+    ZW_CHECK_EQUAL(info.subresources.size(), 4u);
+    if (info.subresources.size() != 4)
+    {
+        return;
+    }
+    const uint64_t sizes[] = { 128, 32, 8, 4 };
+    uint64_t offset = HeaderSize;
+    for (uint32_t mip = 0; mip < 4; ++mip)
+    {
+        ZW_CHECK_EQUAL(info.subresources[mip].offset, offset);
+        ZW_CHECK_EQUAL(info.subresources[mip].size, sizes[mip]);
+        offset += sizes[mip];
+    }
+    ZW_CHECK_EQUAL(info.subresources[3].width, 1u);
+    ZW_CHECK_EQUAL(info.subresources[3].height, 1u);
+    ZW_CHECK_EQUAL(info.dataSize, 172u);
+
+    // one byte short of the last mip
+    DdsFile truncated = MakeDx10(FormatR8G8B8A8Unorm, 8, 4, 4, 1, false, 171);
+    ZW_CHECK(!ParseDds(truncated.Span(), &info));
+
+    // more mips than 8x4 has
+    DdsFile tooManyMips = MakeDx10(FormatR8G8B8A8Unorm, 8, 4, 5, 1, false, 176);
+    ZW_CHECK(!ParseDds(tooManyMips.Span(), &info));
+}
+
+ZW_TEST(CubeHasSixSlicesOfBlocks)
+{
+    // bc1 8x8 with 2 mips: 4 blocks and 1 block of 8 bytes per face
+    DdsFile file = MakeDx10(FormatBC1Unorm, 8, 8, 2, 1, true, 6 * 40);
+    DdsInfo info;
+    ZW_CHECK(ParseDds(file.Span(), &info));
+    ZW_CHECK(info.cube);
+    ZW_CHECK_EQUAL(info.arraySize, 6u);
+    ZW_CHECK_EQUAL(info.subresources.size(), 12u);
+    if (info.subresources.size() == 12)
+    {
+        ZW_CHECK_EQUAL(info.subresources[0].rowPitch, 16u);
+        ZW_CHECK_EQUAL(info.subresources[0].rowCount, 2u);
+        ZW_CHECK_EQUAL(info.subresources[1].size, 8u);
+        ZW_CHECK_EQUAL(info.subresources[11].arraySlice, 5u);
+        ZW_CHECK_EQUAL(info.subresources[11].offset, HeaderSize + 5 * 40 + 32);
+    }
+}
+
+ZW_TEST(CubeCountThatWrapsIsRejected)
+{
+    // 0x2aaaaaab cubes are 0x100000002 slices, 2 in 32 bits. the data of 2 slices is there
+    DdsFile file = MakeDx10(FormatR8G8B8A8Unorm, 4, 4, 1, 0x2aaaaaab, true, 2 * 64);
+    DdsInfo info;
+    ZW_CHECK(!ParseDds(file.Span(), &info));
+}
+
+ZW_TEST(CountTheFileCantHoldIsRejectedBeforeAllocating)
+{
+    // 4 billion slices of 14 mips would reserve terabytes of subresources
+    DdsFile file = MakeDx10(FormatR8G8B8A8Unorm, 8192, 8192, 14, 0xffffffff, false, 64);
+    DdsInfo info;
+    ZW_CHECK(!ParseDds(file.Span(), &info));
+    ZW_CHECK(info.subresources.capacity() < 1024);
+}
+
+ZW_TEST(RowPitchBeyond32BitsIsRejected)
+{
+    // 2^28 pixels of 16 bytes is a 4GB row, which used to be truncated to 0
+    DdsFile file = MakeDx10(FormatR32G32B32A32Float, 1u << 28, 1, 1, 1, false, 64);
+    DdsInfo info;
+    ZW_CHECK(!ParseDds(file.Span(), &info));
+}
+
+ZW_TEST(StreamingMakesEveryMipResidentSmallestFirst)
+{
+    const char* path = "DdsTextureTests.dds";
+    DdsFile file = MakeDx10(FormatR8G8B8A8Unorm, 64, 64, 7, 2, false, 2 * 21844);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write((const char*)file.bytes.data(), (std::streamsize)file.bytes.size());
+    }
+
+    DdsTexture texture;
+    ZW_CHECK(texture.Open(path));
+    ZW_CHECK_EQUAL(texture.GetResidentMip(), 7u);
+    ByteSpan data;
+    ZW_CHECK(!texture.GetSubresource(6, 0, &data));
+
+    JobSystem jobs(2);
+    JobCounter counter;
+    texture.StreamAsync(&jobs, &counter);
+    jobs.Wait(&counter);
+    ZW_CHECK_EQUAL(texture.GetResidentMip(), 0u);
+
+    // the spans point at the file's bytes
+    const DdsInfo& info = texture.GetInfo();
+    for (uint32_t slice = 0; slice < 2; ++slice)
+    {
+        for (uint32_t mip = 0; mip < 7; ++mip)
+        {
+            ZW_CHECK(texture.GetSubresource(mip, slice, &data));
+            const DdsSubresource& sub = info.subresources[mip + slice * 7];
+            ZW_CHECK_EQUAL(data.size, sub.size);
+            ZW_CHECK(memcmp(data.data, file.bytes.data() + sub.offset, (size_t)sub.size) == 0);
+        }
+    }
+    ZW_CHECK(!texture.GetSubresource(7, 0, &data));
+    ZW_CHECK(!texture.GetSubresource(0, 2, &data));
+
+    texture.Close();
+    remove(path);
+}
@@ -0,0 +1,150 @@
+#include "TestFramework.h"
+#include "DescriptorAllocator.h"
+#include "NullRenderBackend.h"
+#include <algorithm>
+#include <vector>
+
+// the allocator on its own with hand picked fences, then through the null backend's frames
+
+ZW_TEST(FreedSlotIsOnlyReusedOnceItsFrameCompleted)
+{
+    DescriptorAllocator allocator;
+    allocator.Init(4, 8);
+    allocator.BeginFrame(0, 0);
+
+    DescriptorIndex slots[4];
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        slots[i] = allocator.AllocatePersistent();
+        ZW_CHECK_EQUAL(slots[i], i); // low slots first
+    }
+    ZW_CHECK_EQUAL(allocator.AllocatePersistent(), InvalidDescriptor);
+    ZW_CHECK_EQUAL(allocator.GetStats().failedAllocations, 1u);
+
+    // freed while frame 5 records, frames up to 5 may still read slot 1
+    allocator.FreePersistent(slots[1], 5);
+    allocator.BeginFrame(1, 4);
+    ZW_CHECK_EQUAL(allocator.AllocatePersistent(), InvalidDescriptor);
+    ZW_CHECK_EQUAL(allocator.GetStats().persistentUsed, 4u);
+
+    allocator.BeginFrame(2, 5);
+    ZW_CHECK_EQUAL(allocator.GetStats().persistentUsed, 3u);
+    ZW_CHECK_EQUAL(allocator.AllocatePersistent(), slots[1]);
+    ZW_CHECK_EQUAL(allocator.AllocatePersistent(), InvalidDescriptor);
+}
+
+ZW_TEST(FreesComeBackInFrameOrder)
+{
+    DescriptorAllocator allocator;
+    allocator.Init(3, 1);
+    DescriptorIndex a = allocator.AllocatePersistent();
+    DescriptorIndex b = allocator.AllocatePersistent();
+    DescriptorIndex c = allocator.AllocatePersistent();
+    allocator.FreePersistent(b, 2);
+    allocator.FreePersistent(a, 3);
+    allocator.FreePersistent(c, 7);
+
+    // frame 3 completed: b and a, not c
+    allocator.BeginFrame(0, 3);
+    ZW_CHECK_EQUAL(allocator.GetStats().persistentUsed, 1u);
+    std::vector<DescriptorIndex> reused;
+    reused.push_back(allocator.AllocatePersistent());
+    reused.push_back(allocator.AllocatePersistent());
+    ZW_CHECK_EQUAL(allocator.AllocatePersistent(), InvalidDescriptor);
+    std::sort(reused.begin(), reused.end());
+    ZW_CHECK_EQUAL(reused[0], std::min(a, b));
+    ZW_CHECK_EQUAL(reused[1], std::max(a, b));
+}
+
+ZW_TEST(DoubleAndForeignFreesAreRejected)
+{
+    DescriptorAllocator allocator;
+    allocator.Init(2, 4);
+    DescriptorIndex slot = allocator.AllocatePersistent();
+    allocator.FreePersistent(slot, 1);
+    allocator.FreePersistent(slot, 1); // already free
+    allocator.FreePersistent(1, 1); // never allocated
+    allocator.FreePersistent(2 + 1, 1); // a transient slot
+    allocator.FreePersistent(InvalidDescriptor, 1);
+
+    // the slot went on the free list once, so both slots are handed out exactly once
+    allocator.BeginFrame(0, 1);
+    ZW_CHECK_EQUAL(allocator.GetStats().persistentUsed, 0u);
+    DescriptorIndex first = allocator.AllocatePersistent();
+    DescriptorIndex second = allocator.AllocatePersistent();
+    ZW_CHECK(first != InvalidDescriptor && second != InvalidDescriptor && first != second);
+    ZW_CHECK_EQUAL(allocator.AllocatePersistent(), InvalidDescriptor);
+}
+
+ZW_TEST(TransientRangesOverflowAndRewindPerFrameContext)
+{
+    const uint32_t persistentCount = 4;
+    const uint32_t transientCount = 5;
+    DescriptorAllocator allocator;
+    allocator.Init(persistentCount, transientCount);
+    ZW_CHECK_EQUAL(allocator.GetCapacity(), persistentCount + frameBufferCount * transientCount);
+
+    // every context has its own range after the persistent slots, tables are contiguous
+    for (uint32_t context = 0; context < (uint32_t)frameBufferCount; ++context)
+    {
+        allocator.BeginFrame(context, 0);
+        DescriptorIndex first, second, overflow;
+        ZW_CHECK(allocator.AllocateTransient(3, &first));
+        ZW_CHECK_EQUAL(first, persistentCount + context * transientCount);
+        ZW_CHECK(allocator.AllocateTransient(2, &second));
+        ZW_CHECK_EQUAL(second, first + 3);
+        ZW_CHECK(!allocator.AllocateTransient(1, &overflow));
+        ZW_CHECK_EQUAL(allocator.GetStats().transientUsed, transientCount);
+    }
+    ZW_CHECK_EQUAL(allocator.GetStats().failedAllocations, (uint32_t)frameBufferCount);
+    ZW_CHECK_EQUAL(allocator.GetStats().peakTransientUsed, transientCount);
+
+    // back at context 0 the range starts over, a table larger than the range never fits
+    allocator.BeginFrame(0, 0);
+    ZW_CHECK_EQUAL(allocator.GetStats().transientUsed, 0u);
+    DescriptorIndex first;
+    ZW_CHECK(!allocator.AllocateTransient(transientCount + 1, &first));
+    ZW_CHECK(allocator.AllocateTransient(transientCount, &first));
+    ZW_CHECK_EQUAL(first, persistentCount);
+}
+
+ZW_TEST(BackendReusesFreedDescriptorsAfterTheGpuCompletedTheFrame)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    ZW_CHECK(backend.SetFramesInFlight(2));
+
+    ZW_CHECK(backend.BeginFrame());
+    DescriptorIndex descriptor = backend.AllocatePersistentDescriptor();
+    ZW_CHECK(descriptor != InvalidDescriptor);
+    backend.CreateConstantBufferView(descriptor, 256, 256);
+    const NullDescriptor* written = backend.GetDescriptor(descriptor);
+    ZW_CHECK(written && written->bufferLocation == 256 && written->size == 256);
+
+    // freed while frame 1 records, so it is still used until frame 1 completed
+    backend.FreePersistentDescriptor(descriptor);
+    backend.FreePersistentDescriptor(descriptor);
+    ZW_CHECK(backend.EndFrame());
+    ZW_CHECK_EQUAL(backend.GetDescriptorAllocator().GetStats().persistentUsed, 1u);
+
+    // transient descriptors only exist while a frame records
+    DescriptorIndex table;
+    ZW_CHECK(!backend.AllocateTransientDescriptors(1, &table));
+
+    uint32_t frames = 0;
+    while (backend.GetDescriptorAllocator().GetStats().persistentUsed != 0 && frames < 10)
+    {
+        ZW_CHECK(backend.BeginFrame());
+        ZW_CHECK(backend.AllocateTransientDescriptors(1, &table));
+        ZW_CHECK(table >= PersistentDescriptorCount);
+        ZW_CHECK(backend.EndFrame());
+        ++frames;
+    }
+    ZW_CHECK(backend.GetCompletedFrameCount() >= 1);
+    ZW_CHECK_EQUAL(backend.GetDescriptorAllocator().GetStats().persistentUsed, 0u);
+
+    ZW_CHECK(backend.BeginFrame());
+    ZW_CHECK_EQUAL(backend.AllocatePersistentDescriptor(), descriptor);
+    ZW_CHECK(backend.EndFrame());
+    backend.Shutdown();
+}
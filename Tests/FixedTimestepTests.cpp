@@ -0,0 +1,104 @@
+#include "TestFramework.h"
+#include "FixedTimestep.h"
+
+// 1/128 s steps and power of two frame times keep the accumulator exact, the uneven cases compare
+// with a tolerance instead
+static const double Step = 1.0 / 128.0;
+
+ZW_TEST(WholeStepsAreConsumedAndTheRestCarriesOver)
+{
+    FixedTimestep timestep(Step);
+    ZW_CHECK_EQUAL(timestep.StepSeconds(), Step);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.0f);
+
+    ZW_CHECK_EQUAL(timestep.Advance(Step * 2), 2);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.0f);
+    ZW_CHECK_EQUAL(timestep.Advance(Step / 2), 0);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.5f);
+    ZW_CHECK_EQUAL(timestep.Advance(Step / 4), 0);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.75f);
+    ZW_CHECK_EQUAL(timestep.Advance(Step / 2), 1);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.25f);
+
+    // nothing, or a clock going backwards, adds no time
+    ZW_CHECK_EQUAL(timestep.Advance(0.0), 0);
+    ZW_CHECK_EQUAL(timestep.Advance(-1.0), 0);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.25f);
+
+    timestep.Reset();
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.0f);
+    ZW_CHECK_EQUAL(timestep.Advance(Step * 3), 3);
+}
+
+ZW_TEST(AHitchRunsAtMostEightStepsAndDropsTheRest)
+{
+    // a one second stall is 128 steps, only 8 of them run and the fraction of a step is kept
+    FixedTimestep timestep(Step);
+    ZW_CHECK_EQUAL(timestep.Advance(1.0 + Step / 4), 8);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.25f);
+
+    // the dropped time does not come back on the next frames
+    ZW_CHECK_EQUAL(timestep.Advance(Step / 4), 0);
+    ZW_CHECK_EQUAL(timestep.Advance(Step / 2), 1);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.0f);
+
+    // exactly the limit is still caught up in full
+    ZW_CHECK_EQUAL(timestep.Advance(Step * 8), 8);
+    ZW_CHECK_EQUAL(timestep.Alpha(), 0.0f);
+
+    FixedTimestep three(Step, 3);
+    ZW_CHECK_EQUAL(three.Advance(Step * 10.5), 3);
+    ZW_CHECK_EQUAL(three.Alpha(), 0.5f);
+}
+
+ZW_TEST(AlphaIsTheTimeNotYetSimulated)
+{
+    // uneven frame times, after every frame the steps run plus alpha add up to the time passed
+    const double deltas[] = { 0.003, 0.0111, 0.0065, 0.0201, 0.0009, 0.0167, 0.0333, 0.004, 0.0078125, 0.012 };
+    FixedTimestep timestep(1.0 / 120.0);
+    double elapsed = 0.0;
+    int steps = 0;
+    bool consistent = true;
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        double delta = deltas[frame % 10];
+        elapsed += delta;
+        steps += timestep.Advance(delta);
+        double alpha = timestep.Alpha();
+        consistent = consistent && alpha >= 0.0 && alpha < 1.0;
+        consistent = consistent && std::fabs((steps + alpha) / 120.0 - elapsed) < 1e-6;
+    }
+    ZW_CHECK(consistent);
+}
+
+ZW_TEST(TheSimulationDoesNotDependOnTheFrameRate)
+{
+    // a point moving at one unit per second, stepped at 120 Hz and drawn interpolated between the
+    // last two steps. whatever the frame rate, the drawn position trails real time by one step
+    const double stepSeconds = 1.0 / 120.0;
+    const double frameRates[] = { 24.0, 30.0, 60.0, 75.0, 144.0, 240.0, 1000.0 };
+    for (size_t r = 0; r < sizeof(frameRates) / sizeof(frameRates[0]); ++r)
+    {
+        FixedTimestep timestep(stepSeconds);
+        double previous = 0.0, current = 0.0, elapsed = 0.0;
+        bool trails = true;
+        for (int frame = 0; frame < (int)(frameRates[r] * 2.0); ++frame)
+        {
+            // a little jitter around the nominal frame time
+            double delta = (1.0 + 0.2 * ((frame * 7) % 5 - 2) / 2.0) / frameRates[r];
+            elapsed += delta;
+            for (int steps = timestep.Advance(delta); steps > 0; --steps)
+            {
+                previous = current;
+                current += stepSeconds;
+            }
+            if (elapsed >= stepSeconds)
+            {
+                double drawn = previous + (current - previous) * timestep.Alpha();
+                trails = trails && std::fabs(drawn - (elapsed - stepSeconds)) < 1e-6;
+            }
+        }
+        ZW_CHECK(trails);
+        ZW_CHECK(std::fabs(current - (elapsed - timestep.Alpha() * stepSeconds)) < 1e-6);
+    }
+}
@@ -0,0 +1,154 @@
+#include "TestFramework.h"
+#include "FrameManager.h"
+#include "NullRenderBackend.h"
+
+// the frame pipeline on a gpu that only runs when told to (SimulatedGpuFence), and through the null
+// backend, whose gpu finishes a frame "latency" frames after it was submitted
+
+namespace
+{
+    // one frame of the null backend with nothing in it
+    bool RunFrame(NullRenderBackend* backend)
+    {
+        return backend->BeginFrame() && backend->EndFrame();
+    }
+}
+
+ZW_TEST(BeginFrameOnlyWaitsWhenEveryContextIsBusy)
+{
+    for (uint32_t framesInFlight = 1; framesInFlight <= (uint32_t)frameBufferCount; ++framesInFlight)
+    {
+        SimulatedGpuFence fence;
+        FrameManager frames;
+        frames.Init(&fence, framesInFlight);
+        ZW_CHECK_EQUAL(frames.GetFramesInFlight(), framesInFlight);
+
+        // the gpu does nothing, the first framesInFlight frames still start right away
+        for (uint64_t frame = 1; frame <= framesInFlight; ++frame)
+        {
+            ZW_CHECK_EQUAL(frames.GetFrameNumber(), frame);
+            ZW_CHECK(frames.BeginFrame());
+            ZW_CHECK_EQUAL(frames.GetContextIndex(), (uint32_t)(frame % framesInFlight));
+            fence.Signal(frame);
+            frames.EndFrame(frame);
+        }
+        ZW_CHECK_EQUAL(frames.GetStallCount(), (uint64_t)0);
+        ZW_CHECK_EQUAL(frames.GetSubmittedFrameCount(), (uint64_t)framesInFlight);
+        ZW_CHECK_EQUAL(frames.GetCompletedFrameCount(), (uint64_t)0);
+
+        // every context is in flight: the next frame waits for the oldest one, and only that one
+        ZW_CHECK(frames.BeginFrame());
+        ZW_CHECK_EQUAL(frames.GetStallCount(), (uint64_t)1);
+        ZW_CHECK_EQUAL(fence.GetCompletedValue(), (uint64_t)1);
+        ZW_CHECK_EQUAL(fence.GetPendingCount(), framesInFlight - 1);
+        ZW_CHECK_EQUAL(frames.GetCompletedFrameCount(), (uint64_t)1);
+        fence.Signal(framesInFlight + 1);
+        frames.EndFrame(framesInFlight + 1);
+
+        // the gpu catches up on its own before the next frame needs it, no wait
+        fence.CompleteNext();
+        ZW_CHECK_EQUAL(frames.GetCompletedFrameCount(), (uint64_t)2);
+        ZW_CHECK(frames.BeginFrame());
+        ZW_CHECK_EQUAL(frames.GetStallCount(), (uint64_t)1);
+        ZW_CHECK_EQUAL(fence.GetWaitCount(), (uint64_t)1);
+        fence.Signal(framesInFlight + 2);
+        frames.EndFrame(framesInFlight + 2);
+        ZW_CHECK(frames.WaitForIdle());
+    }
+}
+
+ZW_TEST(StallsAndCompletedFramesFollowTheGpuLatency)
+{
+    // latency L, F frames in flight: frame n needs frame n - F done and the gpu is at n - 1 - L, so
+    // every frame past the first F waits when F <= L and none ever does when F > L
+    const uint32_t frameCount = 20;
+    for (uint32_t framesInFlight = 1; framesInFlight <= (uint32_t)frameBufferCount; ++framesInFlight)
+    {
+        for (uint32_t latency = 0; latency <= 4; ++latency)
+        {
+            NullRenderBackend backend;
+            ZW_CHECK(backend.Init(64, 64));
+            ZW_CHECK(backend.SetFramesInFlight(framesInFlight));
+            backend.SetGpuLatency(latency);
+
+            bool completedRight = true;
+            for (uint32_t frame = 1; frame <= frameCount; ++frame)
+            {
+                ZW_CHECK(RunFrame(&backend));
+                uint32_t behind = framesInFlight < latency ? framesInFlight : latency;
+                uint64_t expected = frame > behind ? frame - behind : 0;
+                completedRight = completedRight && backend.GetCompletedFrameCount() == expected;
+            }
+            ZW_CHECK(completedRight);
+            ZW_CHECK_EQUAL(backend.GetSubmittedFrameCount(), (uint64_t)frameCount);
+
+            uint64_t stalls = framesInFlight <= latency ? frameCount - framesInFlight : 0;
+            ZW_CHECK_EQUAL(backend.GetFrameManager().GetStallCount(), stalls);
+            backend.Shutdown();
+        }
+    }
+}
+
+ZW_TEST(FramesInFlightOutsideTheContextsAreRejected)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    ZW_CHECK(backend.SetFramesInFlight(2));
+    ZW_CHECK(!backend.SetFramesInFlight(0));
+    ZW_CHECK(!backend.SetFramesInFlight(frameBufferCount + 1));
+    ZW_CHECK(!backend.SetFramesInFlight(0xffffffffu));
+    ZW_CHECK_EQUAL(backend.GetFrameManager().GetFramesInFlight(), 2u);
+    for (uint32_t count = 1; count <= (uint32_t)frameBufferCount; ++count)
+    {
+        ZW_CHECK(backend.SetFramesInFlight(count));
+        ZW_CHECK_EQUAL(backend.GetFrameManager().GetFramesInFlight(), count);
+    }
+
+    // Init takes whatever it is given and clamps it
+    SimulatedGpuFence fence;
+    FrameManager frames;
+    frames.Init(&fence, 0);
+    ZW_CHECK_EQUAL(frames.GetFramesInFlight(), 1u);
+    frames.Init(&fence, 100);
+    ZW_CHECK_EQUAL(frames.GetFramesInFlight(), (uint32_t)frameBufferCount);
+    backend.Shutdown();
+}
+
+ZW_TEST(WaitForIdleDrainsEveryFrame)
+{
+    SimulatedGpuFence fence;
+    FrameManager frames;
+    frames.Init(&fence, frameBufferCount);
+    for (uint64_t frame = 1; frame <= (uint64_t)frameBufferCount; ++frame)
+    {
+        ZW_CHECK(frames.BeginFrame());
+        fence.Signal(frame);
+        frames.EndFrame(frame);
+    }
+    ZW_CHECK_EQUAL(frames.GetCompletedFrameCount(), (uint64_t)0);
+    ZW_CHECK(frames.WaitForIdle());
+    ZW_CHECK_EQUAL(fence.GetPendingCount(), 0u);
+    ZW_CHECK_EQUAL(frames.GetCompletedFrameCount(), (uint64_t)frameBufferCount);
+    ZW_CHECK(frames.WaitForIdle());
+
+    // changing the latency goes idle too, and the next frames start without waiting
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    ZW_CHECK(backend.SetFramesInFlight(frameBufferCount));
+    backend.SetGpuLatency(10);
+    for (int frame = 0; frame < frameBufferCount; ++frame)
+    {
+        ZW_CHECK(RunFrame(&backend));
+    }
+    ZW_CHECK_EQUAL(backend.GetCompletedFrameCount(), (uint64_t)0);
+    ZW_CHECK(backend.SetFramesInFlight(1));
+    ZW_CHECK_EQUAL(backend.GetCompletedFrameCount(), (uint64_t)frameBufferCount);
+    ZW_CHECK_EQUAL(backend.GetGpuFence().GetPendingCount(), 0u);
+    ZW_CHECK(RunFrame(&backend));
+    ZW_CHECK_EQUAL(backend.GetFrameManager().GetStallCount(), (uint64_t)0);
+
+    // and WaitForGpu finishes what is left
+    backend.WaitForGpu();
+    ZW_CHECK_EQUAL(backend.GetCompletedFrameCount(), backend.GetSubmittedFrameCount());
+    backend.Shutdown();
+}
@@ -0,0 +1,99 @@
+#include "TestFramework.h"
+#include "FrameTimeHistogram.h"
+
+// a percentile is the upper bound of its bucket clamped to the max, so it is at most one bucket
+// (1/32 of its power of two) above the exact sample
+static const double BucketError = 1.0 + 1.0 / 32.0;
+
+namespace
+{
+    bool WithinBucket(double percentile, double exact)
+    {
+        return percentile >= exact && percentile <= exact * BucketError;
+    }
+}
+
+ZW_TEST(PercentilesOfAnEvenSpread)
+{
+    // 1 to 100 ms, each once and out of order
+    FrameTimeHistogram histogram(1024);
+    for (int i = 0; i < 100; ++i)
+    {
+        histogram.AddSample(((i * 37) % 100 + 1) / 1000.0);
+    }
+
+    FrameTimeStats stats = histogram.Stats();
+    ZW_CHECK_EQUAL(stats.sampleCount, 100u);
+    ZW_CHECK(WithinBucket(stats.p50, 0.050));
+    ZW_CHECK(WithinBucket(stats.p95, 0.095));
+    ZW_CHECK(WithinBucket(stats.p99, 0.099));
+    ZW_CHECK(stats.p99 <= 0.100);
+    ZW_CHECK_EQUAL(stats.max, 0.100);
+    ZW_CHECK_NEAR(stats.average, 0.0505, 1e-12);
+
+    // the queries on their own agree with Stats
+    ZW_CHECK_EQUAL(histogram.Percentile(0.50), stats.p50);
+    ZW_CHECK_EQUAL(histogram.Percentile(0.99), stats.p99);
+    ZW_CHECK_EQUAL(histogram.Max(), stats.max);
+    ZW_CHECK_EQUAL(histogram.Percentile(1.0), stats.max);
+    ZW_CHECK(WithinBucket(histogram.Percentile(0.0), 0.001));
+}
+
+ZW_TEST(RareHitchesOnlyShowAboveTheirPercentile)
+{
+    // 990 frames at 60 hz and 10 hitches of 50 ms, the hitches are the top 1%
+    FrameTimeHistogram histogram(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        histogram.AddSample(i % 100 == 50 ? 0.050 : 1.0 / 60.0);
+    }
+
+    FrameTimeStats stats = histogram.Stats();
+    ZW_CHECK(WithinBucket(stats.p50, 1.0 / 60.0));
+    ZW_CHECK(WithinBucket(stats.p95, 1.0 / 60.0));
+    ZW_CHECK(WithinBucket(stats.p99, 1.0 / 60.0));
+    ZW_CHECK(WithinBucket(histogram.Percentile(0.995), 0.050));
+    ZW_CHECK_EQUAL(stats.max, 0.050);
+    ZW_CHECK_NEAR(stats.average, (990.0 / 60.0 + 10 * 0.050) / 1000.0, 1e-12);
+}
+
+ZW_TEST(OldSamplesLeaveTheWindow)
+{
+    // 1 to 20 ms through a window of 10, only 11 to 20 ms are left
+    FrameTimeHistogram histogram(10);
+    for (int i = 1; i <= 20; ++i)
+    {
+        histogram.AddSample(i / 1000.0);
+    }
+    FrameTimeStats stats = histogram.Stats();
+    ZW_CHECK_EQUAL(stats.sampleCount, 10u);
+    ZW_CHECK(WithinBucket(stats.p50, 0.015));
+    ZW_CHECK_EQUAL(stats.max, 0.020);
+    ZW_CHECK_NEAR(stats.average, 0.0155, 1e-12);
+
+    uint32_t bucketed = 0;
+    for (uint32_t i = 0; i < FrameTimeHistogram::BucketCount(); ++i)
+    {
+        bucketed += histogram.BucketSamples(i);
+    }
+    ZW_CHECK_EQUAL(bucketed, 10u);
+
+    // a spike is in the max until the window has moved past it
+    histogram.AddSample(0.200);
+    ZW_CHECK_EQUAL(histogram.Max(), 0.200);
+    for (int i = 0; i < 9; ++i)
+    {
+        histogram.AddSample(0.010);
+    }
+    ZW_CHECK_EQUAL(histogram.Max(), 0.200);
+    histogram.AddSample(0.010);
+    ZW_CHECK_EQUAL(histogram.Max(), 0.010);
+    ZW_CHECK(WithinBucket(histogram.Percentile(0.99), 0.010));
+    ZW_CHECK_NEAR(histogram.Average(), 0.010, 1e-12);
+
+    histogram.Clear();
+    stats = histogram.Stats();
+    ZW_CHECK_EQUAL(stats.sampleCount, 0u);
+    ZW_CHECK_EQUAL(stats.p99, 0.0);
+    ZW_CHECK_EQUAL(stats.max, 0.0);
+}
@@ -0,0 +1,225 @@
+#include "TestFramework.h"
+#include "FrustumCulling.h"
+#include <DirectXMath.h>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+    // the scene's camera: at (0, 2, -4) looking at the origin, 45 degrees, 4:3, depth 0.1..1000
+    Frustum MakeFrustum(XMFLOAT4X4* viewProjOut = nullptr)
+    {
+        XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, -4.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f),
+            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX projection = XMMatrixPerspectiveFovLH(0.785398f, 4.0f / 3.0f, 0.1f, 1000.0f);
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, view * projection);
+        if (viewProjOut)
+        {
+            *viewProjOut = viewProj;
+        }
+        Frustum frustum;
+        ExtractFrustum(&viewProj.m[0][0], &frustum);
+        return frustum;
+    }
+
+    // boxes scattered around the camera, many of them crossing the frustum planes
+    AabbArrays RandomBoxes(uint32_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-50.0f, 50.0f), extent(0.05f, 3.0f);
+        AabbArrays boxes;
+        boxes.Resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            boxes.centerX[i] = position(random);
+            boxes.centerY[i] = position(random) * 0.2f;
+            boxes.centerZ[i] = position(random);
+            boxes.extentX[i] = extent(random);
+            boxes.extentY[i] = extent(random);
+            boxes.extentZ[i] = extent(random);
+        }
+        return boxes;
+    }
+
+    // a box is outside when all 8 corners are outside one of the planes, in double precision
+    bool ReferenceOutside(const Frustum& frustum, const AabbArrays& boxes, uint32_t i)
+    {
+        for (int p = 0; p < 6; ++p)
+        {
+            const float* plane = frustum.planes[p];
+            bool allOutside = true;
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                double x = (double)boxes.centerX[i] + (corner & 1 ? boxes.extentX[i] : -boxes.extentX[i]);
+                double y = (double)boxes.centerY[i] + (corner & 2 ? boxes.extentY[i] : -boxes.extentY[i]);
+                double z = (double)boxes.centerZ[i] + (corner & 4 ? boxes.extentZ[i] : -boxes.extentZ[i]);
+                allOutside = allOutside && plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0;
+            }
+            if (allOutside)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+ZW_TEST(PlanesAreUnitLengthAndPointInward)
+{
+    Frustum frustum = MakeFrustum();
+    for (int p = 0; p < 6; ++p)
+    {
+        const float* plane = frustum.planes[p];
+        ZW_CHECK_NEAR(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2], 1.0, 1e-5);
+        // the point the camera looks at is inside every plane
+        ZW_CHECK(plane[3] > 0.0f);
+    }
+    // the near plane is 0.1 in front of the camera, the far plane 1000. the far plane is w - z of two
+    // nearly equal columns, so it only comes out to a few parts in 10^4
+    const float eye[3] = { 0.0f, 2.0f, -4.0f };
+    const float* nearPlane = frustum.planes[4];
+    const float* farPlane = frustum.planes[5];
+    ZW_CHECK_NEAR(nearPlane[0] * eye[0] + nearPlane[1] * eye[1] + nearPlane[2] * eye[2] + nearPlane[3], -0.1, 1e-4);
+    ZW_CHECK_NEAR(farPlane[0] * eye[0] + farPlane[1] * eye[1] + farPlane[2] * eye[2] + farPlane[3], 1000.0, 1.0);
+}
+
+ZW_TEST(BoxesInFrontBehindAndBesideTheCamera)
+{
+    Frustum frustum = MakeFrustum();
+    const float centers[4][3] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 2.0f, -10.0f }, { -100.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 2000.0f } };
+    AabbArrays boxes;
+    boxes.Resize(4);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        boxes.centerX[i] = centers[i][0];
+        boxes.centerY[i] = centers[i][1];
+        boxes.centerZ[i] = centers[i][2];
+        boxes.extentX[i] = boxes.extentY[i] = boxes.extentZ[i] = 0.5f;
+    }
+    for (size_t l = 0; l < sizeof(Levels) / sizeof(Levels[0]); ++l)
+    {
+        uint32_t visible[4];
+        ZW_CHECK_EQUAL(CullAabbs(frustum, boxes, 0, 4, visible, Levels[l]), 1u);
+        ZW_CHECK_EQUAL(visible[0], 0u);
+    }
+
+    // the box behind the camera, grown until it reaches past the eye, is visible
+    boxes.extentZ[1] = 7.0f;
+    uint32_t visible[4];
+    ZW_CHECK_EQUAL(CullAabbs(frustum, boxes, 0, 4, visible), 2u);
+    ZW_CHECK_EQUAL(visible[1], 1u);
+}
+
+ZW_TEST(EveryLevelMatchesTheCornerReference)
+{
+    // odd ranges, so the wide kernels start unaligned and run their tails
+    const uint32_t count = 4099;
+    Frustum frustum = MakeFrustum();
+    AabbArrays boxes = RandomBoxes(count, 1);
+    const uint32_t ranges[3][2] = { { 0, count }, { 3, 1001 }, { 17, 5 } };
+    for (int r = 0; r < 3; ++r)
+    {
+        const uint32_t first = ranges[r][0], rangeCount = ranges[r][1];
+        std::vector<uint32_t> expected;
+        for (uint32_t i = first; i < first + rangeCount; ++i)
+        {
+            if (!ReferenceOutside(frustum, boxes, i))
+            {
+                expected.push_back(i);
+            }
+        }
+        for (size_t l = 0; l < sizeof(Levels) / sizeof(Levels[0]); ++l)
+        {
+            std::vector<uint32_t> visible(rangeCount);
+            uint32_t visibleCount = CullAabbs(frustum, boxes, first, rangeCount, visible.data(), Levels[l]);
+            visible.resize(visibleCount);
+            ZW_CHECK(visible == expected);
+        }
+    }
+}
+
+ZW_TEST(ParallelCullingMatchesOneThread)
+{
+    // several chunks of CullAabbsParallel, the last one partial
+    const uint32_t count = 100003;
+    Frustum frustum = MakeFrustum();
+    AabbArrays boxes = RandomBoxes(count, 2);
+    std::vector<uint32_t> expected(count), visible(count);
+    uint32_t expectedCount = CullAabbs(frustum, boxes, 0, count, expected.data(), SimdLevel::Scalar);
+    ZW_CHECK(expectedCount > 0 && expectedCount < count);
+
+    JobSystem jobs(4);
+    uint32_t visibleCount = CullAabbsParallel(&jobs, frustum, boxes, visible.data());
+    ZW_CHECK_EQUAL(visibleCount, expectedCount);
+    expected.resize(expectedCount);
+    visible.resize(visibleCount);
+    ZW_CHECK(visible == expected);
+}
+
+ZW_TEST(BoundsOfPositionsWithAStride)
+{
+    // position then a color, the layout of the scene's vertices
+    const float vertices[3][7] = {
+        { -1.0f, 2.0f, 0.5f, 9.0f, 9.0f, 9.0f, 9.0f },
+        { 3.0f, -2.0f, 0.0f, -9.0f, -9.0f, -9.0f, -9.0f },
+        { 0.0f, 1.0f, 1.5f, 9.0f, 9.0f, 9.0f, 9.0f },
+    };
+    float center[3], extent[3];
+    ComputeAabb(vertices, 3, sizeof(vertices[0]), center, extent);
+    ZW_CHECK_EQUAL(center[0], 1.0f);
+    ZW_CHECK_EQUAL(center[1], 0.0f);
+    ZW_CHECK_EQUAL(center[2], 0.75f);
+    ZW_CHECK_EQUAL(extent[0], 2.0f);
+    ZW_CHECK_EQUAL(extent[1], 2.0f);
+    ZW_CHECK_EQUAL(extent[2], 0.75f);
+}
+
+ZW_TEST(TransformedBoxesEncloseEveryCorner)
+{
+    const float center[3] = { 0.5f, -0.25f, 1.0f };
+    const float extent[3] = { 1.0f, 0.5f, 2.0f };
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+    const uint32_t count = 16;
+    std::vector<XMFLOAT4X4> world(count);
+    std::vector<uint32_t> indices(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        XMVECTOR axis = XMVector3Normalize(XMVectorSet(value(random), value(random), value(random), 0.0f));
+        XMMATRIX matrix = XMMatrixScaling(1.0f + fabsf(value(random)), 1.0f, 0.5f) * XMMatrixRotationQuaternion(XMQuaternionRotationNormal(axis, value(random))) *
+            XMMatrixTranslation(value(random), value(random), value(random));
+        XMStoreFloat4x4(&world[i], matrix);
+        indices[i] = count - 1 - i;
+    }
+
+    AabbArrays boxes;
+    boxes.Resize(count);
+    TransformAabbs(center, extent, &world[0].m[0][0], indices.data(), 0, count, &boxes);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const XMMATRIX matrix = XMLoadFloat4x4(&world[indices[i]]);
+        bool enclosed = true;
+        bool touched[3] = { false, false, false };
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            XMFLOAT3 p;
+            XMStoreFloat3(&p, XMVector3Transform(XMVectorSet(center[0] + (corner & 1 ? extent[0] : -extent[0]),
+                center[1] + (corner & 2 ? extent[1] : -extent[1]), center[2] + (corner & 4 ? extent[2] : -extent[2]), 1.0f), matrix));
+            const float offset[3] = { fabsf(p.x - boxes.centerX[i]), fabsf(p.y - boxes.centerY[i]), fabsf(p.z - boxes.centerZ[i]) };
+            const float limit[3] = { boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i] };
+            for (int c = 0; c < 3; ++c)
+            {
+                enclosed = enclosed && offset[c] <= limit[c] + 1e-4f;
+                // the box is tight: some corner reaches each face
+                touched[c] = touched[c] || fabsf(offset[c] - limit[c]) < 1e-4f;
+            }
+        }
+        ZW_CHECK(enclosed);
+        ZW_CHECK(touched[0] && touched[1] && touched[2]);
+    }
+}
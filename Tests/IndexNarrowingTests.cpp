@@ -0,0 +1,171 @@
+#include "TestFramework.h"
+#include "IndexNarrowing.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+    // side x side vertices whose payload is their original index, and the triangles of the grid.
+    // "shuffle" renumbers the vertices at random, so no run of triangles uses a compact range
+    void MakeGrid(uint32_t side, bool shuffle, std::vector<uint32_t>* vertices, std::vector<uint32_t>* indices)
+    {
+        const uint32_t vertexCount = side * side;
+        std::vector<uint32_t> order(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            order[i] = i;
+        }
+        if (shuffle)
+        {
+            std::mt19937 random(1);
+            std::shuffle(order.begin(), order.end(), random);
+        }
+        vertices->resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            (*vertices)[order[i]] = i;
+        }
+        indices->clear();
+        for (uint32_t y = 0; y + 1 < side; ++y)
+        {
+            for (uint32_t x = 0; x + 1 < side; ++x)
+            {
+                uint32_t a = order[y * side + x], b = order[y * side + x + 1];
+                uint32_t c = order[(y + 1) * side + x], d = order[(y + 1) * side + x + 1];
+                const uint32_t quad[6] = { a, b, c, b, d, c };
+                indices->insert(indices->end(), quad, quad + 6);
+            }
+        }
+    }
+
+    // every index of every submesh reaches the vertex the 32 bit index did, in the original order
+    bool DrawsTheSameVertices(const std::vector<uint32_t>& vertices, const std::vector<uint32_t>& indices,
+        const std::vector<uint16_t>& indices16, const std::vector<uint8_t>& vertices16, const std::vector<Submesh>& submeshes)
+    {
+        const uint32_t* vertexData = (const uint32_t*)vertices16.data();
+        const int64_t vertexCount = (int64_t)(vertices16.size() / sizeof(uint32_t));
+        uint32_t next = 0;
+        for (size_t s = 0; s < submeshes.size(); ++s)
+        {
+            const Submesh& submesh = submeshes[s];
+            if (submesh.firstIndex != next || submesh.indexCount % 3 != 0)
+            {
+                return false;
+            }
+            for (uint32_t i = 0; i < submesh.indexCount; ++i, ++next)
+            {
+                int64_t vertex = (int64_t)indices16[submesh.firstIndex + i] + submesh.baseVertex;
+                if (vertex < 0 || vertex >= vertexCount || vertexData[vertex] != vertices[indices[next]])
+                {
+                    return false;
+                }
+            }
+        }
+        return next == indices.size() && indices16.size() == indices.size();
+    }
+}
+
+ZW_TEST(EveryLevelNarrowsAndSaturatesTheSame)
+{
+    std::mt19937 random(2);
+    for (int trial = 0; trial < 200; ++trial)
+    {
+        // in range, on the limit, past it, below the base vertex and anything at all, in lengths
+        // that leave every kind of tail
+        const uint32_t count = random() % 100;
+        const uint32_t baseVertex = random() % 3 ? random() % 70000 : 0;
+        std::vector<uint32_t> indices(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            switch (random() % 4)
+            {
+            case 0: indices[i] = random(); break;
+            case 1: indices[i] = baseVertex + random() % 65536; break;
+            case 2: indices[i] = baseVertex + 65535 + random() % 3; break;
+            default: indices[i] = baseVertex - random() % 3; break;
+            }
+        }
+
+        std::vector<uint16_t> expected(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t index = indices[i] - baseVertex;
+            expected[i] = (uint16_t)std::min(index, 0xffffu);
+        }
+        const uint32_t expectedMax = count ? *std::max_element(indices.begin(), indices.end()) : 0;
+
+        for (size_t l = 0; l < sizeof(Levels) / sizeof(Levels[0]); ++l)
+        {
+            std::vector<uint16_t> narrowed(count);
+            NarrowIndices(narrowed.data(), indices.data(), count, baseVertex, Levels[l]);
+            ZW_CHECK(narrowed == expected);
+            ZW_CHECK_EQUAL(GetMaxIndex(indices.data(), count, Levels[l]), expectedMax);
+
+            // in place, into the first half of the same memory
+            std::vector<uint32_t> inPlace = indices;
+            NarrowIndices((uint16_t*)inPlace.data(), inPlace.data(), count, baseVertex, Levels[l]);
+            ZW_CHECK(count == 0 || memcmp(inPlace.data(), expected.data(), count * sizeof(uint16_t)) == 0);
+        }
+    }
+}
+
+ZW_TEST(MeshThatFitsIsOneSubmeshOverItsOwnVertices)
+{
+    std::vector<uint32_t> vertices, indices;
+    MakeGrid(200, true, &vertices, &indices);
+    std::vector<uint16_t> indices16;
+    std::vector<uint8_t> vertices16;
+    std::vector<Submesh> submeshes;
+    BuildIndexBuffer16(indices.data(), (uint32_t)indices.size(), vertices.data(), (uint32_t)vertices.size(), sizeof(uint32_t),
+        &indices16, &vertices16, &submeshes);
+    ZW_CHECK_EQUAL(submeshes.size(), (size_t)1);
+    ZW_CHECK_EQUAL(submeshes[0].baseVertex, 0);
+    ZW_CHECK(vertices16.size() == vertices.size() * sizeof(uint32_t) && memcmp(vertices16.data(), vertices.data(), vertices16.size()) == 0);
+    ZW_CHECK(DrawsTheSameVertices(vertices, indices, indices16, vertices16, submeshes));
+}
+
+ZW_TEST(LargeMeshIsSplitIntoAddressableSubmeshes)
+{
+    for (int shuffle = 0; shuffle < 2; ++shuffle)
+    {
+        // 160k vertices, in grid order and at random
+        std::vector<uint32_t> vertices, indices;
+        MakeGrid(400, shuffle != 0, &vertices, &indices);
+        std::vector<uint16_t> indices16;
+        std::vector<uint8_t> vertices16;
+        std::vector<Submesh> submeshes;
+        BuildIndexBuffer16(indices.data(), (uint32_t)indices.size(), vertices.data(), (uint32_t)vertices.size(), sizeof(uint32_t),
+            &indices16, &vertices16, &submeshes);
+        ZW_CHECK(submeshes.size() >= 3);
+        ZW_CHECK(DrawsTheSameVertices(vertices, indices, indices16, vertices16, submeshes));
+
+        // every submesh stays inside the vertex buffer it was built with
+        bool addressable = true;
+        for (size_t s = 0; s < submeshes.size(); ++s)
+        {
+            uint16_t maxIndex = *std::max_element(indices16.begin() + submeshes[s].firstIndex,
+                indices16.begin() + submeshes[s].firstIndex + submeshes[s].indexCount);
+            addressable = addressable && (uint64_t)submeshes[s].baseVertex + maxIndex < vertices16.size() / sizeof(uint32_t);
+        }
+        ZW_CHECK(addressable);
+
+        // only the vertices on the cuts are stored twice
+        const size_t vertexCount = vertices16.size() / sizeof(uint32_t);
+        ZW_CHECK(vertexCount >= vertices.size() && vertexCount < vertices.size() * 5 / 4);
+    }
+}
+
+ZW_TEST(EmptyMeshIsOneEmptySubmesh)
+{
+    std::vector<uint16_t> indices16(3);
+    std::vector<uint8_t> vertices16(4);
+    std::vector<Submesh> submeshes(2);
+    BuildIndexBuffer16(nullptr, 0, nullptr, 0, 4, &indices16, &vertices16, &submeshes);
+    ZW_CHECK(indices16.empty() && vertices16.empty());
+    ZW_CHECK(submeshes.size() == 1 && submeshes[0].indexCount == 0);
+    ZW_CHECK_EQUAL(GetMaxIndex(nullptr, 0), 0u);
+}
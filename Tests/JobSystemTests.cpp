@@ -0,0 +1,135 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <vector>
+
+// run with -DZW_SANITIZER=thread or address to catch races and use after free, the stress tests
+// below are built to provoke both
+
+ZW_TEST(ParallelForCoversEveryIndexOnce)
+{
+    JobSystem jobs(4);
+    const uint32_t counts[] = { 0, 1, 7, 64, 1000, 4097 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        std::vector<std::atomic<uint32_t>> hits(counts[c] + 1);
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            hits[i] = 0;
+        }
+        jobs.ParallelFor(counts[c], 16, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                hits[i].fetch_add(1);
+            }
+        });
+
+        bool once = true;
+        for (uint32_t i = 0; i < counts[c]; ++i)
+        {
+            once = once && hits[i] == 1;
+        }
+        ZW_CHECK(once);
+        ZW_CHECK_EQUAL(hits[counts[c]].load(), 0u);
+    }
+}
+
+ZW_TEST(NestedParallelForDoesNotDeadlock)
+{
+    // the outer ranges wait for inner ones, waiting runs jobs instead of blocking the thread
+    JobSystem jobs(3);
+    std::atomic<uint32_t> total(0);
+    jobs.ParallelFor(32, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            jobs.ParallelFor(100, 8, [&](uint32_t innerBegin, uint32_t innerEnd)
+            {
+                total.fetch_add(innerEnd - innerBegin);
+            });
+        }
+    });
+    ZW_CHECK_EQUAL(total.load(), 3200u);
+}
+
+ZW_TEST(RunAfterWaitsForTheDependency)
+{
+    JobSystem jobs(4);
+    for (int round = 0; round < 200; ++round)
+    {
+        JobCounter first, second;
+        std::atomic<uint32_t> firstDone(0);
+        std::atomic<bool> ranEarly(false);
+        for (int i = 0; i < 16; ++i)
+        {
+            jobs.Run([&]() { firstDone.fetch_add(1); }, &first);
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            jobs.RunAfter(&first, [&]()
+            {
+                if (firstDone.load() != 16)
+                {
+                    ranEarly = true;
+                }
+            }, &second);
+        }
+        jobs.Wait(&second);
+        ZW_CHECK(first.IsDone());
+        ZW_CHECK(!ranEarly.load());
+    }
+
+    // a dependency that is already done runs the job right away
+    JobCounter done, after;
+    bool ran = false;
+    jobs.RunAfter(&done, [&]() { ran = true; }, &after);
+    jobs.Wait(&after);
+    ZW_CHECK(ran);
+}
+
+ZW_TEST(CounterCanBeDestroyedAsSoonAsWaitReturns)
+{
+    // the counter lives exactly as long as the wait, like the one on ParallelFor's stack. a worker
+    // that still touched it after the last job finished would write into freed memory
+    JobSystem jobs(4);
+    std::atomic<uint32_t> executed(0);
+    for (int round = 0; round < 20000; ++round)
+    {
+        JobCounter* counter = new JobCounter();
+        jobs.Run([&]() { executed.fetch_add(1); }, counter);
+        jobs.Run([&]() { executed.fetch_add(1); }, counter);
+        jobs.Wait(counter);
+        delete counter;
+    }
+    ZW_CHECK_EQUAL(executed.load(), 40000u);
+}
+
+ZW_TEST(StackCountersOfBackToBackParallelFors)
+{
+    // the pattern that broke: every ParallelFor has its counter on the stack at the same address
+    JobSystem jobs(4);
+    std::atomic<uint64_t> sum(0);
+    for (int round = 0; round < 20000; ++round)
+    {
+        jobs.ParallelFor(4, 1, [&](uint32_t begin, uint32_t end) { sum.fetch_add(end - begin); });
+    }
+    ZW_CHECK_EQUAL(sum.load(), 80000u);
+}
+
+ZW_TEST(RunAfterRacingTheLastJobIsNeverLost)
+{
+    // RunAfter on a counter whose last job is finishing on another thread either sees it done or
+    // is started by that job
+    JobSystem jobs(4);
+    for (int round = 0; round < 5000; ++round)
+    {
+        JobCounter dependency, after;
+        std::atomic<bool> ran(false);
+        jobs.Run([]() {}, &dependency);
+        jobs.RunAfter(&dependency, [&]() { ran = true; }, &after);
+        jobs.Wait(&after);
+        jobs.Wait(&dependency);
+        ZW_CHECK(ran.load());
+    }
+}
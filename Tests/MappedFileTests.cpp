@@ -0,0 +1,178 @@
+#include "TestFramework.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// the files are written into the working directory and removed again
+
+namespace
+{
+    const char* TestPath = "MappedFileTests.bin";
+
+    std::vector<uint8_t> WriteTestFile(const char* path, size_t size)
+    {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            bytes[i] = (uint8_t)(i * 131 + (i >> 12));
+        }
+        std::ofstream out(path, std::ios::binary);
+        out.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+        return bytes;
+    }
+}
+
+ZW_TEST(SpansStayInsideTheFile)
+{
+    const std::vector<uint8_t> bytes = WriteTestFile(TestPath, 10000);
+    MappedFile file;
+    ZW_CHECK(file.Open(TestPath));
+    ZW_CHECK(file.IsOpen());
+    ZW_CHECK_EQUAL(file.GetSize(), (uint64_t)10000);
+    ZW_CHECK(file.GetData() != nullptr && memcmp(file.GetData(), bytes.data(), bytes.size()) == 0);
+    ZW_CHECK(file.GetSpan().data == file.GetData() && file.GetSpan().size == 10000);
+
+    ByteSpan span;
+    ZW_CHECK(file.Span(0, 10000, &span) && span.data == file.GetData() && span.size == 10000);
+    ZW_CHECK(file.Span(1234, 100, &span) && span.data == file.GetData() + 1234 && span.size == 100);
+    ZW_CHECK(file.Span(9999, 1, &span) && span.data[0] == bytes[9999]);
+    ZW_CHECK(file.Span(10000, 0, &span) && span.size == 0);
+    ZW_CHECK(!file.Span(0, 10001, &span));
+    ZW_CHECK(!file.Span(9999, 2, &span));
+    ZW_CHECK(!file.Span(10001, 0, &span));
+
+    // offsets and sizes that only fit if the arithmetic wraps or is cut to 32 bits
+    ZW_CHECK(!file.Span(0x100000000ull, 16, &span));
+    ZW_CHECK(!file.Span(16, 0x100000000ull, &span));
+    ZW_CHECK(!file.Span(0x100000000ull + 16, 0, &span));
+    ZW_CHECK(!file.Span(~0ull, 2, &span));
+    ZW_CHECK(!file.Span(2, ~0ull, &span));
+    ZW_CHECK(!file.Span(~0ull, ~0ull, &span));
+    file.Close();
+    remove(TestPath);
+}
+
+ZW_TEST(EmptyAndMissingFiles)
+{
+    // an empty file opens, there just is nothing in it
+    WriteTestFile(TestPath, 0);
+    MappedFile file;
+    ZW_CHECK(file.Open(TestPath));
+    ZW_CHECK(file.IsOpen());
+    ZW_CHECK_EQUAL(file.GetSize(), (uint64_t)0);
+    ZW_CHECK(file.GetData() == nullptr);
+    ByteSpan span;
+    ZW_CHECK(file.Span(0, 0, &span) && span.size == 0);
+    ZW_CHECK(!file.Span(0, 1, &span));
+    file.Advise(MapAdvice::WillNeed);
+    file.Touch();
+    file.Close();
+    remove(TestPath);
+
+    // a missing file or a directory doesn't, and leaves the object closed
+    ZW_CHECK(!file.Open("MappedFileTests.missing.bin"));
+    ZW_CHECK(!file.IsOpen());
+    ZW_CHECK_EQUAL(file.GetSize(), (uint64_t)0);
+    ZW_CHECK(!file.Open("."));
+    ZW_CHECK(!file.IsOpen());
+
+    // a failed open closes what was open before
+    WriteTestFile(TestPath, 100);
+    ZW_CHECK(file.Open(TestPath));
+    ZW_CHECK(!file.Open("MappedFileTests.missing.bin"));
+    ZW_CHECK(!file.IsOpen() && file.GetData() == nullptr);
+    remove(TestPath);
+}
+
+ZW_TEST(AdviseAndTouchWorkOnAnySubRange)
+{
+    // three pages and a bit, ranges that start and end inside pages, reach past the end or start there
+    const std::vector<uint8_t> bytes = WriteTestFile(TestPath, 3 * 4096 + 100);
+    MappedFile file;
+    ZW_CHECK(file.Open(TestPath));
+    const uint64_t ranges[][2] = { { 0, 0 }, { 1, 1 }, { 100, 4000 }, { 4095, 2 }, { 4096, 4096 }, { 5000, 0 },
+        { 8000, 100000 }, { 3 * 4096 + 99, 1 }, { 3 * 4096 + 100, 1 }, { 0x100000000ull, 16 }, { ~0ull, ~0ull } };
+    const MapAdvice advice[] = { MapAdvice::Normal, MapAdvice::Sequential, MapAdvice::Random, MapAdvice::WillNeed };
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r)
+    {
+        for (size_t a = 0; a < sizeof(advice) / sizeof(advice[0]); ++a)
+        {
+            file.Advise(advice[a], ranges[r][0], ranges[r][1]);
+        }
+        file.Touch(ranges[r][0], ranges[r][1]);
+    }
+
+    // hints don't change what's read
+    file.Advise(MapAdvice::Normal);
+    ZW_CHECK(memcmp(file.GetData(), bytes.data(), bytes.size()) == 0);
+    file.Close();
+    remove(TestPath);
+}
+
+ZW_TEST(CloseInvalidatesEverySpan)
+{
+    WriteTestFile(TestPath, 5000);
+    MappedFile file;
+    ZW_CHECK(file.Open(TestPath));
+    ByteSpan span;
+    ZW_CHECK(file.Span(100, 200, &span));
+
+    file.Close();
+    ZW_CHECK(!file.IsOpen());
+    ZW_CHECK(file.GetData() == nullptr && file.GetSize() == 0);
+    ZW_CHECK(file.GetSpan().data == nullptr && file.GetSpan().size == 0);
+    ZW_CHECK(!file.Span(100, 200, &span));
+    ZW_CHECK(!file.Span(0, 1, &span));
+    file.Advise(MapAdvice::WillNeed, 100, 200);
+    file.Touch(100, 200);
+    file.Close();
+
+    // opening again maps the file anew
+    const std::vector<uint8_t> bytes = WriteTestFile(TestPath, 300);
+    ZW_CHECK(file.Open(TestPath));
+    ZW_CHECK(file.Span(100, 200, &span) && memcmp(span.data, bytes.data() + 100, 200) == 0);
+    ZW_CHECK(!file.Span(100, 201, &span));
+    file.Close();
+    remove(TestPath);
+}
+
+#if !defined(_WIN32)
+ZW_TEST(FilesLargerThan4GBAreAddressedWith64BitOffsets)
+{
+    // a sparse 5GB file with a marker past 4GB. ntfs would write the zeros out, so not on windows
+    if (sizeof(void*) < 8)
+    {
+        return;
+    }
+    const uint64_t markerOffset = 0x100000000ull + 12345;
+    const uint64_t size = 5ull << 30;
+    {
+        std::ofstream out(TestPath, std::ios::binary);
+        out.seekp((std::streamoff)markerOffset);
+        out.write("marker", 6);
+        out.seekp((std::streamoff)(size - 1));
+        out.put('!');
+        ZW_CHECK(out.good());
+    }
+
+    MappedFile file;
+    ZW_CHECK(file.Open(TestPath));
+    ZW_CHECK_EQUAL(file.GetSize(), size);
+    ByteSpan span;
+    ZW_CHECK(file.Span(markerOffset, 6, &span) && memcmp(span.data, "marker", 6) == 0);
+    ZW_CHECK(span.data == file.GetData() + markerOffset);
+    ZW_CHECK(file.Span(size - 1, 1, &span) && span.data[0] == '!');
+    ZW_CHECK(file.Span(markerOffset - 0x100000000ull, 6, &span) && span.data[0] == 0); // the same offset cut to 32 bits
+    ZW_CHECK(!file.Span(size - 1, 2, &span));
+    ZW_CHECK(!file.Span(markerOffset, size, &span));
+
+    file.Advise(MapAdvice::Random, markerOffset - 100, 8192);
+    file.Touch(markerOffset - 100, 8192);
+    file.Touch(size - 4096);
+    ZW_CHECK(file.Span(markerOffset, 6, &span) && memcmp(span.data, "marker", 6) == 0);
+    file.Close();
+    remove(TestPath);
+}
+#endif
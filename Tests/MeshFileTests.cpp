@@ -0,0 +1,223 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include "MeshFile.h"
+#include "NullRenderBackend.h"
+#include "Scene.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    // two quads of PositionColorQuantized vertices, each its own submesh over its own 4 vertices
+    struct TestMesh
+    {
+        std::vector<uint8_t> vertices;
+        std::vector<uint16_t> indices;
+        std::vector<Submesh> submeshes;
+        MeshFileInfo info;
+    };
+
+    void MakeTestMesh(TestMesh* mesh)
+    {
+        mesh->vertices.resize(8 * 12);
+        for (size_t i = 0; i < mesh->vertices.size(); ++i)
+        {
+            mesh->vertices[i] = (uint8_t)(i * 37 + 5);
+        }
+        const uint16_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+        mesh->indices.assign(quad, quad + 6);
+        mesh->indices.insert(mesh->indices.end(), quad, quad + 6);
+        const Submesh submeshes[2] = { { 0, 6, 0 }, { 6, 6, 4 } };
+        mesh->submeshes.assign(submeshes, submeshes + 2);
+
+        MeshFileInfo& info = mesh->info;
+        info.vertexLayout = VertexLayout::PositionColorQuantized;
+        info.vertexStride = 12;
+        info.vertexCount = 8;
+        info.indexFormat = IndexFormat::UInt16;
+        info.indexCount = (uint32_t)mesh->indices.size();
+        const float center[3] = { 0.5f, -1.0f, 2.0f };
+        const float extent[3] = { 1.0f, 2.0f, 0.25f };
+        memcpy(info.boundsCenter, center, sizeof(center));
+        memcpy(info.boundsExtent, extent, sizeof(extent));
+        info.vertices.data = mesh->vertices.data();
+        info.vertices.size = mesh->vertices.size();
+        info.indices.data = (const uint8_t*)mesh->indices.data();
+        info.indices.size = mesh->indices.size() * sizeof(uint16_t);
+        info.submeshes = mesh->submeshes.data();
+        info.submeshCount = (uint32_t)mesh->submeshes.size();
+    }
+
+    std::vector<uint8_t> ReadFile(const char* path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    bool Parses(const std::vector<uint8_t>& file)
+    {
+        ByteSpan span = { file.data(), file.size() };
+        MeshFileInfo info;
+        return ParseMeshFile(span, &info);
+    }
+
+    // "file" with the header field at byte "offset" replaced
+    template <typename T>
+    std::vector<uint8_t> Patched(const std::vector<uint8_t>& file, size_t offset, T value)
+    {
+        std::vector<uint8_t> patched = file;
+        memcpy(patched.data() + offset, &value, sizeof(value));
+        return patched;
+    }
+}
+
+ZW_TEST(WrittenMeshOpensWithEverySectionIntact)
+{
+    const char* path = "MeshFileTests.zwmesh";
+    TestMesh mesh;
+    MakeTestMesh(&mesh);
+    ZW_CHECK(WriteMeshFile(path, mesh.info));
+
+    MeshFile file;
+    ZW_CHECK(file.Open(path));
+    const MeshFileInfo& info = file.GetInfo();
+    ZW_CHECK(info.vertexLayout == VertexLayout::PositionColorQuantized);
+    ZW_CHECK_EQUAL(info.vertexStride, 12u);
+    ZW_CHECK_EQUAL(info.vertexCount, 8u);
+    ZW_CHECK(info.indexFormat == IndexFormat::UInt16);
+    ZW_CHECK_EQUAL(info.indexCount, 12u);
+    ZW_CHECK(memcmp(info.boundsCenter, mesh.info.boundsCenter, sizeof(info.boundsCenter)) == 0);
+    ZW_CHECK(memcmp(info.boundsExtent, mesh.info.boundsExtent, sizeof(info.boundsExtent)) == 0);
+    ZW_CHECK(info.vertices.size == mesh.vertices.size() && memcmp(info.vertices.data, mesh.vertices.data(), mesh.vertices.size()) == 0);
+    ZW_CHECK(info.indices.size == 24 && memcmp(info.indices.data, mesh.indices.data(), 24) == 0);
+    ZW_CHECK(info.submeshCount == 2 && memcmp(info.submeshes, mesh.submeshes.data(), 2 * sizeof(Submesh)) == 0);
+
+    // every section starts on a cache line of the file
+    std::vector<uint8_t> bytes = ReadFile(path);
+    MeshFileHeader header;
+    ZW_CHECK(bytes.size() >= sizeof(header));
+    memcpy(&header, bytes.data(), sizeof(header));
+    ZW_CHECK_EQUAL(header.magic, MeshFileMagic);
+    ZW_CHECK_EQUAL(header.version, MeshFileVersion);
+    ZW_CHECK(header.vertexOffset % MeshFileAlignment == 0 && header.indexOffset % MeshFileAlignment == 0 &&
+        header.submeshOffset % MeshFileAlignment == 0);
+    ZW_CHECK_EQUAL(bytes.size(), (size_t)header.submeshOffset + 2 * sizeof(Submesh));
+
+    file.Close();
+    ZW_CHECK(file.GetInfo().vertices.data == nullptr && file.GetInfo().submeshCount == 0);
+    remove(path);
+}
+
+ZW_TEST(BrokenFilesAreRejected)
+{
+    const char* path = "MeshFileTests.zwmesh";
+    TestMesh mesh;
+    MakeTestMesh(&mesh);
+    ZW_CHECK(WriteMeshFile(path, mesh.info));
+    const std::vector<uint8_t> file = ReadFile(path);
+    remove(path);
+    ZW_CHECK(Parses(file));
+
+    // cut anywhere, the submesh section is last and has no padding behind it
+    bool truncatedRejected = true;
+    for (size_t size = 0; size < file.size(); ++size)
+    {
+        truncatedRejected = truncatedRejected && !Parses(std::vector<uint8_t>(file.begin(), file.begin() + size));
+    }
+    ZW_CHECK(truncatedRejected);
+
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, magic), 0x12345678u)));
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, version), MeshFileVersion + 1)));
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, vertexLayout), 7u)));
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, vertexStride), 28u))); // not the stride of the layout
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, indexFormat), 7u)));
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, vertexCount), 0x7fffffffu)));
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, indexOffset), (uint64_t)MeshFileAlignment + 4)));
+    ZW_CHECK(!Parses(Patched(file, offsetof(MeshFileHeader, submeshOffset), ~(uint64_t)0 - 63)));
+
+    // submeshes reaching past the indices or the vertices
+    MeshFileHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    const size_t second = (size_t)header.submeshOffset + sizeof(Submesh);
+    ZW_CHECK(!Parses(Patched(file, second + offsetof(Submesh, indexCount), 7u)));
+    ZW_CHECK(!Parses(Patched(file, second + offsetof(Submesh, baseVertex), (int32_t)8)));
+    ZW_CHECK(!Parses(Patched(file, second + offsetof(Submesh, baseVertex), (int32_t)-1)));
+
+    MeshFile missing;
+    ZW_CHECK(!missing.Open("MeshFileTests.missing.zwmesh"));
+}
+
+ZW_TEST(BuffersAreCreatedStraightFromTheSections)
+{
+    const char* path = "MeshFileTests.zwmesh";
+    TestMesh mesh;
+    MakeTestMesh(&mesh);
+    ZW_CHECK(WriteMeshFile(path, mesh.info));
+
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(320, 240));
+    MeshFile file;
+    ZW_CHECK(file.Open(path));
+    StaticBuffer vertexBuffer, indexBuffer;
+    ZW_CHECK(file.CreateBuffers(&backend, &vertexBuffer, &indexBuffer));
+    ZW_CHECK_EQUAL(vertexBuffer.size, (uint64_t)mesh.vertices.size());
+    ZW_CHECK_EQUAL(indexBuffer.size, (uint64_t)24);
+
+    // the copies out of the map land once the uploads are submitted
+    ZW_CHECK(backend.FlushUploads());
+    const uint8_t* vertices = backend.GetResourceData(vertexBuffer.resource);
+    const uint8_t* indices = backend.GetResourceData(indexBuffer.resource);
+    ZW_CHECK(vertices && memcmp(vertices, mesh.vertices.data(), mesh.vertices.size()) == 0);
+    ZW_CHECK(indices && memcmp(indices, mesh.indices.data(), 24) == 0);
+    file.Close();
+    backend.Shutdown();
+    remove(path);
+}
+
+ZW_TEST(SceneDrawsEverySubmeshOfTheFile)
+{
+    const char* path = "MeshFileTests.zwmesh";
+    TestMesh mesh;
+    MakeTestMesh(&mesh);
+    ZW_CHECK(WriteMeshFile(path, mesh.info));
+
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(320, 240));
+    SceneSettings settings = { 0, true, false, 0, true, path, nullptr };
+    ZW_CHECK(InitScene(&backend, &jobs, 320, 240, settings));
+    backend.ClearCommands();
+    SimulateScene(1.0f / 120.0f);
+    ZW_CHECK(backend.BeginFrame() && UpdateScene(&backend, 1.0f) && RecordScene(&backend) && backend.EndFrame());
+
+    // the file's own index format, and one instanced draw per submesh
+    std::vector<RenderCommand> draws;
+    bool sixteenBit = false;
+    const std::vector<RenderCommand>& commands = backend.GetCommands();
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        if (commands[i].type == RenderCommandType::DrawIndexedInstanced)
+        {
+            draws.push_back(commands[i]);
+        }
+        else if (commands[i].type == RenderCommandType::SetIndexBuffer)
+        {
+            sixteenBit = commands[i].indexBufferView.format == IndexFormat::UInt16;
+        }
+    }
+    ZW_CHECK(sixteenBit);
+    ZW_CHECK_EQUAL(draws.size(), (size_t)2);
+    for (size_t i = 0; i < draws.size() && i < 2; ++i)
+    {
+        ZW_CHECK_EQUAL(draws[i].draw.indexCountPerInstance, mesh.submeshes[i].indexCount);
+        ZW_CHECK_EQUAL(draws[i].draw.startIndexLocation, mesh.submeshes[i].firstIndex);
+        ZW_CHECK_EQUAL(draws[i].draw.baseVertexLocation, mesh.submeshes[i].baseVertex);
+    }
+    ShutdownScene();
+    backend.Shutdown();
+    remove(path);
+}
@@ -0,0 +1,244 @@
+#include "TestFramework.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct Vertex
+    {
+        float position[3];
+        float color[4];
+    };
+
+    struct Mesh
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // a wavy n x n quad grid with its triangles and vertices shuffled, the worst case of an
+    // authored mesh
+    Mesh ShuffledGrid(uint32_t n, uint32_t seed)
+    {
+        Mesh grid;
+        for (uint32_t y = 0; y <= n; ++y)
+        {
+            for (uint32_t x = 0; x <= n; ++x)
+            {
+                Vertex vertex = { { (float)x, (float)y, sinf(x * 0.1f) * cosf(y * 0.1f) }, { x / (float)n, y / (float)n, 0.0f, 1.0f } };
+                grid.vertices.push_back(vertex);
+            }
+        }
+        std::vector<uint32_t> indices;
+        for (uint32_t y = 0; y < n; ++y)
+        {
+            for (uint32_t x = 0; x < n; ++x)
+            {
+                uint32_t a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+                const uint32_t quad[6] = { a, c, b, b, c, d };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+
+        std::mt19937 random(seed);
+        std::vector<uint32_t> triangles(indices.size() / 3), order(grid.vertices.size());
+        for (uint32_t i = 0; i < triangles.size(); ++i)
+        {
+            triangles[i] = i;
+        }
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::shuffle(triangles.begin(), triangles.end(), random);
+        std::shuffle(order.begin(), order.end(), random);
+
+        Mesh shuffled;
+        shuffled.vertices.resize(grid.vertices.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            shuffled.vertices[order[i]] = grid.vertices[i];
+        }
+        for (uint32_t t = 0; t < triangles.size(); ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                shuffled.indices.push_back(order[indices[triangles[t] * 3 + k]]);
+            }
+        }
+        return shuffled;
+    }
+
+    // the triangles as a sorted list, each rotated so its smallest index comes first (which keeps
+    // the winding)
+    std::vector<uint64_t> TriangleSet(const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint64_t> keys;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            while (a > b || a > c)
+            {
+                uint32_t first = a;
+                a = b;
+                b = c;
+                c = first;
+            }
+            keys.push_back(((uint64_t)a << 42) | ((uint64_t)b << 21) | c);
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+}
+
+ZW_TEST(AnalysisReplaysAFifoCache)
+{
+    // two triangles, then the first one again
+    const uint32_t indices[9] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    VertexCacheStats small = AnalyzeVertexCache(indices, 9, 6, 3);
+    ZW_CHECK_EQUAL(small.transformedVertices, 9u); // 0..2 were pushed out by 3..5
+    ZW_CHECK_NEAR(small.acmr, 3.0f, 1e-6f);
+    ZW_CHECK_NEAR(small.atvr, 1.5f, 1e-6f);
+
+    VertexCacheStats large = AnalyzeVertexCache(indices, 9, 6, 6);
+    ZW_CHECK_EQUAL(large.transformedVertices, 6u);
+    ZW_CHECK_NEAR(large.acmr, 2.0f, 1e-6f);
+    ZW_CHECK_NEAR(large.atvr, 1.0f, 1e-6f);
+
+    // a fifo: hits don't refresh an entry, so 0 still leaves after 4 more misses
+    const uint32_t fifo[12] = { 0, 1, 2, 0, 3, 4, 0, 5, 6, 0, 1, 2 };
+    ZW_CHECK_EQUAL(AnalyzeVertexCache(fifo, 12, 7, 4).transformedVertices, 10u);
+}
+
+ZW_TEST(CacheOrderKeepsTheTrianglesAndApproachesTheGridOptimum)
+{
+    Mesh mesh = ShuffledGrid(64, 1);
+    const uint32_t indexCount = (uint32_t)mesh.indices.size();
+    const uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+    VertexCacheStats before = AnalyzeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+    ZW_CHECK(before.acmr > 2.5f);
+
+    std::vector<uint32_t> optimized(indexCount);
+    OptimizeVertexCache(optimized.data(), mesh.indices.data(), indexCount, vertexCount);
+    ZW_CHECK(TriangleSet(optimized) == TriangleSet(mesh.indices));
+    VertexCacheStats after = AnalyzeVertexCache(optimized.data(), indexCount, vertexCount);
+    // 0.5 is the limit for an infinite grid, a 16 entry fifo gets to about 0.7
+    ZW_CHECK(after.acmr < 0.8f);
+    ZW_CHECK(after.atvr < 1.5f);
+
+    // in place gives the same order
+    std::vector<uint32_t> inPlace = mesh.indices;
+    OptimizeVertexCache(inPlace.data(), inPlace.data(), indexCount, vertexCount);
+    ZW_CHECK(inPlace == optimized);
+}
+
+ZW_TEST(OverdrawOrderKeepsTheTrianglesAndMostOfTheCacheLocality)
+{
+    Mesh mesh = ShuffledGrid(64, 2);
+    const uint32_t indexCount = (uint32_t)mesh.indices.size();
+    const uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+    std::vector<uint32_t> cacheOrder(indexCount), overdrawOrder(indexCount);
+    OptimizeVertexCache(cacheOrder.data(), mesh.indices.data(), indexCount, vertexCount);
+    OptimizeOverdraw(overdrawOrder.data(), cacheOrder.data(), indexCount, mesh.vertices[0].position, sizeof(Vertex), vertexCount, 1.05f);
+    ZW_CHECK(TriangleSet(overdrawOrder) == TriangleSet(mesh.indices));
+
+    float cacheAcmr = AnalyzeVertexCache(cacheOrder.data(), indexCount, vertexCount).acmr;
+    float overdrawAcmr = AnalyzeVertexCache(overdrawOrder.data(), indexCount, vertexCount).acmr;
+    ZW_CHECK(overdrawAcmr <= cacheAcmr * 1.05f + 0.02f);
+}
+
+ZW_TEST(IndicesPastTheVerticesKeepTheOrder)
+{
+    // one index of the grid points past the vertex buffer, neither reorder may read or write out of
+    // bounds for it, they copy the triangles through as they are
+    Mesh mesh = ShuffledGrid(16, 4);
+    const uint32_t indexCount = (uint32_t)mesh.indices.size();
+    const uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+    const uint32_t broken[] = { 0, indexCount / 2, indexCount - 1 };
+    for (uint32_t position : broken)
+    {
+        std::vector<uint32_t> indices = mesh.indices;
+        indices[position] = vertexCount + 1000000;
+
+        std::vector<uint32_t> cacheOrder(indexCount, 0), overdrawOrder(indexCount, 0);
+        OptimizeVertexCache(cacheOrder.data(), indices.data(), indexCount, vertexCount);
+        ZW_CHECK(cacheOrder == indices);
+        OptimizeOverdraw(overdrawOrder.data(), indices.data(), indexCount, mesh.vertices[0].position, sizeof(Vertex), vertexCount, 1.05f);
+        ZW_CHECK(overdrawOrder == indices);
+
+        // an index equal to the count is just as far out
+        indices[position] = vertexCount;
+        OptimizeOverdraw(overdrawOrder.data(), indices.data(), indexCount, mesh.vertices[0].position, sizeof(Vertex), vertexCount, 1.05f);
+        ZW_CHECK(overdrawOrder == indices);
+    }
+}
+
+ZW_TEST(FetchOrderFollowsFirstUseAndDropsUnusedVertices)
+{
+    Vertex vertices[5];
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        Vertex vertex = { { (float)i, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+        vertices[i] = vertex;
+    }
+    // vertex 1 is never used
+    uint32_t indices[6] = { 4, 2, 0, 0, 2, 3 };
+    Vertex reordered[5];
+    ZW_CHECK_EQUAL(OptimizeVertexFetch(reordered, indices, 6, vertices, 5, sizeof(Vertex)), 4u);
+    const uint32_t expectedIndices[6] = { 0, 1, 2, 2, 1, 3 };
+    const float expectedPositions[4] = { 4.0f, 2.0f, 0.0f, 3.0f };
+    for (int i = 0; i < 6; ++i)
+    {
+        ZW_CHECK_EQUAL(indices[i], expectedIndices[i]);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        ZW_CHECK_EQUAL(reordered[i].position[0], expectedPositions[i]);
+    }
+}
+
+ZW_TEST(WholePipelineDrawsTheSameMesh)
+{
+    Mesh mesh = ShuffledGrid(32, 3);
+    const uint32_t indexCount = (uint32_t)mesh.indices.size();
+    const uint32_t vertexCount = (uint32_t)mesh.vertices.size();
+    std::vector<uint32_t> cacheOrder(indexCount), indices(indexCount);
+    OptimizeVertexCache(cacheOrder.data(), mesh.indices.data(), indexCount, vertexCount);
+    OptimizeOverdraw(indices.data(), cacheOrder.data(), indexCount, mesh.vertices[0].position, sizeof(Vertex), vertexCount, 1.05f);
+    std::vector<Vertex> vertices(vertexCount);
+    ZW_CHECK_EQUAL(OptimizeVertexFetch(vertices.data(), indices.data(), indexCount, mesh.vertices.data(), vertexCount, sizeof(Vertex)),
+        vertexCount);
+
+    // the same triangles by position, and the vertex buffer is walked front to back
+    std::vector<uint64_t> before, after;
+    uint32_t highest = 0;
+    bool inOrder = true;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        inOrder = inOrder && indices[i] <= highest + 1;
+        highest = std::max(highest, indices[i]);
+    }
+    ZW_CHECK(inOrder);
+    for (uint32_t t = 0; t < indexCount; t += 3)
+    {
+        // a grid corner is x * 1000 + y, a triangle its three corners in ascending order
+        uint64_t originalCorners[3], optimizedCorners[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            const Vertex& original = mesh.vertices[mesh.indices[t + k]];
+            const Vertex& optimized = vertices[indices[t + k]];
+            originalCorners[k] = (uint64_t)(original.position[0] * 1000.0f + original.position[1]);
+            optimizedCorners[k] = (uint64_t)(optimized.position[0] * 1000.0f + optimized.position[1]);
+        }
+        std::sort(originalCorners, originalCorners + 3);
+        std::sort(optimizedCorners, optimizedCorners + 3);
+        before.push_back(originalCorners[0] << 40 | originalCorners[1] << 20 | originalCorners[2]);
+        after.push_back(optimizedCorners[0] << 40 | optimizedCorners[1] << 20 | optimizedCorners[2]);
+    }
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    ZW_CHECK(before == after);
+}
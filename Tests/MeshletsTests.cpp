@@ -0,0 +1,277 @@
+#include "TestFramework.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include <DirectXMath.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct Mesh
+    {
+        std::vector<float> positions; // 3 per vertex
+        std::vector<uint32_t> indices;
+    };
+
+    const float* Position(const Mesh& mesh, uint32_t vertex)
+    {
+        return &mesh.positions[vertex * 3];
+    }
+
+    // n = (p1 - p0) x (p2 - p0), out of the front of a clockwise triangle in a left handed space
+    void TriangleNormal(const float* p0, const float* p1, const float* p2, double* n)
+    {
+        double e1[3], e2[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            e1[k] = (double)p1[k] - p0[k];
+            e2[k] = (double)p2[k] - p0[k];
+        }
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+
+    // a unit uv sphere of "segments" rings, front faces outside, in vertex cache order
+    Mesh MakeSphere(uint32_t segments)
+    {
+        Mesh mesh;
+        const float pi = 3.14159265f;
+        const uint32_t columns = 2 * segments;
+        for (uint32_t y = 0; y <= segments; ++y)
+        {
+            for (uint32_t x = 0; x <= columns; ++x)
+            {
+                float theta = pi * y / segments, phi = 2.0f * pi * x / columns;
+                const float p[3] = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+                mesh.positions.insert(mesh.positions.end(), p, p + 3);
+            }
+        }
+        for (uint32_t y = 0; y < segments; ++y)
+        {
+            for (uint32_t x = 0; x < columns; ++x)
+            {
+                uint32_t a = y * (columns + 1) + x, b = a + 1, c = a + columns + 1, d = c + 1;
+                const uint32_t quad[6] = { a, b, c, b, d, c };
+                mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+            }
+        }
+
+        OptimizeVertexCache(mesh.indices.data(), mesh.indices.data(), (uint32_t)mesh.indices.size(), (uint32_t)(mesh.positions.size() / 3));
+        return mesh;
+    }
+
+    MeshletData Build(const Mesh& mesh, uint32_t maxVertices, uint32_t maxPrimitives)
+    {
+        MeshletData data;
+        BuildMeshlets(mesh.indices.data(), (uint32_t)mesh.indices.size(), mesh.positions.data(), 3 * sizeof(float),
+            (uint32_t)(mesh.positions.size() / 3), maxVertices, maxPrimitives, &data);
+        return data;
+    }
+
+    // the frustum of a camera at "eye" looking at "target", and the camera position
+    Frustum LookAt(const float eye[3], const float target[3])
+    {
+        XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(eye[0], eye[1], eye[2], 1.0f), XMVectorSet(target[0], target[1], target[2], 1.0f),
+            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX projection = XMMatrixPerspectiveFovLH(0.8f, 4.0f / 3.0f, 0.1f, 100.0f);
+        XMFLOAT4X4 viewProj;
+        XMStoreFloat4x4(&viewProj, view * projection);
+        Frustum frustum;
+        ExtractFrustum(&viewProj.m[0][0], &frustum);
+        return frustum;
+    }
+}
+
+ZW_TEST(MeshletsStayInTheLimitsAndKeepEveryTriangleInOrder)
+{
+    const Mesh mesh = MakeSphere(40);
+    const uint32_t limits[][2] = { { 64, 124 }, { 3, 1 }, { 128, 256 }, { 256, 256 }, { 0, 0 }, { 1000, 1000 } };
+    for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); ++l)
+    {
+        // clamped to 3..256 vertices and 1..256 triangles
+        const uint32_t maxVertices = limits[l][0] < 3 ? 3 : (limits[l][0] > 256 ? 256 : limits[l][0]);
+        const uint32_t maxPrimitives = limits[l][1] < 1 ? 1 : (limits[l][1] > 256 ? 256 : limits[l][1]);
+        MeshletData data = Build(mesh, limits[l][0], limits[l][1]);
+        ZW_CHECK_EQUAL(data.bounds.size(), data.meshlets.size());
+
+        // walking the meshlets gives back the index buffer, and each one starts where the last ended
+        bool inLimits = true, contiguous = true, localInRange = true;
+        uint32_t nextVertex = 0, nextPrimitive = 0;
+        std::vector<uint32_t> rebuilt;
+        for (size_t m = 0; m < data.meshlets.size(); ++m)
+        {
+            const Meshlet& meshlet = data.meshlets[m];
+            inLimits = inLimits && meshlet.vertexCount <= maxVertices && meshlet.primitiveCount <= maxPrimitives &&
+                meshlet.primitiveCount > 0;
+            contiguous = contiguous && meshlet.vertexOffset == nextVertex && meshlet.primitiveOffset == nextPrimitive;
+            nextVertex += meshlet.vertexCount;
+            nextPrimitive += meshlet.primitiveCount;
+            for (uint32_t i = 0; i < meshlet.primitiveCount * 3; ++i)
+            {
+                uint8_t local = data.primitives[meshlet.primitiveOffset * 3 + i];
+                localInRange = localInRange && local < meshlet.vertexCount;
+                rebuilt.push_back(data.vertices[meshlet.vertexOffset + (local < meshlet.vertexCount ? local : 0)]);
+            }
+        }
+        ZW_CHECK(inLimits);
+        ZW_CHECK(contiguous);
+        ZW_CHECK(localInRange);
+        ZW_CHECK_EQUAL(nextVertex, (uint32_t)data.vertices.size());
+        ZW_CHECK_EQUAL(nextPrimitive * 3, (uint32_t)data.primitives.size());
+        ZW_CHECK(rebuilt == mesh.indices);
+    }
+}
+
+ZW_TEST(CacheOrderedMeshletsAreMostlyFull)
+{
+    const Mesh mesh = MakeSphere(60);
+    MeshletData data = Build(mesh, DefaultMeshletVertices, DefaultMeshletPrimitives);
+    const uint32_t triangleCount = (uint32_t)mesh.indices.size() / 3;
+
+    // a run of triangles a vertex cache keeps together fills a meshlet with few vertices to spare
+    ZW_CHECK(data.meshlets.size() * DefaultMeshletPrimitives < triangleCount * 2);
+}
+
+ZW_TEST(BoundingSpheresContainTheirVertices)
+{
+    const Mesh mesh = MakeSphere(30);
+    MeshletData data = Build(mesh, DefaultMeshletVertices, DefaultMeshletPrimitives);
+    bool inside = true, tight = true;
+    for (size_t m = 0; m < data.meshlets.size(); ++m)
+    {
+        const Meshlet& meshlet = data.meshlets[m];
+        const MeshletBounds& bounds = data.bounds[m];
+        float farthest = 0.0f;
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        {
+            const float* p = Position(mesh, data.vertices[meshlet.vertexOffset + i]);
+            float dx = p[0] - bounds.center[0], dy = p[1] - bounds.center[1], dz = p[2] - bounds.center[2];
+            float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+            inside = inside && distance <= bounds.radius;
+            farthest = distance > farthest ? distance : farthest;
+        }
+        // Ritter's sphere is touched by at least one vertex
+        tight = tight && bounds.radius <= farthest * 1.0001f;
+    }
+    ZW_CHECK(inside);
+    ZW_CHECK(tight);
+}
+
+ZW_TEST(ConeCullingNeverDropsAFrontFacingTriangle)
+{
+    const Mesh mesh = MakeSphere(40);
+    MeshletData data = Build(mesh, DefaultMeshletVertices, DefaultMeshletPrimitives);
+    std::vector<uint32_t> visible(data.meshlets.size());
+
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    uint64_t coneCulled = 0, tested = 0, frontFacesDropped = 0;
+    for (int camera = 0; camera < 100; ++camera)
+    {
+        // outside the sphere at 1.5 to 5 radii, looking somewhere near the middle
+        float eye[3], length;
+        do
+        {
+            eye[0] = unit(random);
+            eye[1] = unit(random);
+            eye[2] = unit(random);
+            length = sqrtf(eye[0] * eye[0] + eye[1] * eye[1] + eye[2] * eye[2]);
+        } while (length < 0.1f || length > 1.0f);
+        const float distance = 1.5f + 3.5f * (camera % 8) / 7.0f;
+        for (int k = 0; k < 3; ++k)
+        {
+            eye[k] *= distance / length;
+        }
+        const float target[3] = { 0.2f * unit(random), 0.2f * unit(random), 0.2f * unit(random) };
+        const Frustum frustum = LookAt(eye, target);
+
+        MeshletCullStats stats;
+        uint32_t visibleCount = CullMeshlets(data.bounds.data(), (uint32_t)data.bounds.size(), frustum, eye, visible.data(), &stats);
+        ZW_CHECK_EQUAL(visibleCount + stats.frustumCulled + stats.coneCulled, (uint32_t)data.meshlets.size());
+        coneCulled += stats.coneCulled;
+        tested += data.meshlets.size();
+
+        // every meshlet left out that isn't outside the frustum has only triangles facing away
+        std::vector<bool> drawn(data.meshlets.size(), false);
+        for (uint32_t i = 0; i < visibleCount; ++i)
+        {
+            drawn[visible[i]] = true;
+        }
+        for (size_t m = 0; m < data.meshlets.size(); ++m)
+        {
+            const MeshletBounds& bounds = data.bounds[m];
+            bool outside = false;
+            for (int p = 0; p < 6; ++p)
+            {
+                const float* plane = frustum.planes[p];
+                outside = outside || plane[0] * bounds.center[0] + plane[1] * bounds.center[1] + plane[2] * bounds.center[2] + plane[3] <
+                    -bounds.radius;
+            }
+            if (drawn[m] || outside)
+            {
+                continue;
+            }
+            const Meshlet& meshlet = data.meshlets[m];
+            for (uint32_t t = 0; t < meshlet.primitiveCount; ++t)
+            {
+                const uint8_t* triangle = &data.primitives[(meshlet.primitiveOffset + t) * 3];
+                const float* p0 = Position(mesh, data.vertices[meshlet.vertexOffset + triangle[0]]);
+                double n[3];
+                TriangleNormal(p0, Position(mesh, data.vertices[meshlet.vertexOffset + triangle[1]]),
+                    Position(mesh, data.vertices[meshlet.vertexOffset + triangle[2]]), n);
+                double facing = (eye[0] - p0[0]) * n[0] + (eye[1] - p0[1]) * n[1] + (eye[2] - p0[2]) * n[2];
+                frontFacesDropped += facing > 1e-9 ? 1 : 0;
+            }
+        }
+    }
+    ZW_CHECK_EQUAL(frontFacesDropped, 0ull);
+
+    // about half a convex mesh faces away, a good part of that is whole meshlets
+    ZW_CHECK(coneCulled * 5 > tested);
+}
+
+ZW_TEST(MeshletsBehindTheCameraAreFrustumCulled)
+{
+    // small meshlets, with cones narrow enough to cull the far side
+    const Mesh mesh = MakeSphere(20);
+    MeshletData data = Build(mesh, DefaultMeshletVertices, 8);
+    std::vector<uint32_t> visible(data.meshlets.size());
+
+    // looking away from the sphere, then at it
+    const float eye[3] = { 0.0f, 0.0f, -3.0f };
+    const float away[3] = { 0.0f, 0.0f, -10.0f };
+    MeshletCullStats stats;
+    ZW_CHECK_EQUAL(CullMeshlets(data.bounds.data(), (uint32_t)data.bounds.size(), LookAt(eye, away), eye, visible.data(), &stats), 0u);
+    ZW_CHECK_EQUAL(stats.frustumCulled, (uint32_t)data.meshlets.size());
+
+    const float center[3] = { 0.0f, 0.0f, 0.0f };
+    uint32_t visibleCount = CullMeshlets(data.bounds.data(), (uint32_t)data.bounds.size(), LookAt(eye, center), eye, visible.data(), nullptr);
+    ZW_CHECK(visibleCount > 0 && visibleCount < data.meshlets.size());
+    bool inOrder = true;
+    for (uint32_t i = 1; i < visibleCount; ++i)
+    {
+        inOrder = inOrder && visible[i] > visible[i - 1];
+    }
+    ZW_CHECK(inOrder);
+}
+
+ZW_TEST(TrianglesPastTheVertexCountAreDropped)
+{
+    const float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f };
+    const uint32_t indices[] = { 0, 2, 1, 1, 2, 7, 1, 2, 3 };
+    MeshletData data;
+    BuildMeshlets(indices, 9, positions, 3 * sizeof(float), 4, DefaultMeshletVertices, DefaultMeshletPrimitives, &data);
+    ZW_CHECK_EQUAL(data.meshlets.size(), (size_t)1);
+    ZW_CHECK_EQUAL(data.primitives.size(), (size_t)6);
+    ZW_CHECK_EQUAL(data.vertices.size(), (size_t)4);
+
+    // a flat quad: every normal is the same, so the cone is as narrow as it gets
+    ZW_CHECK_NEAR(data.bounds[0].coneCutoff, 0.0f, 1e-3f);
+
+    BuildMeshlets(nullptr, 0, nullptr, 12, 0, DefaultMeshletVertices, DefaultMeshletPrimitives, &data);
+    ZW_CHECK(data.meshlets.empty() && data.bounds.empty() && data.vertices.empty() && data.primitives.empty());
+}
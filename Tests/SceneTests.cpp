@@ -0,0 +1,528 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include "NullRenderBackend.h"
+#include "Scene.h"
+#include "SoftwareRenderBackend.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+// the scene's frame loop on the null backend, checked through the commands it records
+
+namespace
+{
+    const int TestWidth = 320;
+    const int TestHeight = 240;
+
+    SceneSettings MakeSettings(bool instanced, bool quantized, uint32_t gridCubeCount)
+    {
+        SceneSettings settings;
+        settings.gridCubeCount = gridCubeCount;
+        settings.instanced = instanced;
+        settings.descriptorTables = false;
+        settings.meshletPrimitives = 0;
+        settings.quantizedVertices = quantized;
+        settings.meshPath = nullptr;
+        settings.texturePath = nullptr;
+        return settings;
+    }
+
+    // one frame the way the main loop runs it
+    bool RunFrame(NullRenderBackend* backend)
+    {
+        SimulateScene(1.0f / 120.0f);
+        return backend->BeginFrame() && UpdateScene(backend, 1.0f) && RecordScene(backend) && backend->EndFrame();
+    }
+
+    std::vector<RenderCommand> FindCommands(const std::vector<RenderCommand>& commands, RenderCommandType type)
+    {
+        std::vector<RenderCommand> found;
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            if (commands[i].type == type)
+            {
+                found.push_back(commands[i]);
+            }
+        }
+        return found;
+    }
+
+    // the transposed wvp matrix "wvp" maps the local origin into the view volume
+    bool OriginIsVisible(const float* wvp)
+    {
+        // transposed, so the clip position of (0, 0, 0, 1) is the last column
+        float x = wvp[3], y = wvp[7], z = wvp[11], w = wvp[15];
+        return w > 0.0f && x >= -w && x <= w && y >= -w && y <= w && z >= 0.0f && z <= w;
+    }
+
+    void Put(std::vector<uint8_t>* bytes, uint32_t value)
+    {
+        const uint8_t* p = (const uint8_t*)&value;
+        bytes->insert(bytes->end(), p, p + 4);
+    }
+
+    // a DX10 dds of "arraySize" rgba8 "size" x "size" mip chains, the data is a pattern
+    std::vector<uint8_t> MakeDds(uint32_t size, uint32_t mipCount, uint32_t arraySize)
+    {
+        std::vector<uint8_t> bytes;
+        const uint32_t header[] = { 0x20534444, 124, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000, size, size, 0, 0, mipCount };
+        for (uint32_t value : header)
+        {
+            Put(&bytes, value);
+        }
+        for (int i = 0; i < 11; ++i)
+        {
+            Put(&bytes, 0);
+        }
+        const uint32_t pixelFormat[] = { 32, 0x4, 'D' | ('X' << 8) | ('1' << 16) | ('0' << 24), 0, 0, 0, 0, 0, 0x1000, 0, 0, 0, 0 };
+        for (uint32_t value : pixelFormat)
+        {
+            Put(&bytes, value);
+        }
+        const uint32_t dx10[] = { 28, 3, 0, arraySize, 0 }; // rgba8 unorm, texture 2d
+        for (uint32_t value : dx10)
+        {
+            Put(&bytes, value);
+        }
+
+        uint64_t sliceSize = 0;
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            sliceSize += (uint64_t)(size >> mip) * (size >> mip) * 4;
+        }
+        for (uint64_t i = 0; i < sliceSize * arraySize; ++i)
+        {
+            bytes.push_back((uint8_t)(i * 7 + (i >> 8)));
+        }
+        return bytes;
+    }
+}
+
+ZW_TEST(FramesHaveTheRecordedShape)
+{
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, MakeSettings(true, true, 0)));
+    backend.ClearCommands();
+
+    const uint32_t frameCount = 10;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        const int backBufferIndex = backend.GetFrameIndex();
+        ZW_CHECK(RunFrame(&backend));
+
+        const std::vector<RenderCommand>& commands = backend.GetCommands();
+        ZW_CHECK(commands.size() > 4);
+        if (commands.size() <= 4)
+        {
+            return;
+        }
+
+        // present -> render target, clears ... render target -> present, present
+        const RenderCommand& open = commands.front();
+        ZW_CHECK(open.type == RenderCommandType::ResourceBarrier);
+        ZW_CHECK_EQUAL(open.barrier.resource, backend.GetBackBuffer(backBufferIndex));
+        ZW_CHECK(open.barrier.before == ResourceState::Present && open.barrier.after == ResourceState::RenderTarget);
+        ZW_CHECK(commands[1].type == RenderCommandType::ClearRenderTarget);
+        ZW_CHECK(commands[2].type == RenderCommandType::ClearDepth);
+
+        const RenderCommand& close = commands[commands.size() - 2];
+        ZW_CHECK(close.type == RenderCommandType::ResourceBarrier);
+        ZW_CHECK(close.barrier.before == ResourceState::RenderTarget && close.barrier.after == ResourceState::Present);
+        ZW_CHECK(commands.back().type == RenderCommandType::Present);
+        ZW_CHECK_EQUAL(commands.back().backBufferIndex, backBufferIndex);
+
+        backend.ClearCommands();
+    }
+
+    ZW_CHECK_EQUAL(backend.GetSubmittedFrameCount(), frameCount);
+    backend.Shutdown();
+}
+
+ZW_TEST(InstancedFrameDrawsBothCubesFromOneBuffer)
+{
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, MakeSettings(true, true, 0)));
+    backend.ClearCommands();
+    ZW_CHECK(RunFrame(&backend));
+
+    // one draw per submesh covering both cubes, the cube is small enough for one submesh
+    const std::vector<RenderCommand>& commands = backend.GetCommands();
+    std::vector<RenderCommand> draws = FindCommands(commands, RenderCommandType::DrawIndexedInstanced);
+    ZW_CHECK_EQUAL(draws.size(), 1u);
+    if (draws.empty())
+    {
+        return;
+    }
+    ZW_CHECK_EQUAL(draws[0].draw.instanceCount, 2u);
+    ZW_CHECK_EQUAL(draws[0].draw.indexCountPerInstance, 36u);
+
+    // the matrices sit in the upload memory the srv points at, both cubes are in front of the camera
+    std::vector<RenderCommand> srvs = FindCommands(commands, RenderCommandType::SetGraphicsRootShaderResourceView);
+    ZW_CHECK_EQUAL(srvs.size(), 1u);
+    if (srvs.empty())
+    {
+        return;
+    }
+    const float* matrices = (const float*)backend.GetGpuAddressData(srvs[0].rootShaderResourceView.bufferLocation, 2 * 16 * sizeof(float));
+    ZW_CHECK(matrices != nullptr);
+    if (matrices)
+    {
+        ZW_CHECK(OriginIsVisible(matrices));
+        ZW_CHECK(OriginIsVisible(matrices + 16));
+    }
+    backend.Shutdown();
+}
+
+ZW_TEST(PerDrawFrameBindsOneConstantBufferPerCube)
+{
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, MakeSettings(false, false, 0)));
+    backend.ClearCommands();
+    ZW_CHECK(RunFrame(&backend));
+
+    const std::vector<RenderCommand>& commands = backend.GetCommands();
+    std::vector<RenderCommand> draws = FindCommands(commands, RenderCommandType::DrawIndexedInstanced);
+    std::vector<RenderCommand> cbvs = FindCommands(commands, RenderCommandType::SetGraphicsRootConstantBufferView);
+    ZW_CHECK_EQUAL(draws.size(), 2u);
+    ZW_CHECK_EQUAL(cbvs.size(), 2u);
+    for (size_t i = 0; i < draws.size(); ++i)
+    {
+        ZW_CHECK_EQUAL(draws[i].draw.instanceCount, 1u);
+    }
+    for (size_t i = 0; i < cbvs.size(); ++i)
+    {
+        GpuAddress address = cbvs[i].rootConstantBufferView.bufferLocation;
+        ZW_CHECK_EQUAL(address % ConstantBufferAlignment, 0u);
+        const float* wvp = (const float*)backend.GetGpuAddressData(address, 16 * sizeof(float));
+        ZW_CHECK(wvp != nullptr);
+        if (wvp)
+        {
+            ZW_CHECK(OriginIsVisible(wvp));
+        }
+    }
+    if (cbvs.size() == 2)
+    {
+        ZW_CHECK(cbvs[0].rootConstantBufferView.bufferLocation != cbvs[1].rootConstantBufferView.bufferLocation);
+    }
+    backend.Shutdown();
+}
+
+ZW_TEST(DescriptorTableFrameBindsOneTransientCbvPerCube)
+{
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+    SceneSettings settings = MakeSettings(false, false, 100);
+    settings.descriptorTables = true;
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, settings));
+    backend.ClearCommands();
+
+    // a few frames, so every frame context's range is used and rewound
+    for (uint32_t frame = 0; frame < 2 * frameBufferCount; ++frame)
+    {
+        ZW_CHECK(RunFrame(&backend));
+        const std::vector<RenderCommand>& commands = backend.GetCommands();
+        std::vector<RenderCommand> draws = FindCommands(commands, RenderCommandType::DrawIndexedInstanced);
+        std::vector<RenderCommand> tables = FindCommands(commands, RenderCommandType::SetGraphicsRootDescriptorTable);
+        ZW_CHECK(FindCommands(commands, RenderCommandType::SetGraphicsRootConstantBufferView).empty());
+        ZW_CHECK(draws.size() >= 2);
+        ZW_CHECK_EQUAL(tables.size(), draws.size());
+
+        // consecutive transient slots, each a 256 byte cbv of a visible cube's wvp matrix
+        uint32_t originsVisible = 0;
+        const DescriptorStats stats = backend.GetDescriptorAllocator().GetStats();
+        ZW_CHECK_EQUAL(stats.transientUsed, (uint32_t)tables.size());
+        for (size_t i = 0; i < tables.size(); ++i)
+        {
+            DescriptorIndex index = tables[i].rootDescriptorTable.firstDescriptor;
+            ZW_CHECK_EQUAL(tables[i].rootDescriptorTable.rootParameterIndex, 0u);
+            ZW_CHECK_EQUAL(index, tables[0].rootDescriptorTable.firstDescriptor + i);
+            ZW_CHECK(index >= stats.persistentCapacity && index < stats.capacity);
+
+            const NullDescriptor* descriptor = backend.GetDescriptor(index);
+            ZW_CHECK(descriptor != nullptr);
+            if (!descriptor)
+            {
+                continue;
+            }
+            ZW_CHECK_EQUAL(descriptor->size, 256u);
+            const float* wvp = (const float*)backend.GetGpuAddressData(descriptor->bufferLocation, 16 * sizeof(float));
+            ZW_CHECK(wvp != nullptr);
+            originsVisible += wvp && OriginIsVisible(wvp) ? 1 : 0;
+        }
+        ZW_CHECK(originsVisible >= 2); // at least the two big cubes
+        backend.ClearCommands();
+    }
+    ZW_CHECK_EQUAL(backend.GetDescriptorAllocator().GetStats().failedAllocations, 0u);
+    backend.Shutdown();
+}
+
+ZW_TEST(GeometryIsUploadedBeforeTheFirstFrameRuns)
+{
+    NullRenderBackend backend;
+    JobSystem jobs(1);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, MakeSettings(true, true, 0)));
+    backend.ClearCommands();
+    ZW_CHECK(RunFrame(&backend));
+
+    const std::vector<RenderCommand>& commands = backend.GetCommands();
+    std::vector<RenderCommand> vertexViews = FindCommands(commands, RenderCommandType::SetVertexBuffer);
+    std::vector<RenderCommand> indexViews = FindCommands(commands, RenderCommandType::SetIndexBuffer);
+    ZW_CHECK(!vertexViews.empty() && !indexViews.empty());
+    if (vertexViews.empty() || indexViews.empty())
+    {
+        return;
+    }
+
+    // 24 quantized vertices, 36 16 bit indices that all point at one of them
+    const VertexBufferView& vertexView = vertexViews[0].vertexBufferView;
+    const IndexBufferView& indexView = indexViews[0].indexBufferView;
+    ZW_CHECK_EQUAL(vertexView.strideInBytes, 12u);
+    ZW_CHECK_EQUAL(vertexView.sizeInBytes, 24u * 12u);
+    ZW_CHECK(indexView.format == IndexFormat::UInt16);
+    ZW_CHECK_EQUAL(indexView.sizeInBytes, 36u * 2u);
+    ZW_CHECK(backend.GetGpuAddressData(vertexView.bufferLocation, vertexView.sizeInBytes) != nullptr);
+
+    const uint16_t* indices = (const uint16_t*)backend.GetGpuAddressData(indexView.bufferLocation, indexView.sizeInBytes);
+    ZW_CHECK(indices != nullptr);
+    if (indices)
+    {
+        bool inRange = true, anyNonZero = false;
+        for (uint32_t i = 0; i < 36; ++i)
+        {
+            inRange = inRange && indices[i] < 24;
+            anyNonZero = anyNonZero || indices[i] != 0;
+        }
+        ZW_CHECK(inRange && anyNonZero);
+    }
+    backend.Shutdown();
+}
+
+ZW_TEST(GridCubesOutsideTheFrustumAreCulled)
+{
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+
+    // 100 x 100 cubes 0.5 apart, the camera only sees part of the grid
+    const uint32_t gridCubeCount = 10000;
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, MakeSettings(true, true, gridCubeCount)));
+    backend.ClearCommands();
+    ZW_CHECK(RunFrame(&backend));
+
+    std::vector<RenderCommand> draws = FindCommands(backend.GetCommands(), RenderCommandType::DrawIndexedInstanced);
+    ZW_CHECK_EQUAL(draws.size(), 1u);
+    if (!draws.empty())
+    {
+        ZW_CHECK(draws[0].draw.instanceCount >= 2);
+        ZW_CHECK(draws[0].draw.instanceCount < gridCubeCount + 2);
+    }
+    backend.Shutdown();
+}
+
+ZW_TEST(ParallelListsRecordContiguousSlicesOfTheDraws)
+{
+    // not instanced every visible cube is a draw, split over one list per recording thread. the null
+    // backend appends the lists in order: the frame start, every parallel list (each opening with its
+    // render target), then the list the frame resumes on
+    const uint32_t threadCounts[] = { 2, 3, 4, 8 };
+    for (uint32_t threadCount : threadCounts)
+    {
+        NullRenderBackend backend;
+        JobSystem jobs(threadCount);
+        ZW_CHECK(backend.Init(TestWidth, TestHeight));
+        ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, MakeSettings(false, true, 400)));
+        backend.ClearCommands();
+        ZW_CHECK(RunFrame(&backend));
+
+        // the frame's constant buffers are one per visible cube, in draw order
+        const uint32_t visibleCount = (uint32_t)(GetSceneUploadStats().frameBytes / ConstantBufferAlignment);
+        const uint32_t listCount = std::min(std::min(jobs.GetThreadCount(), MaxParallelCommandLists), visibleCount);
+        ZW_CHECK(visibleCount > 8);
+
+        const std::vector<RenderCommand>& commands = backend.GetCommands();
+        std::vector<size_t> listStarts;
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            if (commands[i].type == RenderCommandType::SetRenderTarget)
+            {
+                listStarts.push_back(i);
+            }
+        }
+        ZW_CHECK_EQUAL(listStarts.size(), (size_t)listCount);
+        if (listStarts.size() != listCount)
+        {
+            backend.Shutdown();
+            continue;
+        }
+
+        GpuAddress firstBuffer = 0;
+        uint32_t nextDraw = 0;
+        size_t drawsEnd = 0;
+        for (uint32_t list = 0; list < listCount; ++list)
+        {
+            // each list sets up everything its draws need, it doesn't inherit state from another list
+            const RenderCommandType setup[] = { RenderCommandType::SetRenderTarget, RenderCommandType::SetPipeline,
+                RenderCommandType::SetViewport, RenderCommandType::SetScissorRect, RenderCommandType::SetPrimitiveTopology,
+                RenderCommandType::SetVertexBuffer, RenderCommandType::SetIndexBuffer };
+            const size_t setupCount = sizeof(setup) / sizeof(setup[0]);
+            const size_t start = listStarts[list];
+            bool setUp = start + setupCount <= commands.size();
+            for (size_t i = 0; setUp && i < setupCount; ++i)
+            {
+                setUp = commands[start + i].type == setup[i];
+            }
+            ZW_CHECK(setUp);
+
+            // then a cbv and a draw per cube, the cubes of the slice in order and right after the last list's
+            const uint32_t sliceSize = visibleCount * (list + 1) / listCount - visibleCount * list / listCount;
+            const size_t end = list + 1 < listCount ? listStarts[list + 1] : commands.size();
+            uint32_t draws = 0;
+            bool inOrder = true;
+            for (drawsEnd = start + setupCount; drawsEnd < end; ++drawsEnd)
+            {
+                const size_t i = drawsEnd;
+                if (commands[i].type == RenderCommandType::SetGraphicsRootConstantBufferView)
+                {
+                    GpuAddress address = commands[i].rootConstantBufferView.bufferLocation;
+                    if (nextDraw == 0)
+                    {
+                        firstBuffer = address;
+                    }
+                    inOrder = inOrder && address == firstBuffer + (uint64_t)nextDraw * ConstantBufferAlignment;
+                    inOrder = inOrder && i + 1 < end && commands[i + 1].type == RenderCommandType::DrawIndexedInstanced;
+                    ++nextDraw;
+                    ++draws;
+                }
+                else if (commands[i].type != RenderCommandType::DrawIndexedInstanced)
+                {
+                    break;
+                }
+            }
+            ZW_CHECK(inOrder);
+            ZW_CHECK_EQUAL(draws, sliceSize);
+        }
+
+        // all slices together are every visible cube once. the frame started before the first list and
+        // ends on the resume list after the last one: the barrier back to present, then present
+        ZW_CHECK_EQUAL(nextDraw, visibleCount);
+        ZW_CHECK_EQUAL(drawsEnd + 2, commands.size());
+        if (drawsEnd + 2 == commands.size())
+        {
+            const RenderCommand& close = commands[drawsEnd];
+            ZW_CHECK(close.type == RenderCommandType::ResourceBarrier && close.barrier.after == ResourceState::Present);
+            ZW_CHECK(commands.back().type == RenderCommandType::Present);
+        }
+        ZW_CHECK(listStarts.front() > 2 && commands[listStarts.front() - 1].type == RenderCommandType::ClearDepth);
+        backend.Shutdown();
+    }
+}
+
+ZW_TEST(MeshletCullingOnlySkipsTrianglesThatWouldNotBeDrawn)
+{
+    JobSystem jobs(2);
+
+    // the same frame on the software backend, drawn whole and by meshlets of two triangles (a face)
+    std::vector<uint8_t> images[2];
+    uint32_t drawnIndices[2] = { 0, 0 };
+    SceneMeshletStats stats = {};
+    for (int meshlets = 0; meshlets < 2; ++meshlets)
+    {
+        SoftwareRenderBackend backend(&jobs);
+        ZW_CHECK(backend.Init(TestWidth, TestHeight));
+        SceneSettings settings = MakeSettings(false, true, 16);
+        settings.meshletPrimitives = meshlets ? 2 : 0;
+        ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, settings));
+        backend.ClearCommands();
+        const int backBufferIndex = backend.GetFrameIndex();
+        ZW_CHECK(RunFrame(&backend));
+
+        std::vector<RenderCommand> draws = FindCommands(backend.GetCommands(), RenderCommandType::DrawIndexedInstanced);
+        for (size_t i = 0; i < draws.size(); ++i)
+        {
+            drawnIndices[meshlets] += draws[i].draw.indexCountPerInstance;
+        }
+        const uint8_t* pixels = backend.GetResourceData(backend.GetBackBuffer(backBufferIndex));
+        images[meshlets].assign(pixels, pixels + TestWidth * TestHeight * 4);
+        stats = GetSceneMeshletStats();
+        backend.Shutdown();
+    }
+
+    // six faces per cube, every cube shows at most three of them
+    ZW_CHECK_EQUAL(stats.meshletCount, 6u);
+    ZW_CHECK_EQUAL(stats.testedMeshlets * 6, drawnIndices[0]);
+    ZW_CHECK(stats.coneCulled >= stats.testedMeshlets / 6);
+    ZW_CHECK_EQUAL(drawnIndices[1], drawnIndices[0] - (stats.frustumCulled + stats.coneCulled) * 6);
+
+    // the culled triangles were back faces or off screen, the picture doesn't change
+    ZW_CHECK(images[0] == images[1]);
+}
+
+ZW_TEST(TextureStreamsInAndEveryMipIsUploaded)
+{
+    const char* path = "SceneTests.dds";
+    std::vector<uint8_t> file = MakeDds(64, 7, 2);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write((const char*)file.data(), (std::streamsize)file.size());
+    }
+
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(TestWidth, TestHeight));
+    SceneSettings settings = MakeSettings(true, true, 0);
+    settings.texturePath = path;
+    ZW_CHECK(InitScene(&backend, &jobs, TestWidth, TestHeight, settings));
+    ZW_CHECK_EQUAL(GetSceneTextureStats().mipCount, 7u);
+
+    // frames keep running while the mips stream in, each one uploads what arrived since the last
+    uint32_t frames = 0;
+    uint32_t lastUploadedMip = 7;
+    bool smallestFirst = true;
+    while (GetSceneTextureStats().uploadedMip > 0 && frames < 10000)
+    {
+        ZW_CHECK(RunFrame(&backend));
+        SceneTextureStats stats = GetSceneTextureStats();
+        smallestFirst = smallestFirst && stats.uploadedMip <= lastUploadedMip && stats.residentMip <= stats.uploadedMip;
+        lastUploadedMip = stats.uploadedMip;
+        backend.ClearCommands();
+        ++frames;
+        std::this_thread::yield();
+    }
+    ZW_CHECK(smallestFirst);
+
+    // the copies of the last uploads went out with that frame
+    SceneTextureStats stats = GetSceneTextureStats();
+    ZW_CHECK_EQUAL(stats.uploadedMip, 0u);
+    ZW_CHECK_EQUAL(stats.uploadedBytes, (uint64_t)file.size() - 148);
+    ZW_CHECK(stats.uploadCount >= 2 && stats.uploadCount <= 14);
+    uint64_t offset = 148;
+    for (uint32_t slice = 0; slice < 2; ++slice)
+    {
+        for (uint32_t mip = 0; mip < 7; ++mip)
+        {
+            const uint32_t size = 64 >> mip;
+            const uint8_t* data = backend.GetTextureSubresourceData(stats.texture, mip + slice * 7);
+            ZW_CHECK(data != nullptr);
+            if (data)
+            {
+                ZW_CHECK(memcmp(data, file.data() + offset, (size_t)size * size * 4) == 0);
+            }
+            offset += (uint64_t)size * size * 4;
+        }
+    }
+
+    ShutdownScene();
+    backend.Shutdown();
+    remove(path);
+}
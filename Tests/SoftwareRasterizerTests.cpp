@@ -0,0 +1,277 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    const float ClearColor[4] = { 0.0f, 0.2f, 0.4f, 1.0f };
+
+    struct Vertex
+    {
+        float position[3];
+        float color[4];
+    };
+
+    struct Mesh
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // transposed like the shaders read them, clip = (x, y, z * a + b, z) for a near plane at 0.5
+    // and a far plane at 10
+    const float Perspective[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 10.0f / 9.5f, -5.0f / 9.5f, 0.0f, 0.0f, 1.0f, 0.0f };
+    const float Identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+    // xorshift32, unlike the std distributions it gives the same numbers with every standard library,
+    // which the golden checksum depends on
+    struct Random
+    {
+        uint32_t state;
+
+        float Next(float low, float high)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return low + (high - low) * (float)(state >> 8) / 16777216.0f;
+        }
+    };
+
+    // overlapping triangles of every size and both windings, some through the near plane and some
+    // off screen
+    Mesh RandomTriangles(uint32_t count, uint32_t seed)
+    {
+        Random random = { seed * 2654435761u + 1 };
+        Mesh mesh;
+        for (uint32_t t = 0; t < count; ++t)
+        {
+            float cx = random.Next(-3.0f, 3.0f), cy = random.Next(-3.0f, 3.0f), size = t % 10 == 0 ? 3.0f : 0.3f;
+            for (int k = 0; k < 3; ++k)
+            {
+                float x = cx + random.Next(-1.0f, 1.0f) * size;
+                float y = cy + random.Next(-1.0f, 1.0f) * size;
+                float z = random.Next(0.2f, 6.0f);
+                Vertex vertex = { { x, y, z }, { random.Next(0.0f, 1.0f), random.Next(0.0f, 1.0f), random.Next(0.0f, 1.0f), 1.0f } };
+                mesh.vertices.push_back(vertex);
+                mesh.indices.push_back((uint32_t)mesh.indices.size());
+            }
+        }
+        return mesh;
+    }
+
+    RasterDraw MakeDraw(const Mesh& mesh, const float* wvp, uint32_t width, uint32_t height)
+    {
+        RasterDraw draw;
+        draw.vertexLayout = VertexLayout::PositionColor;
+        draw.vertices = (const uint8_t*)mesh.vertices.data();
+        draw.vertexStride = sizeof(Vertex);
+        draw.vertexCount = (uint32_t)mesh.vertices.size();
+        draw.indices = mesh.indices.data();
+        draw.indexFormat = IndexFormat::UInt32;
+        draw.indexCount = (uint32_t)mesh.indices.size();
+        draw.baseVertex = 0;
+        draw.instanceCount = 1;
+        draw.wvp = wvp;
+        draw.wvpStride = 0;
+        draw.viewport = { 0.0f, 0.0f, (float)width, (float)height, 0.0f, 1.0f };
+        draw.scissor = { 0, 0, (int32_t)width, (int32_t)height };
+        return draw;
+    }
+
+    struct Image
+    {
+        std::vector<uint8_t> color;
+        std::vector<float> depth;
+    };
+
+    // "mesh" drawn on a cleared target, through "jobs" (null for single threaded) with the kernel of "level"
+    Image Render(const Mesh& mesh, const float* wvp, uint32_t width, uint32_t height, JobSystem* jobs, SimdLevel level)
+    {
+        SoftwareRasterizer rasterizer;
+        rasterizer.Init(jobs, width, height);
+        rasterizer.SetSimdLevel(level);
+        Image image;
+        image.color.resize((size_t)width * height * 4);
+        rasterizer.SetColorTarget(image.color.data());
+        rasterizer.ClearColor(ClearColor);
+        rasterizer.ClearDepth(1.0f);
+        rasterizer.Draw(MakeDraw(mesh, wvp, width, height));
+        rasterizer.Flush();
+        image.depth.assign(rasterizer.GetDepthBuffer(), rasterizer.GetDepthBuffer() + (size_t)width * height);
+        return image;
+    }
+
+    bool Identical(const Image& a, const Image& b)
+    {
+        return a.color == b.color && a.depth.size() == b.depth.size() &&
+            memcmp(a.depth.data(), b.depth.data(), a.depth.size() * sizeof(float)) == 0;
+    }
+
+    // a point at pixel coordinates (x, y) of a width x height target, in clip space at depth 0.5
+    Vertex PixelVertex(float x, float y, uint32_t width, uint32_t height)
+    {
+        Vertex vertex = { { x / width * 2.0f - 1.0f, 1.0f - y / height * 2.0f, 0.5f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+        return vertex;
+    }
+
+    // how often every pixel is covered by the triangles of "fan" (center, then the rim) drawn one at a
+    // time, and false if a triangle covered nothing
+    bool CountCoverage(const std::vector<float>& rim, float centerX, float centerY, uint32_t width, uint32_t height,
+        std::vector<uint32_t>* coverage)
+    {
+        coverage->assign((size_t)width * height, 0);
+        const uint32_t rimCount = (uint32_t)rim.size() / 2;
+        bool everyTriangleDrawn = true;
+        for (uint32_t i = 0; i < rimCount; ++i)
+        {
+            Mesh triangle;
+            triangle.vertices.push_back(PixelVertex(centerX, centerY, width, height));
+            triangle.vertices.push_back(PixelVertex(rim[i * 2], rim[i * 2 + 1], width, height));
+            triangle.vertices.push_back(PixelVertex(rim[(i + 1) % rimCount * 2], rim[(i + 1) % rimCount * 2 + 1], width, height));
+            triangle.indices = { 0, 1, 2 };
+            Image image = Render(triangle, Identity, width, height, nullptr, GetSimdLevel());
+            uint32_t covered = 0;
+            for (size_t p = 0; p < image.depth.size(); ++p)
+            {
+                if (image.depth[p] < 1.0f)
+                {
+                    ++(*coverage)[p];
+                    ++covered;
+                }
+            }
+            everyTriangleDrawn = everyTriangleDrawn && covered > 0;
+        }
+        return everyTriangleDrawn;
+    }
+
+    // the pixel center (x + 0.5, y + 0.5) is inside the convex "rim" (clockwise on screen) by more
+    // than "margin" pixels
+    bool InsideRim(const std::vector<float>& rim, uint32_t x, uint32_t y, float margin)
+    {
+        const uint32_t rimCount = (uint32_t)rim.size() / 2;
+        for (uint32_t i = 0; i < rimCount; ++i)
+        {
+            float ax = rim[i * 2], ay = rim[i * 2 + 1];
+            float bx = rim[(i + 1) % rimCount * 2], by = rim[(i + 1) % rimCount * 2 + 1];
+            float ex = bx - ax, ey = by - ay;
+            float cross = ex * (y + 0.5f - ay) - ey * (x + 0.5f - ax);
+            if (cross < margin * sqrtf(ex * ex + ey * ey))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t Fnv1a(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+ZW_TEST(EverySimdLevelDrawsTheSamePixels)
+{
+    // odd target size, so the last tiles are partial and the 4 wide kernels have row tails
+    const uint32_t width = 203, height = 157;
+    Mesh mesh = RandomTriangles(2000, 1);
+    Image reference = Render(mesh, Perspective, width, height, nullptr, SimdLevel::Scalar);
+    for (SimdLevel level : Levels)
+    {
+        ZW_CHECK(Identical(Render(mesh, Perspective, width, height, nullptr, level), reference));
+    }
+
+    // something was drawn, and something was depth tested away
+    size_t drawn = 0;
+    for (size_t p = 0; p < reference.depth.size(); ++p)
+    {
+        drawn += reference.depth[p] < 1.0f ? 1 : 0;
+    }
+    ZW_CHECK(drawn > reference.depth.size() / 2);
+}
+
+ZW_TEST(TheThreadCountDoesNotChangeThePixels)
+{
+    const uint32_t width = 331, height = 250;
+    Mesh mesh = RandomTriangles(3000, 2);
+    Image single = Render(mesh, Perspective, width, height, nullptr, GetSimdLevel());
+    JobSystem one(1), four(4);
+    ZW_CHECK(Identical(Render(mesh, Perspective, width, height, &one, GetSimdLevel()), single));
+    ZW_CHECK(Identical(Render(mesh, Perspective, width, height, &four, GetSimdLevel()), single));
+    ZW_CHECK(Identical(Render(mesh, Perspective, width, height, &four, SimdLevel::Scalar), single));
+}
+
+ZW_TEST(TrianglesOfAFanCoverEveryPixelExactlyOnce)
+{
+    // a fan centered on a tile corner, its edges running exactly through rows, columns and
+    // diagonals of pixel centers, then one with its rim on random 1/16 pixel positions
+    const uint32_t width = 160, height = 128;
+    std::vector<float> aligned;
+    const float rimOffsets[][2] = { { 40.5f, 0.0f }, { 40.5f, 40.5f }, { 0.0f, 50.5f }, { -30.5f, 30.5f }, { -50.5f, 0.0f },
+        { -30.5f, -30.5f }, { 0.0f, -50.5f }, { 40.5f, -40.5f } };
+    for (const float* offset : rimOffsets)
+    {
+        aligned.push_back(64.5f + offset[0]);
+        aligned.push_back(64.5f + offset[1]);
+    }
+
+    Random random = { 3 };
+    std::vector<float> subpixel;
+    const uint32_t rimCount = 13;
+    for (uint32_t i = 0; i < rimCount; ++i)
+    {
+        // increasing angles with y pointing down go clockwise on screen
+        float angle = 6.2831853f * i / rimCount;
+        float r = random.Next(30.0f, 55.0f);
+        subpixel.push_back(floorf((80.0f + cosf(angle) * r) * 16.0f) / 16.0f);
+        subpixel.push_back(floorf((64.0f + sinf(angle) * r) * 16.0f) / 16.0f);
+    }
+
+    const std::vector<float>* rims[] = { &aligned, &subpixel };
+    const float centers[][2] = { { 64.5f, 64.5f }, { 80.0f + 3.0f / 16.0f, 64.0f - 5.0f / 16.0f } };
+    for (int f = 0; f < 2; ++f)
+    {
+        std::vector<uint32_t> coverage;
+        ZW_CHECK(CountCoverage(*rims[f], centers[f][0], centers[f][1], width, height, &coverage));
+
+        // nothing twice, and no holes inside the rim (right on the rim the fill rule decides)
+        bool twice = false, holes = false;
+        uint32_t covered = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint32_t count = coverage[y * width + x];
+                twice = twice || count > 1;
+                holes = holes || (count == 0 && InsideRim(*rims[f], x, y, 0.01f));
+                covered += count;
+            }
+        }
+        ZW_CHECK(!twice);
+        ZW_CHECK(!holes);
+        ZW_CHECK(covered > 1000);
+    }
+}
+
+ZW_TEST(AFixedSceneMatchesItsGoldenChecksum)
+{
+    // catches any change of the output, e.g. in the fill rule, the depth or the color rounding.
+    // when a change is meant to move pixels, check the picture and update the value
+    const uint32_t width = 128, height = 96;
+    Mesh mesh = RandomTriangles(300, 4);
+    Image image = Render(mesh, Perspective, width, height, nullptr, SimdLevel::Scalar);
+    const uint64_t checksum = Fnv1a(image.color.data(), image.color.size());
+    ZW_CHECK_EQUAL(checksum, 0xcd11b6e5b22bf1d0ull);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal test harness. Every test source is its own executable (see CMakeLists.txt): ZW_TEST
+// registers a function, the ZW_CHECK macros report a failure and let the test continue, and the
+// shared main in TestMain.cpp runs everything and returns non zero if anything failed.
+
+typedef void (*TestFunction)();
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, TestFunction function);
+};
+
+// counts a failed check of the running test
+void ReportTestFailure(const char* file, int line, const char* expression);
+
+#define ZW_TEST(name) \
+    static void name(); \
+    static TestRegistration name##Registration(#name, &name); \
+    static void name()
+
+#define ZW_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            ReportTestFailure(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#define ZW_CHECK_EQUAL(a, b) ZW_CHECK((a) == (b))
+
+#define ZW_CHECK_NEAR(a, b, tolerance) ZW_CHECK(std::fabs((double)(a) - (double)(b)) <= (double)(tolerance))
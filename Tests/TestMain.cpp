@@ -0,0 +1,48 @@
+#include "TestFramework.h"
+#include <vector>
+
+namespace
+{
+    struct RegisteredTest
+    {
+        const char* name;
+        TestFunction function;
+    };
+
+    // a function local static, the registrations run during static initialization in any order
+    std::vector<RegisteredTest>& GetTests()
+    {
+        static std::vector<RegisteredTest> tests;
+        return tests;
+    }
+
+    unsigned currentFailures = 0;
+}
+
+TestRegistration::TestRegistration(const char* name, TestFunction function)
+{
+    RegisteredTest test = { name, function };
+    GetTests().push_back(test);
+}
+
+void ReportTestFailure(const char* file, int line, const char* expression)
+{
+    fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+    ++currentFailures;
+}
+
+int main()
+{
+    unsigned failedTests = 0;
+    const std::vector<RegisteredTest>& tests = GetTests();
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        currentFailures = 0;
+        tests[i].function();
+        printf("%-48s %s\n", tests[i].name, currentFailures == 0 ? "ok" : "FAILED");
+        failedTests += currentFailures != 0 ? 1 : 0;
+    }
+
+    printf("%u of %u tests failed\n", failedTests, (unsigned)tests.size());
+    return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+#include "TestFramework.h"
+#include "ResourceHeapAllocator.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// the allocators only hand out offsets, so every test backs them with real bytes: each allocation
+// is filled with its own tag, and a range that overlaps another or got lost in a move shows up as
+// a wrong tag
+
+namespace
+{
+    struct Live
+    {
+        TlsfAllocation allocation;
+        uint64_t alignment;
+        uint8_t tag;
+    };
+
+    struct BackedHeap
+    {
+        TlsfAllocator allocator;
+        std::vector<uint8_t> memory;
+        std::vector<Live> live;
+        uint8_t nextTag;
+
+        BackedHeap(uint64_t size, uint64_t granularity) : memory((size_t)size, 0), nextTag(1)
+        {
+            allocator.Init(size, granularity);
+        }
+
+        bool Allocate(uint64_t size, uint64_t alignment)
+        {
+            Live entry;
+            if (!allocator.Allocate(size, alignment, &entry.allocation))
+            {
+                return false;
+            }
+            entry.alignment = alignment;
+            entry.tag = nextTag++;
+            nextTag = nextTag ? nextTag : 1;
+            memset(&memory[(size_t)entry.allocation.offset], entry.tag, (size_t)entry.allocation.size);
+            live.push_back(entry);
+            return true;
+        }
+
+        void Free(size_t index)
+        {
+            allocator.Free(live[index].allocation.handle);
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        // copy every planned move and free its source, the way a backend executes the plan. returns
+        // the number of moves
+        size_t Defragment(uint32_t maxMoves, bool* movesGoDown)
+        {
+            std::vector<TlsfMove> moves;
+            allocator.PlanDefragmentation(maxMoves, &moves);
+            for (size_t i = 0; i < moves.size(); ++i)
+            {
+                const TlsfMove& move = moves[i];
+                *movesGoDown = *movesGoDown && move.destination.offset < move.source.offset &&
+                    move.destination.size == move.source.size;
+                memcpy(&memory[(size_t)move.destination.offset], &memory[(size_t)move.source.offset], (size_t)move.source.size);
+                allocator.Free(move.source.handle);
+                for (size_t j = 0; j < live.size(); ++j)
+                {
+                    if (live[j].allocation.handle == move.source.handle)
+                    {
+                        live[j].allocation = move.destination;
+                        break;
+                    }
+                }
+            }
+            return moves.size();
+        }
+
+        // aligned, inside the range, not overlapping, still holding their tags, and the stats agree
+        bool IsValid() const
+        {
+            std::vector<Live> sorted = live;
+            std::sort(sorted.begin(), sorted.end(), [](const Live& a, const Live& b) { return a.allocation.offset < b.allocation.offset; });
+            uint64_t end = 0, used = 0;
+            for (size_t i = 0; i < sorted.size(); ++i)
+            {
+                const TlsfAllocation& allocation = sorted[i].allocation;
+                if (allocation.offset % sorted[i].alignment != 0 || allocation.offset < end)
+                {
+                    return false;
+                }
+                end = allocation.offset + allocation.size;
+                used += allocation.size;
+                for (uint64_t b = allocation.offset; b < end; ++b)
+                {
+                    if (memory[(size_t)b] != sorted[i].tag)
+                    {
+                        return false;
+                    }
+                }
+            }
+            TlsfStats stats = allocator.GetStats();
+            return end <= allocator.GetSize() && stats.usedSize == used && stats.allocationCount == sorted.size() &&
+                stats.freeSize == stats.size - used;
+        }
+    };
+}
+
+ZW_TEST(RandomAllocationsAreAlignedAndNeverOverlap)
+{
+    BackedHeap heap(4 * 1024 * 1024, 16);
+    std::mt19937 random(7);
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        if (heap.live.empty() || random() % 100 < 55)
+        {
+            uint64_t size = random() % 4 == 0 ? random() % (256 * 1024) + 1 : random() % 4096 + 1;
+            uint64_t alignment = 1ull << (random() % 13); // 1 .. 4096, below the granularity too
+            failures += heap.Allocate(size, alignment) ? 0 : 1;
+        }
+        else
+        {
+            heap.Free(random() % heap.live.size());
+        }
+        if (i % 1000 == 999)
+        {
+            ZW_CHECK(heap.IsValid());
+        }
+    }
+    ZW_CHECK(failures > 0); // the heap ran full at some point
+    for (size_t i = 0; i < heap.live.size(); ++i)
+    {
+        ZW_CHECK_EQUAL(heap.live[i].allocation.size % 16, 0u);
+    }
+
+    // everything merges back into the one block it started as
+    while (!heap.live.empty())
+    {
+        heap.Free(heap.live.size() - 1);
+    }
+    TlsfStats stats = heap.allocator.GetStats();
+    ZW_CHECK(heap.allocator.IsEmpty());
+    ZW_CHECK_EQUAL(stats.freeBlockCount, 1u);
+    ZW_CHECK_EQUAL(stats.largestFreeBlock, stats.size);
+    ZW_CHECK_EQUAL(stats.fragmentation, 0.0f);
+}
+
+ZW_TEST(FreedBlocksMergeWithBothNeighbours)
+{
+    TlsfAllocator allocator;
+    allocator.Init(1024, 64);
+    TlsfAllocation a, b, c;
+    ZW_CHECK(allocator.Allocate(100, 1, &a));
+    ZW_CHECK(allocator.Allocate(64, 1, &b));
+    ZW_CHECK(allocator.Allocate(64, 1, &c));
+    ZW_CHECK_EQUAL(a.offset, 0u);
+    ZW_CHECK_EQUAL(a.size, 128u); // rounded up to the granularity
+    ZW_CHECK_EQUAL(b.offset, 128u);
+    ZW_CHECK_EQUAL(c.offset, 192u);
+
+    // a and c free, b keeps them apart, c merged with the free tail
+    allocator.Free(a.handle);
+    allocator.Free(c.handle);
+    TlsfStats stats = allocator.GetStats();
+    ZW_CHECK_EQUAL(stats.freeBlockCount, 2u);
+    ZW_CHECK_EQUAL(stats.largestFreeBlock, 1024u - 192u);
+
+    allocator.Free(b.handle);
+    stats = allocator.GetStats();
+    ZW_CHECK_EQUAL(stats.freeBlockCount, 1u);
+    ZW_CHECK_EQUAL(stats.largestFreeBlock, 1024u);
+}
+
+ZW_TEST(AllocationFailsOnlyWhenNoBlockFits)
+{
+    TlsfAllocator allocator;
+    allocator.Init(1024 * 1024, 256);
+    TlsfAllocation whole, more;
+    ZW_CHECK(allocator.Allocate(1024 * 1024, 512 * 1024, &whole));
+    ZW_CHECK(!allocator.Allocate(1, 1, &more));
+    ZW_CHECK_EQUAL(allocator.GetStats().fragmentation, 0.0f);
+    allocator.Free(whole.handle);
+
+    // 256KB free at 256KB: a 256KB allocation aligned to 512KB doesn't fit in it but one aligned to
+    // 256KB does
+    TlsfAllocation head, tail, aligned;
+    ZW_CHECK(allocator.Allocate(256 * 1024, 1, &head));
+    ZW_CHECK(allocator.Allocate(256 * 1024, 1, &more));
+    ZW_CHECK(allocator.Allocate(512 * 1024, 1, &tail));
+    allocator.Free(more.handle);
+    ZW_CHECK(!allocator.Allocate(256 * 1024, 512 * 1024, &aligned));
+    ZW_CHECK(allocator.Allocate(256 * 1024, 256 * 1024, &aligned));
+    ZW_CHECK_EQUAL(aligned.offset, 256u * 1024u);
+    ZW_CHECK(!allocator.Allocate(1, 1, &more));
+}
+
+ZW_TEST(ExecutedDefragmentationCompactsAndKeepsTheData)
+{
+    BackedHeap heap(1024 * 1024, 256);
+    std::mt19937 random(11);
+    while (heap.Allocate(random() % 8192 + 1, 256))
+    {
+    }
+
+    // free every other allocation, the free space is spread over the whole heap
+    for (size_t i = heap.live.size(); i-- > 0;)
+    {
+        if (i % 2 == 0)
+        {
+            heap.Free(i);
+        }
+    }
+    TlsfStats before = heap.allocator.GetStats();
+    ZW_CHECK(before.freeBlockCount > 10);
+    ZW_CHECK(before.fragmentation > 0.5f);
+
+    // a pass moves at most maxMoves, then run passes until nothing moves
+    bool movesGoDown = true;
+    ZW_CHECK(heap.Defragment(8, &movesGoDown) == 8);
+    ZW_CHECK(heap.IsValid());
+    uint32_t passes = 1;
+    while (heap.Defragment(64, &movesGoDown) > 0 && passes < 1000)
+    {
+        ZW_CHECK(heap.IsValid());
+        ++passes;
+    }
+    ZW_CHECK(movesGoDown);
+    ZW_CHECK(heap.IsValid());
+
+    // the free space collected at the end. holes too small for any allocation above them stay
+    // (with this seed 126 free blocks become 14, fragmentation goes from 0.98 to 0.02)
+    TlsfStats after = heap.allocator.GetStats();
+    ZW_CHECK_EQUAL(after.usedSize, before.usedSize);
+    ZW_CHECK_EQUAL(after.allocationCount, before.allocationCount);
+    ZW_CHECK(after.freeBlockCount * 4 < before.freeBlockCount);
+    ZW_CHECK(after.fragmentation < 0.05f);
+}
+
+ZW_TEST(ResourceHeapsFillInOrderAndCompactEachHeap)
+{
+    const uint64_t heapSize = 1024 * 1024;
+    ResourceHeapAllocator allocator;
+    allocator.Init(heapSize);
+    HeapAllocation allocation;
+    ZW_CHECK(!allocator.Allocate(1, ResourcePlacementAlignment, &allocation)); // no heap yet
+    ZW_CHECK_EQUAL(allocator.GetHeapSizeFor(1), heapSize);
+    ZW_CHECK_EQUAL(allocator.GetHeapSizeFor(3 * heapSize + 1), 3 * heapSize + ResourcePlacementAlignment);
+
+    // 48 64KB buffers fill three heaps, in order
+    std::vector<HeapAllocation> allocations;
+    for (uint32_t i = 0; i < 48; ++i)
+    {
+        if (!allocator.Allocate(ResourcePlacementAlignment, ResourcePlacementAlignment, &allocation))
+        {
+            allocator.AddHeap(allocator.GetHeapSizeFor(ResourcePlacementAlignment));
+            ZW_CHECK(allocator.Allocate(ResourcePlacementAlignment, ResourcePlacementAlignment, &allocation));
+        }
+        ZW_CHECK_EQUAL(allocation.heap, i / 16);
+        ZW_CHECK_EQUAL(allocation.allocation.offset, (i % 16) * ResourcePlacementAlignment);
+        allocations.push_back(allocation);
+    }
+    ZW_CHECK_EQUAL(allocator.GetHeapCount(), 3u);
+
+    // a freed spot in the first heap is used before anything later
+    allocator.Free(allocations[5]);
+    ZW_CHECK(allocator.Allocate(ResourcePlacementAlignment, ResourcePlacementAlignment, &allocations[5]));
+    ZW_CHECK_EQUAL(allocations[5].heap, 0u);
+
+    // the first half of every heap freed: each heap's buffers move down within that heap
+    for (uint32_t i = 0; i < 48; ++i)
+    {
+        if (i % 16 < 8)
+        {
+            allocator.Free(allocations[i]);
+        }
+    }
+    // planned in two passes, the first one cut off at maxMoves
+    std::vector<HeapMove> moves;
+    ZW_CHECK_EQUAL(allocator.PlanDefragmentation(5, &moves), 5u);
+    ZW_CHECK_EQUAL(moves.size(), 5u);
+    for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            ZW_CHECK(moves[i].move.destination.offset < moves[i].move.source.offset);
+            ZW_CHECK(moves[i].move.destination.offset < heapSize / 2);
+            allocator.Free(HeapAllocation{ moves[i].heap, moves[i].move.source });
+        }
+        moves.clear();
+        ZW_CHECK_EQUAL(allocator.PlanDefragmentation(100, &moves), pass == 0 ? 19u : 0u);
+    }
+
+    // every heap is its 8 buffers and then one free block
+    ResourceHeapStats stats = allocator.GetStats();
+    ZW_CHECK_EQUAL(stats.allocationCount, 24u);
+    ZW_CHECK_EQUAL(stats.freeBlockCount, 3u);
+    ZW_CHECK_EQUAL(stats.largestFreeBlock, heapSize / 2);
+    ZW_CHECK_NEAR(stats.fragmentation, 2.0f / 3.0f, 1e-5);
+
+    // a buffer larger than a heap gets a heap of exactly its size (rounded to 64KB) and fills it
+    const uint64_t big = 3 * heapSize + 1;
+    ZW_CHECK(!allocator.Allocate(big, ResourcePlacementAlignment, &allocation));
+    uint32_t dedicated = allocator.AddHeap(allocator.GetHeapSizeFor(big));
+    ZW_CHECK(allocator.Allocate(big, ResourcePlacementAlignment, &allocation));
+    ZW_CHECK_EQUAL(allocation.heap, dedicated);
+    ZW_CHECK_EQUAL(allocation.allocation.offset, 0u);
+}
@@ -0,0 +1,106 @@
+#include "TestFramework.h"
+#include "TransformSystem.h"
+#include <cmath>
+using namespace DirectX;
+
+namespace
+{
+    const float Pi = 3.14159265f;
+
+    // "point" (w = 1) times the row-vector matrix "world"
+    XMFLOAT3 TransformPoint(const XMFLOAT4X4& world, const XMFLOAT3& point)
+    {
+        return XMFLOAT3(
+            point.x * world._11 + point.y * world._21 + point.z * world._31 + world._41,
+            point.x * world._12 + point.y * world._22 + point.z * world._32 + world._42,
+            point.x * world._13 + point.y * world._23 + point.z * world._33 + world._43);
+    }
+
+    XMFLOAT4 RotationY(float angle)
+    {
+        return XMFLOAT4(0.0f, sinf(0.5f * angle), 0.0f, cosf(0.5f * angle));
+    }
+
+    void CheckPoint(const XMFLOAT3& actual, float x, float y, float z)
+    {
+        ZW_CHECK_NEAR(actual.x, x, 1e-4);
+        ZW_CHECK_NEAR(actual.y, y, 1e-4);
+        ZW_CHECK_NEAR(actual.z, z, 1e-4);
+    }
+}
+
+ZW_TEST(RootWorldIsScaleThenRotationThenTranslation)
+{
+    TransformSystem transforms;
+    TransformHandle root = transforms.Create(InvalidTransform, XMFLOAT3(1.0f, 2.0f, 3.0f), RotationY(0.5f * Pi), XMFLOAT3(2.0f, 2.0f, 2.0f));
+    transforms.UpdateWorld(1.0f);
+
+    // x is scaled to 2, turned onto -z (left handed, positive angles turn x towards -z) and moved
+    const XMFLOAT4X4& world = transforms.GetWorld(root);
+    CheckPoint(TransformPoint(world, XMFLOAT3(1.0f, 0.0f, 0.0f)), 1.0f, 2.0f, 1.0f);
+    CheckPoint(TransformPoint(world, XMFLOAT3(0.0f, 1.0f, 0.0f)), 1.0f, 4.0f, 3.0f);
+    CheckPoint(TransformPoint(world, XMFLOAT3(0.0f, 0.0f, 0.0f)), 1.0f, 2.0f, 3.0f);
+}
+
+ZW_TEST(ChildrenAreComposedWithTheirParentsWorld)
+{
+    TransformSystem transforms;
+    const XMFLOAT4 identity(0.0f, 0.0f, 0.0f, 1.0f);
+    TransformHandle anchor = transforms.Create(InvalidTransform, XMFLOAT3(0.0f, 0.0f, 5.0f), identity, XMFLOAT3(1.0f, 1.0f, 1.0f));
+    TransformHandle orbit = transforms.Create(anchor, XMFLOAT3(0.0f, 0.0f, 0.0f), RotationY(Pi), XMFLOAT3(1.0f, 1.0f, 1.0f));
+    TransformHandle moon = transforms.Create(orbit, XMFLOAT3(1.5f, 0.0f, 0.0f), identity, XMFLOAT3(0.5f, 0.5f, 0.5f));
+    ZW_CHECK_EQUAL(transforms.GetParent(moon), orbit);
+    transforms.UpdateWorld(1.0f);
+
+    // half a turn of the pivot puts the moon on the other side of the anchor
+    CheckPoint(TransformPoint(transforms.GetWorld(moon), XMFLOAT3(0.0f, 0.0f, 0.0f)), -1.5f, 0.0f, 5.0f);
+    CheckPoint(TransformPoint(transforms.GetWorld(moon), XMFLOAT3(0.0f, 1.0f, 0.0f)), -1.5f, 0.5f, 5.0f);
+
+    ZW_CHECK_EQUAL(transforms.Create(7, XMFLOAT3(0.0f, 0.0f, 0.0f), identity, XMFLOAT3(1.0f, 1.0f, 1.0f)), InvalidTransform);
+}
+
+ZW_TEST(UpdateWorldInterpolatesBetweenSteps)
+{
+    TransformSystem transforms;
+    TransformHandle cube = transforms.Create(InvalidTransform, XMFLOAT3(0.0f, 0.0f, 0.0f), RotationY(0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+
+    transforms.BeginStep();
+    transforms.SetPosition(cube, XMFLOAT3(2.0f, 4.0f, 0.0f));
+    transforms.SetRotation(cube, RotationY(0.5f * Pi));
+    transforms.SetScale(cube, XMFLOAT3(3.0f, 3.0f, 3.0f));
+
+    // half way: at (1, 2, 0), a quarter turn less 45 degrees, scale 2
+    transforms.UpdateWorld(0.5f);
+    const float h = sqrtf(2.0f);
+    CheckPoint(TransformPoint(transforms.GetWorld(cube), XMFLOAT3(1.0f, 0.0f, 0.0f)), 1.0f + h, 2.0f, -h);
+
+    transforms.UpdateWorld(1.0f);
+    CheckPoint(TransformPoint(transforms.GetWorld(cube), XMFLOAT3(1.0f, 0.0f, 0.0f)), 2.0f, 4.0f, -3.0f);
+    transforms.UpdateWorld(0.0f);
+    CheckPoint(TransformPoint(transforms.GetWorld(cube), XMFLOAT3(1.0f, 0.0f, 0.0f)), 1.0f, 0.0f, 0.0f);
+}
+
+ZW_TEST(IntegrateSpinsByTheAngularVelocity)
+{
+    TransformSystem transforms;
+    const XMFLOAT4 identity(0.0f, 0.0f, 0.0f, 1.0f);
+    TransformHandle spinning = transforms.Create(InvalidTransform, XMFLOAT3(0.0f, 0.0f, 0.0f), identity, XMFLOAT3(1.0f, 1.0f, 1.0f));
+    TransformHandle still = transforms.Create(InvalidTransform, XMFLOAT3(0.0f, 0.0f, 0.0f), identity, XMFLOAT3(1.0f, 1.0f, 1.0f));
+    transforms.SetAngularVelocity(spinning, XMFLOAT3(0.0f, Pi, 0.0f));
+
+    // one second in 120 steps is half a turn, and the quaternion stays unit length
+    for (int i = 0; i < 120; ++i)
+    {
+        transforms.BeginStep();
+        transforms.Integrate(1.0f / 120.0f);
+    }
+    const XMFLOAT4& rotation = transforms.GetRotation(spinning);
+    ZW_CHECK_NEAR(rotation.x, 0.0f, 1e-4);
+    ZW_CHECK_NEAR(fabsf(rotation.y), 1.0f, 1e-4);
+    ZW_CHECK_NEAR(rotation.z, 0.0f, 1e-4);
+    ZW_CHECK_NEAR(rotation.w, 0.0f, 1e-3);
+    ZW_CHECK_NEAR(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z + rotation.w * rotation.w, 1.0f, 1e-5);
+
+    const XMFLOAT4& unchanged = transforms.GetRotation(still);
+    ZW_CHECK(unchanged.x == 0.0f && unchanged.y == 0.0f && unchanged.z == 0.0f && unchanged.w == 1.0f);
+}
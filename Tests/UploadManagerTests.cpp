@@ -0,0 +1,284 @@
+#include "TestFramework.h"
+#include "NullRenderBackend.h"
+#include "UploadManager.h"
+#include <cstring>
+#include <vector>
+
+// an UploadManager of its own on the null backend's copy queue. the copies land when a batch is
+// submitted, the fence only completes when a test runs the simulated gpu forward
+
+namespace
+{
+    const uint64_t PageSize = 64 * 1024;
+
+    std::vector<uint8_t> Pattern(size_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            bytes[i] = (uint8_t)(i * 31 + seed);
+        }
+        return bytes;
+    }
+
+    // a destination buffer, an upload buffer is just a resource the test can read
+    ResourceHandle CreateDestination(NullRenderBackend* backend, uint64_t size)
+    {
+        UploadBuffer buffer;
+        backend->CreateUploadBuffer(size, &buffer);
+        return buffer.resource;
+    }
+}
+
+ZW_TEST(UploadsLandWhenTheirBatchIsSubmitted)
+{
+    NullRenderBackend backend;
+    UploadManager uploads;
+    uploads.Init(&backend, &backend.GetCopyQueue(), PageSize);
+
+    ResourceHandle a = CreateDestination(&backend, 1024);
+    ResourceHandle b = CreateDestination(&backend, 1024);
+    std::vector<uint8_t> data = Pattern(1024, 1);
+
+    // the two halves of "a" continue each other and become one copy
+    ZW_CHECK(uploads.Upload(a, 0, data.data(), 512));
+    ZW_CHECK(uploads.Upload(a, 512, data.data() + 512, 512));
+    ZW_CHECK(uploads.Upload(b, 256, data.data(), 100));
+    ZW_CHECK_EQUAL(uploads.GetStats().pendingCopies, 2u);
+    ZW_CHECK_EQUAL(uploads.GetStats().pendingBytes, 1124u);
+    ZW_CHECK(backend.GetResourceData(a)[0] == 0);
+
+    uint64_t fence;
+    ZW_CHECK(uploads.Submit(&fence));
+    ZW_CHECK_EQUAL(fence, 1u);
+    ZW_CHECK_EQUAL(uploads.GetLastFenceValue(), 1u);
+    ZW_CHECK(memcmp(backend.GetResourceData(a), data.data(), 1024) == 0);
+    ZW_CHECK(memcmp(backend.GetResourceData(b) + 256, data.data(), 100) == 0);
+    ZW_CHECK(backend.GetResourceData(b)[255] == 0 && backend.GetResourceData(b)[356] == 0);
+
+    UploadStats stats = uploads.GetStats();
+    ZW_CHECK_EQUAL(stats.uploads, 3u);
+    ZW_CHECK_EQUAL(stats.submittedCopies, 2u);
+    ZW_CHECK_EQUAL(stats.submittedBatches, 1u);
+    ZW_CHECK_EQUAL(stats.pendingCopies, 0u);
+
+    // nothing open, nothing submitted
+    ZW_CHECK(uploads.Submit(&fence));
+    ZW_CHECK_EQUAL(fence, 0u);
+}
+
+ZW_TEST(FullPagesWaitForTheirFence)
+{
+    NullRenderBackend backend;
+    SimulatedGpuFence& gpu = backend.GetCopyQueue().GetSimulatedFence();
+    UploadManager uploads;
+    uploads.Init(&backend, &backend.GetCopyQueue(), PageSize);
+
+    ResourceHandle destination = CreateDestination(&backend, PageSize);
+    std::vector<uint8_t> data = Pattern(PageSize / 4, 2);
+
+    // a quarter page each, the gpu completes nothing: every full page stays in flight
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        ZW_CHECK(uploads.Upload(destination, 0, data.data(), data.size()));
+    }
+    ZW_CHECK_EQUAL(uploads.GetStats().pageCount, 4u);
+    ZW_CHECK_EQUAL(uploads.GetStats().pagesInFlight, 3u);
+
+    // once their batches completed the three pages come back instead of new ones being created. the
+    // fourth goes in flight with the batch the next upload submits
+    gpu.CompleteUpTo(uploads.GetLastFenceValue());
+    for (uint32_t i = 0; i < 12; ++i)
+    {
+        ZW_CHECK(uploads.Upload(destination, 0, data.data(), data.size()));
+    }
+    ZW_CHECK_EQUAL(uploads.GetStats().pageCount, 4u);
+    ZW_CHECK_EQUAL(uploads.GetStats().pagesInFlight, 3u);
+
+    // its batch hasn't completed, so the next page is a new one
+    ZW_CHECK(uploads.Upload(destination, 0, data.data(), data.size()));
+    ZW_CHECK_EQUAL(uploads.GetStats().pageCount, 5u);
+}
+
+ZW_TEST(StagingSettlesAtWhatTheBatchesInFlightNeed)
+{
+    NullRenderBackend backend;
+    SimulatedGpuFence& gpu = backend.GetCopyQueue().GetSimulatedFence();
+    UploadManager uploads;
+    uploads.Init(&backend, &backend.GetCopyQueue(), PageSize);
+
+    ResourceHandle destination = CreateDestination(&backend, 40 * 1024);
+    std::vector<uint8_t> data = Pattern(1024, 3);
+
+    // 200 frames of 40 uploads (a page fills every ~1.5 frames), the gpu three batches behind
+    for (uint32_t frame = 0; frame < 200; ++frame)
+    {
+        for (uint32_t i = 0; i < 40; ++i)
+        {
+            data[0] = (uint8_t)(frame + i);
+            ZW_CHECK(uploads.Upload(destination, i * 1024, data.data(), data.size()));
+        }
+        uint64_t fence;
+        ZW_CHECK(uploads.Submit(&fence));
+        if (fence > 3)
+        {
+            gpu.CompleteUpTo(fence - 3);
+        }
+    }
+    UploadStats stats = uploads.GetStats();
+    ZW_CHECK(stats.pageCount <= 5);
+    ZW_CHECK_EQUAL(stats.stagingCapacity, stats.pageCount * PageSize);
+    ZW_CHECK_EQUAL(stats.uploads, 200u * 40u);
+    ZW_CHECK(stats.submittedCopies < stats.uploads); // neighbouring uploads merged
+    ZW_CHECK(backend.GetResourceData(destination)[39 * 1024] == (uint8_t)(199 + 39));
+
+    // waiting runs the copy queue to the last batch, every page is free again
+    ZW_CHECK(uploads.WaitForIdle());
+    ZW_CHECK_EQUAL(uploads.GetStats().pagesInFlight, 0u);
+    ZW_CHECK_EQUAL(gpu.GetCompletedValue(), uploads.GetLastFenceValue());
+}
+
+ZW_TEST(LargeUnalignedUploadsAreStagedExactly)
+{
+    NullRenderBackend backend;
+    UploadManager uploads;
+    uploads.Init(&backend, &backend.GetCopyQueue(), PageSize);
+
+    // 3 bytes first so the big one starts off any alignment, and it's bigger than a page
+    const size_t bigSize = 3 * PageSize + 7;
+    ResourceHandle destination = CreateDestination(&backend, bigSize + 3);
+    std::vector<uint8_t> small = Pattern(3, 4);
+    std::vector<uint8_t> big = Pattern(bigSize, 5);
+    ZW_CHECK(uploads.Upload(destination, 0, small.data(), small.size()));
+    ZW_CHECK(uploads.Upload(destination, 3, big.data(), big.size()));
+    ZW_CHECK(uploads.Submit());
+
+    // the oversized upload got a page of its own
+    ZW_CHECK_EQUAL(uploads.GetStats().pageCount, 2u);
+    ZW_CHECK_EQUAL(uploads.GetStats().submittedBatches, 2u);
+    const uint8_t* result = backend.GetResourceData(destination);
+    ZW_CHECK(memcmp(result, small.data(), small.size()) == 0);
+    ZW_CHECK(memcmp(result + 3, big.data(), big.size()) == 0);
+}
+
+ZW_TEST(StaticBuffersOfTheBackendGoThroughItsManager)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    std::vector<uint8_t> data = Pattern(300 * 1024, 6);
+    StaticBuffer buffer;
+    ZW_CHECK(backend.CreateStaticBuffer(data.data(), data.size(), ResourceState::VertexAndConstantBuffer, &buffer));
+    ZW_CHECK(backend.GetResourceData(buffer.resource)[1] == 0);
+
+    ZW_CHECK(backend.FlushUploads());
+    ZW_CHECK(memcmp(backend.GetGpuAddressData(buffer.gpuAddress, data.size()), data.data(), data.size()) == 0);
+    ZW_CHECK_EQUAL(backend.GetUploadManager().GetStats().submittedBatches, 1u);
+    backend.Shutdown();
+}
+
+ZW_TEST(TextureSubresourcesArePlacedAndCopiedRowByRow)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+
+    // rgba8 10x6 with 3 mips (10x6, 5x3, 2x1) in 2 slices, rows that need padding in the footprints
+    TextureDesc desc;
+    desc.format = 28; // DXGI_FORMAT_R8G8B8A8_UNORM
+    desc.width = 10;
+    desc.height = 6;
+    desc.depth = 1;
+    desc.arraySize = 2;
+    desc.mipCount = 3;
+    desc.volume = false;
+    ResourceHandle texture;
+    ZW_CHECK(backend.CreateTexture(desc, &texture));
+
+    const uint32_t widths[] = { 10, 5, 2 };
+    const uint32_t heights[] = { 6, 3, 1 };
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<SubresourceSource> sources;
+    for (uint32_t slice = 0; slice < 2; ++slice)
+    {
+        for (uint32_t mip = 0; mip < 3; ++mip)
+        {
+            data.push_back(Pattern(widths[mip] * 4 * heights[mip], slice * 3 + mip));
+        }
+    }
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        SubresourceSource source;
+        source.data = data[i].data();
+        source.rowPitch = widths[i % 3] * 4;
+        source.slicePitch = source.rowPitch * heights[i % 3];
+        sources.push_back(source);
+    }
+
+    // a buffer upload in the same batch, the texture starts on a placement boundary after it
+    StaticBuffer buffer;
+    ZW_CHECK(backend.CreateStaticBuffer(data[0].data(), 3, ResourceState::GenericRead, &buffer));
+    ZW_CHECK(backend.UploadTexture(texture, 0, 6, sources.data(), nullptr));
+    ZW_CHECK(backend.GetTextureSubresourceData(texture, 0)[0] == 0);
+    ZW_CHECK_EQUAL(backend.GetUploadManager().GetStats().pendingCopies, 7u);
+    ZW_CHECK(backend.FlushUploads());
+    ZW_CHECK_EQUAL(backend.GetUploadManager().GetStats().submittedBatches, 1u);
+
+    ZW_CHECK(memcmp(backend.GetResourceData(buffer.resource), data[0].data(), 3) == 0);
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        ZW_CHECK(memcmp(backend.GetTextureSubresourceData(texture, i), data[i].data(), data[i].size()) == 0);
+    }
+
+    // past the last subresource
+    ZW_CHECK(!backend.UploadTexture(texture, 5, 2, sources.data(), nullptr));
+    backend.Shutdown();
+}
+
+ZW_TEST(CompressedMipsCopyWholeBlocks)
+{
+    NullRenderBackend backend;
+    UploadManager uploads;
+    uploads.Init(&backend, &backend.GetCopyQueue(), PageSize);
+
+    // bc1 5x5 with 3 mips: 2x2, 1x1 and 1x1 blocks of 8 bytes
+    TextureDesc desc;
+    desc.format = 71; // DXGI_FORMAT_BC1_UNORM
+    desc.width = 5;
+    desc.height = 5;
+    desc.depth = 1;
+    desc.arraySize = 1;
+    desc.mipCount = 3;
+    desc.volume = false;
+    ResourceHandle texture;
+    ZW_CHECK(backend.CreateTexture(desc, &texture));
+
+    TextureSubresourceLayout layout;
+    ZW_CHECK(GetTextureSubresourceLayout(desc, 0, &layout));
+    ZW_CHECK_EQUAL(layout.rowSize, 16u);
+    ZW_CHECK_EQUAL(layout.rowCount, 2u);
+    ZW_CHECK_EQUAL(layout.width, 8u);
+    ZW_CHECK_EQUAL(layout.height, 8u);
+    ZW_CHECK(GetTextureSubresourceLayout(desc, 2, &layout));
+    ZW_CHECK_EQUAL(layout.rowSize, 8u);
+    ZW_CHECK_EQUAL(layout.width, 4u);
+    ZW_CHECK(!GetTextureSubresourceLayout(desc, 3, &layout));
+
+    std::vector<uint8_t> data = Pattern(32 + 8 + 8, 7);
+    SubresourceSource sources[3];
+    sources[0].data = data.data();
+    sources[0].rowPitch = 16;
+    sources[0].slicePitch = 32;
+    sources[1].data = data.data() + 32;
+    sources[1].rowPitch = 8;
+    sources[1].slicePitch = 8;
+    sources[2].data = data.data() + 40;
+    sources[2].rowPitch = 8;
+    sources[2].slicePitch = 8;
+    ZW_CHECK(uploads.UploadTexture(texture, desc, 0, 3, sources, nullptr));
+    ZW_CHECK_EQUAL(uploads.GetStats().pendingCopies, 3u);
+    ZW_CHECK(uploads.Submit());
+    ZW_CHECK(memcmp(backend.GetResourceData(texture), data.data(), data.size()) == 0);
+
+    // a format without a known size
+    desc.format = 0;
+    ZW_CHECK(!uploads.UploadTexture(texture, desc, 0, 1, sources, nullptr));
+}
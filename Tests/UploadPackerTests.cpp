@@ -0,0 +1,181 @@
+#include "TestFramework.h"
+#include "UploadPacker.h"
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // the packer never needs more than SSE2, AVX2 takes the same path
+    const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::SSE2 };
+
+    std::vector<uint8_t> Pattern(size_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            bytes[i] = (uint8_t)((i * 131) ^ (i >> 8) ^ seed);
+        }
+        return bytes;
+    }
+
+    // every row of the footprint holds the source row, and the padding around it is untouched
+    bool RowsMatch(const std::vector<uint8_t>& staging, const UploadFootprint& footprint, const SubresourceSource& source,
+        uint8_t padding)
+    {
+        const uint8_t* src = (const uint8_t*)source.data;
+        for (uint32_t z = 0; z < footprint.depth; ++z)
+        {
+            for (uint32_t y = 0; y < footprint.rowCount; ++y)
+            {
+                uint64_t offset = footprint.offset + ((uint64_t)z * footprint.rowCount + y) * footprint.rowPitch;
+                if (memcmp(&staging[(size_t)offset], src + z * source.slicePitch + y * source.rowPitch, footprint.rowSize) != 0)
+                {
+                    return false;
+                }
+                bool last = z + 1 == footprint.depth && y + 1 == footprint.rowCount;
+                for (uint32_t x = footprint.rowSize; x < footprint.rowPitch && !last; ++x)
+                {
+                    if (staging[(size_t)offset + x] != padding)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+}
+
+ZW_TEST(FootprintsFollowThePlacementRules)
+{
+    const uint32_t rowSizes[] = { 100, 256, 4, 1000 };
+    const uint32_t rowCounts[] = { 3, 2, 1, 5 };
+    const uint32_t depths[] = { 1, 1, 2, 3 };
+    UploadFootprint footprints[4];
+    const uint64_t base = 10;
+    uint64_t size = UploadPacker::ComputeFootprints(4, rowSizes, rowCounts, depths, base, footprints);
+
+    uint64_t end = base;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        const UploadFootprint& footprint = footprints[i];
+        ZW_CHECK_EQUAL(footprint.offset % TexturePlacementAlignment, 0u);
+        ZW_CHECK_EQUAL(footprint.rowPitch % TextureRowPitchAlignment, 0u);
+        ZW_CHECK(footprint.rowPitch >= footprint.rowSize && footprint.rowPitch < footprint.rowSize + TextureRowPitchAlignment);
+        ZW_CHECK(footprint.offset >= end);
+        ZW_CHECK_EQUAL(footprint.rowSize, rowSizes[i]);
+        ZW_CHECK_EQUAL(footprint.rowCount, rowCounts[i]);
+        ZW_CHECK_EQUAL(footprint.depth, depths[i]);
+        end = footprint.offset + ((uint64_t)footprint.rowCount * footprint.depth - 1) * footprint.rowPitch + footprint.rowSize;
+    }
+
+    // like GetCopyableFootprints: the last row of the last subresource without its padding
+    ZW_CHECK_EQUAL(footprints[0].offset, 512u);
+    ZW_CHECK_EQUAL(footprints[1].offset, 1536u); // 512 + 2 * 256 + 100 rounded up
+    ZW_CHECK_EQUAL(size, end - base);
+}
+
+ZW_TEST(EveryLevelPacksRowsWithTheirPadding)
+{
+    // a source with its own pitches, rows of 100 and of 1000 bytes (the second is long enough to stream)
+    const uint32_t rowSizes[] = { 100, 1000 };
+    const uint32_t rowCounts[] = { 7, 5 };
+    const uint32_t depths[] = { 1, 3 };
+    UploadFootprint footprints[2];
+    uint64_t size = UploadPacker::ComputeFootprints(2, rowSizes, rowCounts, depths, 0, footprints);
+
+    std::vector<uint8_t> small = Pattern(130 * 7, 1);
+    std::vector<uint8_t> big = Pattern(1010 * 5 * 3 + 64, 2);
+    SubresourceSource sources[2];
+    sources[0].data = small.data();
+    sources[0].rowPitch = 130;
+    sources[0].slicePitch = 130 * 7;
+    sources[1].data = big.data();
+    sources[1].rowPitch = 1010;
+    sources[1].slicePitch = 1010 * 5 + 20;
+
+    for (SimdLevel level : Levels)
+    {
+        std::vector<uint8_t> staging((size_t)size + 64, 0xcd);
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            UploadPacker::PackSubresource(sources[i], footprints[i], staging.data(), level);
+            ZW_CHECK(RowsMatch(staging, footprints[i], sources[i], 0xcd));
+        }
+        ZW_CHECK(staging[(size_t)size] == 0xcd);
+    }
+}
+
+ZW_TEST(ContiguousCopiesAreExactAtAnyAlignment)
+{
+    // a buffer is one row; big enough to stream, starting at every offset of a 16 byte line
+    const uint32_t size = 200 * 1024 + 5;
+    std::vector<uint8_t> data = Pattern(size, 3);
+    SubresourceSource source;
+    source.data = data.data();
+    source.rowPitch = size;
+    source.slicePitch = size;
+
+    for (SimdLevel level : Levels)
+    {
+        for (uint32_t offset = 0; offset < 17; ++offset)
+        {
+            UploadFootprint footprint;
+            footprint.offset = offset;
+            footprint.rowPitch = size;
+            footprint.rowSize = size;
+            footprint.rowCount = 1;
+            footprint.depth = 1;
+
+            std::vector<uint8_t> staging(size + 64, 0xcd);
+            UploadPacker::PackSubresource(source, footprint, staging.data(), level);
+            ZW_CHECK(memcmp(staging.data() + offset, data.data(), size) == 0);
+            ZW_CHECK(offset == 0 || staging[offset - 1] == 0xcd);
+            ZW_CHECK(staging[offset + size] == 0xcd);
+        }
+    }
+}
+
+ZW_TEST(JobsPackTheSameBytesAsOneThread)
+{
+    // a 512x512 rgba8 mip chain (mip 0 is split into row ranges) plus a bc1 chain with 2 byte rows at the end
+    std::vector<uint32_t> rowSizes, rowCounts, depths;
+    for (uint32_t mip = 0; mip < 10; ++mip)
+    {
+        uint32_t width = 512 >> mip;
+        rowSizes.push_back(width * 4);
+        rowCounts.push_back(width);
+        depths.push_back(1);
+    }
+    for (uint32_t mip = 0; mip < 10; ++mip)
+    {
+        uint32_t blocks = ((512 >> mip) + 3) / 4;
+        rowSizes.push_back(blocks * 8);
+        rowCounts.push_back(blocks);
+        depths.push_back(1);
+    }
+    const uint32_t count = (uint32_t)rowSizes.size();
+    std::vector<UploadFootprint> footprints(count);
+    uint64_t size = UploadPacker::ComputeFootprints(count, rowSizes.data(), rowCounts.data(), depths.data(), 0, footprints.data());
+
+    std::vector<std::vector<uint8_t>> data(count);
+    std::vector<SubresourceSource> sources(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        data[i] = Pattern((size_t)rowSizes[i] * rowCounts[i], i);
+        sources[i].data = data[i].data();
+        sources[i].rowPitch = rowSizes[i];
+        sources[i].slicePitch = (uint64_t)rowSizes[i] * rowCounts[i];
+    }
+
+    std::vector<uint8_t> single((size_t)size, 0);
+    std::vector<uint8_t> parallel((size_t)size, 0);
+    UploadPacker::PackSubresources(nullptr, count, sources.data(), footprints.data(), single.data());
+    JobSystem jobs(4);
+    UploadPacker::PackSubresources(&jobs, count, sources.data(), footprints.data(), parallel.data());
+    ZW_CHECK(single == parallel);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ZW_CHECK(RowsMatch(parallel, footprints[i], sources[i], 0));
+    }
+}
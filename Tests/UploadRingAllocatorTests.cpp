@@ -0,0 +1,273 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include "NullRenderBackend.h"
+#include "Scene.h"
+#include "UploadRingAllocator.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+// the ring on the null backend, whose upload buffers are cpu memory with a fake gpu address range.
+// pages are 64KB and every resource starts on a 64KB boundary, so the page of an allocation is its
+// gpu address rounded down
+
+namespace
+{
+    const uint64_t PageSize = 64 * 1024;
+
+    GpuAddress PageOf(const UploadAllocation& allocation)
+    {
+        return allocation.gpuAddress & ~(PageSize - 1);
+    }
+
+    bool Overlap(const UploadAllocation& a, const UploadAllocation& b)
+    {
+        return a.gpuAddress < b.gpuAddress + b.size && b.gpuAddress < a.gpuAddress + a.size;
+    }
+}
+
+ZW_TEST(AllocationsAreAlignedAndBothAddressesPointAtTheSameBytes)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    UploadRingAllocator ring;
+    ring.Init(&backend, PageSize);
+    ring.BeginFrame(1, 0);
+
+    const uint64_t sizes[] = { 1, 64, 255, 256, 257, 1000, 4096, 17, 3 };
+    std::vector<UploadAllocation> allocations;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        UploadAllocation allocation;
+        ZW_CHECK(ring.Allocate(sizes[i], ConstantBufferAlignment, &allocation));
+        ZW_CHECK_EQUAL(allocation.size, sizes[i]);
+        ZW_CHECK_EQUAL(allocation.gpuAddress % ConstantBufferAlignment, 0u);
+
+        // what the cpu writes is what the gpu address reads
+        memset(allocation.cpuAddress, (int)(i + 1), (size_t)allocation.size);
+        ZW_CHECK(backend.GetGpuAddressData(allocation.gpuAddress, allocation.size) == allocation.cpuAddress);
+        allocations.push_back(allocation);
+    }
+    for (size_t i = 0; i < allocations.size(); ++i)
+    {
+        const uint8_t* data = backend.GetGpuAddressData(allocations[i].gpuAddress, allocations[i].size);
+        bool intact = data != nullptr;
+        for (uint64_t b = 0; intact && b < allocations[i].size; ++b)
+        {
+            intact = data[b] == (uint8_t)(i + 1);
+        }
+        ZW_CHECK(intact);
+        for (size_t j = i + 1; j < allocations.size(); ++j)
+        {
+            ZW_CHECK(!Overlap(allocations[i], allocations[j]));
+        }
+    }
+
+    // smaller alignments pack tighter, larger ones still hold
+    UploadAllocation small, large;
+    ZW_CHECK(ring.Allocate(4, 4, &small) && ring.Allocate(4, 4, &large));
+    ZW_CHECK_EQUAL(large.gpuAddress, small.gpuAddress + 4);
+    ZW_CHECK(ring.Allocate(100, 4096, &large));
+    ZW_CHECK_EQUAL(large.gpuAddress % 4096, 0u);
+    backend.Shutdown();
+}
+
+ZW_TEST(APageIsOnlyReusedOnceTheGpuFinishedItsLastFrame)
+{
+    // 40KB a frame, so every frame moves on to another page, with the gpu 0 to 3 frames behind
+    for (uint32_t latency = 0; latency <= 3; ++latency)
+    {
+        NullRenderBackend backend;
+        ZW_CHECK(backend.Init(64, 64));
+        ZW_CHECK(backend.SetFramesInFlight(frameBufferCount));
+        backend.SetGpuLatency(latency);
+        UploadRingAllocator ring;
+        ring.Init(&backend, PageSize);
+
+        std::map<GpuAddress, uint64_t> lastFrameOfPage;
+        bool reusedTooEarly = false;
+        uint32_t pagesAfterWarmUp = 0;
+        for (uint64_t frame = 1; frame <= 50; ++frame)
+        {
+            ZW_CHECK(backend.BeginFrame());
+            const uint64_t completed = backend.GetCompletedFrameCount();
+            ring.BeginFrame(backend.GetSubmittedFrameCount() + 1, completed);
+
+            UploadAllocation allocation;
+            ZW_CHECK(ring.Allocate(40 * 1024, ConstantBufferAlignment, &allocation));
+            std::map<GpuAddress, uint64_t>::iterator page = lastFrameOfPage.find(PageOf(allocation));
+            if (page != lastFrameOfPage.end() && page->second > completed)
+            {
+                reusedTooEarly = true;
+            }
+            lastFrameOfPage[PageOf(allocation)] = frame;
+            ZW_CHECK(backend.EndFrame());
+
+            if (frame == 10)
+            {
+                pagesAfterWarmUp = ring.GetStats().pageCount;
+            }
+        }
+        ZW_CHECK(!reusedTooEarly);
+
+        // the ring stops growing once it covers the frames in flight
+        UploadRingStats stats = ring.GetStats();
+        ZW_CHECK_EQUAL(stats.pageCount, pagesAfterWarmUp);
+        ZW_CHECK(stats.pageCount <= (uint32_t)frameBufferCount + 1);
+        ZW_CHECK_EQUAL(stats.capacity, stats.pageCount * PageSize);
+        backend.Shutdown();
+    }
+
+    // a gpu that never finishes anything: every frame needs a page of its own
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    UploadRingAllocator ring;
+    ring.Init(&backend, PageSize);
+    std::vector<GpuAddress> pages;
+    for (uint64_t frame = 1; frame <= 8; ++frame)
+    {
+        ring.BeginFrame(frame, 0);
+        UploadAllocation allocation;
+        ZW_CHECK(ring.Allocate(PageSize, ConstantBufferAlignment, &allocation));
+        pages.push_back(PageOf(allocation));
+    }
+    std::sort(pages.begin(), pages.end());
+    ZW_CHECK(std::unique(pages.begin(), pages.end()) == pages.end());
+    ZW_CHECK_EQUAL(ring.GetStats().pagesInFlight, 7u);
+
+    // once frames 1 to 4 are done their pages come back, 5 to 7 stay out (8 is still the current page)
+    ring.BeginFrame(9, 4);
+    ZW_CHECK_EQUAL(ring.GetStats().pagesInFlight, 3u);
+    for (int i = 0; i < 4; ++i)
+    {
+        UploadAllocation allocation;
+        ZW_CHECK(ring.Allocate(PageSize, ConstantBufferAlignment, &allocation));
+    }
+    ZW_CHECK_EQUAL(ring.GetStats().pageCount, 8u);
+    UploadAllocation fifth;
+    ZW_CHECK(ring.Allocate(PageSize, ConstantBufferAlignment, &fifth));
+    ZW_CHECK_EQUAL(ring.GetStats().pageCount, 9u);
+    backend.Shutdown();
+}
+
+ZW_TEST(AFrameLargerThanThePagesGrowsTheRing)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    UploadRingAllocator ring;
+    ring.Init(&backend, PageSize);
+    ring.BeginFrame(1, 0);
+
+    // 300 constant buffers, more than four pages worth
+    std::vector<UploadAllocation> allocations(300);
+    for (size_t i = 0; i < allocations.size(); ++i)
+    {
+        ZW_CHECK(ring.Allocate(1000, ConstantBufferAlignment, &allocations[i]));
+    }
+    UploadRingStats stats = ring.GetStats();
+    ZW_CHECK(stats.pageCount >= 5);
+    ZW_CHECK_EQUAL(stats.capacity, stats.pageCount * PageSize);
+    bool disjoint = true;
+    for (size_t i = 1; i < allocations.size(); ++i)
+    {
+        for (size_t j = 0; j < i; ++j)
+        {
+            disjoint = disjoint && !Overlap(allocations[i], allocations[j]);
+        }
+    }
+    ZW_CHECK(disjoint);
+
+    // a request larger than a page gets a page of its own size
+    UploadAllocation huge;
+    ZW_CHECK(ring.Allocate(3 * PageSize + 100, ConstantBufferAlignment, &huge));
+    ZW_CHECK(backend.GetGpuAddressData(huge.gpuAddress, huge.size) == huge.cpuAddress);
+    ZW_CHECK_EQUAL(ring.GetStats().pageCount, stats.pageCount + 1);
+    ZW_CHECK_EQUAL(ring.GetStats().capacity, stats.capacity + 3 * PageSize + 100);
+    backend.Shutdown();
+}
+
+ZW_TEST(StatsCountEveryFrameWithItsPadding)
+{
+    NullRenderBackend backend;
+    ZW_CHECK(backend.Init(64, 64));
+    UploadRingAllocator ring;
+    ring.Init(&backend, PageSize);
+
+    ring.BeginFrame(1, 0);
+    UploadAllocation allocation;
+    ZW_CHECK(ring.Allocate(100, ConstantBufferAlignment, &allocation));
+    ZW_CHECK(ring.Allocate(100, ConstantBufferAlignment, &allocation));
+    UploadRingStats stats = ring.GetStats();
+    ZW_CHECK_EQUAL(stats.frameBytes, (uint64_t)(256 + 100));
+    ZW_CHECK_EQUAL(stats.lastFrameBytes, (uint64_t)0);
+    ZW_CHECK_EQUAL(stats.peakFrameBytes, (uint64_t)356);
+    ZW_CHECK_EQUAL(stats.pageCount, 1u);
+
+    ring.BeginFrame(2, 1);
+    ZW_CHECK(ring.Allocate(4096, ConstantBufferAlignment, &allocation));
+    stats = ring.GetStats();
+    ZW_CHECK_EQUAL(stats.frameBytes, (uint64_t)(156 + 4096)); // up to the next boundary, then the buffer
+    ZW_CHECK_EQUAL(stats.lastFrameBytes, (uint64_t)356);
+    ZW_CHECK_EQUAL(stats.peakFrameBytes, (uint64_t)(156 + 4096));
+
+    ring.BeginFrame(3, 2);
+    ZW_CHECK(ring.Allocate(256, ConstantBufferAlignment, &allocation));
+    stats = ring.GetStats();
+    ZW_CHECK_EQUAL(stats.frameBytes, (uint64_t)256);
+    ZW_CHECK_EQUAL(stats.lastFrameBytes, (uint64_t)(156 + 4096));
+    ZW_CHECK_EQUAL(stats.peakFrameBytes, (uint64_t)(156 + 4096));
+    ZW_CHECK_EQUAL(stats.pagesInFlight, 0u);
+    backend.Shutdown();
+}
+
+ZW_TEST(SceneFramesOfMoreThan256CubesGetEveryConstantBuffer)
+{
+    // one 256 byte constant buffer per draw, more draws than fit a 64KB page (the fixed size heap
+    // this replaced held 256), with the gpu two frames behind
+    NullRenderBackend backend;
+    JobSystem jobs(2);
+    ZW_CHECK(backend.Init(320, 240));
+    backend.SetGpuLatency(2);
+    SceneSettings settings = { 2000, false, false, 0, true, nullptr, nullptr };
+    ZW_CHECK(InitScene(&backend, &jobs, 320, 240, settings));
+    backend.ClearCommands();
+
+    uint64_t peak = 0;
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        SimulateScene(1.0f / 120.0f);
+        ZW_CHECK(backend.BeginFrame() && UpdateScene(&backend, 1.0f) && RecordScene(&backend) && backend.EndFrame());
+
+        std::vector<GpuAddress> addresses;
+        const std::vector<RenderCommand>& commands = backend.GetCommands();
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            if (commands[i].type == RenderCommandType::SetGraphicsRootConstantBufferView)
+            {
+                addresses.push_back(commands[i].rootConstantBufferView.bufferLocation);
+            }
+        }
+        ZW_CHECK(addresses.size() > 256);
+
+        // the frame's constant buffers, all of them distinct and readable
+        bool readable = true;
+        for (size_t i = 0; i < addresses.size(); ++i)
+        {
+            readable = readable && addresses[i] % ConstantBufferAlignment == 0 &&
+                backend.GetGpuAddressData(addresses[i], ConstantBufferAlignment) != nullptr;
+        }
+        ZW_CHECK(readable);
+        std::sort(addresses.begin(), addresses.end());
+        ZW_CHECK(std::unique(addresses.begin(), addresses.end()) == addresses.end());
+
+        UploadRingStats stats = GetSceneUploadStats();
+        ZW_CHECK_EQUAL(stats.frameBytes, (uint64_t)addresses.size() * ConstantBufferAlignment);
+        ZW_CHECK(stats.capacity >= stats.frameBytes);
+        peak = std::max(peak, stats.frameBytes);
+        backend.ClearCommands();
+    }
+    ZW_CHECK_EQUAL(GetSceneUploadStats().peakFrameBytes, peak);
+    ShutdownScene();
+    backend.Shutdown();
+}
@@ -0,0 +1,152 @@
+#include "TestFramework.h"
+#include "FrustumCulling.h"
+#include "VertexQuantization.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+    // the 28 byte layout of the scene's float vertices
+    struct Vertex
+    {
+        float position[3];
+        float color[4];
+    };
+
+    // odd count, so the wide kernels run their tails
+    std::vector<Vertex> RandomVertices(uint32_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-3.0f, 5.0f), color(0.0f, 1.0f);
+        std::vector<Vertex> vertices(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                vertices[i].position[k] = position(random) * (k + 1);
+            }
+            for (int k = 0; k < 4; ++k)
+            {
+                vertices[i].color[k] = color(random);
+            }
+        }
+        return vertices;
+    }
+}
+
+ZW_TEST(EveryLevelEncodesTheSameBytes)
+{
+    const uint32_t count = 1001;
+    std::vector<Vertex> vertices = RandomVertices(count, 1);
+    // a few values on the rounding ties and outside the bounds
+    vertices[3].position[0] = 100.0f;
+    vertices[4].color[1] = -0.5f;
+    vertices[5].color[2] = 2.0f;
+    vertices[6].color[3] = 0.5f / 255.0f;
+    float center[3], extent[3];
+    ComputeAabb(vertices.data(), 100, sizeof(Vertex), center, extent);
+
+    std::vector<QuantizedVertex> reference(count);
+    QuantizeVertices(reference.data(), vertices[0].position, sizeof(Vertex), vertices[0].color, sizeof(Vertex), count, center, extent,
+        SimdLevel::Scalar);
+    for (size_t l = 1; l < sizeof(Levels) / sizeof(Levels[0]); ++l)
+    {
+        std::vector<QuantizedVertex> encoded(count);
+        QuantizeVertices(encoded.data(), vertices[0].position, sizeof(Vertex), vertices[0].color, sizeof(Vertex), count, center, extent,
+            Levels[l]);
+        ZW_CHECK(memcmp(encoded.data(), reference.data(), count * sizeof(QuantizedVertex)) == 0);
+
+        std::vector<Vertex> decoded(count), decodedReference(count);
+        DequantizeVertices(decoded[0].position, sizeof(Vertex), decoded[0].color, sizeof(Vertex), encoded.data(), count, center, extent,
+            Levels[l]);
+        DequantizeVertices(decodedReference[0].position, sizeof(Vertex), decodedReference[0].color, sizeof(Vertex), reference.data(),
+            count, center, extent, SimdLevel::Scalar);
+        ZW_CHECK(memcmp(decoded.data(), decodedReference.data(), count * sizeof(Vertex)) == 0);
+    }
+
+    // clamped to the bounds and to 0..1
+    ZW_CHECK_EQUAL(reference[3].position[0], 32767);
+    ZW_CHECK_EQUAL(reference[4].color[1], 0);
+    ZW_CHECK_EQUAL(reference[5].color[2], 255);
+    ZW_CHECK_EQUAL(reference[0].position[3], 32767);
+}
+
+ZW_TEST(RoundTripErrorIsHalfAStep)
+{
+    const uint32_t count = 997;
+    std::vector<Vertex> vertices = RandomVertices(count, 2);
+    float center[3], extent[3];
+    ComputeAabb(vertices.data(), count, sizeof(Vertex), center, extent);
+
+    std::vector<QuantizedVertex> encoded(count);
+    std::vector<Vertex> decoded(count);
+    QuantizeVertices(encoded.data(), vertices[0].position, sizeof(Vertex), vertices[0].color, sizeof(Vertex), count, center, extent);
+    DequantizeVertices(decoded[0].position, sizeof(Vertex), decoded[0].color, sizeof(Vertex), encoded.data(), count, center, extent);
+
+    bool positionsClose = true, colorsClose = true;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            // half a snorm step, plus float rounding of the scale and the center
+            float step = extent[k] / 32767.0f;
+            positionsClose = positionsClose && fabsf(decoded[i].position[k] - vertices[i].position[k]) <= 0.5f * step + 1e-6f * extent[k];
+        }
+        for (int k = 0; k < 4; ++k)
+        {
+            colorsClose = colorsClose && fabsf(decoded[i].color[k] - vertices[i].color[k]) <= 0.5f / 255.0f + 1e-6f;
+        }
+    }
+    ZW_CHECK(positionsClose);
+    ZW_CHECK(colorsClose);
+}
+
+ZW_TEST(DequantizationMatrixTakesSnormBackToMeshSpace)
+{
+    const float center[3] = { 1.0f, -2.0f, 0.5f };
+    const float extent[3] = { 4.0f, 0.25f, 3.0f };
+    float matrix[16];
+    GetDequantizationMatrix(center, extent, matrix);
+
+    // row vector times matrix, the way the shader applies it in front of the world matrix
+    const float snorm[4] = { 1.0f, -1.0f, 0.5f, 1.0f };
+    float result[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        result[c] = snorm[0] * matrix[0 * 4 + c] + snorm[1] * matrix[1 * 4 + c] + snorm[2] * matrix[2 * 4 + c] + snorm[3] * matrix[3 * 4 + c];
+    }
+    ZW_CHECK_NEAR(result[0], 5.0f, 1e-6f);
+    ZW_CHECK_NEAR(result[1], -2.25f, 1e-6f);
+    ZW_CHECK_NEAR(result[2], 2.0f, 1e-6f);
+    ZW_CHECK_NEAR(result[3], 1.0f, 1e-6f);
+}
+
+ZW_TEST(FlatAxisStoresZero)
+{
+    // a quad in the xy plane: z has no extent
+    Vertex vertices[4] = {
+        { { -1.0f, -1.0f, 2.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+        { { 1.0f, -1.0f, 2.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+        { { 1.0f, 1.0f, 2.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+        { { -1.0f, 1.0f, 2.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+    };
+    float center[3], extent[3];
+    ComputeAabb(vertices, 4, sizeof(Vertex), center, extent);
+    ZW_CHECK_EQUAL(extent[2], 0.0f);
+    for (size_t l = 0; l < sizeof(Levels) / sizeof(Levels[0]); ++l)
+    {
+        QuantizedVertex encoded[4];
+        Vertex decoded[4];
+        QuantizeVertices(encoded, vertices[0].position, sizeof(Vertex), vertices[0].color, sizeof(Vertex), 4, center, extent, Levels[l]);
+        DequantizeVertices(decoded[0].position, sizeof(Vertex), decoded[0].color, sizeof(Vertex), encoded, 4, center, extent, Levels[l]);
+        for (int i = 0; i < 4; ++i)
+        {
+            ZW_CHECK_EQUAL(encoded[i].position[2], 0);
+            ZW_CHECK_EQUAL(decoded[i].position[2], 2.0f);
+            ZW_CHECK_EQUAL(decoded[i].position[0], vertices[i].position[0]);
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include "TestFramework.h"
+#include "WvpBatch.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+    std::vector<float> RandomMatrices(uint32_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+        std::vector<float> matrices(count * 16);
+        for (size_t i = 0; i < matrices.size(); ++i)
+        {
+            matrices[i] = value(random);
+        }
+        return matrices;
+    }
+
+    // transpose(local * world * viewProj) in double precision
+    void ReferenceWvp(const float* local, const float* world, const float* viewProj, double* out)
+    {
+        double localWorld[16];
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                double sum = 0.0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    sum += (local ? local[row * 4 + k] : (row == k ? 1.0 : 0.0)) * world[k * 4 + col];
+                }
+                localWorld[row * 4 + col] = sum;
+            }
+        }
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                double sum = 0.0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    sum += localWorld[row * 4 + k] * viewProj[k * 4 + col];
+                }
+                out[col * 4 + row] = sum;
+            }
+        }
+    }
+
+    // every level against the reference, for odd counts so the wide kernels run their tails
+    void CheckAllLevels(bool withIndices, bool withLocal, uint32_t stride)
+    {
+        const uint32_t worldCount = 37;
+        const uint32_t count = 29;
+        std::vector<float> world = RandomMatrices(worldCount, 1);
+        std::vector<float> viewProj = RandomMatrices(1, 2);
+        std::vector<float> local = RandomMatrices(1, 3);
+        std::vector<uint32_t> indices(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            indices[i] = (i * 7 + 3) % worldCount;
+        }
+
+        for (size_t l = 0; l < sizeof(Levels) / sizeof(Levels[0]); ++l)
+        {
+            // bytes between the results must stay untouched
+            std::vector<uint8_t> output((size_t)count * stride, 0xcd);
+            ComputeWvpBatch(world.data(), withIndices ? indices.data() : nullptr, count, withLocal ? local.data() : nullptr,
+                viewProj.data(), output.data(), stride, Levels[l]);
+
+            bool close = true, paddingKept = true;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                double expected[16];
+                ReferenceWvp(withLocal ? local.data() : nullptr, &world[16 * (withIndices ? indices[i] : i)], viewProj.data(), expected);
+                float actual[16];
+                memcpy(actual, &output[(size_t)i * stride], sizeof(actual));
+                for (int k = 0; k < 16; ++k)
+                {
+                    close = close && fabs(actual[k] - expected[k]) <= 1e-4 * (1.0 + fabs(expected[k]));
+                }
+                for (uint32_t b = 64; b < stride; ++b)
+                {
+                    paddingKept = paddingKept && output[(size_t)i * stride + b] == 0xcd;
+                }
+            }
+            ZW_CHECK(close);
+            ZW_CHECK(paddingKept);
+        }
+    }
+}
+
+ZW_TEST(EveryLevelMatchesTheReference)
+{
+    CheckAllLevels(false, false, 64);
+}
+
+ZW_TEST(EveryLevelMatchesTheReferenceThroughIndices)
+{
+    CheckAllLevels(true, false, 64);
+}
+
+ZW_TEST(EveryLevelAppliesTheLocalMatrix)
+{
+    CheckAllLevels(true, true, 64);
+}
+
+ZW_TEST(EveryLevelKeepsTheConstantBufferStride)
+{
+    CheckAllLevels(true, true, 256);
+}
+
+ZW_TEST(ScalarAndSimdAgree)
+{
+    // the paths only differ by rounding (fma on avx2)
+    const uint32_t count = 1000;
+    std::vector<float> world = RandomMatrices(count, 4);
+    std::vector<float> viewProj = RandomMatrices(1, 5);
+    std::vector<float> scalar(count * 16), simd(count * 16);
+    ComputeWvpBatch(world.data(), nullptr, count, nullptr, viewProj.data(), (uint8_t*)scalar.data(), 64, SimdLevel::Scalar);
+    ComputeWvpBatch(world.data(), nullptr, count, nullptr, viewProj.data(), (uint8_t*)simd.data(), 64);
+    float maxDifference = 0.0f;
+    for (size_t i = 0; i < scalar.size(); ++i)
+    {
+        float difference = fabsf(scalar[i] - simd[i]);
+        maxDifference = difference > maxDifference ? difference : maxDifference;
+    }
+    ZW_CHECK(maxDifference < 1e-4f);
+}
+
+ZW_TEST(EmptyBatchWritesNothing)
+{
+    std::vector<float> viewProj = RandomMatrices(1, 6);
+    uint8_t output[64];
+    memset(output, 0xcd, sizeof(output));
+    ComputeWvpBatch(viewProj.data(), nullptr, 0, nullptr, viewProj.data(), output, 64);
+    bool untouched = true;
+    for (size_t i = 0; i < sizeof(output); ++i)
+    {
+        untouched = untouched && output[i] == 0xcd;
+    }
+    ZW_CHECK(untouched);
+}
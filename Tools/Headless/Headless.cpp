@@ -0,0 +1,294 @@
+// Headless: runs the scene's frame loop without a window or a gpu, on the null backend.
+//
+//   Headless [--frames N] [--grid N] [--threads N] [--no-instancing] [--descriptor-tables] [--meshlets N]
+//            [--float-vertices] [--mesh file.zwmesh] [--texture file.dds] [--software out.png]
+//
+// With --software the frames are drawn by SoftwareRenderBackend and the last one is written to
+// out.png, it fails if nothing but the clear color ended up in it.
+//
+// Every frame goes through the same calls as the windows main loop (BeginFrame, UpdateScene,
+// RecordScene, EndFrame), the simulation advances one fixed step per frame so runs are
+// repeatable. The command stream of every frame is checked for the shape RecordScene promises,
+// the exit code is non zero if a frame fails or doesn't match. At the end the frame time
+// percentiles (GameTimer::FrameTimes) are printed, and with --texture how many frames it took until
+// every mip of the streamed texture was uploaded. With --meshlets (per draw only) the cube is cut into
+// meshlets of N triangles and the share of them culled by frustum and normal cone is printed too.
+//
+// Built by CMakeLists.txt at the repository root, ctest runs it as HeadlessNull and HeadlessSoftware.
+
+#include "GameTimer.h"
+#include "JobSystem.h"
+#include "NullRenderBackend.h"
+#include "PngWriter.h"
+#include "Scene.h"
+#include "SoftwareRenderBackend.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t frames;
+        uint32_t threads; // 0 for one per core
+        int width;
+        int height;
+        SceneSettings scene;
+        const char* pngPath; // draw on the software backend and write the last frame here, null for the null backend
+    };
+
+    bool ParseOptions(int argc, char** argv, Options* options)
+    {
+        options->frames = 100;
+        options->threads = 0;
+        options->width = 800;
+        options->height = 600;
+        options->scene.gridCubeCount = 0;
+        options->scene.instanced = true;
+        options->scene.descriptorTables = false;
+        options->scene.meshletPrimitives = 0;
+        options->scene.quantizedVertices = true;
+        options->scene.meshPath = nullptr;
+        options->scene.texturePath = nullptr;
+        options->pngPath = nullptr;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* option = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(option, "--no-instancing") == 0)
+            {
+                options->scene.instanced = false;
+            }
+            else if (strcmp(option, "--descriptor-tables") == 0)
+            {
+                options->scene.descriptorTables = true;
+            }
+            else if (strcmp(option, "--float-vertices") == 0)
+            {
+                options->scene.quantizedVertices = false;
+            }
+            else if (value && strcmp(option, "--frames") == 0)
+            {
+                options->frames = (uint32_t)strtoul(value, nullptr, 10);
+                ++i;
+            }
+            else if (value && strcmp(option, "--meshlets") == 0)
+            {
+                options->scene.meshletPrimitives = (uint32_t)strtoul(value, nullptr, 10);
+                ++i;
+            }
+            else if (value && strcmp(option, "--grid") == 0)
+            {
+                options->scene.gridCubeCount = (uint32_t)strtoul(value, nullptr, 10);
+                ++i;
+            }
+            else if (value && strcmp(option, "--threads") == 0)
+            {
+                options->threads = (uint32_t)strtoul(value, nullptr, 10);
+                ++i;
+            }
+            else if (value && strcmp(option, "--mesh") == 0)
+            {
+                options->scene.meshPath = value;
+                ++i;
+            }
+            else if (value && strcmp(option, "--texture") == 0)
+            {
+                options->scene.texturePath = value;
+                ++i;
+            }
+            else if (value && strcmp(option, "--software") == 0)
+            {
+                options->pngPath = value;
+                ++i;
+            }
+            else
+            {
+                fprintf(stderr, "unknown option %s\n", option);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // a frame is the opening barrier and clears, then per command list the state RecordDraws sets and
+    // its draws, the closing barrier and the present. returns the number of draw calls, -1 if the
+    // stream doesn't look like that
+    int CheckFrame(const RenderCommand* commands, size_t count, ResourceHandle backBuffer, int backBufferIndex)
+    {
+        if (count < 5 || commands[0].type != RenderCommandType::ResourceBarrier || commands[0].barrier.resource != backBuffer ||
+            commands[0].barrier.before != ResourceState::Present || commands[0].barrier.after != ResourceState::RenderTarget ||
+            commands[1].type != RenderCommandType::ClearRenderTarget || commands[2].type != RenderCommandType::ClearDepth)
+        {
+            return -1;
+        }
+
+        const RenderCommand& close = commands[count - 2];
+        const RenderCommand& present = commands[count - 1];
+        if (close.type != RenderCommandType::ResourceBarrier || close.barrier.resource != backBuffer ||
+            close.barrier.before != ResourceState::RenderTarget || close.barrier.after != ResourceState::Present ||
+            present.type != RenderCommandType::Present || present.backBufferIndex != backBufferIndex)
+        {
+            return -1;
+        }
+
+        // every draw comes after a pipeline, both buffers and a wvp source were bound on its list
+        int draws = 0;
+        bool pipeline = false, vertexBuffer = false, indexBuffer = false, wvp = false;
+        for (size_t i = 3; i < count - 2; ++i)
+        {
+            switch (commands[i].type)
+            {
+            case RenderCommandType::SetRenderTarget:
+                pipeline = vertexBuffer = indexBuffer = wvp = false; // a new command list starts
+                break;
+            case RenderCommandType::SetPipeline:
+                pipeline = true;
+                break;
+            case RenderCommandType::SetVertexBuffer:
+                vertexBuffer = true;
+                break;
+            case RenderCommandType::SetIndexBuffer:
+                indexBuffer = true;
+                break;
+            case RenderCommandType::SetGraphicsRootConstantBufferView:
+            case RenderCommandType::SetGraphicsRootShaderResourceView:
+            case RenderCommandType::SetGraphicsRootDescriptorTable:
+                wvp = true;
+                break;
+            case RenderCommandType::DrawIndexedInstanced:
+                if (!pipeline || !vertexBuffer || !indexBuffer || !wvp)
+                {
+                    return -1;
+                }
+                draws += 1;
+                break;
+            case RenderCommandType::Present:
+                return -1;
+            default:
+                break;
+            }
+        }
+        return draws;
+    }
+
+    // pixels of the rgba8 image that aren't the clear color RecordScene uses
+    uint64_t CountDrawnPixels(const uint8_t* pixels, uint32_t width, uint32_t height)
+    {
+        const uint8_t clear[4] = { 0, 51, 102, 255 };
+        uint64_t drawn = 0;
+        for (uint64_t i = 0; i < (uint64_t)width * height; ++i)
+        {
+            drawn += memcmp(pixels + i * 4, clear, 4) != 0 ? 1 : 0;
+        }
+        return drawn;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        fprintf(stderr, "usage: Headless [--frames N] [--grid N] [--threads N] [--no-instancing] [--descriptor-tables] [--meshlets N]\n"
+            "                [--float-vertices] [--mesh file] [--texture file] [--software out.png]\n");
+        return 1;
+    }
+
+    JobSystem jobs(options.threads);
+    NullRenderBackend nullBackend;
+    SoftwareRenderBackend softwareBackend(&jobs);
+    NullRenderBackend& backend = options.pngPath ? softwareBackend : nullBackend;
+    if (!backend.Init(options.width, options.height) || !InitScene(&backend, &jobs, options.width, options.height, options.scene))
+    {
+        fprintf(stderr, "scene initialization failed\n");
+        return 1;
+    }
+    backend.ClearCommands();
+
+    GameTimer timer;
+    timer.Reset();
+    uint64_t drawCalls = 0;
+    uint64_t commandCount = 0;
+    uint64_t testedMeshlets = 0, frustumCulledMeshlets = 0, coneCulledMeshlets = 0;
+    uint32_t textureFrames = 0; // frames until the last mip was uploaded, 0 while it wasn't
+    int lastBackBuffer = -1;
+    for (uint32_t frame = 0; frame < options.frames; ++frame)
+    {
+        SimulateScene(1.0f / 120.0f);
+
+        const int backBufferIndex = backend.GetFrameIndex();
+        if (!backend.BeginFrame() || !UpdateScene(&backend, 1.0f) || !RecordScene(&backend) || !backend.EndFrame())
+        {
+            fprintf(stderr, "frame %u failed\n", frame);
+            return 1;
+        }
+
+        const std::vector<RenderCommand>& commands = backend.GetCommands();
+        int draws = CheckFrame(commands.data(), commands.size(), backend.GetBackBuffer(backBufferIndex), backBufferIndex);
+        if (draws < 0)
+        {
+            fprintf(stderr, "frame %u: unexpected command stream\n", frame);
+            return 1;
+        }
+        drawCalls += (uint64_t)draws;
+        SceneMeshletStats meshlets = GetSceneMeshletStats();
+        testedMeshlets += meshlets.testedMeshlets;
+        frustumCulledMeshlets += meshlets.frustumCulled;
+        coneCulledMeshlets += meshlets.coneCulled;
+        lastBackBuffer = backBufferIndex;
+        commandCount += commands.size();
+        backend.ClearCommands();
+        if (textureFrames == 0 && GetSceneTextureStats().uploadedMip == 0)
+        {
+            textureFrames = frame + 1;
+        }
+
+        // one sample per frame, from the end of the last one
+        timer.Tick();
+    }
+    // the back buffer is only written by the software backend
+    if (options.pngPath && lastBackBuffer >= 0)
+    {
+        const uint8_t* pixels = backend.GetResourceData(backend.GetBackBuffer(lastBackBuffer));
+        const uint64_t drawn = CountDrawnPixels(pixels, options.width, options.height);
+        if (!WritePng(options.pngPath, pixels, options.width, options.height, options.width * 4))
+        {
+            fprintf(stderr, "can't write %s\n", options.pngPath);
+            return 1;
+        }
+        printf("wrote %s, %llu of %u pixels drawn\n", options.pngPath, (unsigned long long)drawn, options.width * options.height);
+        if (drawn == 0)
+        {
+            fprintf(stderr, "the last frame is only the clear color\n");
+            return 1;
+        }
+    }
+
+    ShutdownScene();
+    backend.Shutdown();
+
+    printf("%u frames, %llu commands, %llu draw calls on %u threads\n", options.frames, (unsigned long long)commandCount,
+        (unsigned long long)drawCalls, jobs.GetThreadCount());
+
+    if (testedMeshlets > 0)
+    {
+        printf("meshlets: %llu tested, %.1f%% outside the frustum, %.1f%% facing away\n", (unsigned long long)testedMeshlets,
+            100.0 * frustumCulledMeshlets / testedMeshlets, 100.0 * coneCulledMeshlets / testedMeshlets);
+    }
+
+    SceneTextureStats texture = GetSceneTextureStats();
+    if (texture.mipCount > 0)
+    {
+        printf("texture: %u of %u mips uploaded (%.2f MB in %u uploads), the last one in frame %u\n",
+            texture.mipCount - texture.uploadedMip, texture.mipCount, texture.uploadedBytes / 1e6, texture.uploadCount, textureFrames);
+    }
+
+    // the cpu time of a frame, there is no gpu or vsync to wait for
+    FrameTimeStats stats = timer.FrameTimes().Stats();
+    printf("frame time over the last %u frames: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms, average %.3f ms\n",
+        stats.sampleCount, stats.p50 * 1000.0, stats.p95 * 1000.0, stats.p99 * 1000.0, stats.max * 1000.0, stats.average * 1000.0);
+    return 0;
+}
@@ -0,0 +1,115 @@
+// MeshConverter: turns a wavefront .obj into the engine's binary mesh file (ZWEngine/MeshFile.h).
+//
+//   MeshConverter input.obj output.zwmesh [--float]
+//
+// Everything the engine would otherwise do at load time happens here once: the triangles are
+// reordered for the vertex cache and overdraw, the vertices by first use, positions and colors are
+// quantized (PositionColorQuantized, --float keeps PositionColor) and the indices narrowed to 16
+// bits, cut into submeshes if the mesh has more than 65536 vertices.
+//
+// Only positions, the common "v x y z r g b" color extension and faces are read, see ObjParser.h.
+//
+// Not part of the engine project, CMakeLists.txt at the repository root builds it against the
+// portable engine library (target MeshConverter).
+
+#include "FrustumCulling.h"
+#include "IndexNarrowing.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "VertexQuantization.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: MeshConverter input.obj output.zwmesh [--float]\n");
+        return 1;
+    }
+    const bool quantize = !(argc > 3 && strcmp(argv[3], "--float") == 0);
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input)
+    {
+        fprintf(stderr, "can't open %s\n", argv[1]);
+        return 1;
+    }
+    std::stringstream text;
+    text << input.rdbuf();
+
+    std::vector<ObjVertex> vertices;
+    std::vector<uint32_t> indices;
+    if (!ParseObj(text.str().c_str(), &vertices, &indices) || indices.empty())
+    {
+        fprintf(stderr, "no triangles in %s\n", argv[1]);
+        return 1;
+    }
+    const uint32_t indexCount = (uint32_t)indices.size();
+    const uint32_t objVertexCount = (uint32_t)vertices.size();
+    const float acmrBefore = AnalyzeVertexCache(indices.data(), indexCount, objVertexCount).acmr;
+
+    // the same order MeshOptimizer.h recommends, unused vertices are dropped by the last step
+    OptimizeVertexCache(indices.data(), indices.data(), indexCount, objVertexCount);
+    std::vector<uint32_t> ordered(indexCount);
+    OptimizeOverdraw(ordered.data(), indices.data(), indexCount, vertices[0].position, sizeof(ObjVertex), objVertexCount, 1.05f);
+    std::vector<ObjVertex> fetchOrdered(objVertexCount);
+    const uint32_t vertexCount = OptimizeVertexFetch(fetchOrdered.data(), ordered.data(), indexCount, vertices.data(),
+        objVertexCount, sizeof(ObjVertex));
+    const float acmrAfter = AnalyzeVertexCache(ordered.data(), indexCount, vertexCount).acmr;
+
+    MeshFileInfo mesh;
+    memset(&mesh, 0, sizeof(mesh));
+    ComputeAabb(fetchOrdered[0].position, vertexCount, sizeof(ObjVertex), mesh.boundsCenter, mesh.boundsExtent);
+
+    // the vertices the way the input layout reads them
+    std::vector<uint8_t> packed;
+    if (quantize)
+    {
+        packed.resize((size_t)vertexCount * sizeof(QuantizedVertex));
+        QuantizeVertices((QuantizedVertex*)packed.data(), fetchOrdered[0].position, sizeof(ObjVertex), fetchOrdered[0].color,
+            sizeof(ObjVertex), vertexCount, mesh.boundsCenter, mesh.boundsExtent);
+        mesh.vertexLayout = VertexLayout::PositionColorQuantized;
+        mesh.vertexStride = sizeof(QuantizedVertex);
+    }
+    else
+    {
+        packed.assign((const uint8_t*)fetchOrdered.data(), (const uint8_t*)(fetchOrdered.data() + vertexCount));
+        mesh.vertexLayout = VertexLayout::PositionColor;
+        mesh.vertexStride = sizeof(ObjVertex);
+    }
+
+    std::vector<uint16_t> indices16;
+    std::vector<uint8_t> vertices16;
+    std::vector<Submesh> submeshes;
+    BuildIndexBuffer16(ordered.data(), indexCount, packed.data(), vertexCount, mesh.vertexStride, &indices16, &vertices16, &submeshes);
+
+    mesh.vertexCount = (uint32_t)(vertices16.size() / mesh.vertexStride);
+    mesh.vertices.data = vertices16.data();
+    mesh.vertices.size = vertices16.size();
+    mesh.indexFormat = IndexFormat::UInt16;
+    mesh.indexCount = (uint32_t)indices16.size();
+    mesh.indices.data = (const uint8_t*)indices16.data();
+    mesh.indices.size = indices16.size() * sizeof(uint16_t);
+    mesh.submeshes = submeshes.data();
+    mesh.submeshCount = (uint32_t)submeshes.size();
+
+    if (!WriteMeshFile(argv[2], mesh))
+    {
+        fprintf(stderr, "can't write %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("%u triangles, %u vertices in %u submeshes, acmr %.3f -> %.3f\n", indexCount / 3, mesh.vertexCount, mesh.submeshCount,
+        acmrBefore, acmrAfter);
+    printf("%llu bytes of vertices and indices (%llu as 32 bit floats and indices)\n",
+        (unsigned long long)(mesh.vertices.size + mesh.indices.size),
+        (unsigned long long)((uint64_t)vertexCount * sizeof(ObjVertex) + (uint64_t)indexCount * sizeof(uint32_t)));
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "ObjParser.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// the 1 based (or negative, counted from the end) vertex index of a face corner "v/vt/vn"
+static bool ParseFaceIndex(const char** cursor, uint32_t vertexCount, uint32_t* index)
+{
+    char* end;
+    long value = strtol(*cursor, &end, 10);
+    if (end == *cursor)
+    {
+        return false;
+    }
+    while (*end && *end != ' ' && *end != '\t' && *end != '\r' && *end != '\n')
+    {
+        ++end; // texture coordinate and normal indices
+    }
+    *cursor = end;
+
+    long resolved = value < 0 ? (long)vertexCount + value : value - 1;
+    if (resolved < 0 || resolved >= (long)vertexCount)
+    {
+        return false;
+    }
+    *index = (uint32_t)resolved;
+    return true;
+}
+
+bool ParseObj(const char* text, std::vector<ObjVertex>* vertices, std::vector<uint32_t>* indices)
+{
+    const char* line = text;
+    uint32_t lineNumber = 1;
+    while (*line)
+    {
+        const char* next = strchr(line, '\n');
+        next = next ? next + 1 : line + strlen(line);
+
+        if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t'))
+        {
+            // x y z, optionally followed by r g b
+            ObjVertex vertex = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+            const char* cursor = line + 2;
+            float values[6];
+            int count = 0;
+            while (count < 6)
+            {
+                char* end;
+                values[count] = strtof(cursor, &end);
+                if (end == cursor || end > next)
+                {
+                    break;
+                }
+                cursor = end;
+                ++count;
+            }
+            if (count < 3)
+            {
+                fprintf(stderr, "line %u: vertex without a position\n", lineNumber);
+                return false;
+            }
+            vertex.position[0] = values[0];
+            vertex.position[1] = values[1];
+            vertex.position[2] = -values[2];
+            if (count == 6)
+            {
+                vertex.color[0] = values[3];
+                vertex.color[1] = values[4];
+                vertex.color[2] = values[5];
+            }
+            vertices->push_back(vertex);
+        }
+        else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t'))
+        {
+            // a fan around the first corner
+            uint32_t corners[3];
+            uint32_t count = 0;
+            const char* cursor = line + 2;
+            for (;;)
+            {
+                while (*cursor == ' ' || *cursor == '\t')
+                {
+                    ++cursor;
+                }
+                if (cursor >= next || *cursor == '\r' || *cursor == '\n' || *cursor == '\0')
+                {
+                    break;
+                }
+                uint32_t index;
+                if (!ParseFaceIndex(&cursor, (uint32_t)vertices->size(), &index))
+                {
+                    fprintf(stderr, "line %u: bad face index\n", lineNumber);
+                    return false;
+                }
+                if (count < 3)
+                {
+                    corners[count++] = index;
+                }
+                else
+                {
+                    corners[1] = corners[2];
+                    corners[2] = index;
+                }
+                if (count == 3)
+                {
+                    indices->insert(indices->end(), corners, corners + 3);
+                }
+            }
+        }
+
+        line = next;
+        ++lineNumber;
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Wavefront .obj reader of MeshConverter, shared with the benchmark that compares loading the text
+// against the binary mesh file.
+
+// float3 position, float4 color, the engine's PositionColor layout
+struct ObjVertex
+{
+    float position[3];
+    float color[4];
+};
+
+// Only positions, the common "v x y z r g b" color extension and faces are read; polygons are
+// fanned into triangles. .obj is right handed with counter clockwise front faces, z is negated,
+// which makes it left handed with clockwise front faces like the engine. Vertices without a color
+// are white. false, with the line written to stderr, for a vertex without a position or a face
+// index that isn't a vertex defined before it
+bool ParseObj(const char* text, std::vector<ObjVertex>* vertices, std::vector<uint32_t>* indices);
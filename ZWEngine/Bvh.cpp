@@ -0,0 +1,564 @@
+#include "Bvh.h"
+#include <cfloat>
+#include <cmath>
+
+static const uint32_t MaxLeafItems = 4; // leaves may be larger when splitting doesn't pay off
+static const uint32_t MaxDepth = 48; // nodes this deep stay leaves, so the query stacks can't overflow
+static const uint32_t SahBinCount = 16;
+static const float TraversalCost = 1.0f; // cost of visiting a node relative to testing one item
+
+static inline float SurfaceArea(const float minimum[3], const float maximum[3])
+{
+    float x = maximum[0] - minimum[0];
+    float y = maximum[1] - minimum[1];
+    float z = maximum[2] - minimum[2];
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+namespace
+{
+
+struct Bounds
+{
+    float minimum[3];
+    float maximum[3];
+    uint32_t count;
+
+    void Clear()
+    {
+        minimum[0] = minimum[1] = minimum[2] = FLT_MAX;
+        maximum[0] = maximum[1] = maximum[2] = -FLT_MAX;
+        count = 0;
+    }
+
+    void Grow(const float boxMinimum[3], const float boxMaximum[3])
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            minimum[c] = boxMinimum[c] < minimum[c] ? boxMinimum[c] : minimum[c];
+            maximum[c] = boxMaximum[c] > maximum[c] ? boxMaximum[c] : maximum[c];
+        }
+    }
+
+    float Area() const
+    {
+        return count ? SurfaceArea(minimum, maximum) : 0.0f;
+    }
+};
+
+}
+
+static inline bool Overlaps(const float minimumA[3], const float maximumA[3], const float minimumB[3], const float maximumB[3])
+{
+    return minimumA[0] <= maximumB[0] && maximumA[0] >= minimumB[0] &&
+        minimumA[1] <= maximumB[1] && maximumA[1] >= minimumB[1] &&
+        minimumA[2] <= maximumB[2] && maximumA[2] >= minimumB[2];
+}
+
+// tests the planes in "planeMask" and clears the ones the box is completely in front of.
+// false if the box is completely behind one of them
+static inline bool TestPlanes(const Frustum& frustum, const float minimum[3], const float maximum[3], uint32_t* planeMask)
+{
+    float center[3], extent[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        center[c] = 0.5f * (minimum[c] + maximum[c]);
+        extent[c] = 0.5f * (maximum[c] - minimum[c]);
+    }
+
+    for (int p = 0; p < 6; ++p)
+    {
+        if (!(*planeMask & (1u << p)))
+        {
+            continue;
+        }
+        const float* plane = frustum.planes[p];
+        float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+        float radius = fabsf(plane[0]) * extent[0] + fabsf(plane[1]) * extent[1] + fabsf(plane[2]) * extent[2];
+        if (distance + radius < 0.0f)
+        {
+            return false;
+        }
+        if (distance - radius >= 0.0f)
+        {
+            *planeMask &= ~(1u << p);
+        }
+    }
+    return true;
+}
+
+// distance at which the ray enters the box (slab test), or false if it misses it within [0, maxDistance]
+static inline bool IntersectRay(const float origin[3], const float inverseDirection[3], float maxDistance,
+    const float minimum[3], const float maximum[3], float* distance)
+{
+    float enter = 0.0f;
+    float exit = maxDistance;
+    for (int c = 0; c < 3; ++c)
+    {
+        float t0 = (minimum[c] - origin[c]) * inverseDirection[c];
+        float t1 = (maximum[c] - origin[c]) * inverseDirection[c];
+        if (t0 > t1)
+        {
+            float t = t0;
+            t0 = t1;
+            t1 = t;
+        }
+        enter = t0 > enter ? t0 : enter;
+        exit = t1 < exit ? t1 : exit;
+    }
+    *distance = enter;
+    return enter <= exit;
+}
+
+static inline float Center(const float minimum[3], const float maximum[3], int axis)
+{
+    return 0.5f * (minimum[axis] + maximum[axis]);
+}
+
+Bvh::Bvh()
+    : mSahCost(0.0f)
+{
+}
+
+void Bvh::CopyItemBoxes(const AabbArrays& boxes)
+{
+    mItemBoxes.resize(mItems.size());
+    for (uint32_t i = 0; i < mItems.size(); ++i)
+    {
+        uint32_t item = mItems[i];
+        ItemBox& box = mItemBoxes[i];
+        box.minimum[0] = boxes.centerX[item] - boxes.extentX[item];
+        box.minimum[1] = boxes.centerY[item] - boxes.extentY[item];
+        box.minimum[2] = boxes.centerZ[item] - boxes.extentZ[item];
+        box.maximum[0] = boxes.centerX[item] + boxes.extentX[item];
+        box.maximum[1] = boxes.centerY[item] + boxes.extentY[item];
+        box.maximum[2] = boxes.centerZ[item] + boxes.extentZ[item];
+    }
+}
+
+void Bvh::ComputeBounds(Node& node) const
+{
+    Bounds bounds;
+    bounds.Clear();
+    for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+    {
+        bounds.Grow(mItemBoxes[i].minimum, mItemBoxes[i].maximum);
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        node.minimum[c] = bounds.minimum[c];
+        node.maximum[c] = bounds.maximum[c];
+    }
+}
+
+void Bvh::Build(const AabbArrays& boxes)
+{
+    const uint32_t count = boxes.Size();
+    mItems.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mItems[i] = i;
+    }
+    CopyItemBoxes(boxes);
+
+    mNodes.clear();
+    if (count == 0)
+    {
+        mSahCost = 0.0f;
+        return;
+    }
+    mNodes.reserve(2 * count - 1);
+
+    Node root;
+    root.firstItem = 0;
+    root.itemCount = count;
+    root.left = 0;
+    ComputeBounds(root);
+    mNodes.push_back(root);
+
+    // the nodes are split level by level in the order they were created, children are appended
+    // behind their parent. "levelEnd" is where the nodes of the next level start
+    uint32_t depth = 0;
+    uint32_t levelEnd = 1;
+    for (uint32_t node = 0; node < mNodes.size(); ++node)
+    {
+        if (node == levelEnd)
+        {
+            ++depth;
+            levelEnd = (uint32_t)mNodes.size();
+        }
+        if (depth < MaxDepth)
+        {
+            Split(node);
+        }
+    }
+    mSahCost = ComputeSahCost();
+}
+
+bool Bvh::Split(uint32_t nodeIndex)
+{
+    const Node node = mNodes[nodeIndex];
+    if (node.itemCount <= MaxLeafItems)
+    {
+        return false;
+    }
+
+    // the bins are spread over the bounds of the item centers, not of the items
+    float centerMinimum[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float centerMaximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            float center = Center(mItemBoxes[i].minimum, mItemBoxes[i].maximum, c);
+            centerMinimum[c] = center < centerMinimum[c] ? center : centerMinimum[c];
+            centerMaximum[c] = center > centerMaximum[c] ? center : centerMaximum[c];
+        }
+    }
+
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    uint32_t bestSplit = 0; // bins [0, bestSplit) go left
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = centerMaximum[axis] - centerMinimum[axis];
+        if (extent <= 0.0f)
+        {
+            continue;
+        }
+        float scale = SahBinCount / extent;
+
+        Bounds bins[SahBinCount];
+        for (uint32_t b = 0; b < SahBinCount; ++b)
+        {
+            bins[b].Clear();
+        }
+        for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+        {
+            uint32_t bin = (uint32_t)((Center(mItemBoxes[i].minimum, mItemBoxes[i].maximum, axis) - centerMinimum[axis]) * scale);
+            bin = bin < SahBinCount ? bin : SahBinCount - 1;
+            bins[bin].Grow(mItemBoxes[i].minimum, mItemBoxes[i].maximum);
+            ++bins[bin].count;
+        }
+
+        // sweep in from both ends, leftCost[s] is area * count of bins [0, s)
+        float leftCost[SahBinCount];
+        Bounds sweep;
+        sweep.Clear();
+        for (uint32_t s = 1; s < SahBinCount; ++s)
+        {
+            sweep.Grow(bins[s - 1].minimum, bins[s - 1].maximum);
+            sweep.count += bins[s - 1].count;
+            leftCost[s] = sweep.Area() * sweep.count;
+        }
+        sweep.Clear();
+        for (uint32_t s = SahBinCount - 1; s > 0; --s)
+        {
+            sweep.Grow(bins[s].minimum, bins[s].maximum);
+            sweep.count += bins[s].count;
+            float cost = leftCost[s] + sweep.Area() * sweep.count;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = s;
+            }
+        }
+    }
+
+    // visiting two children has to be cheaper than testing every item of the node
+    float area = SurfaceArea(node.minimum, node.maximum);
+    if (bestAxis < 0 || TraversalCost * area + bestCost >= area * node.itemCount)
+    {
+        return false;
+    }
+
+    // partition the node's items by bin, in place
+    float scale = SahBinCount / (centerMaximum[bestAxis] - centerMinimum[bestAxis]);
+    uint32_t middle = node.firstItem;
+    for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+    {
+        uint32_t bin = (uint32_t)((Center(mItemBoxes[i].minimum, mItemBoxes[i].maximum, bestAxis) - centerMinimum[bestAxis]) * scale);
+        bin = bin < SahBinCount ? bin : SahBinCount - 1;
+        if (bin < bestSplit)
+        {
+            uint32_t item = mItems[i];
+            mItems[i] = mItems[middle];
+            mItems[middle] = item;
+            ItemBox box = mItemBoxes[i];
+            mItemBoxes[i] = mItemBoxes[middle];
+            mItemBoxes[middle] = box;
+            ++middle;
+        }
+    }
+    if (middle == node.firstItem || middle == node.firstItem + node.itemCount)
+    {
+        return false;
+    }
+
+    Node left;
+    left.firstItem = node.firstItem;
+    left.itemCount = middle - node.firstItem;
+    left.left = 0;
+    ComputeBounds(left);
+
+    Node right;
+    right.firstItem = middle;
+    right.itemCount = node.firstItem + node.itemCount - middle;
+    right.left = 0;
+    ComputeBounds(right);
+
+    mNodes[nodeIndex].left = (uint32_t)mNodes.size();
+    mNodes.push_back(left);
+    mNodes.push_back(right);
+    return true;
+}
+
+void Bvh::Refit(const AabbArrays& boxes)
+{
+    CopyItemBoxes(boxes);
+
+    // children come after their parents, so walking backwards sees them first
+    for (uint32_t i = (uint32_t)mNodes.size(); i-- > 0;)
+    {
+        Node& node = mNodes[i];
+        if (node.left == 0)
+        {
+            ComputeBounds(node);
+            continue;
+        }
+        const Node& left = mNodes[node.left];
+        const Node& right = mNodes[node.left + 1];
+        for (int c = 0; c < 3; ++c)
+        {
+            node.minimum[c] = left.minimum[c] < right.minimum[c] ? left.minimum[c] : right.minimum[c];
+            node.maximum[c] = left.maximum[c] > right.maximum[c] ? left.maximum[c] : right.maximum[c];
+        }
+    }
+    mSahCost = ComputeSahCost();
+}
+
+float Bvh::ComputeSahCost() const
+{
+    if (mNodes.empty())
+    {
+        return 0.0f;
+    }
+
+    // the chance of visiting a node is its area relative to the root's
+    float rootArea = SurfaceArea(mNodes[0].minimum, mNodes[0].maximum);
+    if (rootArea <= 0.0f)
+    {
+        return 0.0f;
+    }
+    float cost = 0.0f;
+    for (uint32_t i = 0; i < mNodes.size(); ++i)
+    {
+        const Node& node = mNodes[i];
+        float area = SurfaceArea(node.minimum, node.maximum);
+        cost += node.left ? TraversalCost * area : area * node.itemCount;
+    }
+    return cost / rootArea;
+}
+
+void Bvh::AddSubtree(uint32_t node, std::vector<uint32_t>* items) const
+{
+    const Node& n = mNodes[node];
+    items->insert(items->end(), mItems.begin() + n.firstItem, mItems.begin() + n.firstItem + n.itemCount);
+}
+
+void Bvh::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>* items) const
+{
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    // every entry carries the planes its box may still cross. planes a node is completely in front
+    // of are not tested again below it, a node in front of all of them is accepted as a whole
+    struct Entry
+    {
+        uint32_t node;
+        uint32_t planeMask;
+    };
+    Entry stack[MaxDepth + 2];
+    uint32_t stackSize = 0;
+    stack[stackSize].node = 0;
+    stack[stackSize].planeMask = 0x3f;
+    ++stackSize;
+
+    while (stackSize > 0)
+    {
+        Entry entry = stack[--stackSize];
+        const Node& node = mNodes[entry.node];
+        if (!TestPlanes(frustum, node.minimum, node.maximum, &entry.planeMask))
+        {
+            continue;
+        }
+        if (entry.planeMask == 0)
+        {
+            AddSubtree(entry.node, items);
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+            {
+                uint32_t planeMask = entry.planeMask;
+                if (TestPlanes(frustum, mItemBoxes[i].minimum, mItemBoxes[i].maximum, &planeMask))
+                {
+                    items->push_back(mItems[i]);
+                }
+            }
+            continue;
+        }
+
+        stack[stackSize].node = node.left + 1;
+        stack[stackSize].planeMask = entry.planeMask;
+        ++stackSize;
+        stack[stackSize].node = node.left;
+        stack[stackSize].planeMask = entry.planeMask;
+        ++stackSize;
+    }
+}
+
+void Bvh::QueryAabb(const float minimum[3], const float maximum[3], std::vector<uint32_t>* items) const
+{
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    uint32_t stack[MaxDepth + 2];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = mNodes[stack[--stackSize]];
+        if (!Overlaps(node.minimum, node.maximum, minimum, maximum))
+        {
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+            {
+                if (Overlaps(mItemBoxes[i].minimum, mItemBoxes[i].maximum, minimum, maximum))
+                {
+                    items->push_back(mItems[i]);
+                }
+            }
+            continue;
+        }
+
+        stack[stackSize++] = node.left + 1;
+        stack[stackSize++] = node.left;
+    }
+}
+
+bool Bvh::Raycast(const float origin[3], const float direction[3], float maxDistance, BvhRayHit* hit) const
+{
+    if (mNodes.empty())
+    {
+        return false;
+    }
+
+    // 1 / 0 is infinity, which the slab test handles for rays parallel to an axis
+    float inverseDirection[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        inverseDirection[c] = 1.0f / direction[c];
+    }
+
+    float closest = maxDistance;
+    bool found = false;
+
+    uint32_t stack[MaxDepth + 2];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = mNodes[stack[--stackSize]];
+        float distance;
+        if (!IntersectRay(origin, inverseDirection, closest, node.minimum, node.maximum, &distance))
+        {
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+            {
+                if (IntersectRay(origin, inverseDirection, closest, mItemBoxes[i].minimum, mItemBoxes[i].maximum, &distance))
+                {
+                    closest = distance;
+                    hit->item = mItems[i];
+                    hit->distance = distance;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // visit the nearer child first, so the far one is often skipped once something was hit
+        const Node& left = mNodes[node.left];
+        const Node& right = mNodes[node.left + 1];
+        float leftDistance, rightDistance;
+        bool hitLeft = IntersectRay(origin, inverseDirection, closest, left.minimum, left.maximum, &leftDistance);
+        bool hitRight = IntersectRay(origin, inverseDirection, closest, right.minimum, right.maximum, &rightDistance);
+        if (hitLeft && hitRight)
+        {
+            bool leftFirst = leftDistance <= rightDistance;
+            stack[stackSize++] = leftFirst ? node.left + 1 : node.left;
+            stack[stackSize++] = leftFirst ? node.left : node.left + 1;
+        }
+        else if (hitLeft)
+        {
+            stack[stackSize++] = node.left;
+        }
+        else if (hitRight)
+        {
+            stack[stackSize++] = node.left + 1;
+        }
+    }
+    return found;
+}
+
+uint32_t Bvh::GetItemCount() const
+{
+    return (uint32_t)mItems.size();
+}
+
+float Bvh::GetSahCost() const
+{
+    return mSahCost;
+}
+
+BvhStats Bvh::GetStats() const
+{
+    BvhStats stats;
+    stats.nodeCount = (uint32_t)mNodes.size();
+    stats.leafCount = 0;
+    stats.depth = 0;
+    stats.sahCost = mSahCost;
+
+    // parents come first, so every node's depth is known before its children are reached
+    std::vector<uint32_t> depths(mNodes.size(), 0);
+    for (uint32_t i = 0; i < mNodes.size(); ++i)
+    {
+        const Node& node = mNodes[i];
+        if (node.left == 0)
+        {
+            ++stats.leafCount;
+            stats.depth = depths[i] > stats.depth ? depths[i] : stats.depth;
+            continue;
+        }
+        depths[node.left] = depths[i] + 1;
+        depths[node.left + 1] = depths[i] + 1;
+    }
+    return stats;
+}
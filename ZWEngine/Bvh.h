@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FrustumCulling.h"
+#include <cstdint>
+#include <vector>
+
+struct BvhRayHit
+{
+    uint32_t item; // index of the box that was hit
+    float distance; // along the ray direction, in units of its length
+};
+
+struct BvhStats
+{
+    uint32_t nodeCount;
+    uint32_t leafCount;
+    uint32_t depth; // levels below the root
+    float sahCost; // expected cost of a query, relative to testing the root box once
+};
+
+// Bounding volume hierarchy over a set of boxes (AabbArrays, indexed like the scene's objects).
+// Build splits with the surface area heuristic: the items are sorted into bins along each axis
+// and the split that minimizes area * item count of both halves wins. Every node covers a
+// contiguous range of the item order, so a subtree that is completely inside a query is
+// accepted without visiting its children. Refit recomputes the node bounds from the moved boxes
+// bottom up in one pass without changing the tree, which stays valid but loses quality as things
+// move; compare GetSahCost with the cost after the last Build to decide when to rebuild.
+class Bvh
+{
+public:
+    Bvh();
+
+    void Build(const AabbArrays& boxes);
+
+    // same boxes (same count) at new positions
+    void Refit(const AabbArrays& boxes);
+
+    // the queries append the indices of the matching boxes to "items", in tree order
+
+    // boxes that intersect the frustum
+    void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>* items) const;
+
+    // boxes that overlap [minimum, maximum]
+    void QueryAabb(const float minimum[3], const float maximum[3], std::vector<uint32_t>* items) const;
+
+    // closest box hit by origin + t * direction, 0 <= t <= maxDistance. false if nothing is hit
+    bool Raycast(const float origin[3], const float direction[3], float maxDistance, BvhRayHit* hit) const;
+
+    uint32_t GetItemCount() const; // boxes of the last Build
+    float GetSahCost() const; // of the current bounds, updated by Build and Refit
+    BvhStats GetStats() const;
+
+private:
+    struct Node
+    {
+        float minimum[3];
+        float maximum[3];
+        uint32_t firstItem; // range of mItems below this node
+        uint32_t itemCount;
+        uint32_t left; // first child, the second one is left + 1. 0 for leaves, the root is nobody's child
+    };
+
+    struct ItemBox
+    {
+        float minimum[3];
+        float maximum[3];
+    };
+
+    void CopyItemBoxes(const AabbArrays& boxes);
+    void ComputeBounds(Node& node) const;
+    bool Split(uint32_t node);
+    void AddSubtree(uint32_t node, std::vector<uint32_t>* items) const;
+    float ComputeSahCost() const;
+
+    std::vector<Node> mNodes; // root first, children always after their parent
+    std::vector<uint32_t> mItems; // box indices in tree order
+    std::vector<ItemBox> mItemBoxes; // their bounds, in the same order so leaves read them sequentially
+    float mSahCost;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+// instruction sets the cpu kernels can use. the x86 paths are compiled into every build and
+// picked at runtime, so one binary runs everywhere and uses AVX2 where it exists.
+enum class SimdLevel
+{
+    Scalar,
+    SSE2, // always there on x64
+    AVX2, // AVX2 + FMA, and an os that saves the ymm registers
+};
+
+SimdLevel GetSimdLevel(); // best level of this machine, detected once
+
+const char* GetSimdLevelName(SimdLevel level);
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ZW_SIMD_X86 1
+#endif
+
+// msvc compiles any intrinsic without flags, gcc and clang need to be told per function
+#if defined(__GNUC__) || defined(__clang__)
+#define ZW_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define ZW_TARGET_AVX2
+#endif
@@ -0,0 +1,1375 @@
+#include "D3D12RenderBackend.h"
+#include <D3Dcompiler.h>
+#include "d3dx12.h"
+
+// this will only call release if an object exists (prevents exceptions calling release on non existant objects)
+#define SAFE_RELEASE(p) { if ( (p) ) { (p)->Release(); (p) = 0; } }
+
+// buffers are placed in heaps of this size, bigger buffers get a heap of their own
+static const uint64_t bufferHeapSize = 64 * 1024 * 1024;
+
+static D3D12_RESOURCE_STATES ToD3D12State(ResourceState state)
+{
+    switch (state)
+    {
+    case ResourceState::Present: return D3D12_RESOURCE_STATE_PRESENT;
+    case ResourceState::RenderTarget: return D3D12_RESOURCE_STATE_RENDER_TARGET;
+    case ResourceState::DepthWrite: return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    case ResourceState::CopyDest: return D3D12_RESOURCE_STATE_COPY_DEST;
+    case ResourceState::VertexAndConstantBuffer: return D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+    case ResourceState::IndexBuffer: return D3D12_RESOURCE_STATE_INDEX_BUFFER;
+    case ResourceState::GenericRead: return D3D12_RESOURCE_STATE_GENERIC_READ;
+    }
+    return D3D12_RESOURCE_STATE_COMMON;
+}
+
+D3D12CommandList::D3D12CommandList()
+    : mBackend(nullptr), mList(nullptr)
+{
+}
+
+void D3D12CommandList::Bind(D3D12RenderBackend* backend, ID3D12GraphicsCommandList* list)
+{
+    mBackend = backend;
+    mList = list;
+}
+
+void D3D12CommandList::ResourceBarrier(ResourceHandle resource, ResourceState before, ResourceState after)
+{
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(mBackend->mResources[resource], ToD3D12State(before), ToD3D12State(after));
+    mList->ResourceBarrier(1, &barrier);
+}
+
+void D3D12CommandList::SetRenderTarget(int backBufferIndex)
+{
+    // here we again get the handle to our current render target view so we can set it as the render target in the output merger stage of the pipeline
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mBackend->mRtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), backBufferIndex, mBackend->mRtvDescriptorSize);
+
+    // get a handle to the depth/stencil buffer
+    CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(mBackend->mDsDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+
+    // set the render target for the output merger stage (the output of the pipeline)
+    mList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+}
+
+void D3D12CommandList::ClearRenderTarget(int backBufferIndex, const float color[4])
+{
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mBackend->mRtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), backBufferIndex, mBackend->mRtvDescriptorSize);
+    mList->ClearRenderTargetView(rtvHandle, color, 0, nullptr);
+}
+
+void D3D12CommandList::ClearDepth(float depth)
+{
+    mList->ClearDepthStencilView(mBackend->mDsDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_CLEAR_FLAG_DEPTH, depth, 0, 0, nullptr);
+}
+
+void D3D12CommandList::SetPipeline(PipelineHandle pipeline)
+{
+    const D3D12RenderBackend::Pipeline& p = mBackend->mPipelines[pipeline];
+    mList->SetGraphicsRootSignature(p.rootSignature);
+    mList->SetPipelineState(p.pipelineStateObject);
+}
+
+void D3D12CommandList::SetViewport(const Viewport& viewport)
+{
+    D3D12_VIEWPORT vp;
+    vp.TopLeftX = viewport.topLeftX;
+    vp.TopLeftY = viewport.topLeftY;
+    vp.Width = viewport.width;
+    vp.Height = viewport.height;
+    vp.MinDepth = viewport.minDepth;
+    vp.MaxDepth = viewport.maxDepth;
+    mList->RSSetViewports(1, &vp);
+}
+
+void D3D12CommandList::SetScissorRect(const ScissorRect& rect)
+{
+    D3D12_RECT r;
+    r.left = rect.left;
+    r.top = rect.top;
+    r.right = rect.right;
+    r.bottom = rect.bottom;
+    mList->RSSetScissorRects(1, &r);
+}
+
+void D3D12CommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+    (void)topology; // triangle lists are the only topology the engine draws
+    mList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+void D3D12CommandList::SetVertexBuffer(const VertexBufferView& view)
+{
+    D3D12_VERTEX_BUFFER_VIEW vbv;
+    vbv.BufferLocation = view.bufferLocation;
+    vbv.SizeInBytes = view.sizeInBytes;
+    vbv.StrideInBytes = view.strideInBytes;
+    mList->IASetVertexBuffers(0, 1, &vbv);
+}
+
+void D3D12CommandList::SetIndexBuffer(const IndexBufferView& view)
+{
+    D3D12_INDEX_BUFFER_VIEW ibv;
+    ibv.BufferLocation = view.bufferLocation;
+    ibv.SizeInBytes = view.sizeInBytes;
+    ibv.Format = view.format == IndexFormat::UInt16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    mList->IASetIndexBuffer(&ibv);
+}
+
+void D3D12CommandList::SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GpuAddress bufferLocation)
+{
+    mList->SetGraphicsRootConstantBufferView(rootParameterIndex, bufferLocation);
+}
+
+void D3D12CommandList::SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, GpuAddress bufferLocation)
+{
+    mList->SetGraphicsRootShaderResourceView(rootParameterIndex, bufferLocation);
+}
+
+void D3D12CommandList::SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, DescriptorIndex firstDescriptor)
+{
+    CD3DX12_GPU_DESCRIPTOR_HANDLE table(mBackend->mShaderDescriptorHeap->GetGPUDescriptorHandleForHeapStart(), firstDescriptor, mBackend->mShaderDescriptorSize);
+    mList->SetGraphicsRootDescriptorTable(rootParameterIndex, table);
+}
+
+void D3D12CommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    mList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+D3D12Fence::D3D12Fence()
+    : mFence(nullptr), mFenceEvent(nullptr)
+{
+}
+
+bool D3D12Fence::Init(ID3D12Device* device)
+{
+    HRESULT hr = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // create a handle to a fence event
+    mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    return mFenceEvent != nullptr;
+}
+
+void D3D12Fence::Release()
+{
+    if (mFenceEvent)
+    {
+        // close the fence event
+        CloseHandle(mFenceEvent);
+        mFenceEvent = nullptr;
+    }
+    SAFE_RELEASE(mFence);
+}
+
+ID3D12Fence* D3D12Fence::Get() const
+{
+    return mFence;
+}
+
+uint64_t D3D12Fence::GetCompletedValue() const
+{
+    return mFence ? mFence->GetCompletedValue() : 0;
+}
+
+bool D3D12Fence::WaitForValue(uint64_t value)
+{
+    if (!mFence || !mFenceEvent)
+    {
+        return false;
+    }
+
+    // if the current fence value is still less than "value", then we know the GPU has not finished executing
+    // the command queue since it has not reached the "commandQueue->Signal(fence, value)" command
+    if (mFence->GetCompletedValue() < value)
+    {
+        //˵GPUִд֡դֵȴfance event
+        // we have the fence create an event which is signaled once the fence's current value is "value"
+        HRESULT hr = mFence->SetEventOnCompletion(value, mFenceEvent);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // We will wait until the fence has triggered the event that it's current value has reached "value". once it's value
+        // has reached "value", we know the command queue has finished executing
+        WaitForSingleObject(mFenceEvent, INFINITE);
+    }
+    return true;
+}
+
+D3D12CopyQueue::D3D12CopyQueue()
+    : mBackend(nullptr), mDevice(nullptr), mQueue(nullptr), mList(nullptr), mFenceValue(0)
+{
+}
+
+bool D3D12CopyQueue::Init(D3D12RenderBackend* backend, ID3D12Device* device)
+{
+    HRESULT hr;
+
+    mBackend = backend;
+    mDevice = device;
+
+    D3D12_COMMAND_QUEUE_DESC cqDesc = {};
+    cqDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    cqDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    hr = mDevice->CreateCommandQueue(&cqDesc, IID_PPV_ARGS(&mQueue));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // the list needs an allocator to be created with, it becomes the first one of the pool
+    Allocator allocator;
+    allocator.fenceValue = 0;
+    hr = mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&allocator.allocator));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mAllocators.push_back(allocator);
+
+    hr = mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, allocator.allocator, NULL, IID_PPV_ARGS(&mList));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mList->Close();
+
+    mFenceValue = 0;
+    return mFence.Init(mDevice);
+}
+
+void D3D12CopyQueue::Release()
+{
+    for (size_t i = 0; i < mAllocators.size(); ++i)
+    {
+        SAFE_RELEASE(mAllocators[i].allocator);
+    }
+    mAllocators.clear();
+    mFence.Release();
+    SAFE_RELEASE(mList);
+    SAFE_RELEASE(mQueue);
+}
+
+ID3D12Fence* D3D12CopyQueue::GetD3D12Fence() const
+{
+    return mFence.Get();
+}
+
+bool D3D12CopyQueue::Submit(ResourceHandle source, const BufferCopy* copies, uint32_t count, const TextureCopy* textureCopies,
+    uint32_t textureCount, uint64_t* fenceValue)
+{
+    HRESULT hr;
+
+    // allocators retire in submission order, the oldest one is the only candidate
+    Allocator allocator;
+    if (!mAllocators.empty() && mAllocators.front().fenceValue <= mFence.GetCompletedValue())
+    {
+        allocator = mAllocators.front();
+        mAllocators.pop_front();
+        hr = allocator.allocator->Reset();
+    }
+    else
+    {
+        hr = mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&allocator.allocator));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = mList->Reset(allocator.allocator, NULL);
+    }
+    if (FAILED(hr))
+    {
+        allocator.allocator->Release();
+        return false;
+    }
+
+    // no barriers: the buffers are in the common state and get promoted to copy dest by the copy itself
+    ID3D12Resource* sourceResource = mBackend->mResources[source];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const BufferCopy& copy = copies[i];
+        mList->CopyBufferRegion(mBackend->mResources[copy.destination], copy.destinationOffset, sourceResource, copy.sourceOffset, copy.size);
+    }
+
+    // textures are promoted from common the same way, every subresource comes from its placed footprint
+    for (uint32_t i = 0; i < textureCount; ++i)
+    {
+        const TextureCopy& copy = textureCopies[i];
+        D3D12_TEXTURE_COPY_LOCATION destination = {};
+        destination.pResource = mBackend->mResources[copy.destination];
+        destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        destination.SubresourceIndex = copy.subresource;
+
+        D3D12_TEXTURE_COPY_LOCATION staging = {};
+        staging.pResource = sourceResource;
+        staging.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        staging.PlacedFootprint.Offset = copy.footprint.offset;
+        staging.PlacedFootprint.Footprint.Format = (DXGI_FORMAT)copy.format;
+        staging.PlacedFootprint.Footprint.Width = copy.width;
+        staging.PlacedFootprint.Footprint.Height = copy.height;
+        staging.PlacedFootprint.Footprint.Depth = copy.footprint.depth;
+        staging.PlacedFootprint.Footprint.RowPitch = copy.footprint.rowPitch;
+        mList->CopyTextureRegion(&destination, 0, 0, 0, &staging, nullptr);
+    }
+
+    hr = mList->Close();
+    if (FAILED(hr))
+    {
+        allocator.allocator->Release();
+        return false;
+    }
+
+    ID3D12CommandList* ppCommandLists[] = { mList };
+    mQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+
+    // the allocator is in use until the gpu passed this value, even if signaling fails
+    allocator.fenceValue = ++mFenceValue;
+    mAllocators.push_back(allocator);
+    hr = mQueue->Signal(mFence.Get(), mFenceValue);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    *fenceValue = mFenceValue;
+    return true;
+}
+
+GpuFence* D3D12CopyQueue::GetFence()
+{
+    return &mFence;
+}
+
+D3D12RenderBackend::D3D12RenderBackend(HWND hwnd, bool fullScreen)
+    : mHwnd(hwnd), mFullScreen(fullScreen), mWidth(0), mHeight(0), mDevice(nullptr), mSwapChain(nullptr),
+    mCommandQueue(nullptr), mRtvDescriptorHeap(nullptr), mCommandList(nullptr), mFenceValue(0), mFrameIndex(0),
+    mRtvDescriptorSize(0), mDepthStencilBuffer(nullptr), mDsDescriptorHeap(nullptr), mShaderDescriptorHeap(nullptr),
+    mShaderDescriptorSize(0),
+    mCommandListOpen(false), mCopyFenceWaited(0), mResumeList(nullptr), mParallelCount(0)
+{
+    for (int i = 0; i < frameBufferCount; ++i)
+    {
+        mCommandAllocator[i] = nullptr;
+        mResumeAllocator[i] = nullptr;
+        for (uint32_t j = 0; j < MaxParallelCommandLists; ++j)
+        {
+            mParallelAllocator[i][j] = nullptr;
+        }
+    }
+    for (uint32_t j = 0; j < MaxParallelCommandLists; ++j)
+    {
+        mParallelList[j] = nullptr;
+    }
+}
+
+bool D3D12RenderBackend::Init(int width, int height)
+{
+    HRESULT hr;
+
+    mWidth = width;
+    mHeight = height;
+
+    // -- Create the Device -- //
+
+    //Ǿȫ
+    IDXGIFactory4* dxgiFactory;
+    hr = CreateDXGIFactory1(IID_PPV_ARGS(&dxgiFactory));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    //ԴӲ
+    IDXGIAdapter1* adapter; // adapters are the graphics card (this includes the embedded graphics on the motherboard)
+
+    int adapterIndex = 0; // we'll start looking for directx 12  compatible graphics devices starting at index 0
+
+    bool adapterFound = false; // set this to true when a good one was found
+
+    // find first hardware gpu that supports d3d 12
+    while (dxgiFactory->EnumAdapters1(adapterIndex, &adapter) != DXGI_ERROR_NOT_FOUND)
+    {
+        DXGI_ADAPTER_DESC1 desc;
+        adapter->GetDesc1(&desc);
+
+        if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
+        {
+            // we dont want a software device
+            adapterIndex++;
+            continue;
+        }
+
+        // we want a device that is compatible with direct3d 12 (feature level 11 or higher)
+        // ҵһ֧level 11adapter
+        hr = D3D12CreateDevice(adapter, D3D_FEATURE_LEVEL_11_0, _uuidof(ID3D12Device), nullptr);
+        if (SUCCEEDED(hr))
+        {
+            adapterFound = true;
+            break;
+        }
+
+        adapterIndex++;
+    }
+
+    if (!adapterFound)
+    {
+        return false;
+    }
+
+    // Create the device
+    //IID_PPV_ARGS ϲΪ1
+    hr = D3D12CreateDevice(
+        adapter,
+        D3D_FEATURE_LEVEL_11_0,
+        IID_PPV_ARGS(&mDevice)
+    );
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    // -- Create the Command Queue -- //
+    //typedirectcomputecopypriorityqueueflagnodemaskGPU
+    D3D12_COMMAND_QUEUE_DESC cqDesc = {}; // we will be using all the default values
+    cqDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    cqDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+
+    hr = mDevice->CreateCommandQueue(&cqDesc, IID_PPV_ARGS(&mCommandQueue)); // create the command queue
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // -- Create the Swap Chain (double/tripple buffering) -- //
+
+    DXGI_MODE_DESC backBufferDesc = {}; // this is to describe our display mode
+    backBufferDesc.Width = mWidth; // buffer width
+    backBufferDesc.Height = mHeight; // buffer height
+    backBufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; // format of the buffer (rgba 32 bits, 8 bits for each chanel)
+
+    // describe our multi-sampling. We are not multi-sampling, so we set the count to 1 (we need at least one sample of course)
+    DXGI_SAMPLE_DESC sampleDesc = {};
+    sampleDesc.Count = 1; // multisample count (no multisampling, so we just put 1, since we still need 1 sample)
+
+    // Describe and create the swap chain.
+    DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
+    swapChainDesc.BufferCount = frameBufferCount; // number of buffers we have
+    swapChainDesc.BufferDesc = backBufferDesc; // our back buffer description
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT; // this says the pipeline will render to this swap chain
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD; // dxgi will discard the buffer (data) after we call present
+    swapChainDesc.OutputWindow = mHwnd; // handle to our window
+    swapChainDesc.SampleDesc = sampleDesc; // our multi-sampling description
+    swapChainDesc.Windowed = !mFullScreen; // set to true, then if in fullscreen must call SetFullScreenState with true for full screen to get uncapped fps
+
+    IDXGISwapChain* tempSwapChain;
+
+    hr = dxgiFactory->CreateSwapChain(
+        mCommandQueue, // the queue will be flushed once the swap chain is created
+        &swapChainDesc, // give it the swap chain description we created above
+        &tempSwapChain // store the created swap chain in a temp IDXGISwapChain interface
+    );
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    //IDXGISwapChain3ֻ֧õǰbackbuffer±
+    mSwapChain = static_cast<IDXGISwapChain3*>(tempSwapChain);
+
+    mFrameIndex = mSwapChain->GetCurrentBackBufferIndex();
+
+    // -- Create the Back Buffers (render target views) Descriptor Heap -- //
+
+    // describe an rtv descriptor heap and create
+    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+    rtvHeapDesc.NumDescriptors = frameBufferCount; // number of descriptors for this heap.
+    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV; // this heap is a render target view heap
+
+    // This heap will not be directly referenced by the shaders (not shader visible), as this will store the output from the pipeline
+    // otherwise we would set the heap's flag to D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE
+    rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    hr = mDevice->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&mRtvDescriptorHeap));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // get the size of a descriptor in this heap (this is a rtv heap, so only rtv descriptors should be stored in it.
+    // descriptor sizes may vary from device to device, which is why there is no set size and we must ask the
+    // device to give us the size. we will use this size to increment a descriptor handle offset
+    mRtvDescriptorSize = mDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+    // get a handle to the first descriptor in the descriptor heap. a handle is basically a pointer,
+    // but we cannot literally use it like a c++ pointer.
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mRtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+
+    // Create a RTV for each buffer (double buffering is two buffers, tripple buffering is 3).
+    // the back buffers take the first frameBufferCount resource handles
+    for (int i = 0; i < frameBufferCount; i++)
+    {
+        // first we get the n'th buffer in the swap chain and store it in the n'th
+        // position of our ID3D12Resource array
+        ID3D12Resource* renderTarget;
+        hr = mSwapChain->GetBuffer(i, IID_PPV_ARGS(&renderTarget));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        AddResource(renderTarget);
+
+        // the we "create" a render target view which binds the swap chain buffer (ID3D12Resource[n]) to the rtv handle
+        mDevice->CreateRenderTargetView(renderTarget, nullptr, rtvHandle);
+
+        // we increment the rtv handle by the rtv descriptor size we got above
+        rtvHandle.Offset(1, mRtvDescriptorSize);
+    }
+
+    // -- Create the Command Allocators -- //
+    for (int i = 0; i < frameBufferCount; i++)
+    {
+        hr = mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mCommandAllocator[i]));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+    }
+
+    // -- Create a Command List -- //
+
+    // create the command list with the first allocator
+    //ִʱ޷ãбֻҪһ
+    hr = mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mCommandAllocator[0], NULL, IID_PPV_ARGS(&mCommandList));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mCommandList->Close(); // opened by BeginFrame
+    mRenderCommandList.Bind(this, mCommandList);
+
+    // -- Create the parallel recording allocators and lists -- //
+
+    // every thread needs its own allocator per frame, an allocator can't be recorded into from two threads
+    for (int i = 0; i < frameBufferCount; i++)
+    {
+        for (uint32_t j = 0; j < MaxParallelCommandLists; ++j)
+        {
+            hr = mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mParallelAllocator[i][j]));
+            if (FAILED(hr))
+            {
+                return false;
+            }
+        }
+        hr = mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mResumeAllocator[i]));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+    }
+
+    // lists are created open, close them until a frame splits
+    for (uint32_t j = 0; j < MaxParallelCommandLists; ++j)
+    {
+        hr = mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mParallelAllocator[0][j], NULL, IID_PPV_ARGS(&mParallelList[j]));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        mParallelList[j]->Close();
+        mParallelCommandList[j].Bind(this, mParallelList[j]);
+    }
+    hr = mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mResumeAllocator[0], NULL, IID_PPV_ARGS(&mResumeList));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mResumeList->Close();
+    mResumeCommandList.Bind(this, mResumeList);
+
+    // -- Create a Fence & Fence Event -- //
+
+    // one fence for the queue, every submission signals the next value
+    if (!mFence.Init(mDevice))
+    {
+        return false;
+    }
+    mFenceValue = 0;
+
+    // the cpu may record up to frameBufferCount frames ahead until SetFramesInFlight says otherwise
+    mFrames.Init(&mFence, frameBufferCount);
+
+    // -- Create the Copy Queue -- //
+
+    // static buffers are uploaded on their own queue, the frames only wait for the copies on the gpu
+    if (!mCopyQueue.Init(this, mDevice))
+    {
+        return false;
+    }
+    mCopyFenceWaited = 0;
+    mUploads.Init(this, &mCopyQueue);
+
+    // heaps are created on demand, the first buffer of each type creates one
+    mStaticHeapAllocator.Init(bufferHeapSize);
+    mUploadHeapAllocator.Init(bufferHeapSize);
+
+    // Create the depth/stencil buffer
+
+    // create a depth stencil descriptor heap so we can get a pointer to the depth stencil buffer
+    D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc = {};
+    dsvHeapDesc.NumDescriptors = 1;
+    dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+    dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    hr = mDevice->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&mDsDescriptorHeap));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    D3D12_DEPTH_STENCIL_VIEW_DESC depthStencilDesc = {};
+    depthStencilDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    depthStencilDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+    depthStencilDesc.Flags = D3D12_DSV_FLAG_NONE;
+
+    //bufferʱֵ
+    D3D12_CLEAR_VALUE depthOptimizedClearValue = {};
+    depthOptimizedClearValue.Format = DXGI_FORMAT_D32_FLOAT;
+    depthOptimizedClearValue.DepthStencil.Depth = 1.0f;
+    depthOptimizedClearValue.DepthStencil.Stencil = 0;
+
+    CD3DX12_HEAP_PROPERTIES defaultHeapProperties(D3D12_HEAP_TYPE_DEFAULT);
+    CD3DX12_RESOURCE_DESC depthBufferDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, mWidth, mHeight, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+    hr = mDevice->CreateCommittedResource(
+        &defaultHeapProperties,
+        D3D12_HEAP_FLAG_NONE,
+        &depthBufferDesc,
+        D3D12_RESOURCE_STATE_DEPTH_WRITE,
+        &depthOptimizedClearValue,
+        IID_PPV_ARGS(&mDepthStencilBuffer)
+    );
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mDsDescriptorHeap->SetName(L"Depth/Stencil Resource Heap");
+
+    mDevice->CreateDepthStencilView(mDepthStencilBuffer, &depthStencilDesc, mDsDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+
+    // -- Create the Shader Visible Descriptor Heap -- //
+
+    // one heap for every descriptor the shaders read, switching heaps is expensive. persistent slots come
+    // first, then a transient range per frame context
+    mDescriptorAllocator.Init(PersistentDescriptorCount, TransientDescriptorCount);
+    D3D12_DESCRIPTOR_HEAP_DESC shaderHeapDesc = {};
+    shaderHeapDesc.NumDescriptors = mDescriptorAllocator.GetCapacity();
+    shaderHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    shaderHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    hr = mDevice->CreateDescriptorHeap(&shaderHeapDesc, IID_PPV_ARGS(&mShaderDescriptorHeap));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mShaderDescriptorHeap->SetName(L"Shader Visible Descriptor Heap");
+    mShaderDescriptorSize = mDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    SAFE_RELEASE(dxgiFactory);
+
+    return true;
+}
+
+ResourceHandle D3D12RenderBackend::AddResource(ID3D12Resource* resource)
+{
+    mResources.push_back(resource);
+    return (ResourceHandle)(mResources.size() - 1);
+}
+
+bool D3D12RenderBackend::CreatePlacedBuffer(ResourceHeapAllocator* allocator, std::vector<ID3D12Heap*>* heaps, D3D12_HEAP_TYPE heapType,
+    uint64_t size, D3D12_RESOURCE_STATES initialState, ID3D12Resource** resource)
+{
+    HRESULT hr;
+
+    CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &bufferDesc);
+
+    HeapAllocation allocation;
+    if (!allocator->Allocate(info.SizeInBytes, info.Alignment, &allocation))
+    {
+        // every heap is full, add one. buffers larger than a heap get a heap of their own
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = allocator->GetHeapSizeFor(info.SizeInBytes);
+        heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(heapType);
+        heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+        ID3D12Heap* heap;
+        hr = mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        heap->SetName(heapType == D3D12_HEAP_TYPE_UPLOAD ? L"Upload Buffer Heap" : L"Static Buffer Heap");
+        heaps->push_back(heap);
+        allocator->AddHeap(heapDesc.SizeInBytes);
+
+        if (!allocator->Allocate(info.SizeInBytes, info.Alignment, &allocation))
+        {
+            return false;
+        }
+    }
+
+    hr = mDevice->CreatePlacedResource(
+        (*heaps)[allocation.heap],
+        allocation.allocation.offset,
+        &bufferDesc,
+        initialState,
+        nullptr, // optimized clear value must be null for buffers
+        IID_PPV_ARGS(resource));
+    if (FAILED(hr))
+    {
+        allocator->Free(allocation);
+        return false;
+    }
+    return true;
+}
+
+bool D3D12RenderBackend::CreateStaticBuffer(const void* data, uint64_t size, ResourceState finalState, StaticBuffer* buffer)
+{
+    // default heap is memory on the GPU. Only the GPU has access to this memory
+    // To get data into this heap, we will have to upload the data using
+    // an upload heap
+    // the buffer starts in common: the copy queue promotes it to copy dest, after the copy it decays back
+    // to common and the direct queue promotes it to "finalState" on first use, buffers need no barriers for either
+    ID3D12Resource* defaultBuffer;
+    if (!CreatePlacedBuffer(&mStaticHeapAllocator, &mStaticHeaps, D3D12_HEAP_TYPE_DEFAULT, size, D3D12_RESOURCE_STATE_COMMON, &defaultBuffer))
+    {
+        return false;
+    }
+    (void)finalState;
+
+    // we can give resource heaps a name so when we debug with the graphics debugger we know what resource we are looking at
+    defaultBuffer->SetName(L"Static Buffer Resource Heap");
+    buffer->resource = AddResource(defaultBuffer);
+    buffer->gpuAddress = defaultBuffer->GetGPUVirtualAddress();
+    buffer->size = size;
+
+    // store buffer data in a staging page, the copy goes out with the next batch
+    return mUploads.Upload(buffer->resource, 0, data, size);
+}
+
+bool D3D12RenderBackend::CreateUploadBuffer(uint64_t size, UploadBuffer* buffer)
+{
+    HRESULT hr;
+
+    // resources are placed on 64KB boundaries anyway, so round the size up instead of wasting the tail
+    size = (size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~(uint64_t)(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+
+    // will be data that is read from so we keep it in the generic read state
+    ID3D12Resource* uploadHeap;
+    if (!CreatePlacedBuffer(&mUploadHeapAllocator, &mUploadHeaps, D3D12_HEAP_TYPE_UPLOAD, size, D3D12_RESOURCE_STATE_GENERIC_READ, &uploadHeap))
+    {
+        return false;
+    }
+    uploadHeap->SetName(L"Upload Resource Heap");
+
+    CD3DX12_RANGE readRange(0, 0);    // We do not intend to read from this resource on the CPU. (so end is less than or equal to begin)
+
+    // map the resource heap to get a cpu address to the beginning of the heap. upload heaps stay mapped for their whole lifetime
+    void* cpuAddress;
+    hr = uploadHeap->Map(0, &readRange, &cpuAddress);
+    if (FAILED(hr))
+    {
+        uploadHeap->Release();
+        return false;
+    }
+
+    buffer->resource = AddResource(uploadHeap);
+    buffer->cpuAddress = reinterpret_cast<uint8_t*>(cpuAddress);
+    buffer->gpuAddress = uploadHeap->GetGPUVirtualAddress();
+    buffer->size = size;
+    return true;
+}
+
+bool D3D12RenderBackend::CreateTexture(const TextureDesc& desc, ResourceHandle* texture)
+{
+    HRESULT hr;
+
+    TextureSubresourceLayout layout;
+    if (desc.mipCount > 0xffff || !GetTextureSubresourceLayout(desc, 0, &layout))
+    {
+        return false;
+    }
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = desc.volume ? D3D12_RESOURCE_DIMENSION_TEXTURE3D : D3D12_RESOURCE_DIMENSION_TEXTURE2D; // 1d textures are 2d ones of height 1
+    textureDesc.Alignment = 0;
+    textureDesc.Width = desc.width;
+    textureDesc.Height = desc.height;
+    textureDesc.DepthOrArraySize = (UINT16)(desc.volume ? desc.depth : desc.arraySize);
+    textureDesc.MipLevels = (UINT16)desc.mipCount;
+    textureDesc.Format = (DXGI_FORMAT)desc.format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+    // committed, the buffer heaps only take buffers. like static buffers it starts in common: the copy
+    // queue promotes it to copy dest and the direct queue to the shader resource state on first use
+    CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+    ID3D12Resource* resource;
+    hr = mDevice->CreateCommittedResource(
+        &heapProperties,
+        D3D12_HEAP_FLAG_NONE,
+        &textureDesc,
+        D3D12_RESOURCE_STATE_COMMON,
+        nullptr,
+        IID_PPV_ARGS(&resource));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    resource->SetName(L"Texture Resource Heap");
+    *texture = AddResource(resource);
+    return true;
+}
+
+bool D3D12RenderBackend::UploadTexture(ResourceHandle texture, uint32_t firstSubresource, uint32_t count,
+    const SubresourceSource* sources, JobSystem* jobs)
+{
+    if (texture >= mResources.size())
+    {
+        return false;
+    }
+
+    // the description the texture was created from, back from the resource
+    D3D12_RESOURCE_DESC resourceDesc = mResources[texture]->GetDesc();
+    TextureDesc desc;
+    desc.format = (uint32_t)resourceDesc.Format;
+    desc.width = (uint32_t)resourceDesc.Width;
+    desc.height = resourceDesc.Height;
+    desc.volume = resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+    desc.depth = desc.volume ? resourceDesc.DepthOrArraySize : 1;
+    desc.arraySize = desc.volume ? 1 : resourceDesc.DepthOrArraySize;
+    desc.mipCount = resourceDesc.MipLevels;
+    return mUploads.UploadTexture(texture, desc, firstSubresource, count, sources, jobs);
+}
+
+PipelineHandle D3D12RenderBackend::CreatePipeline(const PipelineDesc& desc)
+{
+    HRESULT hr;
+    Pipeline pipeline = {};
+
+    // create a root descriptor, which explains where to find the data for this root parameter
+    // (b0 for the constant buffer, t0 for the instance buffer of instanced pipelines)
+    D3D12_ROOT_DESCRIPTOR rootCBVDescriptor;
+    rootCBVDescriptor.RegisterSpace = 0;
+    rootCBVDescriptor.ShaderRegister = 0;
+
+    // create a root parameter and fill it out
+    D3D12_ROOT_PARAMETER  rootParameters[1]; // only one parameter right now
+    rootParameters[0].ParameterType = desc.instanced ? D3D12_ROOT_PARAMETER_TYPE_SRV : D3D12_ROOT_PARAMETER_TYPE_CBV; // a root descriptor, no descriptor heap needed
+    rootParameters[0].Descriptor = rootCBVDescriptor; // this is the root descriptor for this root parameter
+    rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX; // our pixel shader will be the only shader accessing this parameter for now
+
+    // or a table with the cbv in the shader visible heap
+    CD3DX12_DESCRIPTOR_RANGE constantBufferRange(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
+    if (desc.constantBufferTable && !desc.instanced)
+    {
+        rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        rootParameters[0].DescriptorTable.NumDescriptorRanges = 1;
+        rootParameters[0].DescriptorTable.pDescriptorRanges = &constantBufferRange;
+    }
+
+    CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Init(_countof(rootParameters), // we have 1 root parameter
+        rootParameters, // a pointer to the beginning of our root parameters array
+        0,
+        nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT | // we can deny shader stages here for better performance
+        D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+        D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+        D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS |
+        D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS);
+
+    //лΪֽ룬ٴ
+    ID3DBlob* signature;
+    hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, nullptr);
+    if (FAILED(hr))
+    {
+        return InvalidPipeline;
+    }
+
+    hr = mDevice->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&pipeline.rootSignature));
+    SAFE_RELEASE(signature);
+    if (FAILED(hr))
+    {
+        return InvalidPipeline;
+    }
+
+    // create vertex and pixel shaders
+
+    // when debugging, we can compile the shader files at runtime.
+    // but for release versions, we can compile the hlsl shaders
+    // with fxc.exe to create .cso files, which contain the shader
+    // bytecode. We can load the .cso files at runtime to get the
+    // shader bytecode, which of course is faster than compiling
+    // them at runtime
+
+    // compile vertex shader
+    ID3DBlob* vertexShader; // d3d blob for holding vertex shader bytecode
+    ID3DBlob* errorBuff; // a buffer holding the error data if any
+    const D3D_SHADER_MACRO instancedDefines[] = { { "INSTANCED", "1" }, { nullptr, nullptr } };
+    hr = D3DCompileFromFile(desc.vertexShader,
+        desc.instanced ? instancedDefines : nullptr,
+        nullptr,
+        "main",
+        "vs_5_0",
+        D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
+        0,
+        &vertexShader,
+        &errorBuff);
+    if (FAILED(hr))
+    {
+        if (errorBuff)
+        {
+            OutputDebugStringA((char*)errorBuff->GetBufferPointer());
+        }
+        SAFE_RELEASE(pipeline.rootSignature);
+        return InvalidPipeline;
+    }
+
+    // fill out a shader bytecode structure, which is basically just a pointer
+    // to the shader bytecode and the size of the shader bytecode
+    D3D12_SHADER_BYTECODE vertexShaderBytecode = {};
+    vertexShaderBytecode.BytecodeLength = vertexShader->GetBufferSize();
+    vertexShaderBytecode.pShaderBytecode = vertexShader->GetBufferPointer();
+
+    // compile pixel shader
+    ID3DBlob* pixelShader;
+    hr = D3DCompileFromFile(desc.pixelShader,
+        nullptr,
+        nullptr,
+        "main",
+        "ps_5_0",
+        D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION,
+        0,
+        &pixelShader,
+        &errorBuff);
+    if (FAILED(hr))
+    {
+        if (errorBuff)
+        {
+            OutputDebugStringA((char*)errorBuff->GetBufferPointer());
+        }
+        SAFE_RELEASE(vertexShader);
+        SAFE_RELEASE(pipeline.rootSignature);
+        return InvalidPipeline;
+    }
+
+    // fill out shader bytecode structure for pixel shader
+    D3D12_SHADER_BYTECODE pixelShaderBytecode = {};
+    pixelShaderBytecode.BytecodeLength = pixelShader->GetBufferSize();
+    pixelShaderBytecode.pShaderBytecode = pixelShader->GetBufferPointer();
+
+    // create input layout
+
+    // The input layout is used by the Input Assembler so that it knows
+    // how to read the vertex data bound to it.
+
+    D3D12_INPUT_ELEMENT_DESC positionColorLayout[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+    };
+
+    // the snorm position has a w of 1, so the shader's float4 input is the same as with the float3
+    // one. it is still relative to the mesh bounds, the wvp matrix undoes that
+    D3D12_INPUT_ELEMENT_DESC positionColorQuantizedLayout[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+    };
+
+    // fill out an input layout description structure
+    D3D12_INPUT_LAYOUT_DESC inputLayoutDesc = {};
+    switch (desc.vertexLayout)
+    {
+    case VertexLayout::PositionColor:
+        inputLayoutDesc.NumElements = _countof(positionColorLayout);
+        inputLayoutDesc.pInputElementDescs = positionColorLayout;
+        break;
+    case VertexLayout::PositionColorQuantized:
+        inputLayoutDesc.NumElements = _countof(positionColorQuantizedLayout);
+        inputLayoutDesc.pInputElementDescs = positionColorQuantizedLayout;
+        break;
+    }
+
+    // create a pipeline state object (PSO)
+
+    // In a real application, you will have many pso's. for each different shader
+    // or different combinations of shaders, different blend states or different rasterizer states,
+    // different topology types (point, line, triangle, patch), or a different number
+    // of render targets you will need a pso
+
+    DXGI_SAMPLE_DESC sampleDesc = {};
+    sampleDesc.Count = 1; // must be the same sample description as the swapchain and depth/stencil buffer
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {}; // a structure to define a pso
+    psoDesc.InputLayout = inputLayoutDesc; // the structure describing our input layout
+    psoDesc.pRootSignature = pipeline.rootSignature; // the root signature that describes the input data this pso needs
+    psoDesc.VS = vertexShaderBytecode; // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = pixelShaderBytecode; // same as VS but for pixel shader
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE; // type of topology we are drawing
+    psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM; // format of the render target
+    psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT; // format of the depth buffer bound in SetRenderTarget
+    psoDesc.SampleDesc = sampleDesc; // must be the same sample description as the swapchain and depth/stencil buffer
+    psoDesc.SampleMask = 0xffffffff; // sample mask has to do with multi-sampling. 0xffffffff means point sampling is done
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT); // a default rasterizer state.
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT); // a default blent state.
+    psoDesc.NumRenderTargets = 1; // we are only binding one render target
+    psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+
+    // create the pso
+    hr = mDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pipeline.pipelineStateObject));
+    SAFE_RELEASE(vertexShader);
+    SAFE_RELEASE(pixelShader);
+    if (FAILED(hr))
+    {
+        SAFE_RELEASE(pipeline.rootSignature);
+        return InvalidPipeline;
+    }
+
+    mPipelines.push_back(pipeline);
+    return (PipelineHandle)(mPipelines.size() - 1);
+}
+
+bool D3D12RenderBackend::FlushUploads()
+{
+    return SubmitUploads();
+}
+
+bool D3D12RenderBackend::SubmitUploads()
+{
+    if (!mUploads.Submit())
+    {
+        return false;
+    }
+
+    // batches can also go out on their own when a staging page fills up, so wait for the last one
+    // submitted. this is a gpu side wait, the cpu doesn't block
+    UINT64 lastCopy = mUploads.GetLastFenceValue();
+    if (lastCopy > mCopyFenceWaited)
+    {
+        HRESULT hr = mCommandQueue->Wait(mCopyQueue.GetD3D12Fence(), lastCopy);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        mCopyFenceWaited = lastCopy;
+    }
+    return true;
+}
+
+DescriptorIndex D3D12RenderBackend::AllocatePersistentDescriptor()
+{
+    return mDescriptorAllocator.AllocatePersistent();
+}
+
+void D3D12RenderBackend::FreePersistentDescriptor(DescriptorIndex descriptor)
+{
+    // the frames recorded so far may still read it, the slot is reused once they are done
+    mDescriptorAllocator.FreePersistent(descriptor, mFrames.GetFrameNumber());
+}
+
+bool D3D12RenderBackend::AllocateTransientDescriptors(uint32_t count, DescriptorIndex* first)
+{
+    // only while a frame is being recorded, BeginFrame picks the range
+    if (!mCommandListOpen && mParallelCount == 0)
+    {
+        return false;
+    }
+    return mDescriptorAllocator.AllocateTransient(count, first);
+}
+
+void D3D12RenderBackend::CreateConstantBufferView(DescriptorIndex descriptor, GpuAddress bufferLocation, uint32_t size)
+{
+    D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+    cbvDesc.BufferLocation = bufferLocation;
+    cbvDesc.SizeInBytes = size;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE handle(mShaderDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), descriptor, mShaderDescriptorSize);
+    mDevice->CreateConstantBufferView(&cbvDesc, handle);
+}
+
+int D3D12RenderBackend::GetFrameIndex() const
+{
+    return mFrameIndex;
+}
+
+ResourceHandle D3D12RenderBackend::GetBackBuffer(int frameIndex) const
+{
+    return (ResourceHandle)frameIndex;
+}
+
+bool D3D12RenderBackend::SetFramesInFlight(uint32_t count)
+{
+    return mFrames.SetFramesInFlight(count);
+}
+
+uint64_t D3D12RenderBackend::GetSubmittedFrameCount() const
+{
+    return mFrames.GetSubmittedFrameCount();
+}
+
+uint64_t D3D12RenderBackend::GetCompletedFrameCount() const
+{
+    return mFrames.GetCompletedFrameCount();
+}
+
+bool D3D12RenderBackend::BeginFrame()
+{
+    HRESULT hr;
+
+    // We have to wait for the gpu to finish with the frame context's command allocators before we reset them.
+    // this only blocks when the gpu is the maximum number of frames behind
+    if (!mFrames.BeginFrame())
+    {
+        return false;
+    }
+    const uint32_t context = mFrames.GetContextIndex();
+
+    // swap the current rtv buffer index so we draw on the correct buffer
+    mFrameIndex = mSwapChain->GetCurrentBackBufferIndex();
+
+    // we can only reset an allocator once the gpu is done with it
+    // resetting an allocator frees the memory that the command list was stored in
+    hr = mCommandAllocator[context]->Reset();
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // reset the command list. by resetting the command list we are putting it into
+    // a recording state so we can start recording commands into the command allocator.
+    // the command allocator that we reference here may have multiple command lists
+    // associated with it, but only one can be recording at any time. Make sure
+    // that any other command lists associated to this command allocator are in
+    // the closed state (not recording).
+    // the pipeline is set by the frame code through SetPipeline, so we pass NULL as the initial state
+    hr = mCommandList->Reset(mCommandAllocator[context], NULL);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mCommandListOpen = true;
+
+    // the frame context's transient descriptors are free again, the gpu finished the frame that used them
+    mDescriptorAllocator.BeginFrame(context, mFrames.GetCompletedFrameCount());
+    mCommandList->SetDescriptorHeaps(1, &mShaderDescriptorHeap);
+    // here we start recording commands into the commandList (which all the commands will be stored in the commandAllocator)
+    return true;
+}
+
+RenderCommandList* D3D12RenderBackend::GetCommandList()
+{
+    return mParallelCount > 0 ? &mResumeCommandList : &mRenderCommandList;
+}
+
+bool D3D12RenderBackend::BeginParallelRecording(uint32_t count)
+{
+    HRESULT hr;
+
+    if (!mCommandListOpen || mParallelCount > 0 || count == 0 || count > MaxParallelCommandLists)
+    {
+        return false;
+    }
+
+    // everything recorded so far runs first
+    hr = mCommandList->Close();
+    mCommandListOpen = false;
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // the gpu is done with this frame context's allocators, BeginFrame waited for the fence
+    const uint32_t context = mFrames.GetContextIndex();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        hr = mParallelAllocator[context][i]->Reset();
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = mParallelList[i]->Reset(mParallelAllocator[context][i], NULL);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        mParallelList[i]->SetDescriptorHeaps(1, &mShaderDescriptorHeap);
+        mParallelCount = i + 1; // so EndFrame closes the lists opened so far
+    }
+
+    hr = mResumeAllocator[context]->Reset();
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    hr = mResumeList->Reset(mResumeAllocator[context], NULL);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mResumeList->SetDescriptorHeaps(1, &mShaderDescriptorHeap);
+    return true;
+}
+
+RenderCommandList* D3D12RenderBackend::GetParallelCommandList(uint32_t index)
+{
+    return index < mParallelCount ? &mParallelCommandList[index] : nullptr;
+}
+
+bool D3D12RenderBackend::EndFrame()
+{
+    HRESULT hr;
+
+    // the main list, then the parallel lists in order, then the rest of the frame
+    ID3D12CommandList* ppCommandLists[MaxParallelCommandLists + 2];
+    UINT numCommandLists = 0;
+    ppCommandLists[numCommandLists++] = mCommandList;
+
+    if (mParallelCount > 0)
+    {
+        bool closed = true;
+        for (uint32_t i = 0; i < mParallelCount; ++i)
+        {
+            closed = SUCCEEDED(mParallelList[i]->Close()) && closed;
+            ppCommandLists[numCommandLists++] = mParallelList[i];
+        }
+        closed = SUCCEEDED(mResumeList->Close()) && closed;
+        ppCommandLists[numCommandLists++] = mResumeList;
+        mParallelCount = 0;
+        if (!closed)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        hr = mCommandList->Close();
+        mCommandListOpen = false;
+        if (FAILED(hr))
+        {
+            return false;
+        }
+    }
+
+    // the frame may draw with buffers uploaded since the last frame
+    if (!SubmitUploads())
+    {
+        return false;
+    }
+
+    // execute the array of command lists
+    mCommandQueue->ExecuteCommandLists(numCommandLists, ppCommandLists);
+
+    // this command goes in at the end of our command queue. we will know when our command queue
+    // has finished because the fence value will be set to "fenceValue" from the GPU since the command
+    // queue is being executed on the GPU
+    hr = mCommandQueue->Signal(mFence.Get(), ++mFenceValue);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    mFrames.EndFrame(mFenceValue);
+
+    // present the current backbuffer
+    hr = mSwapChain->Present(0, 0);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+    return true;
+}
+
+void D3D12RenderBackend::WaitForGpu()
+{
+    // wait for the gpu to finish all frames and uploads
+    if (mFence.Get() && mFenceValue > 0)
+    {
+        mFence.WaitForValue(mFenceValue);
+    }
+    if (mCopyQueue.GetD3D12Fence())
+    {
+        mUploads.WaitForIdle();
+    }
+}
+
+void D3D12RenderBackend::Shutdown()
+{
+    // wait for the gpu to finish all frames
+    WaitForGpu();
+
+    // get swapchain out of full screen before exiting
+    BOOL fs = false;
+    if (mSwapChain && SUCCEEDED(mSwapChain->GetFullscreenState(&fs, NULL)) && fs)
+        mSwapChain->SetFullscreenState(false, NULL);
+
+    mFence.Release();
+    mCopyQueue.Release();
+
+    // the staging pages are resources too
+    for (size_t i = 0; i < mResources.size(); ++i)
+    {
+        SAFE_RELEASE(mResources[i]);
+    }
+    mResources.clear();
+
+    // the placed resources are gone, now their heaps can go
+    for (size_t i = 0; i < mStaticHeaps.size(); ++i)
+    {
+        SAFE_RELEASE(mStaticHeaps[i]);
+    }
+    mStaticHeaps.clear();
+    mStaticHeapAllocator.Init(bufferHeapSize);
+    for (size_t i = 0; i < mUploadHeaps.size(); ++i)
+    {
+        SAFE_RELEASE(mUploadHeaps[i]);
+    }
+    mUploadHeaps.clear();
+    mUploadHeapAllocator.Init(bufferHeapSize);
+
+    for (size_t i = 0; i < mPipelines.size(); ++i)
+    {
+        SAFE_RELEASE(mPipelines[i].pipelineStateObject);
+        SAFE_RELEASE(mPipelines[i].rootSignature);
+    }
+    mPipelines.clear();
+
+    for (int i = 0; i < frameBufferCount; ++i)
+    {
+        SAFE_RELEASE(mCommandAllocator[i]);
+        SAFE_RELEASE(mResumeAllocator[i]);
+        for (uint32_t j = 0; j < MaxParallelCommandLists; ++j)
+        {
+            SAFE_RELEASE(mParallelAllocator[i][j]);
+        }
+    };
+
+    for (uint32_t j = 0; j < MaxParallelCommandLists; ++j)
+    {
+        SAFE_RELEASE(mParallelList[j]);
+    }
+    SAFE_RELEASE(mResumeList);
+
+    SAFE_RELEASE(mCommandList);
+    SAFE_RELEASE(mDepthStencilBuffer);
+    SAFE_RELEASE(mDsDescriptorHeap);
+    SAFE_RELEASE(mShaderDescriptorHeap);
+    SAFE_RELEASE(mRtvDescriptorHeap);
+    SAFE_RELEASE(mSwapChain);
+    SAFE_RELEASE(mCommandQueue);
+    SAFE_RELEASE(mDevice);
+}
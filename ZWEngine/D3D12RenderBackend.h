@@ -0,0 +1,218 @@
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN    // Exclude rarely-used stuff from Windows headers.
+#endif
+
+#include <windows.h>
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <deque>
+#include <vector>
+#include "DescriptorAllocator.h"
+#include "FrameManager.h"
+#include "RenderBackend.h"
+#include "ResourceHeapAllocator.h"
+#include "UploadManager.h"
+
+class D3D12RenderBackend;
+
+class D3D12CommandList : public RenderCommandList
+{
+public:
+    D3D12CommandList();
+
+    // record into "list", resources and pipelines are looked up in "backend"
+    void Bind(D3D12RenderBackend* backend, ID3D12GraphicsCommandList* list);
+
+    void ResourceBarrier(ResourceHandle resource, ResourceState before, ResourceState after) override;
+    void SetRenderTarget(int backBufferIndex) override;
+    void ClearRenderTarget(int backBufferIndex, const float color[4]) override;
+    void ClearDepth(float depth) override;
+    void SetPipeline(PipelineHandle pipeline) override;
+    void SetViewport(const Viewport& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+    void SetVertexBuffer(const VertexBufferView& view) override;
+    void SetIndexBuffer(const IndexBufferView& view) override;
+    void SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GpuAddress bufferLocation) override;
+    void SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, GpuAddress bufferLocation) override;
+    void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, DescriptorIndex firstDescriptor) override;
+    void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+private:
+    D3D12RenderBackend* mBackend;
+    ID3D12GraphicsCommandList* mList;
+};
+
+// the queue's fence, one value per submission
+class D3D12Fence : public GpuFence
+{
+public:
+    D3D12Fence();
+
+    bool Init(ID3D12Device* device);
+    void Release();
+
+    ID3D12Fence* Get() const;
+
+    uint64_t GetCompletedValue() const override;
+    bool WaitForValue(uint64_t value) override;
+
+private:
+    ID3D12Fence* mFence;
+    HANDLE mFenceEvent; // a handle to an event when our fence is unlocked by the gpu
+};
+
+// a D3D12_COMMAND_LIST_TYPE_COPY queue with its own fence. every submission records into an
+// allocator of a small pool, allocators are reused once the fence passed their submission
+class D3D12CopyQueue : public CopyQueue
+{
+public:
+    D3D12CopyQueue();
+
+    bool Init(D3D12RenderBackend* backend, ID3D12Device* device);
+    void Release();
+
+    ID3D12Fence* GetD3D12Fence() const;
+
+    bool Submit(ResourceHandle source, const BufferCopy* copies, uint32_t count, const TextureCopy* textureCopies,
+        uint32_t textureCount, uint64_t* fenceValue) override;
+    GpuFence* GetFence() override;
+
+private:
+    struct Allocator
+    {
+        ID3D12CommandAllocator* allocator;
+        uint64_t fenceValue; // submission that used it last
+    };
+
+    D3D12RenderBackend* mBackend;
+    ID3D12Device* mDevice;
+    ID3D12CommandQueue* mQueue;
+    ID3D12GraphicsCommandList* mList;
+    D3D12Fence mFence;
+    UINT64 mFenceValue; // last value we signaled
+    std::deque<Allocator> mAllocators; // in submission order
+};
+
+class D3D12RenderBackend : public RenderBackend
+{
+public:
+    D3D12RenderBackend(HWND hwnd, bool fullScreen);
+
+    bool Init(int width, int height) override;
+    void Shutdown() override;
+
+    bool CreateStaticBuffer(const void* data, uint64_t size, ResourceState finalState, StaticBuffer* buffer) override;
+    bool CreateUploadBuffer(uint64_t size, UploadBuffer* buffer) override;
+    bool CreateTexture(const TextureDesc& desc, ResourceHandle* texture) override;
+    bool UploadTexture(ResourceHandle texture, uint32_t firstSubresource, uint32_t count, const SubresourceSource* sources,
+        JobSystem* jobs) override;
+    PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+    bool FlushUploads() override;
+
+    DescriptorIndex AllocatePersistentDescriptor() override;
+    void FreePersistentDescriptor(DescriptorIndex descriptor) override;
+    bool AllocateTransientDescriptors(uint32_t count, DescriptorIndex* first) override;
+    void CreateConstantBufferView(DescriptorIndex descriptor, GpuAddress bufferLocation, uint32_t size) override;
+
+    int GetFrameIndex() const override;
+    bool SetFramesInFlight(uint32_t count) override;
+    ResourceHandle GetBackBuffer(int frameIndex) const override;
+    uint64_t GetSubmittedFrameCount() const override;
+    uint64_t GetCompletedFrameCount() const override;
+
+    bool BeginFrame() override;
+    RenderCommandList* GetCommandList() override;
+    bool BeginParallelRecording(uint32_t count) override;
+    RenderCommandList* GetParallelCommandList(uint32_t index) override;
+    bool EndFrame() override;
+    void WaitForGpu() override;
+
+private:
+    friend class D3D12CommandList;
+    friend class D3D12CopyQueue;
+
+    struct Pipeline
+    {
+        ID3D12RootSignature* rootSignature; // root signature defines data shaders will access
+        ID3D12PipelineState* pipelineStateObject; // pso containing a pipeline state
+    };
+
+    ResourceHandle AddResource(ID3D12Resource* resource);
+
+    // a buffer placed in one of "heaps", a new heap is created when none has room
+    bool CreatePlacedBuffer(ResourceHeapAllocator* allocator, std::vector<ID3D12Heap*>* heaps, D3D12_HEAP_TYPE heapType,
+        uint64_t size, D3D12_RESOURCE_STATES initialState, ID3D12Resource** resource);
+
+    // submit the staged uploads and make the direct queue wait for every copy submitted so far
+    bool SubmitUploads();
+
+    HWND mHwnd; // window the swap chain presents to
+    bool mFullScreen;
+    int mWidth;
+    int mHeight;
+
+    ID3D12Device* mDevice; // direct3d device
+
+    IDXGISwapChain3* mSwapChain; // swapchain used to switch between render targets
+
+    ID3D12CommandQueue* mCommandQueue; // container for command lists
+
+    ID3D12DescriptorHeap* mRtvDescriptorHeap; // a descriptor heap to hold resources like the render targets
+
+    ID3D12CommandAllocator* mCommandAllocator[frameBufferCount]; // one allocator per frame context, the gpu may still read the other frames' commands
+
+    ID3D12GraphicsCommandList* mCommandList; // a command list we can record commands into, then execute them to render the frame
+
+    D3D12Fence mFence; // signaled with the next value after every submission
+
+    UINT64 mFenceValue; // last value we signaled
+
+    FrameManager mFrames; // frames in flight, picks the frame context (allocators) a frame records into
+
+    int mFrameIndex; // current rtv we are on
+
+    int mRtvDescriptorSize; // size of the rtv descriptor on the device (all front and back buffers will be the same size)
+
+    ID3D12Resource* mDepthStencilBuffer; // This is the memory for our depth buffer. it will also be used for a stencil buffer in a later tutorial
+    ID3D12DescriptorHeap* mDsDescriptorHeap; // This is a heap for our depth/stencil buffer descriptor
+
+    ID3D12DescriptorHeap* mShaderDescriptorHeap; // the shader visible cbv/srv/uav heap, bound on every command list
+    UINT mShaderDescriptorSize;
+    DescriptorAllocator mDescriptorAllocator; // persistent and per frame slots of mShaderDescriptorHeap
+
+    bool mCommandListOpen; // between BeginFrame and EndFrame, until the frame splits
+
+    std::vector<ID3D12Resource*> mResources; // every resource handed out by handle, the back buffers come first
+
+    D3D12CopyQueue mCopyQueue; // static buffers are filled here, next to the frames
+
+    UploadManager mUploads; // stages static buffer data and retires the staging memory by copy fence value
+
+    UINT64 mCopyFenceWaited; // last copy fence value the direct queue was told to wait for
+
+    // buffers are placed in big heaps instead of getting an implicit heap each
+    ResourceHeapAllocator mStaticHeapAllocator; // default heaps, for static buffers
+    std::vector<ID3D12Heap*> mStaticHeaps;
+    ResourceHeapAllocator mUploadHeapAllocator; // upload heaps, for upload buffers and staging pages
+    std::vector<ID3D12Heap*> mUploadHeaps;
+
+    std::vector<Pipeline> mPipelines;
+
+    D3D12CommandList mRenderCommandList;
+
+    // parallel recording. the main command list is closed when a frame splits, the parallel lists and
+    // the resume list (which takes over GetCommandList for the rest of the frame) run after it
+    ID3D12CommandAllocator* mParallelAllocator[frameBufferCount][MaxParallelCommandLists];
+    ID3D12GraphicsCommandList* mParallelList[MaxParallelCommandLists];
+    D3D12CommandList mParallelCommandList[MaxParallelCommandLists];
+
+    ID3D12CommandAllocator* mResumeAllocator[frameBufferCount];
+    ID3D12GraphicsCommandList* mResumeList;
+    D3D12CommandList mResumeCommandList;
+
+    uint32_t mParallelCount; // parallel lists in the current frame, 0 if it didn't split
+};
@@ -0,0 +1,467 @@
+#include "DdsTexture.h"
+#include <cstring>
+
+namespace
+{
+    const uint32_t DdsMagic = 0x20534444; // "DDS "
+
+    // header flags
+    const uint32_t DdsdDepth = 0x800000;
+
+    // pixel format flags
+    const uint32_t DdpfAlpha = 0x2;
+    const uint32_t DdpfFourCC = 0x4;
+    const uint32_t DdpfRgb = 0x40;
+    const uint32_t DdpfLuminance = 0x20000;
+
+    // caps2
+    const uint32_t Caps2Cubemap = 0x200;
+    const uint32_t Caps2CubemapAllFaces = 0xFC00;
+    const uint32_t Caps2Volume = 0x200000;
+
+    // DX10 header
+    const uint32_t ResourceDimensionTexture1D = 2;
+    const uint32_t ResourceDimensionTexture2D = 3;
+    const uint32_t ResourceDimensionTexture3D = 4;
+    const uint32_t MiscTextureCube = 0x4;
+
+    // DXGI_FORMAT values the legacy pixel formats map to
+    const uint32_t FormatR32G32B32A32Float = 2;
+    const uint32_t FormatR16G16B16A16Float = 10;
+    const uint32_t FormatR16G16B16A16Unorm = 11;
+    const uint32_t FormatR16G16B16A16Snorm = 13;
+    const uint32_t FormatR32G32Float = 16;
+    const uint32_t FormatR8G8B8A8Unorm = 28;
+    const uint32_t FormatR16G16Float = 34;
+    const uint32_t FormatR32Float = 41;
+    const uint32_t FormatR8G8Unorm = 49;
+    const uint32_t FormatR16Float = 54;
+    const uint32_t FormatR16Unorm = 56;
+    const uint32_t FormatR8Unorm = 61;
+    const uint32_t FormatA8Unorm = 65;
+    const uint32_t FormatBC1Unorm = 71;
+    const uint32_t FormatBC2Unorm = 74;
+    const uint32_t FormatBC3Unorm = 77;
+    const uint32_t FormatBC4Unorm = 80;
+    const uint32_t FormatBC4Snorm = 81;
+    const uint32_t FormatBC5Unorm = 83;
+    const uint32_t FormatBC5Snorm = 84;
+    const uint32_t FormatB5G6R5Unorm = 85;
+    const uint32_t FormatB5G5R5A1Unorm = 86;
+    const uint32_t FormatB8G8R8A8Unorm = 87;
+    const uint32_t FormatB8G8R8X8Unorm = 88;
+
+    struct DdsPixelFormat
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t rBitMask;
+        uint32_t gBitMask;
+        uint32_t bBitMask;
+        uint32_t aBitMask;
+    };
+
+    struct DdsHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DdsPixelFormat pixelFormat;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    struct DdsHeaderDx10
+    {
+        uint32_t format;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+    }
+
+    bool HasMasks(const DdsPixelFormat& pf, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+    {
+        return pf.rBitMask == r && pf.gBitMask == g && pf.bBitMask == b && pf.aBitMask == a;
+    }
+
+    // the pre DX10 ways of describing a format, only the common ones. 0 if unknown
+    uint32_t GetLegacyFormat(const DdsPixelFormat& pf)
+    {
+        if (pf.flags & DdpfFourCC)
+        {
+            uint32_t fourCC = pf.fourCC;
+            if (fourCC == MakeFourCC('D', 'X', 'T', '1')) return FormatBC1Unorm;
+            if (fourCC == MakeFourCC('D', 'X', 'T', '2') || fourCC == MakeFourCC('D', 'X', 'T', '3')) return FormatBC2Unorm;
+            if (fourCC == MakeFourCC('D', 'X', 'T', '4') || fourCC == MakeFourCC('D', 'X', 'T', '5')) return FormatBC3Unorm;
+            if (fourCC == MakeFourCC('A', 'T', 'I', '1') || fourCC == MakeFourCC('B', 'C', '4', 'U')) return FormatBC4Unorm;
+            if (fourCC == MakeFourCC('B', 'C', '4', 'S')) return FormatBC4Snorm;
+            if (fourCC == MakeFourCC('A', 'T', 'I', '2') || fourCC == MakeFourCC('B', 'C', '5', 'U')) return FormatBC5Unorm;
+            if (fourCC == MakeFourCC('B', 'C', '5', 'S')) return FormatBC5Snorm;
+
+            // D3DFORMAT numbers stored as the fourcc
+            switch (fourCC)
+            {
+            case 36: return FormatR16G16B16A16Unorm;
+            case 110: return FormatR16G16B16A16Snorm;
+            case 111: return FormatR16Float;
+            case 112: return FormatR16G16Float;
+            case 113: return FormatR16G16B16A16Float;
+            case 114: return FormatR32Float;
+            case 115: return FormatR32G32Float;
+            case 116: return FormatR32G32B32A32Float;
+            default: return 0;
+            }
+        }
+
+        if (pf.flags & DdpfRgb)
+        {
+            switch (pf.rgbBitCount)
+            {
+            case 32:
+                if (HasMasks(pf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) return FormatR8G8B8A8Unorm;
+                if (HasMasks(pf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)) return FormatB8G8R8A8Unorm;
+                if (HasMasks(pf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0)) return FormatB8G8R8X8Unorm;
+                break;
+            case 16:
+                if (HasMasks(pf, 0xf800, 0x07e0, 0x001f, 0)) return FormatB5G6R5Unorm;
+                if (HasMasks(pf, 0x7c00, 0x03e0, 0x001f, 0x8000)) return FormatB5G5R5A1Unorm;
+                break;
+            }
+            return 0;
+        }
+
+        if (pf.flags & DdpfLuminance)
+        {
+            if (pf.rgbBitCount == 8 && pf.rBitMask == 0xff) return FormatR8Unorm;
+            if (pf.rgbBitCount == 16 && pf.rBitMask == 0xffff) return FormatR16Unorm;
+            if (pf.rgbBitCount == 16 && pf.rBitMask == 0xff && pf.aBitMask == 0xff00) return FormatR8G8Unorm;
+            return 0;
+        }
+
+        if ((pf.flags & DdpfAlpha) && pf.rgbBitCount == 8)
+        {
+            return FormatA8Unorm;
+        }
+        return 0;
+    }
+
+    uint32_t MipSize(uint32_t size, uint32_t mip)
+    {
+        size >>= mip;
+        return size ? size : 1;
+    }
+}
+
+bool GetDxgiFormatSize(uint32_t format, uint32_t* blockBytes, uint32_t* bitsPerPixel)
+{
+    *blockBytes = 0;
+    *bitsPerPixel = 0;
+
+    if ((format >= 70 && format <= 72) || (format >= 79 && format <= 81))
+    {
+        *blockBytes = 8; // BC1, BC4
+        return true;
+    }
+    if ((format >= 73 && format <= 78) || (format >= 82 && format <= 84) || (format >= 94 && format <= 99))
+    {
+        *blockBytes = 16; // BC2, BC3, BC5, BC6H, BC7
+        return true;
+    }
+
+    if (format >= 1 && format <= 4) *bitsPerPixel = 128;
+    else if (format >= 5 && format <= 8) *bitsPerPixel = 96;
+    else if (format >= 9 && format <= 22) *bitsPerPixel = 64;
+    else if ((format >= 23 && format <= 47) || format == 67 || (format >= 87 && format <= 93)) *bitsPerPixel = 32;
+    else if ((format >= 48 && format <= 59) || format == 85 || format == 86 || format == 115) *bitsPerPixel = 16;
+    else if (format >= 60 && format <= 65) *bitsPerPixel = 8;
+    return *bitsPerPixel != 0;
+}
+
+bool ParseDds(ByteSpan file, DdsInfo* info)
+{
+    if (file.size < sizeof(uint32_t) + sizeof(DdsHeader))
+    {
+        return false;
+    }
+
+    uint32_t magic;
+    DdsHeader header;
+    memcpy(&magic, file.data, sizeof(magic));
+    memcpy(&header, file.data + sizeof(magic), sizeof(header));
+    if (magic != DdsMagic || header.size != sizeof(DdsHeader) || header.pixelFormat.size != sizeof(DdsPixelFormat))
+    {
+        return false;
+    }
+
+    info->width = header.width;
+    info->height = header.height ? header.height : 1;
+    info->depth = 1;
+    info->mipCount = header.mipMapCount ? header.mipMapCount : 1;
+    info->arraySize = 1;
+    info->cube = false;
+    info->dataOffset = sizeof(uint32_t) + sizeof(DdsHeader);
+
+    if ((header.pixelFormat.flags & DdpfFourCC) && header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0'))
+    {
+        if (file.size < info->dataOffset + sizeof(DdsHeaderDx10))
+        {
+            return false;
+        }
+        DdsHeaderDx10 dx10;
+        memcpy(&dx10, file.data + info->dataOffset, sizeof(dx10));
+        info->dataOffset += sizeof(DdsHeaderDx10);
+
+        // cube arrays store 6 slices per cube, a count that only fits 64 bits is a broken file
+        uint64_t arraySize = dx10.arraySize;
+        info->format = dx10.format;
+        switch (dx10.resourceDimension)
+        {
+        case ResourceDimensionTexture1D:
+            info->dimension = DdsDimension::Texture1D;
+            info->height = 1;
+            break;
+        case ResourceDimensionTexture2D:
+            info->dimension = DdsDimension::Texture2D;
+            if (dx10.miscFlag & MiscTextureCube)
+            {
+                info->cube = true;
+                arraySize *= 6;
+            }
+            break;
+        case ResourceDimensionTexture3D:
+            info->dimension = DdsDimension::Texture3D;
+            info->depth = header.depth ? header.depth : 1;
+            if (arraySize != 1)
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+        if (arraySize > 0xffffffff)
+        {
+            return false;
+        }
+        info->arraySize = (uint32_t)arraySize;
+    }
+    else
+    {
+        info->format = GetLegacyFormat(header.pixelFormat);
+        info->dimension = DdsDimension::Texture2D;
+        if ((header.flags & DdsdDepth) && (header.caps2 & Caps2Volume))
+        {
+            info->dimension = DdsDimension::Texture3D;
+            info->depth = header.depth ? header.depth : 1;
+        }
+        else if (header.caps2 & Caps2Cubemap)
+        {
+            // partial cubes can't be created in d3d12
+            if ((header.caps2 & Caps2CubemapAllFaces) != Caps2CubemapAllFaces)
+            {
+                return false;
+            }
+            info->cube = true;
+            info->arraySize = 6;
+        }
+    }
+
+    uint32_t blockBytes;
+    uint32_t bitsPerPixel;
+    if (info->width == 0 || info->arraySize == 0 || !GetDxgiFormatSize(info->format, &blockBytes, &bitsPerPixel))
+    {
+        return false;
+    }
+
+    // no mip below 1x1x1
+    uint32_t largest = info->width > info->height ? info->width : info->height;
+    largest = largest > info->depth ? largest : info->depth;
+    uint32_t maxMips = 1;
+    while (largest >> maxMips)
+    {
+        ++maxMips;
+    }
+    if (info->mipCount > maxMips)
+    {
+        return false;
+    }
+
+    // every subresource is at least a byte, a count the file can't hold is rejected before anything
+    // is allocated for it
+    if ((uint64_t)info->arraySize * info->mipCount > file.size - info->dataOffset)
+    {
+        return false;
+    }
+
+    // every slice holds its whole mip chain, one after the other
+    info->subresources.clear();
+    info->subresources.reserve((size_t)info->arraySize * info->mipCount);
+    uint64_t offset = info->dataOffset;
+    for (uint32_t slice = 0; slice < info->arraySize; ++slice)
+    {
+        for (uint32_t mip = 0; mip < info->mipCount; ++mip)
+        {
+            DdsSubresource sub;
+            sub.mip = mip;
+            sub.arraySlice = slice;
+            sub.width = MipSize(info->width, mip);
+            sub.height = MipSize(info->height, mip);
+            sub.depth = MipSize(info->depth, mip);
+            uint64_t rowPitch;
+            if (blockBytes)
+            {
+                rowPitch = ((uint64_t)sub.width + 3) / 4 * blockBytes;
+                sub.rowCount = (uint32_t)(((uint64_t)sub.height + 3) / 4);
+            }
+            else
+            {
+                rowPitch = ((uint64_t)sub.width * bitsPerPixel + 7) / 8;
+                sub.rowCount = sub.height;
+            }
+            if (rowPitch > 0xffffffff)
+            {
+                return false;
+            }
+            sub.rowPitch = (uint32_t)rowPitch;
+            sub.offset = offset;
+
+            // a slice fits 64 bits, the whole subresource only if it fits the file
+            uint64_t sliceSize = rowPitch * sub.rowCount;
+            if (sliceSize > file.size / sub.depth)
+            {
+                return false;
+            }
+            sub.size = sliceSize * sub.depth;
+            if (sub.size > file.size || offset > file.size - sub.size)
+            {
+                return false;
+            }
+            offset += sub.size;
+            info->subresources.push_back(sub);
+        }
+    }
+    info->dataSize = offset - info->dataOffset;
+    return true;
+}
+
+DdsTexture::DdsTexture()
+    : mResidentMip(0)
+{
+    mInfo.mipCount = 0;
+}
+
+bool DdsTexture::Open(const char* path)
+{
+    Close();
+    return mFile.Open(path) && Parse();
+}
+
+#if defined(_WIN32)
+bool DdsTexture::Open(const wchar_t* path)
+{
+    Close();
+    return mFile.Open(path) && Parse();
+}
+#endif
+
+bool DdsTexture::Parse()
+{
+    if (!ParseDds(mFile.GetSpan(), &mInfo))
+    {
+        Close();
+        return false;
+    }
+    mResidentMip.store(mInfo.mipCount);
+
+    // mips are read out of file order, read ahead would fetch the wrong pages
+    mFile.Advise(MapAdvice::Random);
+    return true;
+}
+
+void DdsTexture::Close()
+{
+    mFile.Close();
+    mInfo.mipCount = 0;
+    mInfo.subresources.clear();
+    mResidentMip.store(0);
+}
+
+const DdsInfo& DdsTexture::GetInfo() const
+{
+    return mInfo;
+}
+
+void DdsTexture::StreamAsync(JobSystem* jobs, JobCounter* counter)
+{
+    uint32_t resident = mResidentMip.load(std::memory_order_acquire);
+    if (resident == 0)
+    {
+        return;
+    }
+    jobs->Run([this, jobs, counter, resident]() { StreamMip(jobs, counter, resident - 1); }, counter);
+}
+
+void DdsTexture::StreamMip(JobSystem* jobs, JobCounter* counter, uint32_t mip)
+{
+    LoadMip(mip);
+
+    // the next mip is queued before this job finishes, so "counter" can't reach 0 in between
+    if (mip > 0)
+    {
+        jobs->Run([this, jobs, counter, mip]() { StreamMip(jobs, counter, mip - 1); }, counter);
+    }
+}
+
+void DdsTexture::LoadAll()
+{
+    for (uint32_t mip = mResidentMip.load(std::memory_order_acquire); mip > 0; --mip)
+    {
+        LoadMip(mip - 1);
+    }
+}
+
+void DdsTexture::LoadMip(uint32_t mip)
+{
+    for (uint32_t slice = 0; slice < mInfo.arraySize; ++slice)
+    {
+        const DdsSubresource& sub = mInfo.subresources[mip + slice * mInfo.mipCount];
+        mFile.Advise(MapAdvice::WillNeed, sub.offset, sub.size);
+    }
+    for (uint32_t slice = 0; slice < mInfo.arraySize; ++slice)
+    {
+        const DdsSubresource& sub = mInfo.subresources[mip + slice * mInfo.mipCount];
+        mFile.Touch(sub.offset, sub.size);
+    }
+    mResidentMip.store(mip, std::memory_order_release);
+}
+
+uint32_t DdsTexture::GetResidentMip() const
+{
+    return mResidentMip.load(std::memory_order_acquire);
+}
+
+bool DdsTexture::GetSubresource(uint32_t mip, uint32_t arraySlice, ByteSpan* data) const
+{
+    if (mip >= mInfo.mipCount || arraySlice >= mInfo.arraySize || mip < GetResidentMip())
+    {
+        return false;
+    }
+    const DdsSubresource& sub = mInfo.subresources[mip + arraySlice * mInfo.mipCount];
+    return mFile.Span(sub.offset, sub.size, data);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+enum class DdsDimension
+{
+    Texture1D,
+    Texture2D,
+    Texture3D,
+};
+
+// one mip of one array slice (cube faces are slices too), as stored in the file
+struct DdsSubresource
+{
+    uint32_t mip;
+    uint32_t arraySlice;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t rowPitch; // bytes per row of pixels, or of 4x4 blocks for compressed formats
+    uint32_t rowCount; // rows of pixels or blocks per depth slice
+    uint64_t offset; // from the start of the file
+    uint64_t size;
+};
+
+struct DdsInfo
+{
+    DdsDimension dimension;
+    uint32_t format; // DXGI_FORMAT, legacy pixel formats are translated
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t mipCount;
+    uint32_t arraySize; // 6 per cube
+    bool cube;
+    uint64_t dataOffset; // first byte after the headers
+    uint64_t dataSize;
+
+    // in d3d12 subresource order, mip + arraySlice * mipCount, which is also the file order
+    std::vector<DdsSubresource> subresources;
+};
+
+// parse the headers (including the DX10 extension) and lay out every subresource. false if the file
+// isn't a dds, uses a format without a known size, or is shorter than its subresources
+bool ParseDds(ByteSpan file, DdsInfo* info);
+
+// bytes per 4x4 block for block compressed formats, otherwise 0 and "bitsPerPixel" is set. false
+// for formats ParseDds can't lay out
+bool GetDxgiFormatSize(uint32_t format, uint32_t* blockBytes, uint32_t* bitsPerPixel);
+
+// A mapped dds file that becomes resident mip by mip. StreamAsync reads the smallest mip first and
+// works up to mip 0 on the job system, so the texture is usable as soon as the 1x1 mip is in and
+// gets sharper while the rest streams. "Reading" faults the pages of the map in, the data is never
+// copied; the subresources stay spans into the file.
+class DdsTexture
+{
+public:
+    DdsTexture();
+
+    DdsTexture(const DdsTexture&) = delete;
+    DdsTexture& operator=(const DdsTexture&) = delete;
+
+    // map and parse, nothing is resident yet
+    bool Open(const char* path);
+#if defined(_WIN32)
+    bool Open(const wchar_t* path);
+#endif
+    void Close(); // streaming must be finished
+
+    const DdsInfo& GetInfo() const;
+
+    // queue the missing mips smallest first. "counter" reaches 0 once mip 0 is resident; the texture
+    // must stay alive until then
+    void StreamAsync(JobSystem* jobs, JobCounter* counter);
+
+    // read all missing mips on the calling thread
+    void LoadAll();
+
+    // most detailed resident mip, every smaller one is resident too. mipCount while nothing is
+    uint32_t GetResidentMip() const;
+
+    // false if the subresource doesn't exist or its mip isn't resident yet
+    bool GetSubresource(uint32_t mip, uint32_t arraySlice, ByteSpan* data) const;
+
+private:
+    bool Parse();
+    void LoadMip(uint32_t mip); // all array slices of "mip"
+    void StreamMip(JobSystem* jobs, JobCounter* counter, uint32_t mip);
+
+    MappedFile mFile;
+    DdsInfo mInfo;
+    std::atomic<uint32_t> mResidentMip;
+};
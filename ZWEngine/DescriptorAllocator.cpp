@@ -0,0 +1,98 @@
+#include "DescriptorAllocator.h"
+
+DescriptorAllocator::DescriptorAllocator()
+    : mPersistentCount(0), mTransientCount(0), mContextIndex(0), mTransientOffset(0), mPeakTransientUsed(0),
+    mFailedAllocations(0)
+{
+}
+
+void DescriptorAllocator::Init(uint32_t persistentCount, uint32_t transientCount)
+{
+    mPersistentCount = persistentCount;
+    mTransientCount = transientCount;
+
+    // pushed in reverse so the low slots are handed out first
+    mFreeList.resize(persistentCount);
+    for (uint32_t i = 0; i < persistentCount; ++i)
+    {
+        mFreeList[i] = persistentCount - 1 - i;
+    }
+    mAllocated.assign(persistentCount, 0);
+    mPendingFrees.clear();
+
+    mContextIndex = 0;
+    mTransientOffset = 0;
+    mPeakTransientUsed = 0;
+    mFailedAllocations = 0;
+}
+
+DescriptorIndex DescriptorAllocator::AllocatePersistent()
+{
+    if (mFreeList.empty())
+    {
+        ++mFailedAllocations;
+        return InvalidDescriptor;
+    }
+    DescriptorIndex descriptor = mFreeList.back();
+    mFreeList.pop_back();
+    mAllocated[descriptor] = 1;
+    return descriptor;
+}
+
+void DescriptorAllocator::FreePersistent(DescriptorIndex descriptor, uint64_t frameFence)
+{
+    if (descriptor >= mPersistentCount || !mAllocated[descriptor])
+    {
+        return;
+    }
+    mAllocated[descriptor] = 0;
+
+    PendingFree pending;
+    pending.descriptor = descriptor;
+    pending.fence = frameFence;
+    mPendingFrees.push_back(pending);
+}
+
+void DescriptorAllocator::BeginFrame(uint32_t contextIndex, uint64_t completedFence)
+{
+    // frees come in frame order, so stop at the first one the gpu may still read
+    while (!mPendingFrees.empty() && mPendingFrees.front().fence <= completedFence)
+    {
+        mFreeList.push_back(mPendingFrees.front().descriptor);
+        mPendingFrees.pop_front();
+    }
+
+    mContextIndex = contextIndex;
+    mTransientOffset = 0;
+}
+
+bool DescriptorAllocator::AllocateTransient(uint32_t count, DescriptorIndex* first)
+{
+    if (count > mTransientCount - mTransientOffset)
+    {
+        ++mFailedAllocations;
+        return false;
+    }
+    *first = mPersistentCount + mContextIndex * mTransientCount + mTransientOffset;
+    mTransientOffset += count;
+    mPeakTransientUsed = mTransientOffset > mPeakTransientUsed ? mTransientOffset : mPeakTransientUsed;
+    return true;
+}
+
+uint32_t DescriptorAllocator::GetCapacity() const
+{
+    return mPersistentCount + frameBufferCount * mTransientCount;
+}
+
+DescriptorStats DescriptorAllocator::GetStats() const
+{
+    DescriptorStats stats;
+    stats.capacity = GetCapacity();
+    stats.persistentCapacity = mPersistentCount;
+    stats.persistentUsed = mPersistentCount - (uint32_t)mFreeList.size();
+    stats.transientCapacity = mTransientCount;
+    stats.transientUsed = mTransientOffset;
+    stats.peakTransientUsed = mPeakTransientUsed;
+    stats.failedAllocations = mFailedAllocations;
+    return stats;
+}
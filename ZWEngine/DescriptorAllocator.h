@@ -0,0 +1,65 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include <deque>
+#include <vector>
+
+struct DescriptorStats
+{
+    uint32_t capacity; // persistent + transient slots
+    uint32_t persistentCapacity;
+    uint32_t persistentUsed; // including freed slots the gpu may still read
+    uint32_t transientCapacity; // per frame
+    uint32_t transientUsed; // in the current frame
+    uint32_t peakTransientUsed; // largest frame so far
+    uint32_t failedAllocations; // persistent or transient requests that didn't fit
+};
+
+// Hands out slots of one shader visible descriptor heap, by index. The heap is split in two:
+//   [0, persistentCount)               persistent descriptors (textures, long lived views), a free list
+//                                      of slot indices makes allocating and freeing O(1). a freed slot is
+//                                      only reused once the gpu completed the frame that freed it
+//   [persistentCount, capacity)        one linear range of transientCount slots per frame context. a frame
+//                                      bumps contiguous tables out of its range, BeginFrame rewinds it
+// The frame context is the one FrameManager picked, so the gpu is done with a range when it is rewound.
+// Only indices are handled here, the backend turns them into cpu / gpu descriptor handles.
+class DescriptorAllocator
+{
+public:
+    DescriptorAllocator();
+
+    void Init(uint32_t persistentCount, uint32_t transientCount);
+
+    // InvalidDescriptor if every persistent slot is taken
+    DescriptorIndex AllocatePersistent();
+    // "frameFence" is the frame recording when the slot is freed, frames before it may still use it
+    void FreePersistent(DescriptorIndex descriptor, uint64_t frameFence);
+
+    // rewind the transient range of frame context "contextIndex" (< frameBufferCount), slots freed
+    // by frames <= completedFence go back on the free list
+    void BeginFrame(uint32_t contextIndex, uint64_t completedFence);
+
+    // "count" consecutive slots for the current frame, false if the frame's range is full
+    bool AllocateTransient(uint32_t count, DescriptorIndex* first);
+
+    uint32_t GetCapacity() const;
+
+    DescriptorStats GetStats() const;
+
+private:
+    struct PendingFree
+    {
+        DescriptorIndex descriptor;
+        uint64_t fence;
+    };
+
+    uint32_t mPersistentCount;
+    uint32_t mTransientCount;
+    std::vector<DescriptorIndex> mFreeList; // free persistent slots, lowest on top
+    std::vector<uint8_t> mAllocated; // per persistent slot, catches double frees
+    std::deque<PendingFree> mPendingFrees; // in the order they were freed
+    uint32_t mContextIndex;
+    uint32_t mTransientOffset; // bump offset into the current frame's range
+    uint32_t mPeakTransientUsed;
+    uint32_t mFailedAllocations;
+};
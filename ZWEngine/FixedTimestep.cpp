@@ -0,0 +1,44 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(double stepSeconds, int maxStepsPerFrame)
+    : mStep(stepSeconds), mAccumulator(0.0), mMaxSteps(maxStepsPerFrame)
+{
+}
+
+int FixedTimestep::Advance(double frameSeconds)
+{
+    if (frameSeconds > 0.0)
+    {
+        mAccumulator += frameSeconds;
+    }
+
+    int steps = 0;
+    while (mAccumulator >= mStep)
+    {
+        if (steps == mMaxSteps)
+        {
+            // we fell too far behind (debugger break, window drag, ...). running every missed step
+            // would make the next frame even slower, so keep only the fraction of a step
+            mAccumulator -= (int)(mAccumulator / mStep) * mStep;
+            break;
+        }
+        mAccumulator -= mStep;
+        ++steps;
+    }
+    return steps;
+}
+
+float FixedTimestep::Alpha() const
+{
+    return (float)(mAccumulator / mStep);
+}
+
+double FixedTimestep::StepSeconds() const
+{
+    return mStep;
+}
+
+void FixedTimestep::Reset()
+{
+    mAccumulator = 0.0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Fixed step accumulator. The frame time measured by GameTimer is added every frame and
+// consumed in whole simulation steps, the remainder is the interpolation factor between the
+// last two simulation states. Rendering can then run uncapped while the simulation always
+// advances at e.g. 120 Hz.
+class FixedTimestep
+{
+public:
+    // maxStepsPerFrame bounds the catch up work after a hitch, time beyond that is dropped
+    explicit FixedTimestep(double stepSeconds, int maxStepsPerFrame = 8);
+
+    // add a frame's delta and return how many simulation steps to run now
+    int Advance(double frameSeconds);
+
+    // 0..1, how far the rendered frame is between the previous and the current simulation state
+    float Alpha() const;
+
+    double StepSeconds() const;
+
+    void Reset();
+
+private:
+    double mStep;
+    double mAccumulator;
+    int mMaxSteps;
+};
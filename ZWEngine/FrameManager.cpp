@@ -0,0 +1,195 @@
+#include "FrameManager.h"
+
+SimulatedGpuFence::SimulatedGpuFence()
+    : mCompleted(0), mWaitCount(0)
+{
+}
+
+void SimulatedGpuFence::Signal(uint64_t value)
+{
+    mPending.push_back(value);
+}
+
+void SimulatedGpuFence::CompleteNext()
+{
+    if (!mPending.empty())
+    {
+        mCompleted = mPending.front();
+        mPending.pop_front();
+    }
+}
+
+void SimulatedGpuFence::CompleteUpTo(uint64_t value)
+{
+    while (!mPending.empty() && mPending.front() <= value)
+    {
+        CompleteNext();
+    }
+}
+
+uint64_t SimulatedGpuFence::GetCompletedValue() const
+{
+    return mCompleted;
+}
+
+bool SimulatedGpuFence::WaitForValue(uint64_t value)
+{
+    if (mCompleted >= value)
+    {
+        return true;
+    }
+    ++mWaitCount;
+    CompleteUpTo(value);
+
+    // waiting for a value that was never signaled would hang on a real gpu
+    return mCompleted >= value;
+}
+
+uint32_t SimulatedGpuFence::GetPendingCount() const
+{
+    return (uint32_t)mPending.size();
+}
+
+uint64_t SimulatedGpuFence::GetWaitCount() const
+{
+    return mWaitCount;
+}
+
+FrameManager::FrameManager()
+    : mFence(nullptr), mFramesInFlight(1), mSubmittedFrames(0), mContextIndex(0), mStallCount(0)
+{
+    for (int i = 0; i < frameBufferCount; ++i)
+    {
+        mContexts[i].frameNumber = 0;
+        mContexts[i].fenceValue = 0;
+    }
+}
+
+void FrameManager::Init(GpuFence* fence, uint32_t framesInFlight)
+{
+    mFence = fence;
+    mSubmittedFrames = 0;
+    mStallCount = 0;
+    if (framesInFlight < 1)
+    {
+        framesInFlight = 1;
+    }
+    if (framesInFlight > (uint32_t)frameBufferCount)
+    {
+        framesInFlight = frameBufferCount;
+    }
+    SetFramesInFlight(framesInFlight);
+}
+
+bool FrameManager::SetFramesInFlight(uint32_t framesInFlight)
+{
+    // there are only frameBufferCount contexts, anything else is a caller bug and changes nothing
+    if (framesInFlight < 1 || framesInFlight > (uint32_t)frameBufferCount)
+    {
+        return false;
+    }
+
+    // contexts are about to be renumbered, none of them may still be in use
+    if (!WaitForIdle())
+    {
+        return false;
+    }
+    mFramesInFlight = framesInFlight;
+
+    for (int i = 0; i < frameBufferCount; ++i)
+    {
+        mContexts[i].frameNumber = 0;
+        mContexts[i].fenceValue = 0;
+    }
+    mContextIndex = (uint32_t)((mSubmittedFrames + 1) % mFramesInFlight);
+    return true;
+}
+
+uint32_t FrameManager::GetFramesInFlight() const
+{
+    return mFramesInFlight;
+}
+
+bool FrameManager::BeginFrame()
+{
+    mContextIndex = (uint32_t)((mSubmittedFrames + 1) % mFramesInFlight);
+
+    // the context was last used framesInFlight frames ago, that's the only frame we wait for
+    const FrameContext& context = mContexts[mContextIndex];
+    if (context.frameNumber != 0 && mFence->GetCompletedValue() < context.fenceValue)
+    {
+        ++mStallCount;
+        if (!mFence->WaitForValue(context.fenceValue))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FrameManager::EndFrame(uint64_t fenceValue)
+{
+    FrameContext& context = mContexts[mContextIndex];
+    context.frameNumber = ++mSubmittedFrames;
+    context.fenceValue = fenceValue;
+}
+
+uint32_t FrameManager::GetContextIndex() const
+{
+    return mContextIndex;
+}
+
+uint64_t FrameManager::GetFrameNumber() const
+{
+    return mSubmittedFrames + 1;
+}
+
+uint64_t FrameManager::GetSubmittedFrameCount() const
+{
+    return mSubmittedFrames;
+}
+
+uint64_t FrameManager::GetCompletedFrameCount() const
+{
+    if (!mFence)
+    {
+        return mSubmittedFrames;
+    }
+
+    // frames finish in order, so everything before the oldest unfinished frame is done. frames older
+    // than the contexts were waited for before their context was reused
+    uint64_t completedValue = mFence->GetCompletedValue();
+    uint64_t completed = mSubmittedFrames;
+    for (uint32_t i = 0; i < mFramesInFlight; ++i)
+    {
+        const FrameContext& context = mContexts[i];
+        if (context.frameNumber != 0 && context.fenceValue > completedValue && context.frameNumber <= completed)
+        {
+            completed = context.frameNumber - 1;
+        }
+    }
+    return completed;
+}
+
+bool FrameManager::WaitForIdle()
+{
+    if (!mFence)
+    {
+        return true;
+    }
+
+    uint64_t lastValue = 0;
+    for (int i = 0; i < frameBufferCount; ++i)
+    {
+        if (mContexts[i].fenceValue > lastValue)
+        {
+            lastValue = mContexts[i].fenceValue;
+        }
+    }
+    return lastValue == 0 || mFence->WaitForValue(lastValue);
+}
+
+uint64_t FrameManager::GetStallCount() const
+{
+    return mStallCount;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include <deque>
+
+// gpu progress as one increasing value, the queue signals a new value after each submission
+class GpuFence
+{
+public:
+    virtual ~GpuFence() {}
+
+    virtual uint64_t GetCompletedValue() const = 0;
+
+    // block until the gpu reached "value", false if waiting failed
+    virtual bool WaitForValue(uint64_t value) = 0;
+};
+
+// A gpu that only runs when told to, for driving the frame pipeline headless. Signal queues a value
+// behind the work submitted so far; the test completes queued values explicitly, or the cpu
+// "blocks" in WaitForValue, which runs the gpu forward to the value and counts the stall.
+class SimulatedGpuFence : public GpuFence
+{
+public:
+    SimulatedGpuFence();
+
+    void Signal(uint64_t value); // values must increase
+    void CompleteNext(); // the gpu finished the oldest queued signal
+    void CompleteUpTo(uint64_t value); // ... every queued signal <= value
+
+    uint64_t GetCompletedValue() const override;
+    bool WaitForValue(uint64_t value) override;
+
+    uint32_t GetPendingCount() const; // signals the gpu hasn't reached yet
+    uint64_t GetWaitCount() const; // WaitForValue calls that had to run the gpu forward
+
+private:
+    std::deque<uint64_t> mPending;
+    uint64_t mCompleted;
+    uint64_t mWaitCount;
+};
+
+// Frames in flight. Every frame records into one of "framesInFlight" contexts (command allocators,
+// per frame scratch) picked round robin, independent of which back buffer the swap chain hands out.
+// Starting a frame only blocks when the gpu still uses the context the frame needs, i.e. when the
+// cpu is framesInFlight frames ahead; frame numbers start at 1 and double as fence values for
+// anything written for a frame.
+class FrameManager
+{
+public:
+    FrameManager();
+
+    // "framesInFlight" in [1, frameBufferCount], 1 runs the cpu and gpu in lockstep
+    void Init(GpuFence* fence, uint32_t framesInFlight);
+
+    // change the latency, waits for the gpu to finish everything first. false for a count outside
+    // [1, frameBufferCount], which leaves the current one in place
+    bool SetFramesInFlight(uint32_t framesInFlight);
+    uint32_t GetFramesInFlight() const;
+
+    // start the next frame. false if waiting for the gpu failed
+    bool BeginFrame();
+
+    // the frame's commands were submitted and "fenceValue" is signaled once the gpu finished them
+    void EndFrame(uint64_t fenceValue);
+
+    uint32_t GetContextIndex() const; // context of the frame being recorded, in [0, framesInFlight)
+    uint64_t GetFrameNumber() const; // frame being recorded (or the next one between frames)
+
+    uint64_t GetSubmittedFrameCount() const;
+    uint64_t GetCompletedFrameCount() const;
+
+    bool WaitForIdle(); // block until the gpu finished every submitted frame
+
+    uint64_t GetStallCount() const; // BeginFrame calls that had to wait for the gpu
+
+private:
+    struct FrameContext
+    {
+        uint64_t frameNumber; // last frame recorded into this context, 0 if none
+        uint64_t fenceValue; // signaled when that frame is done
+    };
+
+    GpuFence* mFence;
+    uint32_t mFramesInFlight;
+    FrameContext mContexts[frameBufferCount];
+    uint64_t mSubmittedFrames;
+    uint32_t mContextIndex;
+    uint64_t mStallCount;
+};
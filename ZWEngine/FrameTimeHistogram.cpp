@@ -0,0 +1,160 @@
+#include "FrameTimeHistogram.h"
+#include <cmath>
+
+// bucket 0 holds everything below 1us, then SubBuckets buckets for every power of two
+// microseconds up to 2^Octaves us (~67 seconds). anything longer lands in the last bucket.
+static const uint32_t SubBuckets = 32;
+static const uint32_t Octaves = 26;
+static const uint32_t NumBuckets = 1 + SubBuckets * Octaves;
+
+FrameTimeHistogram::FrameTimeHistogram(uint32_t windowSize)
+    : mSamples(windowSize > 0 ? windowSize : 1), mBuckets(NumBuckets), mNext(0), mCount(0), mSum(0.0)
+{
+}
+
+uint32_t FrameTimeHistogram::BucketIndex(double seconds)
+{
+    double us = seconds * 1000000.0;
+    if (!(us >= 1.0)) // also catches NaN
+    {
+        return 0;
+    }
+
+    // us = mantissa * 2^exponent with mantissa in [0.5, 1)
+    int exponent;
+    double mantissa = frexp(us, &exponent);
+    uint32_t octave = (uint32_t)(exponent - 1);
+    if (octave >= Octaves)
+    {
+        return NumBuckets - 1;
+    }
+
+    uint32_t sub = (uint32_t)((mantissa * 2.0 - 1.0) * SubBuckets);
+    if (sub >= SubBuckets)
+    {
+        sub = SubBuckets - 1;
+    }
+    return 1 + octave * SubBuckets + sub;
+}
+
+uint32_t FrameTimeHistogram::BucketCount()
+{
+    return NumBuckets;
+}
+
+double FrameTimeHistogram::BucketUpperBound(uint32_t bucket)
+{
+    if (bucket == 0)
+    {
+        return 0.000001;
+    }
+    uint32_t octave = (bucket - 1) / SubBuckets;
+    uint32_t sub = (bucket - 1) % SubBuckets;
+    return ldexp(1.0 + (double)(sub + 1) / SubBuckets, (int)octave) / 1000000.0;
+}
+
+uint32_t FrameTimeHistogram::BucketSamples(uint32_t bucket) const
+{
+    return bucket < NumBuckets ? mBuckets[bucket] : 0;
+}
+
+void FrameTimeHistogram::AddSample(double seconds)
+{
+    if (mCount == mSamples.size())
+    {
+        // the window is full, the oldest sample drops out
+        double oldest = mSamples[mNext];
+        --mBuckets[BucketIndex(oldest)];
+        mSum -= oldest;
+    }
+    else
+    {
+        ++mCount;
+    }
+
+    mSamples[mNext] = seconds;
+    ++mBuckets[BucketIndex(seconds)];
+    mSum += seconds;
+
+    mNext = (mNext + 1) % (uint32_t)mSamples.size();
+}
+
+void FrameTimeHistogram::Clear()
+{
+    for (size_t i = 0; i < mBuckets.size(); ++i)
+    {
+        mBuckets[i] = 0;
+    }
+    mNext = 0;
+    mCount = 0;
+    mSum = 0.0;
+}
+
+uint32_t FrameTimeHistogram::SampleCount() const
+{
+    return mCount;
+}
+
+double FrameTimeHistogram::Max() const
+{
+    double maxTime = 0.0;
+    for (uint32_t i = 0; i < mCount; ++i)
+    {
+        if (mSamples[i] > maxTime)
+        {
+            maxTime = mSamples[i];
+        }
+    }
+    return maxTime;
+}
+
+double FrameTimeHistogram::Average() const
+{
+    return mCount > 0 ? mSum / mCount : 0.0;
+}
+
+double FrameTimeHistogram::Percentile(double fraction) const
+{
+    return Percentile(fraction, Max());
+}
+
+double FrameTimeHistogram::Percentile(double fraction, double maxTime) const
+{
+    if (mCount == 0)
+    {
+        return 0.0;
+    }
+
+    // the sample with this rank (1 based) is the percentile
+    uint32_t rank = (uint32_t)ceil(fraction * mCount);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < NumBuckets; ++i)
+    {
+        seen += mBuckets[i];
+        if (seen >= rank)
+        {
+            // the bucket bound can overshoot the largest sample in it
+            double bound = BucketUpperBound(i);
+            return bound < maxTime ? bound : maxTime;
+        }
+    }
+    return maxTime;
+}
+
+FrameTimeStats FrameTimeHistogram::Stats() const
+{
+    // one scan of the window for the max, the percentiles are clamped to it
+    FrameTimeStats stats;
+    stats.max = Max();
+    stats.p50 = Percentile(0.50, stats.max);
+    stats.p95 = Percentile(0.95, stats.max);
+    stats.p99 = Percentile(0.99, stats.max);
+    stats.average = Average();
+    stats.sampleCount = mCount;
+    return stats;
+}
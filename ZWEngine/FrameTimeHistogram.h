@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// frame time percentiles over a rolling window, all values in seconds
+struct FrameTimeStats
+{
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    double average;
+    uint32_t sampleCount;
+};
+
+// Rolling frame time histogram. The last "windowSize" samples are kept in a ring so they can be
+// removed again, and counted in log-linear buckets (32 per power of two microseconds, so a
+// percentile is off by at most ~3%). Adding a sample is O(1), a percentile query walks the buckets.
+class FrameTimeHistogram
+{
+public:
+    explicit FrameTimeHistogram(uint32_t windowSize = 1024);
+
+    void AddSample(double seconds);
+    void Clear();
+
+    uint32_t SampleCount() const;
+
+    double Percentile(double fraction) const; // fraction in [0, 1], e.g. 0.99 for p99
+    double Max() const; // exact, scans the window
+    double Average() const;
+
+    FrameTimeStats Stats() const;
+
+    // raw buckets, e.g. for drawing the distribution
+    static uint32_t BucketCount();
+    static double BucketUpperBound(uint32_t bucket); // in seconds
+    uint32_t BucketSamples(uint32_t bucket) const;
+
+private:
+    static uint32_t BucketIndex(double seconds);
+    double Percentile(double fraction, double maxTime) const; // maxTime is Max() of the window
+
+    std::vector<double> mSamples; // ring of the last mSamples.size() frame times
+    std::vector<uint32_t> mBuckets;
+    uint32_t mNext; // ring slot the next sample is written to
+    uint32_t mCount; // number of valid samples in the ring
+    double mSum;
+};
@@ -0,0 +1,291 @@
+#include "FrustumCulling.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(ZW_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+// boxes per job of CullAabbsParallel
+static const uint32_t CullChunkSize = 16 * 1024;
+
+void ExtractFrustum(const float* viewProj, Frustum* frustum)
+{
+    // clip = p * viewProj, so clip.x = p . column 0 etc. a point is inside when -w <= x <= w,
+    // -w <= y <= w and 0 <= z <= w, every inequality is a plane made of two columns
+    float column[4][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            column[c][r] = viewProj[r * 4 + c];
+        }
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        frustum->planes[0][i] = column[3][i] + column[0][i]; // left
+        frustum->planes[1][i] = column[3][i] - column[0][i]; // right
+        frustum->planes[2][i] = column[3][i] + column[1][i]; // bottom
+        frustum->planes[3][i] = column[3][i] - column[1][i]; // top
+        frustum->planes[4][i] = column[2][i]; // near
+        frustum->planes[5][i] = column[3][i] - column[2][i]; // far
+    }
+
+    // unit normals, so the plane distances can be compared with the box extents
+    for (int p = 0; p < 6; ++p)
+    {
+        float* plane = frustum->planes[p];
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            plane[0] /= length;
+            plane[1] /= length;
+            plane[2] /= length;
+            plane[3] /= length;
+        }
+    }
+}
+
+void AabbArrays::Resize(uint32_t count)
+{
+    centerX.resize(count);
+    centerY.resize(count);
+    centerZ.resize(count);
+    extentX.resize(count);
+    extentY.resize(count);
+    extentZ.resize(count);
+}
+
+uint32_t AabbArrays::Size() const
+{
+    return (uint32_t)centerX.size();
+}
+
+void ComputeAabb(const void* positions, uint32_t count, uint32_t stride, float center[3], float extent[3])
+{
+    if (count == 0)
+    {
+        center[0] = center[1] = center[2] = 0.0f;
+        extent[0] = extent[1] = extent[2] = 0.0f;
+        return;
+    }
+
+    float minimum[3], maximum[3];
+    memcpy(minimum, positions, sizeof(minimum));
+    memcpy(maximum, positions, sizeof(maximum));
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        float p[3];
+        memcpy(p, (const uint8_t*)positions + (uint64_t)i * stride, sizeof(p));
+        for (int c = 0; c < 3; ++c)
+        {
+            minimum[c] = p[c] < minimum[c] ? p[c] : minimum[c];
+            maximum[c] = p[c] > maximum[c] ? p[c] : maximum[c];
+        }
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        center[c] = 0.5f * (minimum[c] + maximum[c]);
+        extent[c] = 0.5f * (maximum[c] - minimum[c]);
+    }
+}
+
+void TransformAabbs(const float center[3], const float extent[3], const float* world, const uint32_t* indices,
+    uint32_t first, uint32_t count, AabbArrays* boxes)
+{
+    float* centers[3] = { boxes->centerX.data(), boxes->centerY.data(), boxes->centerZ.data() };
+    float* extents[3] = { boxes->extentX.data(), boxes->extentY.data(), boxes->extentZ.data() };
+
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        const float* m = world + 16 * (indices ? indices[i] : i);
+
+        // the center moves with the matrix, the extent along each world axis is the sum of the
+        // local extents projected onto it (Arvo)
+        for (int c = 0; c < 3; ++c)
+        {
+            centers[c][i] = center[0] * m[0 * 4 + c] + center[1] * m[1 * 4 + c] + center[2] * m[2 * 4 + c] + m[3 * 4 + c];
+            extents[c][i] = extent[0] * fabsf(m[0 * 4 + c]) + extent[1] * fabsf(m[1 * 4 + c]) + extent[2] * fabsf(m[2 * 4 + c]);
+        }
+    }
+}
+
+// a box is outside when it is completely behind one plane: the distance of its center plus its
+// extent projected onto the normal is negative
+static uint32_t CullScalar(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible)
+{
+    uint32_t visibleCount = 0;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        bool outside = false;
+        for (int p = 0; p < 6; ++p)
+        {
+            const float* plane = frustum.planes[p];
+            float distance = plane[0] * boxes.centerX[i] + plane[1] * boxes.centerY[i] + plane[2] * boxes.centerZ[i] + plane[3];
+            float radius = fabsf(plane[0]) * boxes.extentX[i] + fabsf(plane[1]) * boxes.extentY[i] + fabsf(plane[2]) * boxes.extentZ[i];
+            outside = outside || distance + radius < 0.0f;
+        }
+
+        // always written, only kept when visible, so there is no branch on the result
+        visible[visibleCount] = i;
+        visibleCount += outside ? 0 : 1;
+    }
+    return visibleCount;
+}
+
+#if defined(ZW_SIMD_X86)
+
+static uint32_t CullSSE2(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible)
+{
+    __m128 planes[6][4];
+    __m128 absNormals[6][3];
+    for (int p = 0; p < 6; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            absNormals[p][c] = _mm_set1_ps(fabsf(frustum.planes[p][c]));
+        }
+    }
+
+    uint32_t visibleCount = 0;
+    uint32_t i = first;
+    for (; i + 4 <= first + count; i += 4)
+    {
+        const __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+        const __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+        const __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+        const __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+        const __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+        const __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+
+        // one plane against 4 boxes per step, a lane's sign bit ends up set if any plane rejects it
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], cx), _mm_mul_ps(planes[p][1], cy)),
+                _mm_add_ps(_mm_mul_ps(planes[p][2], cz), planes[p][3]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absNormals[p][0], ex), _mm_mul_ps(absNormals[p][1], ey)),
+                _mm_mul_ps(absNormals[p][2], ez));
+            outside = _mm_or_ps(outside, _mm_add_ps(distance, radius));
+        }
+        int outsideMask = _mm_movemask_ps(outside);
+
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            visible[visibleCount] = i + lane;
+            visibleCount += ((outsideMask >> lane) & 1) ^ 1;
+        }
+    }
+    return visibleCount + CullScalar(frustum, boxes, i, first + count - i, visible + visibleCount);
+}
+
+ZW_TARGET_AVX2
+static uint32_t CullAVX2(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible)
+{
+    __m256 planes[6][4];
+    __m256 absNormals[6][3];
+    for (int p = 0; p < 6; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            absNormals[p][c] = _mm256_set1_ps(fabsf(frustum.planes[p][c]));
+        }
+    }
+
+    uint32_t visibleCount = 0;
+    uint32_t i = first;
+    for (; i + 8 <= first + count; i += 8)
+    {
+        const __m256 cx = _mm256_loadu_ps(&boxes.centerX[i]);
+        const __m256 cy = _mm256_loadu_ps(&boxes.centerY[i]);
+        const __m256 cz = _mm256_loadu_ps(&boxes.centerZ[i]);
+        const __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+        const __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+        const __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; ++p)
+        {
+            __m256 distance = _mm256_fmadd_ps(planes[p][0], cx, _mm256_fmadd_ps(planes[p][1], cy, _mm256_fmadd_ps(planes[p][2], cz, planes[p][3])));
+            __m256 radius = _mm256_fmadd_ps(absNormals[p][0], ex, _mm256_fmadd_ps(absNormals[p][1], ey, _mm256_mul_ps(absNormals[p][2], ez)));
+            outside = _mm256_or_ps(outside, _mm256_add_ps(distance, radius));
+        }
+        int outsideMask = _mm256_movemask_ps(outside);
+
+        for (uint32_t lane = 0; lane < 8; ++lane)
+        {
+            visible[visibleCount] = i + lane;
+            visibleCount += ((outsideMask >> lane) & 1) ^ 1;
+        }
+    }
+    return visibleCount + CullScalar(frustum, boxes, i, first + count - i, visible + visibleCount);
+}
+
+#endif
+
+uint32_t CullAabbs(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible,
+    SimdLevel level)
+{
+    if (level > GetSimdLevel())
+    {
+        level = GetSimdLevel();
+    }
+
+    switch (level)
+    {
+#if defined(ZW_SIMD_X86)
+    case SimdLevel::AVX2:
+        return CullAVX2(frustum, boxes, first, count, visible);
+    case SimdLevel::SSE2:
+        return CullSSE2(frustum, boxes, first, count, visible);
+#endif
+    default:
+        return CullScalar(frustum, boxes, first, count, visible);
+    }
+}
+
+uint32_t CullAabbs(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible)
+{
+    return CullAabbs(frustum, boxes, first, count, visible, GetSimdLevel());
+}
+
+uint32_t CullAabbsParallel(JobSystem* jobs, const Frustum& frustum, const AabbArrays& boxes, uint32_t* visible)
+{
+    const uint32_t count = boxes.Size();
+    const uint32_t chunkCount = (count + CullChunkSize - 1) / CullChunkSize;
+    if (chunkCount <= 1)
+    {
+        return CullAabbs(frustum, boxes, 0, count, visible);
+    }
+
+    // every chunk writes its visible indices where its boxes start, then the chunks are packed
+    // together. the visible indices are a fraction of the box data, so the packing pass is cheap
+    std::vector<uint32_t> chunkVisible(chunkCount);
+    jobs->ParallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t chunk = begin; chunk < end; ++chunk)
+        {
+            uint32_t first = chunk * CullChunkSize;
+            uint32_t chunkSize = count - first < CullChunkSize ? count - first : CullChunkSize;
+            chunkVisible[chunk] = CullAabbs(frustum, boxes, first, chunkSize, visible + first);
+        }
+    });
+
+    uint32_t visibleCount = chunkVisible[0];
+    for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+    {
+        memmove(visible + visibleCount, visible + (uint64_t)chunk * CullChunkSize, chunkVisible[chunk] * sizeof(uint32_t));
+        visibleCount += chunkVisible[chunk];
+    }
+    return visibleCount;
+}
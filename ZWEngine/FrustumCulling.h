@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include <cstdint>
+#include <vector>
+
+// View frustum as six planes (left, right, bottom, top, near, far). A point p is inside a plane
+// when a * p.x + b * p.y + c * p.z + d >= 0, the normals (a, b, c) are unit length.
+struct Frustum
+{
+    float planes[6][4];
+};
+
+// planes of "viewProj" (16 floats, DirectXMath row-vector layout, d3d depth range 0..1)
+void ExtractFrustum(const float* viewProj, Frustum* frustum);
+
+// axis aligned boxes as center and half extent, structure of arrays so the culling kernel loads
+// the same component of 4 (SSE2) or 8 (AVX2) boxes with one instruction
+struct AabbArrays
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    void Resize(uint32_t count);
+    uint32_t Size() const;
+};
+
+// bounds of "count" positions of 3 floats, "stride" bytes apart (e.g. the position of a vertex)
+void ComputeAabb(const void* positions, uint32_t count, uint32_t stride, float center[3], float extent[3]);
+
+// world space bounds of boxes [first, first + count): box i is the local box ("center", "extent")
+// transformed by world matrix indices[i] (16 floats each, row-vector layout). the result encloses
+// the transformed box
+void TransformAabbs(const float center[3], const float extent[3], const float* world, const uint32_t* indices,
+    uint32_t first, uint32_t count, AabbArrays* boxes);
+
+// write the indices of the boxes in [first, first + count) that intersect the frustum to "visible",
+// in order, and return how many there are. boxes crossing a plane count as visible. "visible" needs
+// room for "count" indices, the kernels store every index and only advance past the visible ones
+uint32_t CullAabbs(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible);
+
+// same, with a fixed kernel instead of the best one for this cpu (for comparing the paths)
+uint32_t CullAabbs(const Frustum& frustum, const AabbArrays& boxes, uint32_t first, uint32_t count, uint32_t* visible,
+    SimdLevel level);
+
+// CullAabbs over all boxes, split into chunks that run on "jobs". "visible" needs room for
+// boxes.Size() indices, the result is compacted and in order like the single threaded one
+uint32_t CullAabbsParallel(JobSystem* jobs, const Frustum& frustum, const AabbArrays& boxes, uint32_t* visible);
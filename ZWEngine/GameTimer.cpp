@@ -2,16 +2,23 @@
 // GameTimer.cpp by Frank Luna (C) 2011 All Rights Reserved.
 //***************************************************************************************
 
-#include <windows.h>
+#include <chrono>
 #include "GameTimer.h"
 
+// steady_clock is monotonic on every platform (QueryPerformanceCounter on windows,
+// clock_gettime(CLOCK_MONOTONIC) on linux), so it never jumps when the wall clock is changed.
+typedef std::chrono::steady_clock TimerClock;
+
+static int64_t QueryCounter()
+{
+	return (int64_t)TimerClock::now().time_since_epoch().count();
+}
+
 GameTimer::GameTimer()
 : mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
-  mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+  mPausedTime(0), mStopTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+	mSecondsPerCount = (double)TimerClock::period::num / (double)TimerClock::period::den;
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -53,21 +60,31 @@ float GameTimer::DeltaTime()const
 	return (float)mDeltaTime;
 }
 
+double GameTimer::DeltaTimeSeconds()const
+{
+	return mDeltaTime;
+}
+
+const FrameTimeHistogram& GameTimer::FrameTimes()const
+{
+	return mFrameTimes;
+}
+
 void GameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	int64_t currTime = QueryCounter();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
+	mPausedTime = 0;
 	mStopTime = 0;
 	mStopped  = false;
+	mFrameTimes.Clear();
 }
 
 void GameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	int64_t startTime = QueryCounter();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -90,8 +107,7 @@ void GameTimer::Stop()
 {
 	if( !mStopped )
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+		int64_t currTime = QueryCounter();
 
 		mStopTime = currTime;
 		mStopped  = true;
@@ -106,9 +122,7 @@ void GameTimer::Tick()
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-	mCurrTime = currTime;
+	mCurrTime = QueryCounter();
 
 	// Time difference between this frame and the previous.
 	mDeltaTime = (mCurrTime - mPrevTime)*mSecondsPerCount;
@@ -123,5 +137,7 @@ void GameTimer::Tick()
 	{
 		mDeltaTime = 0.0;
 	}
+
+	mFrameTimes.AddSample(mDeltaTime);
 }
 
@@ -5,6 +5,9 @@
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <cstdint>
+#include "FrameTimeHistogram.h"
+
 class GameTimer
 {
 public:
@@ -12,6 +15,10 @@ public:
 
 	float TotalTime()const; // in seconds
 	float DeltaTime()const; // in seconds
+	double DeltaTimeSeconds()const; // full precision DeltaTime
+
+	// the deltas of the last frames, for p50/p95/p99/max frame time
+	const FrameTimeHistogram& FrameTimes()const;
 
 	void Reset(); // Call before message loop.
 	void Start(); // Call when unpaused.
@@ -22,13 +29,15 @@ private:
 	double mSecondsPerCount;
 	double mDeltaTime;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	int64_t mBaseTime;
+	int64_t mPausedTime;
+	int64_t mStopTime;
+	int64_t mPrevTime;
+	int64_t mCurrTime;
 
 	bool mStopped;
+
+	FrameTimeHistogram mFrameTimes;
 };
 
 #endif // GAMETIMER_H
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "IndexNarrowing.h"
+
+#if defined(ZW_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+static uint32_t GetMaxIndexScalar(const uint32_t* indices, uint32_t count)
+{
+    uint32_t maxIndex = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        maxIndex = indices[i] > maxIndex ? indices[i] : maxIndex;
+    }
+    return maxIndex;
+}
+
+static void NarrowIndicesScalar(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t index = indices[i] - baseVertex;
+        destination[i] = (uint16_t)(index < 0xffff ? index : 0xffff);
+    }
+}
+
+#if defined(ZW_SIMD_X86)
+
+// sse2 only compares signed, so both sides are moved down by 2^31 first
+static uint32_t GetMaxIndexSSE2(const uint32_t* indices, uint32_t count)
+{
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    __m128i maxIndex = bias; // 0
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i value = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(indices + i)), bias);
+        __m128i greater = _mm_cmpgt_epi32(value, maxIndex);
+        maxIndex = _mm_or_si128(_mm_and_si128(greater, value), _mm_andnot_si128(greater, maxIndex));
+    }
+
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, _mm_xor_si128(maxIndex, bias));
+    uint32_t result = GetMaxIndexScalar(lanes, 4);
+    uint32_t tail = GetMaxIndexScalar(indices + i, count - i);
+    return tail > result ? tail : result;
+}
+
+// _mm_packus_epi32 is sse4.1: clamp to 65535 with the biased compare, then move the values into the
+// signed range for _mm_packs_epi32 and back
+static void NarrowIndicesSSE2(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex)
+{
+    const __m128i base = _mm_set1_epi32((int)baseVertex);
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    const __m128i limit = _mm_set1_epi32(0xffff);
+    const __m128i biasedLimit = _mm_set1_epi32((int)(0x80000000u + 0xffff));
+    const __m128i half = _mm_set1_epi32(0x8000);
+    const __m128i halfBack = _mm_set1_epi16((short)0x8000);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(indices + i)), base);
+        __m128i b = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(indices + i + 4)), base);
+
+        __m128i overA = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), biasedLimit);
+        __m128i overB = _mm_cmpgt_epi32(_mm_xor_si128(b, bias), biasedLimit);
+        a = _mm_or_si128(_mm_andnot_si128(overA, a), _mm_and_si128(overA, limit));
+        b = _mm_or_si128(_mm_andnot_si128(overB, b), _mm_and_si128(overB, limit));
+
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, half), _mm_sub_epi32(b, half));
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_xor_si128(packed, halfBack));
+    }
+    NarrowIndicesScalar(destination + i, indices + i, count - i, baseVertex);
+}
+
+ZW_TARGET_AVX2
+static uint32_t GetMaxIndexAVX2(const uint32_t* indices, uint32_t count)
+{
+    __m256i maxIndex = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        maxIndex = _mm256_max_epu32(maxIndex, _mm256_loadu_si256((const __m256i*)(indices + i)));
+    }
+
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, maxIndex);
+    uint32_t result = GetMaxIndexScalar(lanes, 8);
+    uint32_t tail = GetMaxIndexScalar(indices + i, count - i);
+    return tail > result ? tail : result;
+}
+
+ZW_TARGET_AVX2
+static void NarrowIndicesAVX2(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex)
+{
+    const __m256i base = _mm256_set1_epi32((int)baseVertex);
+    const __m256i limit = _mm256_set1_epi32(0xffff);
+
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i a = _mm256_min_epu32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(indices + i)), base), limit);
+        __m256i b = _mm256_min_epu32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(indices + i + 8)), base), limit);
+
+        // the pack works per 128 bit lane: a0-3 b0-3 | a4-7 b4-7, put the quarters back in order
+        __m256i packed = _mm256_packus_epi32(a, b);
+        _mm256_storeu_si256((__m256i*)(destination + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    NarrowIndicesScalar(destination + i, indices + i, count - i, baseVertex);
+}
+
+#endif
+
+uint32_t GetMaxIndex(const uint32_t* indices, uint32_t count, SimdLevel level)
+{
+    if (level > GetSimdLevel())
+    {
+        level = GetSimdLevel();
+    }
+
+    switch (level)
+    {
+#if defined(ZW_SIMD_X86)
+    case SimdLevel::AVX2:
+        return GetMaxIndexAVX2(indices, count);
+    case SimdLevel::SSE2:
+        return GetMaxIndexSSE2(indices, count);
+#endif
+    default:
+        return GetMaxIndexScalar(indices, count);
+    }
+}
+
+void NarrowIndices(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex, SimdLevel level)
+{
+    if (level > GetSimdLevel())
+    {
+        level = GetSimdLevel();
+    }
+
+    switch (level)
+    {
+#if defined(ZW_SIMD_X86)
+    case SimdLevel::AVX2:
+        NarrowIndicesAVX2(destination, indices, count, baseVertex);
+        break;
+    case SimdLevel::SSE2:
+        NarrowIndicesSSE2(destination, indices, count, baseVertex);
+        break;
+#endif
+    default:
+        NarrowIndicesScalar(destination, indices, count, baseVertex);
+        break;
+    }
+}
+
+uint32_t GetMaxIndex(const uint32_t* indices, uint32_t count)
+{
+    return GetMaxIndex(indices, count, GetSimdLevel());
+}
+
+void NarrowIndices(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex)
+{
+    NarrowIndices(destination, indices, count, baseVertex, GetSimdLevel());
+}
+
+void BuildIndexBuffer16(const uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount,
+    uint32_t vertexSize, std::vector<uint16_t>* indices16, std::vector<uint8_t>* vertices16, std::vector<Submesh>* submeshes)
+{
+    const uint8_t* vertexData = (const uint8_t*)vertices;
+    submeshes->clear();
+
+    // the whole mesh is addressable from vertex 0: narrow the indices as they are
+    if (GetMaxIndex(indices, indexCount) < MaxIndex16VertexCount)
+    {
+        indices16->resize(indexCount);
+        NarrowIndices(indices16->data(), indices, indexCount, 0);
+        vertices16->assign(vertexData, vertexData + (uint64_t)vertexCount * vertexSize);
+
+        Submesh submesh = { 0, indexCount, 0 };
+        submeshes->push_back(submesh);
+        return;
+    }
+
+    // greedy cut: a triangle goes into the current submesh unless its new vertices would push it past
+    // 65536. "stamp" says which submesh a vertex was last copied into, "localIndex" where
+    indices16->clear();
+    indices16->reserve(indexCount);
+    vertices16->clear();
+    std::vector<uint32_t> stamp(vertexCount, 0xffffffff);
+    std::vector<uint32_t> localIndex(vertexCount, 0);
+    uint32_t current = 0;
+    uint32_t used = 0;
+    Submesh submesh = { 0, 0, 0 };
+
+    const uint32_t triangleCount = indexCount / 3;
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t* triangle = indices + t * 3;
+        if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount)
+        {
+            continue; // the draw would skip it too
+        }
+
+        uint32_t added = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            added += stamp[triangle[k]] != current ? 1 : 0;
+        }
+        if (used + added > MaxIndex16VertexCount)
+        {
+            submeshes->push_back(submesh);
+            submesh.firstIndex = (uint32_t)indices16->size();
+            submesh.indexCount = 0;
+            submesh.baseVertex = (int32_t)(vertices16->size() / vertexSize);
+            ++current;
+            used = 0;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t vertex = triangle[k];
+            if (stamp[vertex] != current)
+            {
+                stamp[vertex] = current;
+                localIndex[vertex] = used++;
+                const uint8_t* source = vertexData + (uint64_t)vertex * vertexSize;
+                vertices16->insert(vertices16->end(), source, source + vertexSize);
+            }
+            indices16->push_back((uint16_t)localIndex[vertex]);
+        }
+        submesh.indexCount += 3;
+    }
+
+    if (submesh.indexCount > 0)
+    {
+        submeshes->push_back(submesh);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <cstdint>
+#include <vector>
+
+// 16 bit index buffers for meshes of any size. 16 bit indices halve the index memory and the
+// bandwidth the input assembler reads, they reach 65536 vertices, counted from the draw's base
+// vertex. Bigger meshes are cut into submeshes that each fit, instead of going back to 32 bits.
+
+const uint32_t MaxIndex16VertexCount = 65536;
+
+// a range of the index buffer, drawn with one DrawIndexedInstanced
+struct Submesh
+{
+    uint32_t firstIndex; // StartIndexLocation
+    uint32_t indexCount;
+    int32_t baseVertex; // BaseVertexLocation, added to every index of the range
+};
+
+// the largest of "count" indices, 0 for none
+uint32_t GetMaxIndex(const uint32_t* indices, uint32_t count);
+
+// destination[i] = indices[i] - baseVertex, every result has to fit in 16 bits (the rest saturates).
+// "destination" may be "indices", the results then take the first half of the memory
+void NarrowIndices(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex);
+
+// same, but with a fixed kernel instead of the best one for this cpu (for comparing the paths).
+// the result is the same for every level
+uint32_t GetMaxIndex(const uint32_t* indices, uint32_t count, SimdLevel level);
+void NarrowIndices(uint16_t* destination, const uint32_t* indices, uint32_t count, uint32_t baseVertex, SimdLevel level);
+
+// the 16 bit index buffer of a triangle list, with the vertex buffer to draw it from and the submeshes
+// to draw. a mesh that fits keeps its vertices and is one submesh. a bigger one is cut into runs of
+// triangles using at most 65536 vertices each, every run gets its own copy of its vertices (numbered by
+// first use, vertices on a cut are stored twice) and a base vertex pointing at them
+void BuildIndexBuffer16(const uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount,
+    uint32_t vertexSize, std::vector<uint16_t>* indices16, std::vector<uint8_t>* vertices16, std::vector<Submesh>* submeshes);
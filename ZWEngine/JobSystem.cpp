@@ -0,0 +1,275 @@
+#include "JobSystem.h"
+
+// which JobSystem thread this is, and of which system
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local uint32_t currentThreadIndex = 0;
+
+JobCounter::JobCounter()
+    : mPending(0), mFinishing(0)
+{
+}
+
+bool JobCounter::IsDone() const
+{
+    // a job enters mFinishing before it drops mPending, so once mPending is seen at 0 the jobs that
+    // may still touch the counter are all counted in mFinishing
+    return mPending.load(std::memory_order_acquire) == 0 && mFinishing.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem(uint32_t threadCount)
+    : mQueuedJobs(0), mStop(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0)
+        {
+            threadCount = 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        mQueues.push_back(new WorkQueue());
+    }
+
+    currentSystem = this;
+    currentThreadIndex = 0;
+    for (uint32_t i = 1; i < threadCount; ++i)
+    {
+        mWorkers.push_back(std::thread(&JobSystem::WorkerMain, this, i));
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+
+    for (size_t i = 0; i < mWorkers.size(); ++i)
+    {
+        mWorkers[i].join();
+    }
+    for (size_t i = 0; i < mQueues.size(); ++i)
+    {
+        delete mQueues[i];
+    }
+
+    if (currentSystem == this)
+    {
+        currentSystem = nullptr;
+    }
+}
+
+uint32_t JobSystem::GetThreadCount() const
+{
+    return (uint32_t)mQueues.size();
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const
+{
+    return currentSystem == this ? currentThreadIndex : 0;
+}
+
+void JobSystem::Run(std::function<void()> job, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->mPending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job j;
+    j.function = std::move(job);
+    j.counter = counter;
+    Push(std::move(j));
+}
+
+void JobSystem::RunAfter(JobCounter* dependency, std::function<void()> job, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->mPending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        // the last job of "dependency" drains mWaiting under the same lock after it dropped the count
+        // to 0, so the job is either seen here as ready or picked up by that drain, never lost
+        std::lock_guard<std::mutex> lock(dependency->mMutex);
+        if (dependency->mPending.load(std::memory_order_acquire) != 0)
+        {
+            JobCounter::Waiting waiting;
+            waiting.function = std::move(job);
+            waiting.counter = counter;
+            dependency->mWaiting.push_back(std::move(waiting));
+            return;
+        }
+    }
+
+    Job j;
+    j.function = std::move(job);
+    j.counter = counter;
+    Push(std::move(j));
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+    uint32_t threadIndex = GetCurrentThreadIndex();
+    while (!counter->IsDone())
+    {
+        Job job;
+        if (Pop(threadIndex, &job))
+        {
+            Execute(job);
+        }
+        else
+        {
+            // the remaining jobs are running on other threads
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (grainSize == 0)
+    {
+        grainSize = 1;
+    }
+
+    // not worth a job
+    if (count <= grainSize || GetThreadCount() == 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    // queue every range but the first and run that one right away. the queue is LIFO for its owner,
+    // so the other threads steal from the far end while this one works backwards from the front
+    JobCounter counter;
+    for (uint32_t begin = grainSize; begin < count; begin += grainSize)
+    {
+        uint32_t end = count - begin > grainSize ? begin + grainSize : count;
+        Run([&body, begin, end]() { body(begin, end); }, &counter);
+    }
+    body(0, grainSize);
+    Wait(&counter);
+}
+
+void JobSystem::Push(Job job)
+{
+    WorkQueue* queue = mQueues[GetCurrentThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(std::move(job));
+    }
+    mQueuedJobs.fetch_add(1, std::memory_order_release);
+
+    {
+        // taking the lock orders this against a worker checking mQueuedJobs before it sleeps
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+    mWakeUp.notify_one();
+}
+
+bool JobSystem::Pop(uint32_t threadIndex, Job* job)
+{
+    if (mQueuedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    // newest job of our own queue
+    {
+        WorkQueue* queue = mQueues[threadIndex];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            *job = std::move(queue->jobs.back());
+            queue->jobs.pop_back();
+            mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // oldest job of somebody else's, starting at the next thread so the victims are spread out
+    uint32_t threadCount = GetThreadCount();
+    for (uint32_t i = 1; i < threadCount; ++i)
+    {
+        WorkQueue* queue = mQueues[(threadIndex + i) % threadCount];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty())
+        {
+            *job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+            mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    job.function();
+
+    JobCounter* counter = job.counter;
+    if (!counter)
+    {
+        return;
+    }
+
+    // the waiting list is taken and the count dropped under the lock, so RunAfter either sees the
+    // count above 0 and its job is in the list we take, or sees it at 0 and queues the job itself.
+    // the unlock still touches the counter after the count reached 0, so the job stays in
+    // mFinishing until it is out, and decrementing that is the very last access: a thread in Wait
+    // may destroy the counter right after it
+    std::vector<JobCounter::Waiting> ready;
+    counter->mFinishing.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(counter->mMutex);
+        if (counter->mPending.load(std::memory_order_relaxed) == 1)
+        {
+            ready.swap(counter->mWaiting);
+        }
+        counter->mPending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    counter->mFinishing.fetch_sub(1, std::memory_order_release);
+
+    for (size_t i = 0; i < ready.size(); ++i)
+    {
+        Job next;
+        next.function = std::move(ready[i].function);
+        next.counter = ready[i].counter;
+        Push(std::move(next));
+    }
+}
+
+void JobSystem::WorkerMain(uint32_t threadIndex)
+{
+    currentSystem = this;
+    currentThreadIndex = threadIndex;
+
+    while (true)
+    {
+        Job job;
+        if (Pop(threadIndex, &job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWakeUp.wait(lock, [this]() { return mStop.load() || mQueuedJobs.load() > 0; });
+        if (mStop)
+        {
+            return;
+        }
+    }
+}
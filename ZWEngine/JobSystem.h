@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// counts unfinished jobs. jobs started with a counter add one when they are queued and remove it
+// when they are done, so a counter of 0 means everything it tracked has run. jobs can also be
+// held back until a counter reaches 0 (JobSystem::RunAfter), which is how dependencies are built
+class JobCounter
+{
+public:
+    JobCounter();
+
+    // true once every job has finished and let go of the counter, it may be destroyed from then on
+    bool IsDone() const;
+
+private:
+    friend class JobSystem;
+
+    struct Waiting
+    {
+        std::function<void()> function;
+        JobCounter* counter;
+    };
+
+    std::atomic<uint32_t> mPending;
+    std::atomic<uint32_t> mFinishing; // jobs inside Execute's bookkeeping, IsDone waits for them to leave
+    std::mutex mMutex; // guards mWaiting
+    std::vector<Waiting> mWaiting; // jobs started once mPending drops to 0
+};
+
+// Work stealing job scheduler. Every thread (the creating thread is thread 0, the others are
+// workers) has its own deque: it pushes and pops new jobs at the back, so it keeps working on
+// what it just split off while that data is still in cache, and idle threads steal the oldest
+// jobs from the front of other deques. Waiting on a counter runs jobs instead of blocking, so
+// jobs can wait on other jobs without starving the pool.
+class JobSystem
+{
+public:
+    // "threadCount" threads in total including the calling thread, 0 for one per core
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();
+
+    uint32_t GetThreadCount() const;
+
+    // index of the calling thread in [0, GetThreadCount()), threads outside the system get 0
+    uint32_t GetCurrentThreadIndex() const;
+
+    // queue "job", "counter" (optional) is incremented now and decremented when the job finished
+    void Run(std::function<void()> job, JobCounter* counter = nullptr);
+
+    // like Run, but the job is only queued once "dependency" reaches 0
+    void RunAfter(JobCounter* dependency, std::function<void()> job, JobCounter* counter = nullptr);
+
+    // run jobs until "counter" reaches 0
+    void Wait(JobCounter* counter);
+
+    // call body(begin, end) for consecutive ranges of at most "grainSize" items covering [0, count),
+    // spread over all threads. returns when every range is done
+    void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& body);
+
+private:
+    struct Job
+    {
+        std::function<void()> function;
+        JobCounter* counter;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void Push(Job job);
+    bool Pop(uint32_t threadIndex, Job* job); // own queue first, then steal
+    void Execute(Job& job);
+    void WorkerMain(uint32_t threadIndex);
+
+    std::vector<WorkQueue*> mQueues; // one per thread
+    std::vector<std::thread> mWorkers;
+
+    std::atomic<uint32_t> mQueuedJobs; // jobs sitting in any queue
+    std::atomic<bool> mStop;
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeUp;
+};
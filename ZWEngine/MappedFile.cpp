@@ -0,0 +1,277 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : mData(nullptr), mSize(0), mOpen(false)
+#if defined(_WIN32)
+    , mFile(INVALID_HANDLE_VALUE), mMapping(nullptr)
+#else
+    , mFile(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+    mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return Map();
+}
+
+bool MappedFile::Open(const wchar_t* path)
+{
+    Close();
+    mFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return Map();
+}
+
+bool MappedFile::Map()
+{
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size))
+    {
+        Close();
+        return false;
+    }
+    mSize = (uint64_t)size.QuadPart;
+
+    // a 32 bit process can't map more than its address space
+    if (mSize > (uint64_t)(SIZE_T)-1)
+    {
+        Close();
+        return false;
+    }
+
+    // an empty file can't be mapped, it's just open with no data
+    if (mSize != 0)
+    {
+        mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mMapping)
+        {
+            Close();
+            return false;
+        }
+        mData = (const uint8_t*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+        if (!mData)
+        {
+            Close();
+            return false;
+        }
+    }
+    mOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+    }
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFile);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+    mFile = INVALID_HANDLE_VALUE;
+    mMapping = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+    mFile = open(path, O_RDONLY | O_CLOEXEC);
+    return Map();
+}
+
+bool MappedFile::Map()
+{
+    if (mFile < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(mFile, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        Close();
+        return false;
+    }
+    mSize = (uint64_t)info.st_size;
+
+    if (mSize > (uint64_t)(size_t)-1)
+    {
+        Close();
+        return false;
+    }
+
+    if (mSize != 0)
+    {
+        void* data = mmap(nullptr, (size_t)mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+        if (data == MAP_FAILED)
+        {
+            Close();
+            return false;
+        }
+        mData = (const uint8_t*)data;
+    }
+
+    // the mapping keeps the file alive on its own
+    close(mFile);
+    mFile = -1;
+    mOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mData)
+    {
+        munmap((void*)mData, (size_t)mSize);
+    }
+    if (mFile >= 0)
+    {
+        close(mFile);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+    mFile = -1;
+}
+
+#endif
+
+bool MappedFile::IsOpen() const
+{
+    return mOpen;
+}
+
+uint64_t MappedFile::GetSize() const
+{
+    return mSize;
+}
+
+const uint8_t* MappedFile::GetData() const
+{
+    return mData;
+}
+
+ByteSpan MappedFile::GetSpan() const
+{
+    ByteSpan span;
+    span.data = mData;
+    span.size = mSize;
+    return span;
+}
+
+bool MappedFile::Span(uint64_t offset, uint64_t size, ByteSpan* span) const
+{
+    // written so it can't overflow for offsets near 2^64
+    if (offset > mSize || size > mSize - offset)
+    {
+        return false;
+    }
+    span->data = mData + offset;
+    span->size = size;
+    return true;
+}
+
+void MappedFile::Advise(MapAdvice advice, uint64_t offset, uint64_t size) const
+{
+    if (!mData || offset >= mSize)
+    {
+        return;
+    }
+    if (size == 0 || size > mSize - offset)
+    {
+        size = mSize - offset;
+    }
+
+#if defined(_WIN32)
+    // views have no read ahead policy on windows, only an explicit prefetch
+#if _WIN32_WINNT >= _WIN32_WINNT_WIN8
+    if (advice == MapAdvice::WillNeed)
+    {
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = (PVOID)(mData + offset);
+        range.NumberOfBytes = (SIZE_T)size;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    (void)advice;
+#endif
+#else
+    // madvise wants a page aligned start
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t begin = offset & ~(pageSize - 1);
+    size += offset - begin;
+
+    int flag = MADV_NORMAL;
+    switch (advice)
+    {
+    case MapAdvice::Sequential:
+        flag = MADV_SEQUENTIAL;
+        break;
+    case MapAdvice::Random:
+        flag = MADV_RANDOM;
+        break;
+    case MapAdvice::WillNeed:
+        flag = MADV_WILLNEED;
+        break;
+    default:
+        break;
+    }
+    // only a hint, failing is harmless
+    madvise((void*)(mData + begin), (size_t)size, flag);
+#endif
+}
+
+void MappedFile::Touch(uint64_t offset, uint64_t size) const
+{
+    if (!mData || offset >= mSize)
+    {
+        return;
+    }
+    if (size == 0 || size > mSize - offset)
+    {
+        size = mSize - offset;
+    }
+
+    // one byte per 4KB page is enough to fault it in, larger pages are just touched more often
+    const uint64_t step = 4096;
+    uint8_t sum = 0;
+    for (uint64_t i = 0; i < size; i += step)
+    {
+        sum += ((const volatile uint8_t*)mData)[offset + i];
+    }
+    sum += ((const volatile uint8_t*)mData)[offset + size - 1];
+    (void)sum;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+// a range of bytes owned by someone else, e.g. a part of a mapped file
+struct ByteSpan
+{
+    const uint8_t* data;
+    uint64_t size;
+};
+
+// access pattern hints, the os may read ahead or drop pages accordingly
+enum class MapAdvice
+{
+    Normal,
+    Sequential, // read front to back once
+    Random,
+    WillNeed, // start reading the range in now
+};
+
+// Read only view of a whole file. The file is mapped instead of copied, so its pages are shared
+// with the os file cache, only the parts actually touched become resident, and sizes beyond 4GB
+// work (on 64 bit builds). Spans handed out stay valid until the file is closed.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // map "path", closes whatever was open before. false if the file can't be opened or mapped
+    bool Open(const char* path);
+#if defined(_WIN32)
+    bool Open(const wchar_t* path);
+#endif
+    void Close();
+
+    bool IsOpen() const;
+    uint64_t GetSize() const;
+    const uint8_t* GetData() const; // null for an empty file
+
+    ByteSpan GetSpan() const; // the whole file
+
+    // [offset, offset + size) of the file, false if it reaches past the end
+    bool Span(uint64_t offset, uint64_t size, ByteSpan* span) const;
+
+    // hint how [offset, offset + size) will be read, size 0 is up to the end of the file
+    void Advise(MapAdvice advice, uint64_t offset = 0, uint64_t size = 0) const;
+
+    // read every page of the range now, so later accesses don't fault. blocks until it's resident
+    void Touch(uint64_t offset = 0, uint64_t size = 0) const;
+
+private:
+    bool Map(); // maps the opened file handle
+
+    const uint8_t* mData;
+    uint64_t mSize;
+    bool mOpen;
+#if defined(_WIN32)
+    void* mFile; // HANDLE
+    void* mMapping; // HANDLE
+#else
+    int mFile;
+#endif
+};
@@ -0,0 +1,195 @@
+#include "MeshFile.h"
+#include <cstring>
+#include <fstream>
+
+// the only stride each layout can have, the input layouts are fixed
+static uint32_t GetVertexLayoutStride(uint32_t layout)
+{
+    switch (layout)
+    {
+    case (uint32_t)VertexLayout::PositionColor:
+        return 28;
+    case (uint32_t)VertexLayout::PositionColorQuantized:
+        return 12;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t GetIndexSize(uint32_t format)
+{
+    switch (format)
+    {
+    case (uint32_t)IndexFormat::UInt16:
+        return 2;
+    case (uint32_t)IndexFormat::UInt32:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// [offset, offset + size) of "file", aligned and in bounds
+static bool GetSection(ByteSpan file, uint64_t offset, uint64_t size, ByteSpan* section)
+{
+    if (offset % MeshFileAlignment != 0 || offset > file.size || size > file.size - offset)
+    {
+        return false;
+    }
+    section->data = file.data + offset;
+    section->size = size;
+    return true;
+}
+
+static uint64_t AlignUp(uint64_t value)
+{
+    return (value + MeshFileAlignment - 1) & ~(uint64_t)(MeshFileAlignment - 1);
+}
+
+bool ParseMeshFile(ByteSpan file, MeshFileInfo* info)
+{
+    if (file.size < sizeof(MeshFileHeader))
+    {
+        return false;
+    }
+
+    MeshFileHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    if (header.magic != MeshFileMagic || header.version != MeshFileVersion)
+    {
+        return false;
+    }
+
+    const uint32_t indexSize = GetIndexSize(header.indexFormat);
+    if (header.vertexStride == 0 || header.vertexStride != GetVertexLayoutStride(header.vertexLayout) || indexSize == 0)
+    {
+        return false;
+    }
+
+    ByteSpan submeshes;
+    if (!GetSection(file, header.vertexOffset, (uint64_t)header.vertexCount * header.vertexStride, &info->vertices) ||
+        !GetSection(file, header.indexOffset, (uint64_t)header.indexCount * indexSize, &info->indices) ||
+        !GetSection(file, header.submeshOffset, (uint64_t)header.submeshCount * sizeof(Submesh), &submeshes))
+    {
+        return false;
+    }
+
+    // the submeshes have to stay inside the sections. the indices themselves aren't read, that would
+    // touch every page of the section before the upload does
+    info->submeshes = (const Submesh*)submeshes.data;
+    info->submeshCount = header.submeshCount;
+    for (uint32_t i = 0; i < header.submeshCount; ++i)
+    {
+        const Submesh& submesh = info->submeshes[i];
+        if ((uint64_t)submesh.firstIndex + submesh.indexCount > header.indexCount || submesh.baseVertex < 0 ||
+            (uint32_t)submesh.baseVertex >= header.vertexCount)
+        {
+            return false;
+        }
+    }
+
+    info->vertexLayout = (VertexLayout)header.vertexLayout;
+    info->vertexStride = header.vertexStride;
+    info->vertexCount = header.vertexCount;
+    info->indexFormat = (IndexFormat)header.indexFormat;
+    info->indexCount = header.indexCount;
+    memcpy(info->boundsCenter, header.boundsCenter, sizeof(header.boundsCenter));
+    memcpy(info->boundsExtent, header.boundsExtent, sizeof(header.boundsExtent));
+    return true;
+}
+
+bool WriteMeshFile(const char* path, const MeshFileInfo& mesh)
+{
+    const uint64_t vertexSize = (uint64_t)mesh.vertexCount * mesh.vertexStride;
+    const uint64_t indexSize = (uint64_t)mesh.indexCount * GetIndexSize((uint32_t)mesh.indexFormat);
+    const uint64_t submeshSize = (uint64_t)mesh.submeshCount * sizeof(Submesh);
+    if (mesh.vertices.size < vertexSize || mesh.indices.size < indexSize)
+    {
+        return false;
+    }
+
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MeshFileMagic;
+    header.version = MeshFileVersion;
+    header.vertexLayout = (uint32_t)mesh.vertexLayout;
+    header.vertexStride = mesh.vertexStride;
+    header.vertexCount = mesh.vertexCount;
+    header.indexFormat = (uint32_t)mesh.indexFormat;
+    header.indexCount = mesh.indexCount;
+    header.submeshCount = mesh.submeshCount;
+    memcpy(header.boundsCenter, mesh.boundsCenter, sizeof(header.boundsCenter));
+    memcpy(header.boundsExtent, mesh.boundsExtent, sizeof(header.boundsExtent));
+    header.vertexOffset = AlignUp(sizeof(MeshFileHeader));
+    header.indexOffset = AlignUp(header.vertexOffset + vertexSize);
+    header.submeshOffset = AlignUp(header.indexOffset + indexSize);
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        return false;
+    }
+
+    // the sections in file order, with zeros up to the start of each
+    const char padding[MeshFileAlignment] = {};
+    const void* sections[4] = { &header, mesh.vertices.data, mesh.indices.data, mesh.submeshes };
+    const uint64_t offsets[4] = { 0, header.vertexOffset, header.indexOffset, header.submeshOffset };
+    const uint64_t sizes[4] = { sizeof(header), vertexSize, indexSize, submeshSize };
+    uint64_t written = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        stream.write(padding, (std::streamsize)(offsets[i] - written));
+        stream.write((const char*)sections[i], (std::streamsize)sizes[i]);
+        written = offsets[i] + sizes[i];
+    }
+    return stream.good();
+}
+
+MeshFile::MeshFile()
+{
+    memset(&mInfo, 0, sizeof(mInfo));
+}
+
+bool MeshFile::Open(const char* path)
+{
+    Close();
+    return mFile.Open(path) && Parse();
+}
+
+#if defined(_WIN32)
+bool MeshFile::Open(const wchar_t* path)
+{
+    Close();
+    return mFile.Open(path) && Parse();
+}
+#endif
+
+bool MeshFile::Parse()
+{
+    if (!ParseMeshFile(mFile.GetSpan(), &mInfo))
+    {
+        Close();
+        return false;
+    }
+
+    // the upload copies the sections front to back
+    mFile.Advise(MapAdvice::Sequential);
+    return true;
+}
+
+void MeshFile::Close()
+{
+    mFile.Close();
+    memset(&mInfo, 0, sizeof(mInfo));
+}
+
+const MeshFileInfo& MeshFile::GetInfo() const
+{
+    return mInfo;
+}
+
+bool MeshFile::CreateBuffers(RenderBackend* backend, StaticBuffer* vertexBuffer, StaticBuffer* indexBuffer) const
+{
+    return backend->CreateStaticBuffer(mInfo.vertices.data, mInfo.vertices.size, ResourceState::VertexAndConstantBuffer, vertexBuffer) &&
+        backend->CreateStaticBuffer(mInfo.indices.data, mInfo.indices.size, ResourceState::IndexBuffer, indexBuffer);
+}
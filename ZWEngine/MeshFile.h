@@ -0,0 +1,90 @@
+#pragma once
+
+#include "IndexNarrowing.h"
+#include "MappedFile.h"
+#include "RenderBackend.h"
+#include <cstdint>
+
+// Binary mesh container. Everything is stored the way the gpu reads it, so loading is mapping the
+// file and checking the header: the vertex and index sections go to CreateStaticBuffer as they are,
+// there is nothing to parse or convert per vertex. Little endian, written by WriteMeshFile (see
+// Tools/MeshConverter).
+//
+// layout: MeshFileHeader, then the vertex, index and submesh sections, each starting on a
+// MeshFileAlignment boundary
+
+const uint32_t MeshFileMagic = 0x534d575a; // "ZWMS"
+const uint32_t MeshFileVersion = 1; // bumped whenever the layout changes, older files are rejected
+const uint32_t MeshFileAlignment = 64; // section starts, a cache line so copies from the map run aligned
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexLayout; // VertexLayout
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexFormat; // IndexFormat
+    uint32_t indexCount;
+    uint32_t submeshCount;
+
+    // mesh space bounds, also what PositionColorQuantized positions are relative to
+    float boundsCenter[3];
+    float boundsExtent[3];
+
+    uint64_t vertexOffset; // from the start of the file
+    uint64_t indexOffset;
+    uint64_t submeshOffset; // submeshCount Submesh entries
+};
+
+// a mesh in memory, or the sections of a mapped file
+struct MeshFileInfo
+{
+    VertexLayout vertexLayout;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    IndexFormat indexFormat;
+    uint32_t indexCount;
+    float boundsCenter[3];
+    float boundsExtent[3];
+
+    ByteSpan vertices; // vertexCount * vertexStride bytes
+    ByteSpan indices; // indexCount indices
+    const Submesh* submeshes;
+    uint32_t submeshCount;
+};
+
+// check the header and point "info" at the sections of "file". false if it isn't a mesh file of this
+// version, or a section or a submesh reaches past the data it needs
+bool ParseMeshFile(ByteSpan file, MeshFileInfo* info);
+
+// write "mesh" to "path". false if the file can't be written
+bool WriteMeshFile(const char* path, const MeshFileInfo& mesh);
+
+// A mapped mesh file. The spans in GetInfo point into the map and stay valid until Close.
+class MeshFile
+{
+public:
+    MeshFile();
+
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    // map and parse. the sections are read sequentially by the upload, the os is told to read ahead
+    bool Open(const char* path);
+#if defined(_WIN32)
+    bool Open(const wchar_t* path);
+#endif
+    void Close();
+
+    const MeshFileInfo& GetInfo() const;
+
+    // create the vertex and index buffers from the mapped sections, see RenderBackend::CreateStaticBuffer
+    bool CreateBuffers(RenderBackend* backend, StaticBuffer* vertexBuffer, StaticBuffer* indexBuffer) const;
+
+private:
+    bool Parse();
+
+    MappedFile mFile;
+    MeshFileInfo mInfo;
+};
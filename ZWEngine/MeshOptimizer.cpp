@@ -0,0 +1,404 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// the cache OptimizeVertexCache scores against, and the cache of the last 3 vertices that gets a
+// fixed score so the triangle just emitted isn't simply repeated
+static const uint32_t ScoringCacheSize = 32;
+static const float LastTriangleScore = 0.75f;
+static const float CacheDecayPower = 1.5f;
+static const float ValenceBoostScale = 2.0f;
+static const float ValenceBoostPower = 0.5f;
+static const uint32_t MaxScoredValence = 32; // vertices used by more triangles score like this many
+
+static const uint32_t NoTriangle = 0xffffffff;
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    stats.transformedVertices = 0;
+    stats.acmr = 0.0f;
+    stats.atvr = 0.0f;
+
+    // a vertex is in the fifo while fewer than cacheSize misses happened since it was loaded
+    std::vector<uint32_t> loadedAt(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    uint32_t referencedCount = 0;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t vertex = indices[i];
+        if (vertex >= vertexCount)
+        {
+            continue;
+        }
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = true;
+            ++referencedCount;
+            loadedAt[vertex] = stats.transformedVertices;
+            ++stats.transformedVertices;
+        }
+        else if (stats.transformedVertices - loadedAt[vertex] > cacheSize)
+        {
+            loadedAt[vertex] = stats.transformedVertices;
+            ++stats.transformedVertices;
+        }
+    }
+
+    if (indexCount >= 3)
+    {
+        stats.acmr = (float)stats.transformedVertices / (float)(indexCount / 3);
+    }
+    if (referencedCount > 0)
+    {
+        stats.atvr = (float)stats.transformedVertices / (float)referencedCount;
+    }
+    return stats;
+}
+
+namespace
+{
+
+struct ScoreTables
+{
+    float cache[ScoringCacheSize];
+    float valence[MaxScoredValence + 1];
+
+    ScoreTables()
+    {
+        for (uint32_t i = 0; i < ScoringCacheSize; ++i)
+        {
+            cache[i] = i < 3 ? LastTriangleScore :
+                powf(1.0f - (float)(i - 3) / (float)(ScoringCacheSize - 3), CacheDecayPower);
+        }
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i <= MaxScoredValence; ++i)
+        {
+            valence[i] = ValenceBoostScale * powf((float)i, -ValenceBoostPower);
+        }
+    }
+};
+
+}
+
+static inline float VertexScore(const ScoreTables& tables, int32_t cachePosition, uint32_t remaining)
+{
+    if (remaining == 0)
+    {
+        return -1.0f; // every triangle of the vertex was emitted
+    }
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    return score + tables.valence[remaining < MaxScoredValence ? remaining : MaxScoredValence];
+}
+
+void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+    static const ScoreTables tables;
+    const uint32_t triangleCount = indexCount / 3;
+
+    // the input is read until the end, so it can be overwritten in place
+    std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+
+    // triangles of every vertex, the ones already emitted are moved out of the live range
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+    {
+        if (source[i] >= vertexCount)
+        {
+            // not a valid index buffer for this vertex count, keep the order
+            memmove(destination, indices, triangleCount * 3 * sizeof(uint32_t));
+            return;
+        }
+        ++remaining[source[i]];
+    }
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; ++t)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                adjacency[fill[source[t * 3 + c]]++] = t;
+            }
+        }
+    }
+
+    std::vector<float> vertexScore(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        vertexScore[v] = VertexScore(tables, -1, remaining[v]);
+    }
+    std::vector<bool> emitted(triangleCount, false);
+
+    uint32_t cache[ScoringCacheSize + 3];
+    uint32_t cacheCount = 0;
+    uint32_t newCache[ScoringCacheSize + 3];
+    uint32_t cursor = 0; // emitted triangles before this one, for when the cache runs dry
+    uint32_t best = NoTriangle;
+
+    for (uint32_t output = 0; output < triangleCount; ++output)
+    {
+        if (best == NoTriangle)
+        {
+            // nothing around the cached vertices, continue with the next triangle of the input
+            while (emitted[cursor])
+            {
+                ++cursor;
+            }
+            best = cursor;
+        }
+
+        const uint32_t* triangle = &source[best * 3];
+        memcpy(destination + output * 3, triangle, 3 * sizeof(uint32_t));
+        emitted[best] = true;
+
+        // take the triangle off its vertices' live lists
+        for (int c = 0; c < 3; ++c)
+        {
+            uint32_t vertex = triangle[c];
+            uint32_t* live = &adjacency[firstTriangle[vertex]];
+            uint32_t count = remaining[vertex];
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (live[i] == best)
+                {
+                    live[i] = live[count - 1];
+                    live[count - 1] = best;
+                    break;
+                }
+            }
+            --remaining[vertex];
+        }
+
+        // lru: the triangle's vertices to the front, the rest after them
+        uint32_t newCount = 0;
+        for (int c = 0; c < 3; ++c)
+        {
+            newCache[newCount++] = triangle[c];
+        }
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+            {
+                newCache[newCount++] = vertex;
+            }
+        }
+
+        // vertices pushed out of the cache lose their cache score
+        for (uint32_t i = ScoringCacheSize; i < newCount; ++i)
+        {
+            vertexScore[newCache[i]] = VertexScore(tables, -1, remaining[newCache[i]]);
+        }
+        cacheCount = newCount < ScoringCacheSize ? newCount : ScoringCacheSize;
+        memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+        // rescore the cached vertices and pick the best live triangle around them
+        float bestScore = -1.0f;
+        best = NoTriangle;
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            vertexScore[cache[i]] = VertexScore(tables, (int32_t)i, remaining[cache[i]]);
+        }
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t vertex = cache[i];
+            const uint32_t* live = &adjacency[firstTriangle[vertex]];
+            for (uint32_t j = 0; j < remaining[vertex]; ++j)
+            {
+                uint32_t t = live[j];
+                const uint32_t* corners = &source[t * 3];
+                float score = vertexScore[corners[0]] + vertexScore[corners[1]] + vertexScore[corners[2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+    }
+}
+
+void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, uint32_t indexCount,
+    const float* positions, uint32_t positionStride, uint32_t vertexCount, float threshold)
+{
+    const uint32_t triangleCount = indexCount / 3;
+    const uint32_t cacheSize = 16;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            // not a valid index buffer for this vertex count, keep the order
+            memcpy(destination, indices, triangleCount * 3 * sizeof(uint32_t));
+            return;
+        }
+    }
+
+    // hard boundaries: triangles that miss the cache with all three vertices start a cluster
+    std::vector<uint32_t> clusters; // first triangle of every cluster
+    {
+        std::vector<uint32_t> loadedAt(vertexCount, 0xffffffff);
+        uint32_t misses = 0;
+        for (uint32_t t = 0; t < triangleCount; ++t)
+        {
+            uint32_t triangleMisses = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+                uint32_t vertex = indices[t * 3 + c];
+                if (loadedAt[vertex] == 0xffffffff || misses - loadedAt[vertex] > cacheSize)
+                {
+                    loadedAt[vertex] = misses++;
+                    ++triangleMisses;
+                }
+            }
+            if (t == 0 || triangleMisses == 3)
+            {
+                clusters.push_back(t);
+            }
+        }
+    }
+
+    // soft boundaries: cut a hard cluster wherever the part since the last cut, replayed with a
+    // cold cache, is still within "threshold" of the cluster's acmr
+    std::vector<uint32_t> softClusters;
+    std::vector<uint32_t> loadedAt(vertexCount, 0xffffffff);
+    uint32_t epoch = 0; // loadedAt values below this are from before the last cut
+    uint32_t misses = 0;
+    for (uint32_t c = 0; c < clusters.size(); ++c)
+    {
+        uint32_t begin = clusters[c];
+        uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        VertexCacheStats whole = AnalyzeVertexCache(indices + begin * 3, (end - begin) * 3, vertexCount, cacheSize);
+        float target = whole.acmr * threshold;
+
+        softClusters.push_back(begin);
+        uint32_t start = begin;
+        epoch += misses + cacheSize + 1;
+        misses = 0;
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t vertex = indices[t * 3 + k];
+                if (loadedAt[vertex] == 0xffffffff || loadedAt[vertex] < epoch || epoch + misses - loadedAt[vertex] > cacheSize)
+                {
+                    loadedAt[vertex] = epoch + misses++;
+                }
+            }
+            if (t + 1 < end && (float)misses / (float)(t + 1 - start) <= target)
+            {
+                softClusters.push_back(t + 1);
+                start = t + 1;
+                epoch += misses + cacheSize + 1;
+                misses = 0;
+            }
+        }
+    }
+
+    // area weighted centroid and normal of the mesh and of every cluster
+    const uint32_t clusterCount = (uint32_t)softClusters.size();
+    std::vector<float> centroids(clusterCount * 3, 0.0f);
+    std::vector<float> normals(clusterCount * 3, 0.0f);
+    std::vector<float> areas(clusterCount, 0.0f);
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        uint32_t begin = softClusters[c];
+        uint32_t end = c + 1 < clusterCount ? softClusters[c + 1] : triangleCount;
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            const float* p[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                p[k] = (const float*)((const uint8_t*)positions + (uint64_t)indices[t * 3 + k] * positionStride);
+            }
+            float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+            float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+
+            // the cross product points out of clockwise front faces, its length is twice the area
+            float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int k = 0; k < 3; ++k)
+            {
+                float center = (p[0][k] + p[1][k] + p[2][k]) / 3.0f;
+                centroids[c * 3 + k] += center * area;
+                normals[c * 3 + k] += normal[k];
+                meshCentroid[k] += center * area;
+            }
+            areas[c] += area;
+            meshArea += area;
+        }
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        meshCentroid[k] = meshArea > 0.0f ? meshCentroid[k] / meshArea : 0.0f;
+    }
+
+    // clusters far out along their normal go first
+    std::vector<float> sortKey(clusterCount);
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        float* normal = &normals[c * 3];
+        float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float key = 0.0f;
+        if (areas[c] > 0.0f && length > 0.0f)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                key += (centroids[c * 3 + k] / areas[c] - meshCentroid[k]) * normal[k] / length;
+            }
+        }
+        sortKey[c] = key;
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sortKey](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+    uint32_t output = 0;
+    for (uint32_t i = 0; i < clusterCount; ++i)
+    {
+        uint32_t c = order[i];
+        uint32_t begin = softClusters[c];
+        uint32_t end = c + 1 < clusterCount ? softClusters[c + 1] : triangleCount;
+        memcpy(destination + output * 3, indices + begin * 3, (end - begin) * 3 * sizeof(uint32_t));
+        output += end - begin;
+    }
+}
+
+uint32_t OptimizeVertexFetch(void* destination, uint32_t* indices, uint32_t indexCount,
+    const void* vertices, uint32_t vertexCount, uint32_t vertexSize)
+{
+    std::vector<uint32_t> remap(vertexCount, 0xffffffff);
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t vertex = indices[i];
+        if (vertex >= vertexCount)
+        {
+            continue;
+        }
+        if (remap[vertex] == 0xffffffff)
+        {
+            memcpy((uint8_t*)destination + (uint64_t)next * vertexSize, (const uint8_t*)vertices + (uint64_t)vertex * vertexSize, vertexSize);
+            remap[vertex] = next++;
+        }
+        indices[i] = remap[vertex];
+    }
+    return next;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Index and vertex buffer reordering for meshes that are uploaded as authored. All of it runs at
+// load time and leaves the rendered result unchanged, only the order of the triangles and
+// vertices changes. Indices are 32 bit triangle lists.
+//
+// The usual order is OptimizeVertexCache, then OptimizeOverdraw (which keeps most of the cache
+// locality), then OptimizeVertexFetch (which renumbers the vertices in the final order).
+
+// fifo post-transform cache of "cacheSize" entries, replayed over the index buffer
+struct VertexCacheStats
+{
+    uint32_t transformedVertices; // cache misses, vertex shader invocations
+    float acmr; // transformed vertices per triangle: 3 is no reuse at all, a regular grid goes towards 0.5
+    float atvr; // transformed vertices per referenced vertex: 1 is perfect
+};
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+// reorder the triangles for post-transform cache locality (Forsyth's linear-speed algorithm): a
+// simulated lru cache scores every vertex by its cache position and by how many triangles still
+// use it, and the highest scoring triangle around the cached vertices is emitted next.
+// "destination" may be "indices"
+void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+// reorder clusters of the triangles so the ones facing outwards are drawn first and hide more of
+// what comes later. the input should be cache optimized: it is cut into clusters where the cache
+// would be cold anyway, and further where a cluster's own acmr stays within "threshold" (e.g. 1.05)
+// times the acmr of the whole run, so the cache efficiency drops by that much at most.
+// "positions" are 3 floats, "positionStride" bytes apart. "destination" may not be "indices".
+// an index >= vertexCount leaves the order as it is, like OptimizeVertexCache
+void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, uint32_t indexCount,
+    const float* positions, uint32_t positionStride, uint32_t vertexCount, float threshold);
+
+// reorder the vertices by first use in the index buffer and rewrite the indices to match, so the
+// vertex fetch walks the buffer mostly front to back. vertices no triangle uses are dropped.
+// "destination" receives up to vertexCount vertices of "vertexSize" bytes and may not be "vertices".
+// returns how many were written
+uint32_t OptimizeVertexFetch(void* destination, uint32_t* indices, uint32_t indexCount,
+    const void* vertices, uint32_t vertexCount, uint32_t vertexSize);
@@ -0,0 +1,310 @@
+#include "Meshlets.h"
+#include <cmath>
+
+// normal cones wider than this (the cosine of about 84 degrees off the axis) are not worth testing,
+// hardly any camera position would be inside them
+static const float MinConeCosine = 0.1f;
+
+static inline const float* GetPosition(const float* positions, uint32_t positionStride, uint32_t vertex)
+{
+    return (const float*)((const uint8_t*)positions + (uint64_t)vertex * positionStride);
+}
+
+static inline float Dot(const float* a, const float* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline void Subtract(const float* a, const float* b, float* result)
+{
+    result[0] = a[0] - b[0];
+    result[1] = a[1] - b[1];
+    result[2] = a[2] - b[2];
+}
+
+static inline float DistanceSquared(const float* a, const float* b)
+{
+    float d[3];
+    Subtract(a, b, d);
+    return Dot(d, d);
+}
+
+// Ritter's sphere: start from the most distant pair of the points that are extreme on an axis, then
+// grow the sphere over every point still outside. within a few percent of the smallest sphere
+static void ComputeBoundingSphere(const float* positions, uint32_t positionStride, const uint32_t* vertices, uint32_t count,
+    MeshletBounds* bounds)
+{
+    uint32_t minVertex[3] = { vertices[0], vertices[0], vertices[0] };
+    uint32_t maxVertex[3] = { vertices[0], vertices[0], vertices[0] };
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        const float* p = GetPosition(positions, positionStride, vertices[i]);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (p[axis] < GetPosition(positions, positionStride, minVertex[axis])[axis])
+            {
+                minVertex[axis] = vertices[i];
+            }
+            if (p[axis] > GetPosition(positions, positionStride, maxVertex[axis])[axis])
+            {
+                maxVertex[axis] = vertices[i];
+            }
+        }
+    }
+
+    int widest = 0;
+    float widestSquared = -1.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float d = DistanceSquared(GetPosition(positions, positionStride, minVertex[axis]), GetPosition(positions, positionStride, maxVertex[axis]));
+        if (d > widestSquared)
+        {
+            widest = axis;
+            widestSquared = d;
+        }
+    }
+
+    const float* a = GetPosition(positions, positionStride, minVertex[widest]);
+    const float* b = GetPosition(positions, positionStride, maxVertex[widest]);
+    float* center = bounds->center;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        center[axis] = 0.5f * (a[axis] + b[axis]);
+    }
+    float radius = 0.5f * sqrtf(widestSquared);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float* p = GetPosition(positions, positionStride, vertices[i]);
+        float d = sqrtf(DistanceSquared(p, center));
+        if (d > radius)
+        {
+            // move the center towards p, so the new sphere touches p and the far side of the old one
+            float grown = 0.5f * (radius + d);
+            float shift = (grown - radius) / d;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                center[axis] += (p[axis] - center[axis]) * shift;
+            }
+            radius = grown;
+        }
+    }
+
+    // the incremental updates round, keep every vertex inside
+    float maxSquared = 0.0f;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float d = DistanceSquared(GetPosition(positions, positionStride, vertices[i]), center);
+        maxSquared = d > maxSquared ? d : maxSquared;
+    }
+    bounds->radius = sqrtf(maxSquared) > radius ? sqrtf(maxSquared) : radius;
+}
+
+static void ComputeMeshletBounds(const float* positions, uint32_t positionStride, const MeshletData& data, const Meshlet& meshlet,
+    MeshletBounds* bounds)
+{
+    const uint32_t* vertices = &data.vertices[meshlet.vertexOffset];
+    const uint8_t* primitives = &data.primitives[meshlet.primitiveOffset * 3];
+    ComputeBoundingSphere(positions, positionStride, vertices, meshlet.vertexCount, bounds);
+
+    // unit normals of the triangles with an area, their sum is the cone axis
+    float normals[MaxMeshletPrimitiveLimit][3];
+    const float* corners[MaxMeshletPrimitiveLimit];
+    uint32_t normalCount = 0;
+    float axis[3] = { 0.0f, 0.0f, 0.0f };
+    for (uint32_t i = 0; i < meshlet.primitiveCount; ++i)
+    {
+        const float* p0 = GetPosition(positions, positionStride, vertices[primitives[i * 3 + 0]]);
+        const float* p1 = GetPosition(positions, positionStride, vertices[primitives[i * 3 + 1]]);
+        const float* p2 = GetPosition(positions, positionStride, vertices[primitives[i * 3 + 2]]);
+        float e1[3], e2[3];
+        Subtract(p1, p0, e1);
+        Subtract(p2, p0, e2);
+
+        // clockwise front faces in a left handed space, this points out of the front
+        float* n = normals[normalCount];
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        float length = sqrtf(Dot(n, n));
+        if (length == 0.0f)
+        {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            n[k] /= length;
+            axis[k] += n[k];
+        }
+        corners[normalCount++] = p0;
+    }
+
+    // no cone by default
+    for (int k = 0; k < 3; ++k)
+    {
+        bounds->coneApex[k] = bounds->center[k];
+        bounds->coneAxis[k] = 0.0f;
+    }
+    bounds->coneCutoff = 1.0f;
+
+    float axisLength = sqrtf(Dot(axis, axis));
+    if (normalCount == 0 || axisLength == 0.0f)
+    {
+        return;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        axis[k] /= axisLength;
+        bounds->coneAxis[k] = axis[k];
+    }
+
+    float minCosine = 1.0f;
+    for (uint32_t i = 0; i < normalCount; ++i)
+    {
+        float cosine = Dot(normals[i], axis);
+        minCosine = cosine < minCosine ? cosine : minCosine;
+    }
+    if (minCosine <= MinConeCosine)
+    {
+        return;
+    }
+
+    // the apex is on the axis behind the center, far enough back to be behind every triangle's plane:
+    // dot(center - t * axis - corner, normal) <= 0 for all of them
+    float maxT = 0.0f;
+    for (uint32_t i = 0; i < normalCount; ++i)
+    {
+        float toCenter[3];
+        Subtract(bounds->center, corners[i], toCenter);
+        float t = Dot(toCenter, normals[i]) / Dot(axis, normals[i]);
+        maxT = t > maxT ? t : maxT;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        bounds->coneApex[k] = bounds->center[k] - axis[k] * maxT;
+    }
+
+    // a triangle faces away from every point in the half space behind it. the camera directions all
+    // triangles face away from are the normal cone turned around and widened by 90 degrees, the
+    // cosine of that half angle is -cos(angle + 90) = sin(angle)
+    bounds->coneCutoff = sqrtf(1.0f - minCosine * minCosine);
+}
+
+// close "meshlet", compute its bounds and start the next one behind it
+static void FinishMeshlet(const float* positions, uint32_t positionStride, MeshletData* data, Meshlet* meshlet,
+    std::vector<uint32_t>* localIndex)
+{
+    MeshletBounds bounds;
+    ComputeMeshletBounds(positions, positionStride, *data, *meshlet, &bounds);
+    data->meshlets.push_back(*meshlet);
+    data->bounds.push_back(bounds);
+
+    for (uint32_t i = 0; i < meshlet->vertexCount; ++i)
+    {
+        (*localIndex)[data->vertices[meshlet->vertexOffset + i]] = 0xffffffff;
+    }
+    meshlet->vertexOffset = (uint32_t)data->vertices.size();
+    meshlet->vertexCount = 0;
+    meshlet->primitiveOffset = (uint32_t)(data->primitives.size() / 3);
+    meshlet->primitiveCount = 0;
+}
+
+void BuildMeshlets(const uint32_t* indices, uint32_t indexCount, const float* positions, uint32_t positionStride,
+    uint32_t vertexCount, uint32_t maxVertices, uint32_t maxPrimitives, MeshletData* meshlets)
+{
+    maxVertices = maxVertices < 3 ? 3 : (maxVertices > MaxMeshletVertexLimit ? MaxMeshletVertexLimit : maxVertices);
+    maxPrimitives = maxPrimitives < 1 ? 1 : (maxPrimitives > MaxMeshletPrimitiveLimit ? MaxMeshletPrimitiveLimit : maxPrimitives);
+
+    meshlets->meshlets.clear();
+    meshlets->bounds.clear();
+    meshlets->vertices.clear();
+    meshlets->primitives.clear();
+
+    // where a vertex is in the current meshlet, 0xffffffff if it isn't
+    std::vector<uint32_t> localIndex(vertexCount, 0xffffffff);
+    Meshlet meshlet = { 0, 0, 0, 0 };
+
+    const uint32_t triangleCount = indexCount / 3;
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t a = indices[t * 3 + 0];
+        const uint32_t b = indices[t * 3 + 1];
+        const uint32_t c = indices[t * 3 + 2];
+        if (a >= vertexCount || b >= vertexCount || c >= vertexCount)
+        {
+            continue;
+        }
+
+        uint32_t added = (localIndex[a] == 0xffffffff ? 1 : 0) + (localIndex[b] == 0xffffffff && b != a ? 1 : 0) +
+            (localIndex[c] == 0xffffffff && c != a && c != b ? 1 : 0);
+        if (meshlet.vertexCount + added > maxVertices || meshlet.primitiveCount == maxPrimitives)
+        {
+            FinishMeshlet(positions, positionStride, meshlets, &meshlet, &localIndex);
+        }
+
+        const uint32_t triangle[3] = { a, b, c };
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t vertex = triangle[k];
+            if (localIndex[vertex] == 0xffffffff)
+            {
+                localIndex[vertex] = meshlet.vertexCount++;
+                meshlets->vertices.push_back(vertex);
+            }
+            meshlets->primitives.push_back((uint8_t)localIndex[vertex]);
+        }
+        ++meshlet.primitiveCount;
+    }
+
+    if (meshlet.primitiveCount > 0)
+    {
+        FinishMeshlet(positions, positionStride, meshlets, &meshlet, &localIndex);
+    }
+}
+
+uint32_t CullMeshlets(const MeshletBounds* bounds, uint32_t count, const Frustum& frustum, const float cameraPosition[3],
+    uint32_t* visible, MeshletCullStats* stats)
+{
+    uint32_t visibleCount = 0;
+    uint32_t frustumCulled = 0;
+    uint32_t coneCulled = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const MeshletBounds& meshlet = bounds[i];
+
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; ++p)
+        {
+            const float* plane = frustum.planes[p];
+            outside = Dot(plane, meshlet.center) + plane[3] < -meshlet.radius;
+        }
+        if (outside)
+        {
+            ++frustumCulled;
+            continue;
+        }
+
+        // the camera is in the back facing cone, moved back by the sphere so it holds for every
+        // point of the meshlet and not just the center
+        if (meshlet.coneCutoff < 1.0f)
+        {
+            float toCenter[3];
+            Subtract(meshlet.center, cameraPosition, toCenter);
+            float distance = sqrtf(Dot(toCenter, toCenter));
+            if (Dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * distance + meshlet.radius)
+            {
+                ++coneCulled;
+                continue;
+            }
+        }
+
+        visible[visibleCount++] = i;
+    }
+
+    if (stats)
+    {
+        stats->frustumCulled = frustumCulled;
+        stats->coneCulled = coneCulled;
+    }
+    return visibleCount;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "FrustumCulling.h"
+#include <cstdint>
+#include <vector>
+
+// Meshlets for mesh shader pipelines (D3DX12_MESH_SHADER_PIPELINE_STATE_DESC): the triangles of a
+// mesh cut into small groups that one threadgroup outputs, each with the bounds to cull it as a
+// whole before its vertices are shaded. CullMeshlets is the reference for what an amplification
+// shader does with them.
+
+// d3d12 limits of a mesh shader's output
+const uint32_t MaxMeshletVertexLimit = 256;
+const uint32_t MaxMeshletPrimitiveLimit = 256;
+
+// a good fit for most hardware, the primitive count keeps the local index buffer a multiple of 4 bytes
+const uint32_t DefaultMeshletVertices = 64;
+const uint32_t DefaultMeshletPrimitives = 124;
+
+struct Meshlet
+{
+    uint32_t vertexOffset; // first entry of MeshletData::vertices
+    uint32_t vertexCount;
+    uint32_t primitiveOffset; // first triangle of MeshletData::primitives
+    uint32_t primitiveCount;
+};
+
+// bounding sphere and the cone that contains every triangle normal, both in mesh space
+struct MeshletBounds
+{
+    float center[3];
+    float radius;
+
+    // the triangles all face away from any camera inside the cone at "coneApex" that opens along
+    // "coneAxis" with the sine of the normal cone's half angle, "coneCutoff", as cosine. a cutoff
+    // of 1 means the normals spread too far to cull anything
+    float coneApex[3];
+    float coneAxis[3];
+    float coneCutoff;
+};
+
+struct MeshletData
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds; // one per meshlet
+    std::vector<uint32_t> vertices; // per meshlet, the indices of its vertices in the mesh's vertex buffer
+    std::vector<uint8_t> primitives; // per meshlet, 3 indices into its vertices per triangle
+};
+
+// cut a triangle list into meshlets of at most "maxVertices" vertices and "maxPrimitives" triangles
+// (clamped to the d3d12 limits). the triangles are taken in order, so run OptimizeVertexCache first:
+// that keeps neighbours together and the meshlets small and full. "positions" are 3 floats,
+// "positionStride" bytes apart. triangles with indices past "vertexCount" are dropped
+void BuildMeshlets(const uint32_t* indices, uint32_t indexCount, const float* positions, uint32_t positionStride,
+    uint32_t vertexCount, uint32_t maxVertices, uint32_t maxPrimitives, MeshletData* meshlets);
+
+struct MeshletCullStats
+{
+    uint32_t frustumCulled; // bounding sphere outside a plane
+    uint32_t coneCulled; // in the frustum, but every triangle faces away
+};
+
+// write the indices of the meshlets that survive the frustum and the normal cone test to "visible",
+// in order, and return how many there are. "frustum" and "cameraPosition" are in mesh space, e.g.
+// the frustum of world * viewProj (see ExtractFrustum) and the camera moved by the inverse world
+// matrix. back facing is the same in every space a world matrix maps to, as long as it doesn't
+// mirror the mesh. "stats" may be null
+uint32_t CullMeshlets(const MeshletBounds* bounds, uint32_t count, const Frustum& frustum, const float cameraPosition[3],
+    uint32_t* visible, MeshletCullStats* stats);
@@ -0,0 +1,546 @@
+#include "NullRenderBackend.h"
+#include <cstring>
+
+// fake gpu addresses start away from 0 so a null address is never handed out, and every
+// resource is placed on a 64KB boundary like a committed resource would be
+static const GpuAddress NullGpuAddressBase = 0x100000000ull;
+static const uint64_t NullResourceAlignment = 64 * 1024;
+
+NullCommandList::NullCommandList(std::vector<RenderCommand>* stream)
+    : mStream(stream)
+{
+}
+
+RenderCommand& NullCommandList::Append(RenderCommandType type)
+{
+    RenderCommand command;
+    memset(&command, 0, sizeof(command));
+    command.type = type;
+    mStream->push_back(command);
+    return mStream->back();
+}
+
+void NullCommandList::ResourceBarrier(ResourceHandle resource, ResourceState before, ResourceState after)
+{
+    RenderCommand& command = Append(RenderCommandType::ResourceBarrier);
+    command.barrier.resource = resource;
+    command.barrier.before = before;
+    command.barrier.after = after;
+}
+
+void NullCommandList::SetRenderTarget(int backBufferIndex)
+{
+    Append(RenderCommandType::SetRenderTarget).backBufferIndex = backBufferIndex;
+}
+
+void NullCommandList::ClearRenderTarget(int backBufferIndex, const float color[4])
+{
+    RenderCommand& command = Append(RenderCommandType::ClearRenderTarget);
+    command.clearRenderTarget.backBufferIndex = backBufferIndex;
+    memcpy(command.clearRenderTarget.color, color, sizeof(command.clearRenderTarget.color));
+}
+
+void NullCommandList::ClearDepth(float depth)
+{
+    Append(RenderCommandType::ClearDepth).depth = depth;
+}
+
+void NullCommandList::SetPipeline(PipelineHandle pipeline)
+{
+    Append(RenderCommandType::SetPipeline).pipeline = pipeline;
+}
+
+void NullCommandList::SetViewport(const Viewport& viewport)
+{
+    Append(RenderCommandType::SetViewport).viewport = viewport;
+}
+
+void NullCommandList::SetScissorRect(const ScissorRect& rect)
+{
+    Append(RenderCommandType::SetScissorRect).scissorRect = rect;
+}
+
+void NullCommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+    Append(RenderCommandType::SetPrimitiveTopology).topology = topology;
+}
+
+void NullCommandList::SetVertexBuffer(const VertexBufferView& view)
+{
+    Append(RenderCommandType::SetVertexBuffer).vertexBufferView = view;
+}
+
+void NullCommandList::SetIndexBuffer(const IndexBufferView& view)
+{
+    Append(RenderCommandType::SetIndexBuffer).indexBufferView = view;
+}
+
+void NullCommandList::SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GpuAddress bufferLocation)
+{
+    RenderCommand& command = Append(RenderCommandType::SetGraphicsRootConstantBufferView);
+    command.rootConstantBufferView.rootParameterIndex = rootParameterIndex;
+    command.rootConstantBufferView.bufferLocation = bufferLocation;
+}
+
+void NullCommandList::SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, GpuAddress bufferLocation)
+{
+    RenderCommand& command = Append(RenderCommandType::SetGraphicsRootShaderResourceView);
+    command.rootShaderResourceView.rootParameterIndex = rootParameterIndex;
+    command.rootShaderResourceView.bufferLocation = bufferLocation;
+}
+
+void NullCommandList::SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, DescriptorIndex firstDescriptor)
+{
+    RenderCommand& command = Append(RenderCommandType::SetGraphicsRootDescriptorTable);
+    command.rootDescriptorTable.rootParameterIndex = rootParameterIndex;
+    command.rootDescriptorTable.firstDescriptor = firstDescriptor;
+}
+
+void NullCommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    RenderCommand& command = Append(RenderCommandType::DrawIndexedInstanced);
+    command.draw.indexCountPerInstance = indexCountPerInstance;
+    command.draw.instanceCount = instanceCount;
+    command.draw.startIndexLocation = startIndexLocation;
+    command.draw.baseVertexLocation = baseVertexLocation;
+    command.draw.startInstanceLocation = startInstanceLocation;
+}
+
+NullCopyQueue::NullCopyQueue(NullRenderBackend* backend)
+    : mBackend(backend), mFenceValue(0)
+{
+}
+
+bool NullCopyQueue::Submit(ResourceHandle source, const BufferCopy* copies, uint32_t count, const TextureCopy* textureCopies,
+    uint32_t textureCount, uint64_t* fenceValue)
+{
+    std::vector<NullRenderBackend::Resource>& resources = mBackend->mResources;
+    if (source >= resources.size())
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const BufferCopy& copy = copies[i];
+        if (copy.destination >= resources.size() ||
+            copy.destinationOffset + copy.size > resources[copy.destination].data.size() ||
+            copy.sourceOffset + copy.size > resources[source].data.size())
+        {
+            return false;
+        }
+        memcpy(resources[copy.destination].data.data() + copy.destinationOffset,
+            resources[source].data.data() + copy.sourceOffset, (size_t)copy.size);
+    }
+
+    // the rows of the footprint into the tightly packed subresource, the footprint has to describe
+    // the subresource exactly like d3d12 requires
+    for (uint32_t i = 0; i < textureCount; ++i)
+    {
+        const TextureCopy& copy = textureCopies[i];
+        const UploadFootprint& footprint = copy.footprint;
+        TextureSubresourceLayout layout;
+        if (copy.destination >= resources.size() || resources[copy.destination].texture.mipCount == 0 ||
+            !GetTextureSubresourceLayout(resources[copy.destination].texture, copy.subresource, &layout) ||
+            layout.rowSize != footprint.rowSize || layout.rowCount != footprint.rowCount || layout.depth != footprint.depth ||
+            layout.width != copy.width || layout.height != copy.height || footprint.offset % TexturePlacementAlignment != 0 ||
+            footprint.rowPitch % TextureRowPitchAlignment != 0)
+        {
+            return false;
+        }
+        uint64_t rows = (uint64_t)footprint.rowCount * footprint.depth;
+        if (footprint.offset + (rows - 1) * footprint.rowPitch + footprint.rowSize > resources[source].data.size())
+        {
+            return false;
+        }
+
+        NullRenderBackend::Resource& destination = resources[copy.destination];
+        uint8_t* dst = destination.data.data() + destination.subresourceOffsets[copy.subresource];
+        const uint8_t* src = resources[source].data.data() + footprint.offset;
+        for (uint64_t row = 0; row < rows; ++row)
+        {
+            memcpy(dst + row * footprint.rowSize, src + row * footprint.rowPitch, footprint.rowSize);
+        }
+    }
+
+    mFence.Signal(++mFenceValue);
+    *fenceValue = mFenceValue;
+    return true;
+}
+
+GpuFence* NullCopyQueue::GetFence()
+{
+    return &mFence;
+}
+
+SimulatedGpuFence& NullCopyQueue::GetSimulatedFence()
+{
+    return mFence;
+}
+
+uint64_t NullCopyQueue::GetLastFenceValue() const
+{
+    return mFenceValue;
+}
+
+NullRenderBackend::NullRenderBackend()
+    : mCommandList(&mCommands), mResumeCommandList(&mResumeCommands), mParallelCount(0),
+    mNextGpuAddress(NullGpuAddressBase), mPipelineCount(0), mFenceValue(0), mGpuLatency(0), mCopyQueue(this),
+    mFrameIndex(0), mRecording(false)
+{
+    mFrames.Init(&mGpuFence, frameBufferCount);
+    mUploads.Init(this, &mCopyQueue);
+    mDescriptorAllocator.Init(PersistentDescriptorCount, TransientDescriptorCount);
+    mDescriptors.assign(mDescriptorAllocator.GetCapacity(), NullDescriptor());
+
+    for (uint32_t i = 0; i < MaxParallelCommandLists; ++i)
+    {
+        mParallelCommandLists.push_back(NullCommandList(&mParallelCommands[i]));
+    }
+}
+
+bool NullRenderBackend::Init(int width, int height)
+{
+    // the back buffers are always the first frameBufferCount resources, like the swap chain buffers on d3d12
+    for (int i = 0; i < frameBufferCount; ++i)
+    {
+        AddResource((uint64_t)width * height * 4);
+    }
+    return true;
+}
+
+void NullRenderBackend::Shutdown()
+{
+    WaitForGpu();
+    mUploads.Init(this, &mCopyQueue);
+    mDescriptorAllocator.Init(PersistentDescriptorCount, TransientDescriptorCount);
+    mDescriptors.assign(mDescriptorAllocator.GetCapacity(), NullDescriptor());
+    mResources.clear();
+    mCommands.clear();
+}
+
+ResourceHandle NullRenderBackend::AddResource(uint64_t size)
+{
+    Resource resource;
+    resource.data.resize((size_t)size);
+    resource.gpuAddress = mNextGpuAddress;
+    memset(&resource.texture, 0, sizeof(resource.texture));
+    mNextGpuAddress += (size + NullResourceAlignment - 1) & ~(NullResourceAlignment - 1);
+    mResources.push_back(resource);
+    return (ResourceHandle)(mResources.size() - 1);
+}
+
+bool NullRenderBackend::CreateStaticBuffer(const void* data, uint64_t size, ResourceState finalState, StaticBuffer* buffer)
+{
+    // buffers have no layout that depends on the state, the null gpu reads them in any state
+    (void)finalState;
+
+    ResourceHandle handle = AddResource(size);
+    if (!mUploads.Upload(handle, 0, data, size))
+    {
+        return false;
+    }
+
+    buffer->resource = handle;
+    buffer->gpuAddress = mResources[handle].gpuAddress;
+    buffer->size = size;
+    return true;
+}
+
+bool NullRenderBackend::CreateUploadBuffer(uint64_t size, UploadBuffer* buffer)
+{
+    ResourceHandle handle = AddResource(size);
+
+    buffer->resource = handle;
+    buffer->cpuAddress = mResources[handle].data.data();
+    buffer->gpuAddress = mResources[handle].gpuAddress;
+    buffer->size = size;
+    return true;
+}
+
+bool NullRenderBackend::CreateTexture(const TextureDesc& desc, ResourceHandle* texture)
+{
+    const uint32_t subresourceCount = desc.mipCount * desc.arraySize;
+    if (desc.width == 0 || desc.height == 0 || subresourceCount == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> offsets(subresourceCount);
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < subresourceCount; ++i)
+    {
+        TextureSubresourceLayout layout;
+        if (!GetTextureSubresourceLayout(desc, i, &layout))
+        {
+            return false;
+        }
+        offsets[i] = size;
+        size += (uint64_t)layout.rowSize * layout.rowCount * layout.depth;
+    }
+
+    *texture = AddResource(size);
+    mResources[*texture].texture = desc;
+    mResources[*texture].subresourceOffsets.swap(offsets);
+    return true;
+}
+
+bool NullRenderBackend::UploadTexture(ResourceHandle texture, uint32_t firstSubresource, uint32_t count,
+    const SubresourceSource* sources, JobSystem* jobs)
+{
+    if (texture >= mResources.size() || mResources[texture].texture.mipCount == 0)
+    {
+        return false;
+    }
+    return mUploads.UploadTexture(texture, mResources[texture].texture, firstSubresource, count, sources, jobs);
+}
+
+PipelineHandle NullRenderBackend::CreatePipeline(const PipelineDesc&)
+{
+    return mPipelineCount++;
+}
+
+bool NullRenderBackend::FlushUploads()
+{
+    return mUploads.Submit();
+}
+
+DescriptorIndex NullRenderBackend::AllocatePersistentDescriptor()
+{
+    return mDescriptorAllocator.AllocatePersistent();
+}
+
+void NullRenderBackend::FreePersistentDescriptor(DescriptorIndex descriptor)
+{
+    mDescriptorAllocator.FreePersistent(descriptor, mFrames.GetFrameNumber());
+}
+
+bool NullRenderBackend::AllocateTransientDescriptors(uint32_t count, DescriptorIndex* first)
+{
+    return mRecording && mDescriptorAllocator.AllocateTransient(count, first);
+}
+
+void NullRenderBackend::CreateConstantBufferView(DescriptorIndex descriptor, GpuAddress bufferLocation, uint32_t size)
+{
+    if (descriptor < mDescriptors.size())
+    {
+        mDescriptors[descriptor].bufferLocation = bufferLocation;
+        mDescriptors[descriptor].size = size;
+    }
+}
+
+int NullRenderBackend::GetFrameIndex() const
+{
+    return mFrameIndex;
+}
+
+ResourceHandle NullRenderBackend::GetBackBuffer(int frameIndex) const
+{
+    return (ResourceHandle)frameIndex;
+}
+
+bool NullRenderBackend::SetFramesInFlight(uint32_t count)
+{
+    return mFrames.SetFramesInFlight(count);
+}
+
+uint64_t NullRenderBackend::GetSubmittedFrameCount() const
+{
+    return mFrames.GetSubmittedFrameCount();
+}
+
+uint64_t NullRenderBackend::GetCompletedFrameCount() const
+{
+    return mFrames.GetCompletedFrameCount();
+}
+
+bool NullRenderBackend::BeginFrame()
+{
+    if (mRecording || !mFrames.BeginFrame())
+    {
+        return false;
+    }
+    mDescriptorAllocator.BeginFrame(mFrames.GetContextIndex(), mFrames.GetCompletedFrameCount());
+    mRecording = true;
+    return true;
+}
+
+RenderCommandList* NullRenderBackend::GetCommandList()
+{
+    return mParallelCount > 0 ? &mResumeCommandList : &mCommandList;
+}
+
+bool NullRenderBackend::BeginParallelRecording(uint32_t count)
+{
+    if (!mRecording || mParallelCount > 0 || count == 0 || count > MaxParallelCommandLists)
+    {
+        return false;
+    }
+    mParallelCount = count;
+    return true;
+}
+
+RenderCommandList* NullRenderBackend::GetParallelCommandList(uint32_t index)
+{
+    return index < mParallelCount ? &mParallelCommandLists[index] : nullptr;
+}
+
+bool NullRenderBackend::EndFrame()
+{
+    if (!mRecording)
+    {
+        return false;
+    }
+    mRecording = false;
+
+    // the frame waits for the uploads submitted before it
+    if (!mUploads.Submit())
+    {
+        return false;
+    }
+    mCopyQueue.GetSimulatedFence().CompleteUpTo(mCopyQueue.GetLastFenceValue());
+
+    // submit like d3d12 would run them: the main list, the parallel lists in order, the rest of the frame
+    if (mParallelCount > 0)
+    {
+        for (uint32_t i = 0; i < mParallelCount; ++i)
+        {
+            mCommands.insert(mCommands.end(), mParallelCommands[i].begin(), mParallelCommands[i].end());
+            mParallelCommands[i].clear();
+        }
+        mCommands.insert(mCommands.end(), mResumeCommands.begin(), mResumeCommands.end());
+        mResumeCommands.clear();
+        mParallelCount = 0;
+    }
+
+    RenderCommand present;
+    memset(&present, 0, sizeof(present));
+    present.type = RenderCommandType::Present;
+    present.backBufferIndex = mFrameIndex;
+    mCommands.push_back(present);
+
+    // the gpu finishes the frame once it is mGpuLatency frames behind
+    mGpuFence.Signal(++mFenceValue);
+    mFrames.EndFrame(mFenceValue);
+    if (mFenceValue > mGpuLatency)
+    {
+        mGpuFence.CompleteUpTo(mFenceValue - mGpuLatency);
+    }
+
+    // the swap chain hands out back buffers round robin
+    mFrameIndex = (mFrameIndex + 1) % frameBufferCount;
+    return true;
+}
+
+void NullRenderBackend::WaitForGpu()
+{
+    mGpuFence.WaitForValue(mFenceValue);
+    mUploads.WaitForIdle();
+}
+
+const std::vector<RenderCommand>& NullRenderBackend::GetCommands() const
+{
+    return mCommands;
+}
+
+void NullRenderBackend::ClearCommands()
+{
+    mCommands.clear();
+}
+
+void NullRenderBackend::SetGpuLatency(uint32_t frames)
+{
+    mGpuLatency = frames;
+}
+
+SimulatedGpuFence& NullRenderBackend::GetGpuFence()
+{
+    return mGpuFence;
+}
+
+const FrameManager& NullRenderBackend::GetFrameManager() const
+{
+    return mFrames;
+}
+
+NullCopyQueue& NullRenderBackend::GetCopyQueue()
+{
+    return mCopyQueue;
+}
+
+const UploadManager& NullRenderBackend::GetUploadManager() const
+{
+    return mUploads;
+}
+
+const DescriptorAllocator& NullRenderBackend::GetDescriptorAllocator() const
+{
+    return mDescriptorAllocator;
+}
+
+const NullDescriptor* NullRenderBackend::GetDescriptor(DescriptorIndex descriptor) const
+{
+    if (descriptor >= mDescriptors.size())
+    {
+        return nullptr;
+    }
+    return &mDescriptors[descriptor];
+}
+
+const uint8_t* NullRenderBackend::GetResourceData(ResourceHandle resource) const
+{
+    if (resource >= mResources.size())
+    {
+        return nullptr;
+    }
+    return mResources[resource].data.data();
+}
+
+const uint8_t* NullRenderBackend::GetGpuAddressData(GpuAddress address, uint64_t size) const
+{
+    // the last resource starting at or below the address
+    uint32_t low = 0, high = (uint32_t)mResources.size();
+    while (low < high)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (mResources[middle].gpuAddress <= address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == 0)
+    {
+        return nullptr;
+    }
+
+    const Resource& resource = mResources[low - 1];
+    uint64_t offset = address - resource.gpuAddress;
+    if (offset + size > resource.data.size())
+    {
+        return nullptr;
+    }
+    return resource.data.data() + offset;
+}
+
+const uint8_t* NullRenderBackend::GetTextureSubresourceData(ResourceHandle texture, uint32_t subresource) const
+{
+    if (texture >= mResources.size() || subresource >= mResources[texture].subresourceOffsets.size())
+    {
+        return nullptr;
+    }
+    return mResources[texture].data.data() + mResources[texture].subresourceOffsets[subresource];
+}
+
+uint8_t* NullRenderBackend::GetWritableResourceData(ResourceHandle resource)
+{
+    if (resource >= mResources.size())
+    {
+        return nullptr;
+    }
+    return mResources[resource].data.data();
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "DescriptorAllocator.h"
+#include "FrameManager.h"
+#include "RenderBackend.h"
+#include "UploadManager.h"
+#include <vector>
+
+// CPU only backend. It does not draw anything, every command is appended to an in-memory stream
+// so the frame loop can run (and be measured / compared) on machines without a gpu.
+
+enum class RenderCommandType
+{
+    ResourceBarrier,
+    SetRenderTarget,
+    ClearRenderTarget,
+    ClearDepth,
+    SetPipeline,
+    SetViewport,
+    SetScissorRect,
+    SetPrimitiveTopology,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetGraphicsRootConstantBufferView,
+    SetGraphicsRootShaderResourceView,
+    SetGraphicsRootDescriptorTable,
+    DrawIndexedInstanced,
+    Present, // recorded by EndFrame, marks the end of a frame in the stream
+};
+
+struct RenderCommand
+{
+    RenderCommandType type;
+
+    union
+    {
+        struct
+        {
+            ResourceHandle resource;
+            ResourceState before;
+            ResourceState after;
+        } barrier;
+
+        struct
+        {
+            int backBufferIndex;
+            float color[4];
+        } clearRenderTarget;
+
+        struct
+        {
+            uint32_t rootParameterIndex;
+            GpuAddress bufferLocation;
+        } rootConstantBufferView;
+
+        struct
+        {
+            uint32_t rootParameterIndex;
+            GpuAddress bufferLocation;
+        } rootShaderResourceView;
+
+        struct
+        {
+            uint32_t rootParameterIndex;
+            DescriptorIndex firstDescriptor;
+        } rootDescriptorTable;
+
+        struct
+        {
+            uint32_t indexCountPerInstance;
+            uint32_t instanceCount;
+            uint32_t startIndexLocation;
+            int32_t baseVertexLocation;
+            uint32_t startInstanceLocation;
+        } draw;
+
+        int backBufferIndex; // SetRenderTarget, Present
+        float depth; // ClearDepth
+        PipelineHandle pipeline;
+        Viewport viewport;
+        ScissorRect scissorRect;
+        PrimitiveTopology topology;
+        VertexBufferView vertexBufferView;
+        IndexBufferView indexBufferView;
+    };
+};
+
+class NullCommandList : public RenderCommandList
+{
+public:
+    explicit NullCommandList(std::vector<RenderCommand>* stream);
+
+    void ResourceBarrier(ResourceHandle resource, ResourceState before, ResourceState after) override;
+    void SetRenderTarget(int backBufferIndex) override;
+    void ClearRenderTarget(int backBufferIndex, const float color[4]) override;
+    void ClearDepth(float depth) override;
+    void SetPipeline(PipelineHandle pipeline) override;
+    void SetViewport(const Viewport& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+    void SetVertexBuffer(const VertexBufferView& view) override;
+    void SetIndexBuffer(const IndexBufferView& view) override;
+    void SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GpuAddress bufferLocation) override;
+    void SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, GpuAddress bufferLocation) override;
+    void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, DescriptorIndex firstDescriptor) override;
+    void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+private:
+    RenderCommand& Append(RenderCommandType type);
+
+    std::vector<RenderCommand>* mStream;
+};
+
+class NullRenderBackend;
+
+// copies are applied to the resources when they are submitted, their fence completes at the next
+// EndFrame (or earlier when somebody waits for it)
+class NullCopyQueue : public CopyQueue
+{
+public:
+    explicit NullCopyQueue(NullRenderBackend* backend);
+
+    bool Submit(ResourceHandle source, const BufferCopy* copies, uint32_t count, const TextureCopy* textureCopies,
+        uint32_t textureCount, uint64_t* fenceValue) override;
+    GpuFence* GetFence() override;
+
+    SimulatedGpuFence& GetSimulatedFence();
+    uint64_t GetLastFenceValue() const;
+
+private:
+    NullRenderBackend* mBackend;
+    SimulatedGpuFence mFence;
+    uint64_t mFenceValue;
+};
+
+// what a slot of the null backend's descriptor heap holds
+struct NullDescriptor
+{
+    GpuAddress bufferLocation; // 0 if nothing was written
+    uint32_t size;
+};
+
+class NullRenderBackend : public RenderBackend
+{
+public:
+    NullRenderBackend();
+
+    bool Init(int width, int height) override;
+    void Shutdown() override;
+
+    bool CreateStaticBuffer(const void* data, uint64_t size, ResourceState finalState, StaticBuffer* buffer) override;
+    bool CreateUploadBuffer(uint64_t size, UploadBuffer* buffer) override;
+    bool CreateTexture(const TextureDesc& desc, ResourceHandle* texture) override;
+    bool UploadTexture(ResourceHandle texture, uint32_t firstSubresource, uint32_t count, const SubresourceSource* sources,
+        JobSystem* jobs) override;
+    PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+    bool FlushUploads() override;
+
+    DescriptorIndex AllocatePersistentDescriptor() override;
+    void FreePersistentDescriptor(DescriptorIndex descriptor) override;
+    bool AllocateTransientDescriptors(uint32_t count, DescriptorIndex* first) override;
+    void CreateConstantBufferView(DescriptorIndex descriptor, GpuAddress bufferLocation, uint32_t size) override;
+
+    int GetFrameIndex() const override;
+    bool SetFramesInFlight(uint32_t count) override;
+    ResourceHandle GetBackBuffer(int frameIndex) const override;
+    uint64_t GetSubmittedFrameCount() const override;
+    uint64_t GetCompletedFrameCount() const override;
+
+    bool BeginFrame() override;
+    RenderCommandList* GetCommandList() override;
+    bool BeginParallelRecording(uint32_t count) override;
+    RenderCommandList* GetParallelCommandList(uint32_t index) override;
+    bool EndFrame() override;
+    void WaitForGpu() override;
+
+    // everything recorded since Init or the last ClearCommands, in the order the gpu would run it.
+    // parallel lists are recorded into their own streams and appended in list order by EndFrame
+    const std::vector<RenderCommand>& GetCommands() const;
+    void ClearCommands();
+
+    // pretend the gpu runs "frames" frames behind EndFrame (0 by default, everything completes
+    // immediately). BeginFrame, WaitForGpu and the fence waits still run it forward when they block
+    void SetGpuLatency(uint32_t frames);
+
+    // the simulated gpu timeline and the frame pipeline on top of it
+    SimulatedGpuFence& GetGpuFence();
+    const FrameManager& GetFrameManager() const;
+
+    // the copy queue static buffers are filled through
+    NullCopyQueue& GetCopyQueue();
+    const UploadManager& GetUploadManager() const;
+
+    // the descriptor heap, slots hold the last view written into them
+    const DescriptorAllocator& GetDescriptorAllocator() const;
+    const NullDescriptor* GetDescriptor(DescriptorIndex descriptor) const;
+
+    // cpu copy of a resource's contents (static buffers get their data once the upload is submitted).
+    // textures hold their subresources in order, each with tightly packed rows
+    const uint8_t* GetResourceData(ResourceHandle resource) const;
+
+    // where subresource "subresource" of a texture starts in its data, null for anything else
+    const uint8_t* GetTextureSubresourceData(ResourceHandle texture, uint32_t subresource) const;
+
+    // the cpu copy of [address, address + size), null unless the range is inside one resource
+    const uint8_t* GetGpuAddressData(GpuAddress address, uint64_t size) const;
+
+protected:
+    // for backends that execute the recorded commands and write the results back (the back buffers)
+    uint8_t* GetWritableResourceData(ResourceHandle resource);
+
+private:
+    friend class NullCopyQueue;
+
+    struct Resource
+    {
+        std::vector<uint8_t> data;
+        GpuAddress gpuAddress;
+        TextureDesc texture; // mipCount 0 for buffers
+        std::vector<uint64_t> subresourceOffsets; // into "data", textures only
+    };
+
+    ResourceHandle AddResource(uint64_t size);
+
+    std::vector<Resource> mResources; // in gpu address order
+    std::vector<RenderCommand> mCommands;
+    NullCommandList mCommandList;
+
+    std::vector<RenderCommand> mParallelCommands[MaxParallelCommandLists]; // one stream per parallel list
+    std::vector<NullCommandList> mParallelCommandLists;
+    std::vector<RenderCommand> mResumeCommands; // GetCommandList after the frame split
+    NullCommandList mResumeCommandList;
+    uint32_t mParallelCount;
+
+    GpuAddress mNextGpuAddress;
+    PipelineHandle mPipelineCount;
+    SimulatedGpuFence mGpuFence;
+    uint64_t mFenceValue; // last value signaled on mGpuFence
+    FrameManager mFrames;
+    uint32_t mGpuLatency;
+    NullCopyQueue mCopyQueue;
+    UploadManager mUploads;
+    DescriptorAllocator mDescriptorAllocator;
+    std::vector<NullDescriptor> mDescriptors;
+    int mFrameIndex;
+    bool mRecording;
+};
@@ -0,0 +1,123 @@
+#include "PngWriter.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+static const uint32_t MaxStoredBlockSize = 65535; // deflate stored blocks have a 16 bit length
+
+namespace
+{
+
+struct CrcTable
+{
+    uint32_t values[256];
+
+    CrcTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                value = value & 1 ? 0xedb88320u ^ (value >> 1) : value >> 1;
+            }
+            values[i] = value;
+        }
+    }
+};
+
+}
+
+static uint32_t Crc32(const uint8_t* data, uint32_t size)
+{
+    static const CrcTable table; // built on first use
+    uint32_t crc = 0xffffffff;
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        crc = table.values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void PutBigEndian(std::vector<uint8_t>* out, uint32_t value)
+{
+    out->push_back((uint8_t)(value >> 24));
+    out->push_back((uint8_t)(value >> 16));
+    out->push_back((uint8_t)(value >> 8));
+    out->push_back((uint8_t)value);
+}
+
+// length, type, data and the crc of type and data
+static void PutChunk(std::vector<uint8_t>* out, const char type[4], const std::vector<uint8_t>& data)
+{
+    PutBigEndian(out, (uint32_t)data.size());
+    uint32_t start = (uint32_t)out->size();
+    out->insert(out->end(), type, type + 4);
+    out->insert(out->end(), data.begin(), data.end());
+    PutBigEndian(out, Crc32(out->data() + start, (uint32_t)out->size() - start));
+}
+
+bool WritePng(const char* path, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    if (width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    // the filtered image: every row starts with filter type 0 (none)
+    const uint32_t rowSize = width * 4 + 1;
+    std::vector<uint8_t> raw((uint64_t)rowSize * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        raw[(uint64_t)y * rowSize] = 0;
+        memcpy(&raw[(uint64_t)y * rowSize + 1], pixels + (uint64_t)y * rowPitch, width * 4);
+    }
+
+    // zlib stream of stored blocks, then the adler32 of the raw data
+    std::vector<uint8_t> compressed;
+    compressed.reserve(raw.size() + raw.size() / MaxStoredBlockSize * 5 + 16);
+    compressed.push_back(0x78);
+    compressed.push_back(0x01);
+    uint64_t offset = 0;
+    do
+    {
+        uint32_t size = raw.size() - offset < MaxStoredBlockSize ? (uint32_t)(raw.size() - offset) : MaxStoredBlockSize;
+        bool last = offset + size == raw.size();
+        compressed.push_back(last ? 1 : 0);
+        compressed.push_back((uint8_t)size);
+        compressed.push_back((uint8_t)(size >> 8));
+        compressed.push_back((uint8_t)~size);
+        compressed.push_back((uint8_t)(~size >> 8));
+        compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + size);
+        offset += size;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint64_t i = 0; i < raw.size(); ++i)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBigEndian(&compressed, (b << 16) | a);
+
+    // 8 bit rgba, no interlacing
+    std::vector<uint8_t> header;
+    PutBigEndian(&header, width);
+    PutBigEndian(&header, height);
+    const uint8_t format[5] = { 8, 6, 0, 0, 0 };
+    header.insert(header.end(), format, format + 5);
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    std::vector<uint8_t> file(signature, signature + 8);
+    PutChunk(&file, "IHDR", header);
+    PutChunk(&file, "IDAT", compressed);
+    PutChunk(&file, "IEND", std::vector<uint8_t>());
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        return false;
+    }
+    stream.write((const char*)file.data(), (std::streamsize)file.size());
+    return stream.good();
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// Writes rgba8 images as png, to look at or compare rendered frames (the software backend's back
+// buffers). The pixels are stored in uncompressed deflate blocks, so no zlib is needed and the
+// file is about the size of the raw image.
+//
+// "rowPitch" is the distance between rows in bytes. false if the file can't be written
+bool WritePng(const char* path, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowPitch);
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstdint>
+
+class JobSystem;
+struct SubresourceSource;
+
+// Backend neutral rendering interface. The frame code (Scene.cpp) only talks to these classes,
+// so it can run on top of direct3d 12 on windows or on the null backend anywhere else.
+// Nothing in this file may depend on windows.h or d3d12.h.
+
+const int frameBufferCount = 3; // number of buffers we want, 2 for double buffering, 3 for tripple buffering
+
+const uint32_t MaxParallelCommandLists = 8; // command lists per frame that can be recorded at the same time
+
+const uint64_t ConstantBufferAlignment = 256; // constant buffer views must start on a 256 byte boundary
+
+typedef uint64_t GpuAddress; // a gpu virtual address (the null backend hands out fake ones)
+
+typedef uint32_t ResourceHandle; // index of a resource owned by the backend
+
+typedef uint32_t PipelineHandle; // index of a root signature + pso pair owned by the backend
+
+typedef uint32_t DescriptorIndex; // slot in the backend's shader visible descriptor heap
+
+const ResourceHandle InvalidResource = 0xffffffff;
+const PipelineHandle InvalidPipeline = 0xffffffff;
+const DescriptorIndex InvalidDescriptor = 0xffffffff;
+
+const uint32_t PersistentDescriptorCount = 16384; // textures and other long lived views
+const uint32_t TransientDescriptorCount = 4096; // per frame, for tables built while recording
+
+// the resource states the engine uses, they map 1:1 onto D3D12_RESOURCE_STATES
+enum class ResourceState
+{
+    Present,
+    RenderTarget,
+    DepthWrite,
+    CopyDest,
+    VertexAndConstantBuffer,
+    IndexBuffer,
+    GenericRead,
+};
+
+enum class IndexFormat
+{
+    UInt16,
+    UInt32,
+};
+
+enum class PrimitiveTopology
+{
+    TriangleList,
+};
+
+// vertex formats a pipeline can be created with
+enum class VertexLayout
+{
+    PositionColor, // float3 position, float4 color (28 bytes)
+    PositionColorQuantized, // snorm16 xyzw position relative to the mesh bounds, unorm8 rgba color (12 bytes, see QuantizedVertex)
+};
+
+struct PipelineDesc
+{
+    const wchar_t* vertexShader; // hlsl file compiled with entry point "main"
+    const wchar_t* pixelShader;
+    VertexLayout vertexLayout;
+
+    // root parameter 0 is a constant buffer with the wvp matrix (b0) by default. instanced pipelines read
+    // one wvp matrix per instance from a structured buffer (t0) instead, the vertex shader is compiled
+    // with INSTANCED defined
+    bool instanced;
+
+    // not instanced, root parameter 0 can be a descriptor table of one constant buffer view (b0) instead,
+    // bound with SetGraphicsRootDescriptorTable
+    bool constantBufferTable;
+};
+
+struct Viewport
+{
+    float topLeftX;
+    float topLeftY;
+    float width;
+    float height;
+    float minDepth;
+    float maxDepth;
+};
+
+struct ScissorRect
+{
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+};
+
+struct VertexBufferView
+{
+    GpuAddress bufferLocation;
+    uint32_t sizeInBytes;
+    uint32_t strideInBytes;
+};
+
+struct IndexBufferView
+{
+    GpuAddress bufferLocation;
+    uint32_t sizeInBytes;
+    IndexFormat format;
+};
+
+// a buffer in gpu local memory, filled once when it is created (vertex and index data)
+struct StaticBuffer
+{
+    ResourceHandle resource;
+    GpuAddress gpuAddress;
+    uint64_t size;
+};
+
+// a persistently mapped upload heap buffer. the cpu writes through cpuAddress, the gpu reads from gpuAddress
+struct UploadBuffer
+{
+    ResourceHandle resource;
+    uint8_t* cpuAddress;
+    GpuAddress gpuAddress;
+    uint64_t size;
+};
+
+// a texture in gpu local memory, its subresources are filled with UploadTexture. subresource
+// "mip + arraySlice * mipCount" is the d3d12 numbering
+struct TextureDesc
+{
+    uint32_t format; // DXGI_FORMAT
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth; // 1 unless volume
+    uint32_t arraySize; // 1 for volumes, 6 per cube
+    uint32_t mipCount;
+    bool volume;
+};
+
+// command recording interface, mirrors the part of ID3D12GraphicsCommandList the engine uses
+class RenderCommandList
+{
+public:
+    virtual ~RenderCommandList() {}
+
+    virtual void ResourceBarrier(ResourceHandle resource, ResourceState before, ResourceState after) = 0;
+
+    // bind back buffer "backBufferIndex" and the depth buffer for the output merger stage
+    virtual void SetRenderTarget(int backBufferIndex) = 0;
+
+    virtual void ClearRenderTarget(int backBufferIndex, const float color[4]) = 0;
+    virtual void ClearDepth(float depth) = 0;
+
+    // sets both the root signature and the pso of the pipeline
+    virtual void SetPipeline(PipelineHandle pipeline) = 0;
+
+    virtual void SetViewport(const Viewport& viewport) = 0;
+    virtual void SetScissorRect(const ScissorRect& rect) = 0;
+    virtual void SetPrimitiveTopology(PrimitiveTopology topology) = 0;
+    virtual void SetVertexBuffer(const VertexBufferView& view) = 0;
+    virtual void SetIndexBuffer(const IndexBufferView& view) = 0;
+    virtual void SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GpuAddress bufferLocation) = 0;
+    virtual void SetGraphicsRootShaderResourceView(uint32_t rootParameterIndex, GpuAddress bufferLocation) = 0;
+
+    // the table starts at "firstDescriptor" of the shader visible heap, which every command list has bound
+    virtual void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, DescriptorIndex firstDescriptor) = 0;
+
+    virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) = 0;
+};
+
+// device level interface, replaces the InitD3D / UpdatePipeline / Render / Cleanup globals
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() {}
+
+    // create the device, command queue, swap chain, back buffers, depth buffer and command list
+    virtual bool Init(int width, int height) = 0;
+
+    // wait for the gpu and release everything
+    virtual void Shutdown() = 0;
+
+    // create a buffer in gpu local memory and stage the copy of "data" into it. the copy runs on the
+    // copy queue once it is submitted by FlushUploads() or EndFrame(), frames submitted after that
+    // wait for it on the gpu. the buffer is then used in state "finalState" (buffers get there implicitly)
+    virtual bool CreateStaticBuffer(const void* data, uint64_t size, ResourceState finalState, StaticBuffer* buffer) = 0;
+
+    // create a persistently mapped upload heap buffer
+    virtual bool CreateUploadBuffer(uint64_t size, UploadBuffer* buffer) = 0;
+
+    // create a texture in gpu local memory, its contents are undefined until they are uploaded.
+    // false for formats GetDxgiFormatSize doesn't know
+    virtual bool CreateTexture(const TextureDesc& desc, ResourceHandle* texture) = 0;
+
+    // stage the copies of "count" subresources from "firstSubresource" on, "sources" are tightly
+    // packed or have their own pitches. the data is staged before this returns, split over "jobs"
+    // (may be null) when there is a lot of it, the copies go out like the static buffer ones.
+    // textures are promoted to the state they're read in on first use, like buffers
+    virtual bool UploadTexture(ResourceHandle texture, uint32_t firstSubresource, uint32_t count,
+        const SubresourceSource* sources, JobSystem* jobs) = 0;
+
+    virtual PipelineHandle CreatePipeline(const PipelineDesc& desc) = 0;
+
+    // descriptors live in one shader visible heap. persistent ones stay valid until they are freed (the
+    // slot is reused once the gpu finished the frames that may read it), transient ones only for the frame
+    // being recorded, so they are allocated between BeginFrame and EndFrame
+    virtual DescriptorIndex AllocatePersistentDescriptor() = 0;
+    virtual void FreePersistentDescriptor(DescriptorIndex descriptor) = 0;
+    virtual bool AllocateTransientDescriptors(uint32_t count, DescriptorIndex* first) = 0;
+
+    // write a constant buffer view of "size" bytes (a multiple of ConstantBufferAlignment) into "descriptor"
+    virtual void CreateConstantBufferView(DescriptorIndex descriptor, GpuAddress bufferLocation, uint32_t size) = 0;
+
+    // submit the copies staged by CreateStaticBuffer and UploadTexture without waiting for them
+    virtual bool FlushUploads() = 0;
+
+    virtual int GetFrameIndex() const = 0; // current back buffer
+
+    // how many frames (1..frameBufferCount) the cpu may record ahead of the gpu. BeginFrame only
+    // blocks once that many frames are in flight. waits for the gpu to go idle, false (and nothing
+    // changes) for a count outside that range
+    virtual bool SetFramesInFlight(uint32_t count) = 0;
+
+    // frames are numbered 1, 2, 3... in the order they are passed to EndFrame. the frame being
+    // recorded is GetSubmittedFrameCount() + 1, so a frame number works as a fence value for
+    // anything the cpu writes for that frame
+    virtual uint64_t GetSubmittedFrameCount() const = 0;
+    virtual uint64_t GetCompletedFrameCount() const = 0; // every frame up to this one is done on the gpu
+
+    virtual ResourceHandle GetBackBuffer(int frameIndex) const = 0;
+
+    // wait until the gpu is done with the frame context (allocators) the new frame records into, pick up the
+    // back buffer the swap chain hands out next and reset the command list. per frame cpu writes (constant
+    // buffers) belong after this call
+    virtual bool BeginFrame() = 0;
+
+    // the command list being recorded between BeginFrame and EndFrame
+    virtual RenderCommandList* GetCommandList() = 0;
+
+    // split the frame into "count" (at most MaxParallelCommandLists) command lists that can be recorded
+    // on different threads at the same time, each with its own allocator. the gpu runs what was recorded
+    // into GetCommandList() before this call, then parallel list 0, 1, ... and then what GetCommandList()
+    // records afterwards, all submitted together by EndFrame. command lists don't inherit state, so every
+    // parallel list sets its own render target, pipeline, viewport and buffers. at most once per frame
+    virtual bool BeginParallelRecording(uint32_t count) = 0;
+    virtual RenderCommandList* GetParallelCommandList(uint32_t index) = 0;
+
+    // close and execute the command list, signal the frame fence and present
+    virtual bool EndFrame() = 0;
+
+    // block until the gpu finished every frame that was submitted
+    virtual void WaitForGpu() = 0;
+};
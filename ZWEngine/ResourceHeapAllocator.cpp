@@ -0,0 +1,97 @@
+#include "ResourceHeapAllocator.h"
+
+ResourceHeapAllocator::ResourceHeapAllocator()
+    : mHeapSize(0), mGranularity(ResourcePlacementAlignment)
+{
+}
+
+void ResourceHeapAllocator::Init(uint64_t heapSize, uint64_t granularity)
+{
+    mHeapSize = heapSize;
+    mGranularity = granularity;
+    mHeaps.clear();
+}
+
+uint64_t ResourceHeapAllocator::GetHeapSizeFor(uint64_t size) const
+{
+    // heaps start aligned, so a dedicated heap needs no padding
+    uint64_t needed = (size + mGranularity - 1) & ~(mGranularity - 1);
+    return needed > mHeapSize ? needed : mHeapSize;
+}
+
+uint32_t ResourceHeapAllocator::AddHeap(uint64_t size)
+{
+    mHeaps.push_back(TlsfAllocator());
+    mHeaps.back().Init(size, mGranularity);
+    return (uint32_t)mHeaps.size() - 1;
+}
+
+bool ResourceHeapAllocator::Allocate(uint64_t size, uint64_t alignment, HeapAllocation* allocation)
+{
+    for (uint32_t i = 0; i < mHeaps.size(); ++i)
+    {
+        if (mHeaps[i].Allocate(size, alignment, &allocation->allocation))
+        {
+            allocation->heap = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResourceHeapAllocator::Free(const HeapAllocation& allocation)
+{
+    if (allocation.heap < mHeaps.size())
+    {
+        mHeaps[allocation.heap].Free(allocation.allocation.handle);
+    }
+}
+
+uint32_t ResourceHeapAllocator::GetHeapCount() const
+{
+    return (uint32_t)mHeaps.size();
+}
+
+uint32_t ResourceHeapAllocator::PlanDefragmentation(uint32_t maxMoves, std::vector<HeapMove>* moves)
+{
+    uint32_t moveCount = 0;
+    std::vector<TlsfMove> heapMoves;
+    for (uint32_t i = 0; i < mHeaps.size() && moveCount < maxMoves; ++i)
+    {
+        heapMoves.clear();
+        moveCount += mHeaps[i].PlanDefragmentation(maxMoves - moveCount, &heapMoves);
+        for (uint32_t j = 0; j < heapMoves.size(); ++j)
+        {
+            HeapMove move;
+            move.heap = i;
+            move.move = heapMoves[j];
+            moves->push_back(move);
+        }
+    }
+    return moveCount;
+}
+
+ResourceHeapStats ResourceHeapAllocator::GetStats() const
+{
+    ResourceHeapStats stats;
+    stats.heapCount = (uint32_t)mHeaps.size();
+    stats.size = 0;
+    stats.usedSize = 0;
+    stats.largestFreeBlock = 0;
+    stats.allocationCount = 0;
+    stats.freeBlockCount = 0;
+
+    for (uint32_t i = 0; i < mHeaps.size(); ++i)
+    {
+        TlsfStats heap = mHeaps[i].GetStats();
+        stats.size += heap.size;
+        stats.usedSize += heap.usedSize;
+        stats.largestFreeBlock = heap.largestFreeBlock > stats.largestFreeBlock ? heap.largestFreeBlock : stats.largestFreeBlock;
+        stats.allocationCount += heap.allocationCount;
+        stats.freeBlockCount += heap.freeBlockCount;
+    }
+
+    uint64_t freeSize = stats.size - stats.usedSize;
+    stats.fragmentation = freeSize ? 1.0f - (float)((double)stats.largestFreeBlock / (double)freeSize) : 0.0f;
+    return stats;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "TlsfAllocator.h"
+#include <vector>
+
+// buffers and small textures are placed on 64KB boundaries, msaa textures on 4MB ones
+const uint64_t ResourcePlacementAlignment = 64 * 1024; // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+const uint64_t MsaaResourcePlacementAlignment = 4 * 1024 * 1024; // D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+
+struct HeapAllocation
+{
+    uint32_t heap; // index of the heap, in AddHeap order
+    TlsfAllocation allocation;
+};
+
+// a planned move inside one heap, see TlsfMove
+struct HeapMove
+{
+    uint32_t heap;
+    TlsfMove move;
+};
+
+struct ResourceHeapStats
+{
+    uint32_t heapCount;
+    uint64_t size; // of all heaps
+    uint64_t usedSize;
+    uint64_t largestFreeBlock;
+    uint32_t allocationCount;
+    uint32_t freeBlockCount;
+    float fragmentation; // 1 - largestFreeBlock / free size over all heaps
+};
+
+// Places resources in a list of big heaps instead of giving each one an implicit heap of its own
+// (CreateCommittedResource). Only the bookkeeping lives here: the backend creates a heap whenever
+// Allocate fails and registers it with AddHeap. The earliest heap that fits is used, so the
+// later heaps empty out first.
+class ResourceHeapAllocator
+{
+public:
+    ResourceHeapAllocator();
+
+    // heaps are normally "heapSize" bytes, offsets are multiples of "granularity"
+    void Init(uint64_t heapSize, uint64_t granularity = ResourcePlacementAlignment);
+
+    // size of the heap to create when Allocate failed for "size" bytes
+    uint64_t GetHeapSizeFor(uint64_t size) const;
+
+    // register a new heap of "size" bytes, returns its index
+    uint32_t AddHeap(uint64_t size);
+
+    // false if no heap has room, add one and try again
+    bool Allocate(uint64_t size, uint64_t alignment, HeapAllocation* allocation);
+    void Free(const HeapAllocation& allocation);
+
+    uint32_t GetHeapCount() const;
+
+    // plan up to "maxMoves" moves that compact every heap towards its start (TlsfAllocator::PlanDefragmentation)
+    uint32_t PlanDefragmentation(uint32_t maxMoves, std::vector<HeapMove>* moves);
+
+    ResourceHeapStats GetStats() const;
+
+private:
+    uint64_t mHeapSize;
+    uint64_t mGranularity;
+    std::vector<TlsfAllocator> mHeaps;
+};
@@ -0,0 +1,829 @@
+#include "Scene.h"
+#include "Bvh.h"
+#include "DdsTexture.h"
+#include "FrustumCulling.h"
+#include "IndexNarrowing.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include "TransformSystem.h"
+#include "UploadPacker.h"
+#include "WvpBatch.h"
+#include "UploadRingAllocator.h"
+#include "VertexQuantization.h"
+#include <DirectXMath.h>
+#include <atomic>
+#include <cstring>
+#include <vector>
+using namespace DirectX;
+
+struct Vertex {
+    Vertex(float x, float y, float z, float r, float g, float b, float a) : pos(x, y, z), color(r, g, b, a) {}
+    XMFLOAT3 pos;
+    XMFLOAT4 color;
+};
+
+struct ConstantBufferPerObject {
+    XMFLOAT4X4 wvpMat;
+};
+
+// constant buffer views must be 256 byte aligned, so the per object constant buffers are laid out at this stride
+const uint32_t ConstantBufferPerObjectAlignedSize = (sizeof(ConstantBufferPerObject) + 255) & ~255;
+
+// the instance buffer is a structured buffer, its wvp matrices are tightly packed
+const uint32_t InstanceWvpSize = sizeof(XMFLOAT4X4);
+
+UploadRingAllocator constantBufferAllocator; // every frame's constant buffers are allocated from here, pages are reused once the gpu is done with them
+
+GpuAddress cubeConstantBuffers; // this frame's constant buffers (the instance buffer when instanced), one per visible cube
+
+PipelineHandle pipelineStateObject; // pso and root signature used to draw the cubes
+
+bool instancedDraws; // all cubes in one DrawIndexedInstanced, the vertex shader picks the wvp matrix by SV_InstanceID
+
+bool descriptorTableDraws; // per draw, the constant buffers are bound through cbv descriptors
+
+DescriptorIndex cubeDescriptors; // this frame's transient cbvs of cubeConstantBuffers, one per visible cube
+
+StaticBuffer vertexBuffer; // a default buffer in GPU memory that we will load vertex data for our triangle into
+
+VertexBufferView vertexBufferView; // a structure containing a pointer to the vertex data in gpu memory
+// the total size of the buffer, and the size of each element (vertex)
+
+StaticBuffer indexBuffer; // a default buffer in GPU memory that we will load index data for our triangle into
+
+IndexBufferView indexBufferView; // a structure holding information about the index buffer
+
+Viewport viewport; // area that output from rasterizer will be stretched to.
+
+ScissorRect scissorRect; // the area to draw in. pixels outside that area will not be drawn onto
+
+XMFLOAT4X4 cameraProjMat; // this will store our projection matrix
+XMFLOAT4X4 cameraViewMat; // this will store our view matrix
+
+XMFLOAT4 cameraPosition; // this is our cameras position vector
+XMFLOAT4 cameraTarget; // a vector describing the point in space our camera is looking at
+XMFLOAT4 cameraUp; // the worlds up vector
+
+TransformSystem transforms; // position, rotation and scale of everything in the scene
+
+TransformHandle cubeAnchor; // the point both cubes are placed around
+TransformHandle cube1; // our first cube, spins in place at the anchor
+TransformHandle cube2Orbit; // pivot at the anchor, its rotation makes cube2 orbit around cube1
+TransformHandle cube2; // our second cube, hangs off the orbit pivot at an offset and half the size
+
+std::vector<TransformHandle> drawTransforms; // the transforms drawn with the cube mesh, in draw order
+
+float cubeBoundsCenter[3]; // local bounds of the cube mesh, from its vertices
+float cubeBoundsExtent[3];
+
+bool quantizedVertices; // the cube is stored as QuantizedVertex
+
+XMFLOAT4X4 cubeDequantizationMat; // goes in front of the world matrices, quantized vertices are relative to the bounds
+
+AabbArrays cubeBounds; // world space bounds of every entry of drawTransforms, rebuilt every frame
+
+Bvh cubeBvh; // over cubeBounds, refit every frame and rebuilt once it got too slow to query
+
+float cubeBvhBuildCost; // sah cost right after the last build
+
+std::vector<uint32_t> visibleTransforms; // the cubes inside the view frustum this frame, in bvh order
+
+uint32_t visibleCount;
+
+JobSystem* sceneJobs; // runs the per frame work in parallel
+
+uint32_t recordingThreadCount; // command lists the draws of a frame are recorded into, one job each
+
+std::vector<Submesh> cubeSubmeshes; // the ranges of the index buffer the cube is drawn with
+
+uint32_t meshletPrimitives; // triangles per meshlet, 0 when the cube is drawn whole
+
+std::vector<MeshletBounds> cubeMeshletBounds; // mesh space bounds of the cube's meshlets, empty without meshlet culling
+
+std::vector<uint32_t> cubeMeshletFirstIndex; // where each meshlet starts in the index buffer, plus the end of the last one
+
+std::vector<uint32_t> visibleMeshlets; // per visible cube, cubeMeshletBounds.size() slots for the meshlets it draws
+
+std::vector<uint32_t> visibleMeshletCounts; // per visible cube, how many of its slots are used
+
+SceneMeshletStats sceneMeshletStats;
+
+std::atomic<uint32_t> meshletsFrustumCulled; // summed over the jobs of UpdateScene
+std::atomic<uint32_t> meshletsConeCulled;
+
+DdsTexture sceneTexture; // mapped, its mips become resident on the job system smallest first
+
+JobCounter sceneTextureStreaming; // the StreamAsync jobs still running
+
+bool sceneTextureOpen;
+
+ResourceHandle sceneTextureResource; // the gpu copy, filled mip by mip as they become resident
+
+SceneTextureStats sceneTextureStats;
+
+// the built-in cube: optimized, compressed and 16 bit indexed here, then uploaded
+static bool CreateCubeMesh(RenderBackend* backend)
+{
+    // a cube
+    Vertex vList[] = {
+        // front face
+        { -0.5f,  0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f },
+        {  0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 1.0f, 1.0f },
+        { -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 1.0f },
+        {  0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f },
+
+        // right side face
+        {  0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f },
+        {  0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 1.0f, 1.0f },
+        {  0.5f, -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 1.0f },
+        {  0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f },
+
+        // left side face
+        { -0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 1.0f },
+        { -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 1.0f, 1.0f },
+        { -0.5f, -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 1.0f },
+        { -0.5f,  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f },
+
+        // back face
+        {  0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 1.0f },
+        { -0.5f, -0.5f,  0.5f, 1.0f, 0.0f, 1.0f, 1.0f },
+        {  0.5f, -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 1.0f },
+        { -0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f },
+
+        // top face
+        { -0.5f,  0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f },
+        { 0.5f,  0.5f,  0.5f, 1.0f, 0.0f, 1.0f, 1.0f },
+        { 0.5f,  0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 1.0f },
+        { -0.5f,  0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f },
+
+        // bottom face
+        {  0.5f, -0.5f,  0.5f, 1.0f, 0.0f, 0.0f, 1.0f },
+        { -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 1.0f, 1.0f },
+        {  0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 1.0f },
+        { -0.5f, -0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 1.0f },
+    };
+
+    // Create index buffer
+
+    // a quad (2 triangles)
+    uint32_t iList[] = {
+        // ffront face
+        0, 1, 2, // first triangle
+        0, 3, 1, // second triangle
+
+        // left face
+        4, 5, 6, // first triangle
+        4, 7, 5, // second triangle
+
+        // right face
+        8, 9, 10, // first triangle
+        8, 11, 9, // second triangle
+
+        // back face
+        12, 13, 14, // first triangle
+        12, 15, 13, // second triangle
+
+        // top face
+        16, 17, 18, // first triangle
+        16, 19, 17, // second triangle
+
+        // bottom face
+        20, 21, 22, // first triangle
+        20, 23, 21, // second triangle
+    };
+
+    const uint32_t numCubeIndices = sizeof(iList) / sizeof(uint32_t);
+
+    // reorder the triangles for the post-transform cache, then clusters of them for overdraw, and
+    // renumber the vertices in the order the triangles use them, before anything is uploaded
+    const uint32_t cubeVertexCount = sizeof(vList) / sizeof(Vertex);
+    OptimizeVertexCache(iList, iList, numCubeIndices, cubeVertexCount);
+
+    uint32_t optimizedIndices[sizeof(iList) / sizeof(uint32_t)];
+    OptimizeOverdraw(optimizedIndices, iList, numCubeIndices, &vList[0].pos.x, sizeof(Vertex), cubeVertexCount, 1.05f);
+
+    std::vector<Vertex> optimizedVertices(vList, vList + cubeVertexCount);
+    uint32_t usedVertexCount = OptimizeVertexFetch(optimizedVertices.data(), optimizedIndices, numCubeIndices, vList, cubeVertexCount, sizeof(Vertex));
+    memcpy(vList, optimizedVertices.data(), usedVertexCount * sizeof(Vertex));
+    memcpy(iList, optimizedIndices, sizeof(iList));
+
+    // Create vertex buffer
+
+    // every cube is culled with the bounds of the mesh, moved along with its world matrix
+    ComputeAabb(&vList[0].pos, usedVertexCount, sizeof(Vertex), cubeBoundsCenter, cubeBoundsExtent);
+
+    // quantized, the positions are stored relative to the same bounds
+    std::vector<QuantizedVertex> quantizedList;
+    const void* vData = vList;
+    int vStride = sizeof(Vertex);
+    if (quantizedVertices)
+    {
+        quantizedList.resize(usedVertexCount);
+        QuantizeVertices(quantizedList.data(), &vList[0].pos.x, sizeof(Vertex), &vList[0].color.x, sizeof(Vertex), usedVertexCount,
+            cubeBoundsCenter, cubeBoundsExtent);
+        GetDequantizationMatrix(cubeBoundsCenter, cubeBoundsExtent, &cubeDequantizationMat.m[0][0]);
+        vData = quantizedList.data();
+        vStride = sizeof(QuantizedVertex);
+    }
+
+    // 16 bit indices, a mesh past 65536 vertices is drawn as several submeshes instead of with 32 bit ones
+    std::vector<uint16_t> indices16;
+    std::vector<uint8_t> vertices16;
+    BuildIndexBuffer16(iList, numCubeIndices, vData, usedVertexCount, vStride, &indices16, &vertices16, &cubeSubmeshes);
+
+    // the meshlets take the triangles in index buffer order, so each one is a range of the index
+    // buffer a draw can cover. only while the whole mesh is one submesh, the ranges don't follow
+    // the cuts of a split one
+    if (meshletPrimitives > 0 && cubeSubmeshes.size() == 1)
+    {
+        MeshletData meshlets;
+        BuildMeshlets(iList, numCubeIndices, &vList[0].pos.x, sizeof(Vertex), usedVertexCount, DefaultMeshletVertices,
+            meshletPrimitives, &meshlets);
+        cubeMeshletBounds = meshlets.bounds;
+        for (size_t i = 0; i < meshlets.meshlets.size(); ++i)
+        {
+            cubeMeshletFirstIndex.push_back(meshlets.meshlets[i].primitiveOffset * 3);
+        }
+        cubeMeshletFirstIndex.push_back((uint32_t)meshlets.primitives.size());
+    }
+
+    int vBufferSize = (int)vertices16.size();
+    int iBufferSize = (int)(indices16.size() * sizeof(uint16_t));
+
+    // the backend copies the data through an upload heap into a default heap and transitions it to vertex buffer state
+    if (!backend->CreateStaticBuffer(vertices16.data(), vBufferSize, ResourceState::VertexAndConstantBuffer, &vertexBuffer))
+    {
+        return false;
+    }
+
+    if (!backend->CreateStaticBuffer(indices16.data(), iBufferSize, ResourceState::IndexBuffer, &indexBuffer))
+    {
+        return false;
+    }
+
+    // create a vertex buffer view for the triangle. We get the GPU memory address to the vertex pointer using the GetGPUVirtualAddress() method
+    vertexBufferView.bufferLocation = vertexBuffer.gpuAddress;
+    vertexBufferView.strideInBytes = vStride;
+    vertexBufferView.sizeInBytes = vBufferSize;
+
+    indexBufferView.bufferLocation = indexBuffer.gpuAddress;
+    indexBufferView.format = IndexFormat::UInt16; // 16-bit unsigned integer, relative to the base vertex of each submesh
+    indexBufferView.sizeInBytes = iBufferSize;
+
+    return true;
+}
+
+// a mesh file instead of the cube. it is stored ready to draw, the sections are uploaded straight
+// out of the map
+static bool LoadMeshFile(RenderBackend* backend, const char* path)
+{
+    MeshFile file;
+    if (!file.Open(path) || !file.CreateBuffers(backend, &vertexBuffer, &indexBuffer))
+    {
+        return false;
+    }
+
+    const MeshFileInfo& mesh = file.GetInfo();
+    memcpy(cubeBoundsCenter, mesh.boundsCenter, sizeof(cubeBoundsCenter));
+    memcpy(cubeBoundsExtent, mesh.boundsExtent, sizeof(cubeBoundsExtent));
+    quantizedVertices = mesh.vertexLayout == VertexLayout::PositionColorQuantized;
+    if (quantizedVertices)
+    {
+        GetDequantizationMatrix(cubeBoundsCenter, cubeBoundsExtent, &cubeDequantizationMat.m[0][0]);
+    }
+    cubeSubmeshes.assign(mesh.submeshes, mesh.submeshes + mesh.submeshCount);
+
+    vertexBufferView.bufferLocation = vertexBuffer.gpuAddress;
+    vertexBufferView.strideInBytes = mesh.vertexStride;
+    vertexBufferView.sizeInBytes = (uint32_t)mesh.vertices.size;
+
+    indexBufferView.bufferLocation = indexBuffer.gpuAddress;
+    indexBufferView.format = mesh.indexFormat;
+    indexBufferView.sizeInBytes = (uint32_t)mesh.indices.size;
+    return true;
+}
+
+// open the dds, create the texture for all of it and start streaming. nothing is uploaded yet, every
+// frame uploads what became resident since the last one
+static bool OpenSceneTexture(RenderBackend* backend, const char* path)
+{
+    if (!sceneTexture.Open(path))
+    {
+        return false;
+    }
+    sceneTextureOpen = true;
+
+    const DdsInfo& info = sceneTexture.GetInfo();
+    TextureDesc desc;
+    desc.format = info.format;
+    desc.width = info.width;
+    desc.height = info.height;
+    desc.depth = info.dimension == DdsDimension::Texture3D ? info.depth : 1;
+    desc.arraySize = info.arraySize;
+    desc.mipCount = info.mipCount;
+    desc.volume = info.dimension == DdsDimension::Texture3D;
+    if (!backend->CreateTexture(desc, &sceneTextureResource))
+    {
+        return false;
+    }
+
+    sceneTextureStats.texture = sceneTextureResource;
+    sceneTextureStats.mipCount = info.mipCount;
+    sceneTextureStats.residentMip = info.mipCount;
+    sceneTextureStats.uploadedMip = info.mipCount;
+    // without a worker the queued jobs would only run when the frame waits on something else, read
+    // everything now instead, the first frame uploads it
+    if (sceneJobs->GetThreadCount() > 1)
+    {
+        sceneTexture.StreamAsync(sceneJobs, &sceneTextureStreaming);
+    }
+    else
+    {
+        sceneTexture.LoadAll();
+    }
+    return true;
+}
+
+// stage the mips that became resident since the last frame, one UploadTexture per array slice (the
+// new mips of a slice are consecutive subresources). they go out with this frame's copies
+static bool UploadResidentMips(RenderBackend* backend)
+{
+    if (!sceneTextureOpen || sceneTextureStats.uploadedMip == 0)
+    {
+        return true;
+    }
+    const uint32_t residentMip = sceneTexture.GetResidentMip();
+    sceneTextureStats.residentMip = residentMip;
+    if (residentMip == sceneTextureStats.uploadedMip)
+    {
+        return true;
+    }
+
+    const DdsInfo& info = sceneTexture.GetInfo();
+    const uint32_t count = sceneTextureStats.uploadedMip - residentMip;
+    SubresourceSource sources[32]; // a mip chain of 32 bit sizes has at most 32 mips
+    for (uint32_t slice = 0; slice < info.arraySize; ++slice)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ByteSpan data;
+            if (!sceneTexture.GetSubresource(residentMip + i, slice, &data))
+            {
+                return false;
+            }
+            const DdsSubresource& subresource = info.subresources[residentMip + i + slice * info.mipCount];
+            sources[i].data = data.data;
+            sources[i].rowPitch = subresource.rowPitch;
+            sources[i].slicePitch = (uint64_t)subresource.rowPitch * subresource.rowCount;
+            sceneTextureStats.uploadedBytes += data.size;
+        }
+        if (!backend->UploadTexture(sceneTextureResource, residentMip + slice * info.mipCount, count, sources, sceneJobs))
+        {
+            return false;
+        }
+        sceneTextureStats.uploadCount += 1;
+    }
+    sceneTextureStats.uploadedMip = residentMip;
+    return true;
+}
+
+bool InitScene(RenderBackend* backend, JobSystem* jobs, int width, int height, const SceneSettings& settings)
+{
+    // a texture from an earlier InitScene is closed first, its streaming has finished by now
+    ShutdownScene();
+
+    sceneJobs = jobs;
+    sceneTextureStats = SceneTextureStats();
+    if (settings.texturePath && !OpenSceneTexture(backend, settings.texturePath))
+    {
+        return false;
+    }
+    instancedDraws = settings.instanced;
+    descriptorTableDraws = settings.descriptorTables && !settings.instanced;
+    meshletPrimitives = settings.instanced ? 0 : settings.meshletPrimitives;
+    quantizedVertices = settings.quantizedVertices;
+    cubeMeshletBounds.clear();
+    cubeMeshletFirstIndex.clear();
+    sceneMeshletStats = SceneMeshletStats();
+
+    // the vertex and index buffers, the pipeline is created for the vertex layout they ended up with
+    bool meshCreated = settings.meshPath ? LoadMeshFile(backend, settings.meshPath) : CreateCubeMesh(backend);
+    if (!meshCreated)
+    {
+        return false;
+    }
+
+    PipelineDesc pipelineDesc = {};
+    pipelineDesc.vertexShader = L"VertexShader.hlsl";
+    pipelineDesc.pixelShader = L"PixelShader.hlsl";
+    pipelineDesc.vertexLayout = quantizedVertices ? VertexLayout::PositionColorQuantized : VertexLayout::PositionColor;
+    pipelineDesc.instanced = instancedDraws;
+    pipelineDesc.constantBufferTable = descriptorTableDraws;
+    pipelineStateObject = backend->CreatePipeline(pipelineDesc);
+    if (pipelineStateObject == InvalidPipeline)
+    {
+        return false;
+    }
+
+    // create the constant buffer resource heap
+    // We will update the constant buffer one or more times per frame, so we will use only an upload heap
+    // unlike previously we used an upload heap to upload the vertex and index data, and then copied over
+    // to a default heap. If you plan to use a resource for more than a couple frames, it is usually more
+    // efficient to copy to a default heap where it stays on the gpu. In this case, our constant buffer
+    // will be modified and uploaded at least once per frame, so we only use an upload heap
+
+    // the constant buffers are suballocated from 64KB upload pages every frame. the allocator grows
+    // when a frame needs more than the pages the gpu already released, so the number of objects
+    // isn't limited by a fixed heap size
+    constantBufferAllocator.Init(backend, 1024 * 64);
+
+    // Now we submit the uploads of the initial assets (triangle data), the first frame waits for them on the gpu
+    if (!backend->FlushUploads())
+    {
+        return false;
+    }
+
+    // Fill out the Viewport
+    viewport.topLeftX = 0;
+    viewport.topLeftY = 0;
+    viewport.width = (float)width;
+    viewport.height = (float)height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    // Fill out a scissor rect
+    scissorRect.left = 0;
+    scissorRect.top = 0;
+    scissorRect.right = width;
+    scissorRect.bottom = height;
+
+    // build projection and view matrix
+    XMMATRIX tmpMat = XMMatrixPerspectiveFovLH(45.0f * (3.14f / 180.0f), (float)width / (float)height, 0.1f, 1000.0f);
+    XMStoreFloat4x4(&cameraProjMat, tmpMat);
+
+    // set starting camera state
+    cameraPosition = XMFLOAT4(0.0f, 2.0f, -4.0f, 0.0f);
+    cameraTarget = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+    cameraUp = XMFLOAT4(0.0f, 1.0f, 0.0f, 0.0f);
+
+    // build view matrix
+    XMVECTOR cPos = XMLoadFloat4(&cameraPosition);
+    XMVECTOR cTarg = XMLoadFloat4(&cameraTarget);
+    XMVECTOR cUp = XMLoadFloat4(&cameraUp);
+    tmpMat = XMMatrixLookAtLH(cPos, cTarg, cUp);
+    XMStoreFloat4x4(&cameraViewMat, tmpMat);
+
+    // set starting cubes position
+    XMFLOAT4 identityRotation;
+    XMStoreFloat4(&identityRotation, XMQuaternionIdentity());
+    const XMFLOAT3 unitScale(1.0f, 1.0f, 1.0f);
+
+    // first cube, the scene is built from scratch
+    transforms.Clear();
+    cubeAnchor = transforms.Create(InvalidTransform, XMFLOAT3(0.0f, 0.0f, 0.0f), identityRotation, unitScale);
+    cube1 = transforms.Create(cubeAnchor, XMFLOAT3(0.0f, 0.0f, 0.0f), identityRotation, unitScale);
+    transforms.SetAngularVelocity(cube1, XMFLOAT3(0.5f, 1.0f, 1.5f));
+
+    // second cube. it is offset from the orbit pivot, so rotating the pivot moves it around cube1
+    cube2Orbit = transforms.Create(cubeAnchor, XMFLOAT3(0.0f, 0.0f, 0.0f), identityRotation, unitScale);
+    cube2 = transforms.Create(cube2Orbit, XMFLOAT3(1.5f, 0.0f, 0.0f), identityRotation, XMFLOAT3(0.5f, 0.5f, 0.5f));
+    transforms.SetAngularVelocity(cube2Orbit, XMFLOAT3(1.5f, 1.0f, 0.5f));
+
+    drawTransforms.clear();
+    drawTransforms.push_back(cube1);
+    drawTransforms.push_back(cube2);
+
+    // the grid, a square centered below the anchor. every cube spins in place at its own speed
+    uint32_t gridSide = 0;
+    while (gridSide * gridSide < settings.gridCubeCount)
+    {
+        ++gridSide;
+    }
+    const float gridSpacing = 0.5f;
+    transforms.Reserve(transforms.Count() + settings.gridCubeCount);
+    drawTransforms.reserve(drawTransforms.size() + settings.gridCubeCount);
+    for (uint32_t i = 0; i < settings.gridCubeCount; ++i)
+    {
+        XMFLOAT3 position(((float)(i % gridSide) - 0.5f * (gridSide - 1)) * gridSpacing, -1.5f,
+            ((float)(i / gridSide) - 0.5f * (gridSide - 1)) * gridSpacing);
+        TransformHandle cube = transforms.Create(cubeAnchor, position, identityRotation, XMFLOAT3(0.2f, 0.2f, 0.2f));
+        transforms.SetAngularVelocity(cube, XMFLOAT3(0.0f, 0.5f + 0.25f * (i % 7), 0.0f));
+        drawTransforms.push_back(cube);
+    }
+
+    // one command list per job system thread, up to what the backend supports
+    recordingThreadCount = sceneJobs->GetThreadCount();
+    if (recordingThreadCount > MaxParallelCommandLists)
+    {
+        recordingThreadCount = MaxParallelCommandLists;
+    }
+
+    return true;
+}
+
+void SimulateScene(float deltaTime)
+{
+    // keep the last state, rendering interpolates from it towards the new one
+    transforms.BeginStep();
+
+    // spin the cubes, the speed no longer depends on the frame rate
+    transforms.Integrate(deltaTime);
+}
+
+// "point" moved by the inverse of "world", an affine row-vector matrix: p * L + t = point is solved
+// for p with the inverse of L made of the cross products of its rows
+static void InverseTransformPoint(const XMFLOAT4X4& world, const XMFLOAT4& point, float result[3])
+{
+    XMVECTOR r0 = XMVectorSet(world._11, world._12, world._13, 0.0f);
+    XMVECTOR r1 = XMVectorSet(world._21, world._22, world._23, 0.0f);
+    XMVECTOR r2 = XMVectorSet(world._31, world._32, world._33, 0.0f);
+    XMVECTOR d = XMVectorSet(point.x - world._41, point.y - world._42, point.z - world._43, 0.0f);
+    XMVECTOR c0 = XMVector3Cross(r1, r2);
+    float determinant = XMVectorGetX(XMVector3Dot(r0, c0));
+    result[0] = XMVectorGetX(XMVector3Dot(d, c0)) / determinant;
+    result[1] = XMVectorGetX(XMVector3Dot(d, XMVector3Cross(r2, r0))) / determinant;
+    result[2] = XMVectorGetX(XMVector3Dot(d, XMVector3Cross(r0, r1))) / determinant;
+}
+
+// the meshlets of visible cubes [begin, end) that are in the frustum and face the camera. culled
+// in mesh space, against the frustum of world * viewProj and the camera moved into the cube
+static void CullCubeMeshlets(uint32_t begin, uint32_t end, const XMFLOAT4X4& viewProjMat)
+{
+    const uint32_t meshletCount = (uint32_t)cubeMeshletBounds.size();
+    const XMMATRIX viewProj = XMLoadFloat4x4(&viewProjMat);
+    uint32_t frustumCulled = 0, coneCulled = 0;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const XMFLOAT4X4& world = transforms.WorldMatrices()[visibleTransforms[i]];
+        XMFLOAT4X4 worldViewProj;
+        XMStoreFloat4x4(&worldViewProj, XMLoadFloat4x4(&world) * viewProj);
+        Frustum frustum;
+        ExtractFrustum(&worldViewProj.m[0][0], &frustum);
+        float camera[3];
+        InverseTransformPoint(world, cameraPosition, camera);
+
+        MeshletCullStats stats;
+        visibleMeshletCounts[i] = CullMeshlets(cubeMeshletBounds.data(), meshletCount, frustum, camera,
+            visibleMeshlets.data() + (size_t)i * meshletCount, &stats);
+        frustumCulled += stats.frustumCulled;
+        coneCulled += stats.coneCulled;
+    }
+    meshletsFrustumCulled += frustumCulled;
+    meshletsConeCulled += coneCulled;
+}
+
+bool UpdateScene(RenderBackend* backend, float alpha)
+{
+    // everything allocated from here on belongs to the next frame to be submitted
+    constantBufferAllocator.BeginFrame(backend->GetSubmittedFrameCount() + 1, backend->GetCompletedFrameCount());
+
+    // the texture mips streamed in since the last frame
+    if (!UploadResidentMips(backend))
+    {
+        return false;
+    }
+
+    // update app logic, such as moving the camera or figuring out what objects are in view
+
+    // build every world matrix between the last two simulation steps in one pass over the hierarchy
+    transforms.UpdateWorld(alpha);
+
+    XMMATRIX viewMat = XMLoadFloat4x4(&cameraViewMat); // load view matrix
+    XMMATRIX projMat = XMLoadFloat4x4(&cameraProjMat); // load projection matrix
+    XMFLOAT4X4 viewProjMat;
+    XMStoreFloat4x4(&viewProjMat, viewMat * projMat);
+
+    // frustum culling: world space bounds of every cube, then the ones the camera sees
+    const uint32_t drawCount = (uint32_t)drawTransforms.size();
+    cubeBounds.Resize(drawCount);
+    sceneJobs->ParallelFor(drawCount, 4096, [&](uint32_t begin, uint32_t end)
+    {
+        TransformAabbs(cubeBoundsCenter, cubeBoundsExtent, &transforms.WorldMatrices()->m[0][0], drawTransforms.data(),
+            begin, end - begin, &cubeBounds);
+    });
+
+    // the cubes moved, so refit the hierarchy to their new bounds. refitting keeps the tree, which
+    // gets worse as the cubes drift away from where it was built, rebuild it when queries cost half
+    // again as much as right after the build
+    if (cubeBvh.GetItemCount() != drawCount)
+    {
+        cubeBvh.Build(cubeBounds);
+        cubeBvhBuildCost = cubeBvh.GetSahCost();
+    }
+    else
+    {
+        cubeBvh.Refit(cubeBounds);
+        if (cubeBvh.GetSahCost() > 1.5f * cubeBvhBuildCost)
+        {
+            cubeBvh.Build(cubeBounds);
+            cubeBvhBuildCost = cubeBvh.GetSahCost();
+        }
+    }
+
+    Frustum frustum;
+    ExtractFrustum(&viewProjMat.m[0][0], &frustum);
+    visibleTransforms.clear();
+    cubeBvh.QueryFrustum(frustum, &visibleTransforms);
+    visibleCount = (uint32_t)visibleTransforms.size();
+    sceneMeshletStats.meshletCount = (uint32_t)cubeMeshletBounds.size();
+    sceneMeshletStats.testedMeshlets = visibleCount * sceneMeshletStats.meshletCount;
+    sceneMeshletStats.frustumCulled = 0;
+    sceneMeshletStats.coneCulled = 0;
+    if (visibleCount == 0)
+    {
+        return true;
+    }
+
+    // one slice of upload memory holds the constant buffers of every object drawn this frame. instanced
+    // draws read the matrices from a structured buffer, so they don't need the 256 byte stride
+    const uint32_t stride = instancedDraws ? InstanceWvpSize : ConstantBufferPerObjectAlignedSize;
+    UploadAllocation constantBuffers;
+    if (!constantBufferAllocator.Allocate((uint64_t)visibleCount * stride, ConstantBufferAlignment, &constantBuffers))
+    {
+        return false;
+    }
+    cubeConstantBuffers = constantBuffers.gpuAddress;
+
+    // a table of one cbv per cube, in the frame's transient descriptors the next BeginFrame of this
+    // frame context rewinds
+    if (descriptorTableDraws && !backend->AllocateTransientDescriptors(visibleCount, &cubeDescriptors))
+    {
+        return false;
+    }
+
+    visibleMeshlets.resize((size_t)visibleCount * cubeMeshletBounds.size());
+    visibleMeshletCounts.resize(visibleCount);
+    meshletsFrustumCulled = 0;
+    meshletsConeCulled = 0;
+
+    // create the wvp matrices of the visible cubes, transposed for the gpu, directly in the mapped constant buffers
+    sceneJobs->ParallelFor(visibleCount, 1024, [&](uint32_t begin, uint32_t end)
+    {
+        // culling returned positions in drawTransforms, turn them into transforms
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            visibleTransforms[i] = drawTransforms[visibleTransforms[i]];
+        }
+        ComputeWvpBatch(&transforms.WorldMatrices()->m[0][0], visibleTransforms.data() + begin, end - begin,
+            quantizedVertices ? &cubeDequantizationMat.m[0][0] : nullptr, &viewProjMat.m[0][0],
+            constantBuffers.cpuAddress + (uint64_t)begin * stride, stride);
+        for (uint32_t i = begin; i < end && descriptorTableDraws; ++i)
+        {
+            backend->CreateConstantBufferView(cubeDescriptors + i, constantBuffers.gpuAddress + (uint64_t)i * stride, stride);
+        }
+        if (!cubeMeshletBounds.empty())
+        {
+            CullCubeMeshlets(begin, end, viewProjMat);
+        }
+    });
+    sceneMeshletStats.frustumCulled = meshletsFrustumCulled;
+    sceneMeshletStats.coneCulled = meshletsConeCulled;
+    return true;
+}
+
+// record draws [firstDraw, firstDraw + drawCount) of the visible cubes. sets all the state it needs,
+// so every command list of a frame can be recorded independently
+static void RecordDraws(RenderCommandList* commandList, int frameIndex, uint32_t firstDraw, uint32_t drawCount)
+{
+    // set the render target and the depth/stencil buffer for the output merger stage (the output of the pipeline)
+    commandList->SetRenderTarget(frameIndex);
+
+    // set root signature and pso
+    commandList->SetPipeline(pipelineStateObject);
+
+    // draw triangle
+    commandList->SetViewport(viewport); // set the viewports
+    commandList->SetScissorRect(scissorRect); // set the scissor rects
+    commandList->SetPrimitiveTopology(PrimitiveTopology::TriangleList); // set the primitive topology
+    commandList->SetVertexBuffer(vertexBufferView); // set the vertex buffer (using the vertex buffer view)
+    commandList->SetIndexBuffer(indexBufferView);
+
+    if (instancedDraws)
+    {
+        // the instance buffer is laid out in draw order too, instance i uses matrix i of the slice
+        commandList->SetGraphicsRootShaderResourceView(0, cubeConstantBuffers + (uint64_t)firstDraw * InstanceWvpSize);
+        for (uint32_t s = 0; s < cubeSubmeshes.size(); ++s)
+        {
+            const Submesh& submesh = cubeSubmeshes[s];
+            commandList->DrawIndexedInstanced(submesh.indexCount, drawCount, submesh.firstIndex, submesh.baseVertex, 0);
+        }
+        return;
+    }
+
+    for (uint32_t i = firstDraw; i < firstDraw + drawCount; ++i)
+    {
+        // set the cube's constant buffer, they are laid out in draw order, and so are their descriptors
+        if (descriptorTableDraws)
+        {
+            commandList->SetGraphicsRootDescriptorTable(0, cubeDescriptors + i);
+        }
+        else
+        {
+            commandList->SetGraphicsRootConstantBufferView(0, cubeConstantBuffers + (uint64_t)i * ConstantBufferPerObjectAlignedSize);
+        }
+
+        // only the meshlets the cube sees, runs of neighbouring ones in one draw
+        if (!cubeMeshletBounds.empty())
+        {
+            const uint32_t* meshlets = visibleMeshlets.data() + (size_t)i * cubeMeshletBounds.size();
+            const uint32_t count = visibleMeshletCounts[i];
+            for (uint32_t m = 0; m < count;)
+            {
+                uint32_t last = m;
+                while (last + 1 < count && meshlets[last + 1] == meshlets[last] + 1)
+                {
+                    ++last;
+                }
+                const uint32_t firstIndex = cubeMeshletFirstIndex[meshlets[m]];
+                commandList->DrawIndexedInstanced(cubeMeshletFirstIndex[meshlets[last] + 1] - firstIndex, 1, firstIndex,
+                    cubeSubmeshes[0].baseVertex, 0);
+                m = last + 1;
+            }
+            continue;
+        }
+
+        // draw the cube
+        for (uint32_t s = 0; s < cubeSubmeshes.size(); ++s)
+        {
+            const Submesh& submesh = cubeSubmeshes[s];
+            commandList->DrawIndexedInstanced(submesh.indexCount, 1, submesh.firstIndex, submesh.baseVertex, 0);
+        }
+    }
+}
+
+bool RecordScene(RenderBackend* backend)
+{
+    RenderCommandList* commandList = backend->GetCommandList();
+    int frameIndex = backend->GetFrameIndex();
+
+    // transition the "frameIndex" render target from the present state to the render target state so the command list draws to it starting from here
+    //Դת
+    commandList->ResourceBarrier(backend->GetBackBuffer(frameIndex), ResourceState::Present, ResourceState::RenderTarget);
+
+    // Clear the render target by using the ClearRenderTargetView command
+    const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
+    commandList->ClearRenderTarget(frameIndex, clearColor);
+
+    // clear the depth/stencil buffer
+    commandList->ClearDepth(1.0f);
+
+    // split the draws into one slice per command list and record the slices as jobs. instanced there is
+    // only one draw, so one list
+    const uint32_t drawCount = visibleCount;
+    uint32_t listCount = instancedDraws ? 1 : (recordingThreadCount < drawCount ? recordingThreadCount : drawCount);
+    if (listCount > 1)
+    {
+        if (!backend->BeginParallelRecording(listCount))
+        {
+            return false;
+        }
+
+        sceneJobs->ParallelFor(listCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                uint32_t first = drawCount * i / listCount;
+                uint32_t last = drawCount * (i + 1) / listCount;
+                RecordDraws(backend->GetParallelCommandList(i), frameIndex, first, last - first);
+            }
+        });
+
+        // the rest of the frame goes into the list that runs after the parallel ones
+        commandList = backend->GetCommandList();
+    }
+    else if (drawCount > 0) // nothing to draw if everything was culled
+    {
+        RecordDraws(commandList, frameIndex, 0, drawCount);
+    }
+
+    // transition the "frameIndex" render target from the render target state to the present state. If the debug layer is enabled, you will receive a
+    // warning if present is called on the render target when it's not in the present state
+    commandList->ResourceBarrier(backend->GetBackBuffer(frameIndex), ResourceState::RenderTarget, ResourceState::Present);
+    return true;
+}
+
+void ShutdownScene()
+{
+    if (sceneTextureOpen)
+    {
+        sceneJobs->Wait(&sceneTextureStreaming);
+        sceneTexture.Close();
+        sceneTextureOpen = false;
+    }
+}
+
+UploadRingStats GetSceneUploadStats()
+{
+    return constantBufferAllocator.GetStats();
+}
+
+SceneTextureStats GetSceneTextureStats()
+{
+    return sceneTextureStats;
+}
+
+SceneMeshletStats GetSceneMeshletStats()
+{
+    return sceneMeshletStats;
+}
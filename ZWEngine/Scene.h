@@ -0,0 +1,63 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "RenderBackend.h"
+#include "UploadRingAllocator.h"
+
+// The demo scene (two spinning cubes). It only talks to the RenderBackend interface so the
+// whole frame loop can run on the d3d12 backend or headless on the null backend.
+
+struct SceneSettings
+{
+    uint32_t gridCubeCount; // small spinning cubes on a grid below the two big ones, to load the frame
+    bool instanced; // draw every cube with one DrawIndexedInstanced instead of one draw per cube
+    bool descriptorTables; // not instanced, bind each cube's constant buffer through a transient cbv descriptor instead of a root cbv
+    uint32_t meshletPrimitives; // not instanced, cut the built-in cube into meshlets of this many triangles and draw only the ones each cube sees, 0 to draw it whole
+    bool quantizedVertices; // 12 byte PositionColorQuantized vertices instead of the 28 byte float ones
+    const char* meshPath; // binary mesh file (see MeshFile.h) drawn instead of the built-in cube, null for the cube
+    const char* texturePath; // dds file streamed in smallest mip first while the scene runs, null for none
+};
+
+// how far the scene's texture got, mips count down from mipCount (nothing) to 0 (all of them)
+struct SceneTextureStats
+{
+    ResourceHandle texture; // the gpu copy
+    uint32_t mipCount; // 0 without a texture
+    uint32_t residentMip; // read from the file
+    uint32_t uploadedMip; // staged for the gpu, frames recorded from now on see it
+    uint32_t uploadCount; // UploadTexture calls, one per array slice of every batch of new mips
+    uint64_t uploadedBytes;
+};
+
+// meshlet culling in the last UpdateScene (see CullMeshlets), all zero without it
+struct SceneMeshletStats
+{
+    uint32_t meshletCount; // meshlets the cube was cut into
+    uint32_t testedMeshlets; // the meshlets of every cube that passed frustum culling
+    uint32_t frustumCulled;
+    uint32_t coneCulled; // facing away from the camera
+};
+
+// create geometry, constant buffers, camera and cubes. per frame work is spread over "jobs", which
+// also streams the texture in, so it must outlive the scene until ShutdownScene
+bool InitScene(RenderBackend* backend, JobSystem* jobs, int width, int height, const SceneSettings& settings);
+
+// wait for the texture streaming jobs and close the file, before the job system goes away
+void ShutdownScene();
+
+void SimulateScene(float deltaTime); // advance the game logic by one fixed simulation step
+
+// interpolate "alpha" (0..1) of the way between the last two simulation steps and write the
+// constant buffers of the next frame. false if the constant buffer memory could not be allocated, or
+// with descriptor tables the cbvs (TransientDescriptorCount per frame)
+bool UpdateScene(RenderBackend* backend, float alpha);
+
+// record the commands that draw the current frame. the draws are split into jobs, each recording
+// its own command list. false if the backend couldn't split the frame
+bool RecordScene(RenderBackend* backend);
+
+UploadRingStats GetSceneUploadStats(); // constant buffer memory used per frame
+
+SceneTextureStats GetSceneTextureStats();
+
+SceneMeshletStats GetSceneMeshletStats();
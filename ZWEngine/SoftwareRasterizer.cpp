@@ -0,0 +1,726 @@
+#include "SoftwareRasterizer.h"
+#include "VertexQuantization.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(ZW_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+static const int32_t TileShift = 6; // 64x64 pixel tiles
+static const int32_t TileSize = 1 << TileShift;
+static const int32_t SubpixelBits = 4; // vertices snap to 1/16 pixel
+static const float SubpixelScale = (float)(1 << SubpixelBits);
+static const uint32_t SetupChunkSize = 4096; // triangles per setup job
+
+// triangles are clipped to this many pixels around the target origin instead of to the viewport,
+// the bounding box takes care of the rest. it keeps the snapped coordinates within 18 bits, so
+// edge values stay inside 32 bits within a tile
+static const float GuardBand = 8192.0f;
+
+// a clipped vertex: clip space position and color
+static const int VertexSize = 8;
+static const int ClipPlaneCount = 6;
+static const int MaxClipVertices = 3 + ClipPlaneCount; // every plane adds at most one
+
+SoftwareRasterizer::SoftwareRasterizer()
+    : mJobs(nullptr), mWidth(0), mHeight(0), mTilesX(0), mTilesY(0), mColor(nullptr), mLevel(GetSimdLevel()),
+    mTriangleCount(0), mChunkCount(0)
+{
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+void SoftwareRasterizer::Init(JobSystem* jobs, uint32_t width, uint32_t height)
+{
+    mJobs = jobs;
+    mWidth = width;
+    mHeight = height;
+    mTilesX = (width + TileSize - 1) >> TileShift;
+    mTilesY = (height + TileSize - 1) >> TileShift;
+    mColor = nullptr;
+    mDepth.assign((uint32_t)width * height, 1.0f);
+    mDraws.clear();
+    mDrawStarts.clear();
+    mTriangleCount = 0;
+    mChunks.clear();
+    mChunkCount = 0;
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+uint32_t SoftwareRasterizer::GetWidth() const
+{
+    return mWidth;
+}
+
+uint32_t SoftwareRasterizer::GetHeight() const
+{
+    return mHeight;
+}
+
+void SoftwareRasterizer::SetColorTarget(uint8_t* pixels)
+{
+    if (pixels != mColor)
+    {
+        Flush();
+        mColor = pixels;
+    }
+}
+
+static inline uint32_t PackColor(const float color[4])
+{
+    uint32_t packed = 0;
+    for (int c = 0; c < 4; ++c)
+    {
+        float value = color[c] < 1.0f ? color[c] : 1.0f;
+        value = value > 0.0f ? value : 0.0f;
+        packed |= (uint32_t)(int32_t)(value * 255.0f + 0.5f) << (8 * c);
+    }
+    return packed;
+}
+
+void SoftwareRasterizer::ClearColor(const float color[4])
+{
+    Flush();
+    if (!mColor)
+    {
+        return;
+    }
+    uint32_t packed = PackColor(color);
+    for (uint32_t i = 0; i < mWidth * mHeight; ++i)
+    {
+        memcpy(mColor + i * 4, &packed, 4);
+    }
+}
+
+void SoftwareRasterizer::ClearDepth(float depth)
+{
+    Flush();
+    for (uint32_t i = 0; i < mDepth.size(); ++i)
+    {
+        mDepth[i] = depth;
+    }
+}
+
+void SoftwareRasterizer::Draw(const RasterDraw& draw)
+{
+    uint64_t triangles = (uint64_t)(draw.indexCount / 3) * draw.instanceCount;
+    if (triangles == 0 || draw.viewport.width <= 0.0f || draw.viewport.height <= 0.0f)
+    {
+        return;
+    }
+    mDraws.push_back(draw);
+    mDrawStarts.push_back(mTriangleCount);
+    mTriangleCount += triangles;
+}
+
+void SoftwareRasterizer::Flush()
+{
+    if (mDraws.empty())
+    {
+        return;
+    }
+    if (!mColor)
+    {
+        mDraws.clear();
+        mDrawStarts.clear();
+        mTriangleCount = 0;
+        return;
+    }
+
+    // setup: transform, clip, cull and bin every triangle, in chunks of consecutive triangles
+    mChunkCount = (uint32_t)((mTriangleCount + SetupChunkSize - 1) / SetupChunkSize);
+    if (mChunks.size() < mChunkCount)
+    {
+        mChunks.resize(mChunkCount);
+    }
+    if (mJobs)
+    {
+        mJobs->ParallelFor(mChunkCount, 1, [this](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                SetupChunk(i);
+            }
+        });
+    }
+    else
+    {
+        for (uint32_t i = 0; i < mChunkCount; ++i)
+        {
+            SetupChunk(i);
+        }
+    }
+
+    // raster: every tile on its own, so the tiles never share pixels
+    const uint32_t tileCount = mTilesX * mTilesY;
+    if (mJobs)
+    {
+        mJobs->ParallelFor(tileCount, 1, [this](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                RasterizeTile(i);
+            }
+        });
+    }
+    else
+    {
+        for (uint32_t i = 0; i < tileCount; ++i)
+        {
+            RasterizeTile(i);
+        }
+    }
+
+    mStats.triangles += mTriangleCount;
+    for (uint32_t i = 0; i < mChunkCount; ++i)
+    {
+        mStats.rasterizedTriangles += mChunks[i].rasterized;
+        mStats.binnedTriangles += mChunks[i].binned;
+    }
+    ++mStats.flushes;
+
+    mDraws.clear();
+    mDrawStarts.clear();
+    mTriangleCount = 0;
+}
+
+const float* SoftwareRasterizer::GetDepthBuffer() const
+{
+    return mDepth.data();
+}
+
+void SoftwareRasterizer::SetSimdLevel(SimdLevel level)
+{
+    mLevel = level > GetSimdLevel() ? GetSimdLevel() : level;
+}
+
+RasterStats SoftwareRasterizer::GetStats() const
+{
+    return mStats;
+}
+
+// vertex shader: clip = float4(position, 1) * wvpMat. the matrix is stored transposed, so every
+// clip component is a row of it dotted with the position
+static inline void ShadeVertex(const RasterDraw& draw, const float* wvp, uint32_t vertex, float* out)
+{
+    // the input assembler: both layouts become a float4 position and a float4 color
+    const uint8_t* data = draw.vertices + (uint64_t)vertex * draw.vertexStride;
+    float position[4];
+    if (draw.vertexLayout == VertexLayout::PositionColorQuantized)
+    {
+        const QuantizedVertex* quantized = (const QuantizedVertex*)data;
+        for (int i = 0; i < 4; ++i)
+        {
+            float value = (float)quantized->position[i] / 32767.0f;
+            position[i] = value > -1.0f ? value : -1.0f;
+            out[4 + i] = (float)quantized->color[i] / 255.0f;
+        }
+    }
+    else
+    {
+        memcpy(position, data, 3 * sizeof(float));
+        position[3] = 1.0f;
+        memcpy(out + 4, data + 3 * sizeof(float), 4 * sizeof(float));
+    }
+
+    for (int r = 0; r < 4; ++r)
+    {
+        const float* row = wvp + r * 4;
+        out[r] = row[0] * position[0] + row[1] * position[1] + row[2] * position[2] + row[3] * position[3];
+    }
+}
+
+static inline float PlaneDistance(const float plane[4], const float* vertex)
+{
+    return plane[0] * vertex[0] + plane[1] * vertex[1] + plane[2] * vertex[2] + plane[3] * vertex[3];
+}
+
+// the part of the convex polygon "in" on the positive side of "plane" (Sutherland-Hodgman)
+static uint32_t ClipPolygon(const float in[][VertexSize], uint32_t count, const float plane[4], float out[][VertexSize])
+{
+    uint32_t outCount = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float* a = in[i];
+        const float* b = in[(i + 1) % count];
+        float distanceA = PlaneDistance(plane, a);
+        float distanceB = PlaneDistance(plane, b);
+        if (distanceA >= 0.0f)
+        {
+            memcpy(out[outCount++], a, sizeof(in[i]));
+        }
+        if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+        {
+            float t = distanceA / (distanceA - distanceB);
+            for (int c = 0; c < VertexSize; ++c)
+            {
+                out[outCount][c] = a[c] + (b[c] - a[c]) * t;
+            }
+            ++outCount;
+        }
+    }
+    return outCount;
+}
+
+void SoftwareRasterizer::SetupTriangle(const RasterDraw& draw, const float* v0, const float* v1, const float* v2, Chunk* chunk) const
+{
+    const float* vertices[3] = { v0, v1, v2 };
+    const Viewport& viewport = draw.viewport;
+
+    // perspective divide and viewport transform, then snap to the subpixel grid
+    int32_t x[3], y[3];
+    float attributes[3][6]; // depth, 1 / w, color / w
+    for (int i = 0; i < 3; ++i)
+    {
+        const float* v = vertices[i];
+        if (v[3] <= 0.0f)
+        {
+            return;
+        }
+        float invW = 1.0f / v[3];
+        float screenX = (v[0] * invW * 0.5f + 0.5f) * viewport.width + viewport.topLeftX;
+        float screenY = (0.5f - v[1] * invW * 0.5f) * viewport.height + viewport.topLeftY;
+        x[i] = (int32_t)floorf(screenX * SubpixelScale + 0.5f);
+        y[i] = (int32_t)floorf(screenY * SubpixelScale + 0.5f);
+
+        attributes[i][0] = viewport.minDepth + v[2] * invW * (viewport.maxDepth - viewport.minDepth);
+        attributes[i][1] = invW;
+        for (int c = 0; c < 4; ++c)
+        {
+            attributes[i][2 + c] = v[4 + c] * invW;
+        }
+    }
+
+    // clockwise on screen is the front, back faces and degenerate triangles are culled
+    int64_t area = (int64_t)(x[1] - x[0]) * (y[2] - y[0]) - (int64_t)(y[1] - y[0]) * (x[2] - x[0]);
+    if (area <= 0)
+    {
+        return;
+    }
+
+    // pixels whose centers (x * 16 + 8) can be inside, limited to the viewport, scissor and target
+    int32_t minX = x[0] < x[1] ? (x[0] < x[2] ? x[0] : x[2]) : (x[1] < x[2] ? x[1] : x[2]);
+    int32_t maxX = x[0] > x[1] ? (x[0] > x[2] ? x[0] : x[2]) : (x[1] > x[2] ? x[1] : x[2]);
+    int32_t minY = y[0] < y[1] ? (y[0] < y[2] ? y[0] : y[2]) : (y[1] < y[2] ? y[1] : y[2]);
+    int32_t maxY = y[0] > y[1] ? (y[0] > y[2] ? y[0] : y[2]) : (y[1] > y[2] ? y[1] : y[2]);
+    const int32_t half = 1 << (SubpixelBits - 1);
+    Triangle triangle;
+    triangle.minX = (minX - half + (1 << SubpixelBits) - 1) >> SubpixelBits;
+    triangle.maxX = (maxX - half) >> SubpixelBits;
+    triangle.minY = (minY - half + (1 << SubpixelBits) - 1) >> SubpixelBits;
+    triangle.maxY = (maxY - half) >> SubpixelBits;
+
+    int32_t limits[4] =
+    {
+        (int32_t)ceilf(viewport.topLeftX - 0.5f), (int32_t)ceilf(viewport.topLeftY - 0.5f),
+        (int32_t)ceilf(viewport.topLeftX + viewport.width - 0.5f) - 1, (int32_t)ceilf(viewport.topLeftY + viewport.height - 0.5f) - 1,
+    };
+    triangle.minX = triangle.minX > limits[0] ? triangle.minX : limits[0];
+    triangle.minY = triangle.minY > limits[1] ? triangle.minY : limits[1];
+    triangle.maxX = triangle.maxX < limits[2] ? triangle.maxX : limits[2];
+    triangle.maxY = triangle.maxY < limits[3] ? triangle.maxY : limits[3];
+    triangle.minX = triangle.minX > draw.scissor.left ? triangle.minX : draw.scissor.left;
+    triangle.minY = triangle.minY > draw.scissor.top ? triangle.minY : draw.scissor.top;
+    triangle.maxX = triangle.maxX < draw.scissor.right - 1 ? triangle.maxX : draw.scissor.right - 1;
+    triangle.maxY = triangle.maxY < draw.scissor.bottom - 1 ? triangle.maxY : draw.scissor.bottom - 1;
+    triangle.minX = triangle.minX > 0 ? triangle.minX : 0;
+    triangle.minY = triangle.minY > 0 ? triangle.minY : 0;
+    triangle.maxX = triangle.maxX < (int32_t)mWidth - 1 ? triangle.maxX : (int32_t)mWidth - 1;
+    triangle.maxY = triangle.maxY < (int32_t)mHeight - 1 ? triangle.maxY : (int32_t)mHeight - 1;
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    {
+        return;
+    }
+
+    // edge i runs from vertex i + 1 to i + 2 and is positive inside. pixels exactly on an edge
+    // belong to the triangle if it is a top edge (horizontal, going right) or a left edge (going up)
+    for (int i = 0; i < 3; ++i)
+    {
+        int a = (i + 1) % 3;
+        int b = (i + 2) % 3;
+        int32_t edgeA = y[a] - y[b];
+        int32_t edgeB = x[b] - x[a];
+        int64_t edgeC = -((int64_t)edgeA * x[a] + (int64_t)edgeB * y[a]);
+        bool topLeft = edgeA > 0 || (edgeA == 0 && edgeB > 0);
+
+        // evaluated at pixel centers, so the kernels step whole pixels
+        triangle.edgeA[i] = edgeA * (1 << SubpixelBits);
+        triangle.edgeB[i] = edgeB * (1 << SubpixelBits);
+        triangle.edgeC[i] = edgeC + (int64_t)(edgeA + edgeB) * half - (topLeft ? 0 : 1);
+    }
+
+    // attribute planes in pixel coordinates, from the snapped positions
+    float positionX[3], positionY[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        positionX[i] = (float)x[i] / SubpixelScale;
+        positionY[i] = (float)y[i] / SubpixelScale;
+    }
+    float x1 = positionX[1] - positionX[0];
+    float y1 = positionY[1] - positionY[0];
+    float x2 = positionX[2] - positionX[0];
+    float y2 = positionY[2] - positionY[0];
+    float inverseArea = 1.0f / (x1 * y2 - y1 * x2);
+    for (int a = 0; a < 6; ++a)
+    {
+        float delta1 = attributes[1][a] - attributes[0][a];
+        float delta2 = attributes[2][a] - attributes[0][a];
+        triangle.dx[a] = (delta1 * y2 - delta2 * y1) * inverseArea;
+        triangle.dy[a] = (delta2 * x1 - delta1 * x2) * inverseArea;
+        triangle.base[a] = attributes[0][a] + triangle.dx[a] * (0.5f - positionX[0]) + triangle.dy[a] * (0.5f - positionY[0]);
+    }
+
+    uint32_t index = (uint32_t)chunk->triangles.size();
+    chunk->triangles.push_back(triangle);
+    ++chunk->rasterized;
+
+    for (int32_t tileY = triangle.minY >> TileShift; tileY <= triangle.maxY >> TileShift; ++tileY)
+    {
+        for (int32_t tileX = triangle.minX >> TileShift; tileX <= triangle.maxX >> TileShift; ++tileX)
+        {
+            chunk->bins[tileY * mTilesX + tileX].push_back(index);
+            ++chunk->binned;
+        }
+    }
+}
+
+void SoftwareRasterizer::SetupChunk(uint32_t chunkIndex)
+{
+    Chunk& chunk = mChunks[chunkIndex];
+    chunk.triangles.clear();
+    chunk.bins.resize(mTilesX * mTilesY);
+    for (uint32_t i = 0; i < chunk.bins.size(); ++i)
+    {
+        chunk.bins[i].clear();
+    }
+    chunk.rasterized = 0;
+    chunk.binned = 0;
+
+    const uint64_t first = (uint64_t)chunkIndex * SetupChunkSize;
+    const uint64_t last = first + SetupChunkSize < mTriangleCount ? first + SetupChunkSize : mTriangleCount;
+
+    // the draw the chunk starts in
+    uint32_t drawIndex = 0;
+    uint32_t low = 0, high = (uint32_t)mDraws.size();
+    while (low < high)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (mDrawStarts[middle] <= first)
+        {
+            drawIndex = middle;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    for (uint64_t t = first; t < last; ++t)
+    {
+        while (drawIndex + 1 < mDraws.size() && mDrawStarts[drawIndex + 1] <= t)
+        {
+            ++drawIndex;
+        }
+        const RasterDraw& draw = mDraws[drawIndex];
+        const uint32_t trianglesPerInstance = draw.indexCount / 3;
+        const uint64_t local = t - mDrawStarts[drawIndex];
+        const uint32_t instance = (uint32_t)(local / trianglesPerInstance);
+        const uint32_t primitive = (uint32_t)(local % trianglesPerInstance);
+        const float* wvp = (const float*)((const uint8_t*)draw.wvp + (uint64_t)instance * draw.wvpStride);
+
+        // input assembler, indices past the vertex buffer drop the triangle
+        float clip[2][MaxClipVertices][VertexSize];
+        bool valid = true;
+        for (int i = 0; i < 3; ++i)
+        {
+            uint32_t index = draw.indexFormat == IndexFormat::UInt16 ?
+                ((const uint16_t*)draw.indices)[primitive * 3 + i] : ((const uint32_t*)draw.indices)[primitive * 3 + i];
+            int64_t vertex = (int64_t)index + draw.baseVertex;
+            if (vertex < 0 || vertex >= draw.vertexCount)
+            {
+                valid = false;
+                break;
+            }
+            ShadeVertex(draw, wvp, (uint32_t)vertex, clip[0][i]);
+        }
+        if (!valid)
+        {
+            continue;
+        }
+
+        // the depth range and the guard band, in clip space. the rest of the view volume is left to
+        // the bounding box
+        const Viewport& viewport = draw.viewport;
+        float guardMinX = 2.0f * (-GuardBand - viewport.topLeftX) / viewport.width - 1.0f;
+        float guardMaxX = 2.0f * (GuardBand - viewport.topLeftX) / viewport.width - 1.0f;
+        float guardMinY = 1.0f - 2.0f * (GuardBand - viewport.topLeftY) / viewport.height;
+        float guardMaxY = 1.0f - 2.0f * (-GuardBand - viewport.topLeftY) / viewport.height;
+        const float planes[ClipPlaneCount][4] =
+        {
+            { 0.0f, 0.0f, 1.0f, 0.0f }, // near, z >= 0
+            { 0.0f, 0.0f, -1.0f, 1.0f }, // far, z <= w
+            { 1.0f, 0.0f, 0.0f, -guardMinX },
+            { -1.0f, 0.0f, 0.0f, guardMaxX },
+            { 0.0f, 1.0f, 0.0f, -guardMinY },
+            { 0.0f, -1.0f, 0.0f, guardMaxY },
+        };
+
+        // all inside: set up as is. all outside one plane: gone. otherwise clip
+        uint32_t inside = 0;
+        bool rejected = false;
+        for (int p = 0; p < ClipPlaneCount && !rejected; ++p)
+        {
+            uint32_t planeInside = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                planeInside += PlaneDistance(planes[p], clip[0][i]) >= 0.0f ? 1 : 0;
+            }
+            rejected = planeInside == 0;
+            inside += planeInside;
+        }
+        if (rejected)
+        {
+            continue;
+        }
+        if (inside == 3 * ClipPlaneCount)
+        {
+            SetupTriangle(draw, clip[0][0], clip[0][1], clip[0][2], &chunk);
+            continue;
+        }
+
+        uint32_t count = 3;
+        int current = 0;
+        for (int p = 0; p < ClipPlaneCount && count >= 3; ++p)
+        {
+            count = ClipPolygon(clip[current], count, planes[p], clip[1 - current]);
+            current = 1 - current;
+        }
+        for (uint32_t i = 2; i < count; ++i)
+        {
+            SetupTriangle(draw, clip[current][0], clip[current][i - 1], clip[current][i], &chunk);
+        }
+    }
+}
+
+// the edges of a triangle within one tile: value at the tile's first pixel and per pixel steps.
+// edges that don't cross the tile are zeroed, so the values fit 32 bits
+struct TileEdges
+{
+    int32_t start[3];
+    int32_t stepX[3];
+    int32_t stepY[3];
+};
+
+// pixel shader and output merger for one covered pixel: depth test, then the color divided by the
+// interpolated 1 / w
+static inline void ShadePixel(int32_t x, int32_t y, const float* base, const float* dx, const float* dy,
+    uint8_t* color, float* depth, uint32_t width)
+{
+    float fx = (float)x;
+    float fy = (float)y;
+    float z = base[0] + dx[0] * fx + dy[0] * fy;
+    float& stored = depth[(uint32_t)y * width + (uint32_t)x];
+    if (!(z < stored))
+    {
+        return;
+    }
+    stored = z;
+
+    float w = 1.0f / (base[1] + dx[1] * fx + dy[1] * fy);
+    float pixel[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        pixel[c] = (base[2 + c] + dx[2 + c] * fx + dy[2 + c] * fy) * w;
+    }
+    uint32_t packed = PackColor(pixel);
+    memcpy(color + ((uint32_t)y * width + (uint32_t)x) * 4, &packed, 4);
+}
+
+static void RasterizeScalar(const TileEdges& edges, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY,
+    const float* base, const float* dx, const float* dy, uint8_t* color, float* depth, uint32_t width)
+{
+    int32_t row[3] = { edges.start[0], edges.start[1], edges.start[2] };
+    for (int32_t y = minY; y <= maxY; ++y)
+    {
+        int32_t e0 = row[0], e1 = row[1], e2 = row[2];
+        for (int32_t x = minX; x <= maxX; ++x)
+        {
+            if ((e0 | e1 | e2) >= 0)
+            {
+                ShadePixel(x, y, base, dx, dy, color, depth, width);
+            }
+            e0 += edges.stepX[0];
+            e1 += edges.stepX[1];
+            e2 += edges.stepX[2];
+        }
+        row[0] += edges.stepY[0];
+        row[1] += edges.stepY[1];
+        row[2] += edges.stepY[2];
+    }
+}
+
+#if defined(ZW_SIMD_X86)
+
+// 4 pixels of a row at a time, starting on a multiple of 4. same math as ShadePixel lane by lane,
+// so both kernels write the same bits
+static void RasterizeSse2(const TileEdges& edges, int32_t minX, int32_t minY, int32_t maxX, int32_t maxY,
+    const float* base, const float* dx, const float* dy, uint8_t* color, float* depth, uint32_t width)
+{
+    const int32_t firstX = minX & ~3;
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128 laneOffsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 round = _mm_set1_ps(0.5f);
+
+    __m128i stepGroup[3], rowStart[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        stepGroup[i] = _mm_set1_epi32(edges.stepX[i] * 4);
+        // the edge values of the first group's lanes, which may start left of minX
+        rowStart[i] = _mm_add_epi32(_mm_set1_epi32(edges.start[i] + edges.stepX[i] * (firstX - minX)),
+            _mm_setr_epi32(0, edges.stepX[i], edges.stepX[i] * 2, edges.stepX[i] * 3));
+    }
+
+    __m128 planeBase[6], planeDx[6], planeDy[6];
+    for (int a = 0; a < 6; ++a)
+    {
+        planeBase[a] = _mm_set1_ps(base[a]);
+        planeDx[a] = _mm_set1_ps(dx[a]);
+        planeDy[a] = _mm_set1_ps(dy[a]);
+    }
+
+    for (int32_t y = minY; y <= maxY; ++y)
+    {
+        __m128i e0 = rowStart[0], e1 = rowStart[1], e2 = rowStart[2];
+        const __m128 fy = _mm_set1_ps((float)y);
+        for (int32_t x = firstX; x <= maxX; x += 4)
+        {
+            // inside all edges, and within [minX, maxX]
+            __m128i xs = _mm_add_epi32(_mm_set1_epi32(x), lanes);
+            __m128i covered = _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), _mm_set1_epi32(-1));
+            covered = _mm_andnot_si128(_mm_cmplt_epi32(xs, _mm_set1_epi32(minX)), covered);
+            covered = _mm_andnot_si128(_mm_cmpgt_epi32(xs, _mm_set1_epi32(maxX)), covered);
+
+            int coveredBits = _mm_movemask_ps(_mm_castsi128_ps(covered));
+            if (coveredBits != 0 && x + 4 > (int32_t)width)
+            {
+                // the group reaches past the end of the row, no vector loads here
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (coveredBits & (1 << lane))
+                    {
+                        ShadePixel(x + lane, y, base, dx, dy, color, depth, width);
+                    }
+                }
+            }
+            else if (coveredBits != 0)
+            {
+                const __m128 fx = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+                float* depthRow = depth + (uint32_t)y * width + (uint32_t)x;
+                __m128 stored = _mm_loadu_ps(depthRow);
+                __m128 z = _mm_add_ps(_mm_add_ps(planeBase[0], _mm_mul_ps(planeDx[0], fx)), _mm_mul_ps(planeDy[0], fy));
+                __m128 mask = _mm_and_ps(_mm_castsi128_ps(covered), _mm_cmplt_ps(z, stored));
+                if (_mm_movemask_ps(mask) != 0)
+                {
+                    _mm_storeu_ps(depthRow, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, stored)));
+
+                    __m128 invW = _mm_add_ps(_mm_add_ps(planeBase[1], _mm_mul_ps(planeDx[1], fx)), _mm_mul_ps(planeDy[1], fy));
+                    __m128 w = _mm_div_ps(one, invW);
+                    __m128i packed = _mm_setzero_si128();
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        __m128 value = _mm_add_ps(_mm_add_ps(planeBase[2 + c], _mm_mul_ps(planeDx[2 + c], fx)), _mm_mul_ps(planeDy[2 + c], fy));
+                        value = _mm_mul_ps(value, w);
+                        value = _mm_max_ps(_mm_min_ps(value, one), zero);
+                        __m128i channel = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), round));
+                        packed = _mm_or_si128(packed, _mm_slli_epi32(channel, 8 * c));
+                    }
+
+                    __m128i* colorRow = (__m128i*)(color + ((uint32_t)y * width + (uint32_t)x) * 4);
+                    __m128i old = _mm_loadu_si128(colorRow);
+                    __m128i write = _mm_castps_si128(mask);
+                    _mm_storeu_si128(colorRow, _mm_or_si128(_mm_and_si128(write, packed), _mm_andnot_si128(write, old)));
+                }
+            }
+
+            e0 = _mm_add_epi32(e0, stepGroup[0]);
+            e1 = _mm_add_epi32(e1, stepGroup[1]);
+            e2 = _mm_add_epi32(e2, stepGroup[2]);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            rowStart[i] = _mm_add_epi32(rowStart[i], _mm_set1_epi32(edges.stepY[i]));
+        }
+    }
+}
+
+#endif
+
+void SoftwareRasterizer::RasterizeTile(uint32_t tile)
+{
+    const int32_t tileMinX = (int32_t)(tile % mTilesX) << TileShift;
+    const int32_t tileMinY = (int32_t)(tile / mTilesX) << TileShift;
+    const int32_t tileMaxX = tileMinX + TileSize - 1 < (int32_t)mWidth - 1 ? tileMinX + TileSize - 1 : (int32_t)mWidth - 1;
+    const int32_t tileMaxY = tileMinY + TileSize - 1 < (int32_t)mHeight - 1 ? tileMinY + TileSize - 1 : (int32_t)mHeight - 1;
+
+    for (uint32_t c = 0; c < mChunkCount; ++c)
+    {
+        const Chunk& chunk = mChunks[c];
+        const std::vector<uint32_t>& bin = chunk.bins[tile];
+        for (uint32_t i = 0; i < bin.size(); ++i)
+        {
+            const Triangle& triangle = chunk.triangles[bin[i]];
+            int32_t minX = triangle.minX > tileMinX ? triangle.minX : tileMinX;
+            int32_t minY = triangle.minY > tileMinY ? triangle.minY : tileMinY;
+            int32_t maxX = triangle.maxX < tileMaxX ? triangle.maxX : tileMaxX;
+            int32_t maxY = triangle.maxY < tileMaxY ? triangle.maxY : tileMaxY;
+
+            // the edges at the corners of the rectangle, in 64 bits. an edge negative at all of them
+            // misses it, one positive at all of them covers it and is left out
+            TileEdges edges;
+            bool missed = false;
+            for (int e = 0; e < 3 && !missed; ++e)
+            {
+                int64_t start = triangle.edgeC[e] + (int64_t)triangle.edgeA[e] * minX + (int64_t)triangle.edgeB[e] * minY;
+                int64_t spanX = (int64_t)triangle.edgeA[e] * (maxX - minX);
+                int64_t spanY = (int64_t)triangle.edgeB[e] * (maxY - minY);
+                int64_t lowest = start + (spanX < 0 ? spanX : 0) + (spanY < 0 ? spanY : 0);
+                int64_t highest = start + (spanX > 0 ? spanX : 0) + (spanY > 0 ? spanY : 0);
+                if (highest < 0)
+                {
+                    missed = true;
+                }
+                else if (lowest >= 0)
+                {
+                    edges.start[e] = 0;
+                    edges.stepX[e] = 0;
+                    edges.stepY[e] = 0;
+                }
+                else
+                {
+                    edges.start[e] = (int32_t)start;
+                    edges.stepX[e] = triangle.edgeA[e];
+                    edges.stepY[e] = triangle.edgeB[e];
+                }
+            }
+            if (missed)
+            {
+                continue;
+            }
+
+#if defined(ZW_SIMD_X86)
+            if (mLevel != SimdLevel::Scalar)
+            {
+                RasterizeSse2(edges, minX, minY, maxX, maxY, triangle.base, triangle.dx, triangle.dy,
+                    mColor, mDepth.data(), mWidth);
+                continue;
+            }
+#endif
+            RasterizeScalar(edges, minX, minY, maxX, maxY, triangle.base, triangle.dx, triangle.dy,
+                mColor, mDepth.data(), mWidth);
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "RenderBackend.h"
+#include <cstdint>
+#include <vector>
+
+// one DrawIndexedInstanced of the PositionColor pipelines, with every buffer already resolved to cpu memory
+struct RasterDraw
+{
+    VertexLayout vertexLayout;
+    const uint8_t* vertices; // float3 position, float4 color or a QuantizedVertex
+    uint32_t vertexStride;
+    uint32_t vertexCount; // vertices behind "vertices", indices past it are skipped
+    const void* indices; // the first index of the draw
+    IndexFormat indexFormat;
+    uint32_t indexCount; // per instance
+    int32_t baseVertex;
+    uint32_t instanceCount;
+
+    // wvp matrix of instance i at wvp + i * wvpStride bytes (0 for the same one), stored transposed
+    // like the shaders read them
+    const float* wvp;
+    uint32_t wvpStride;
+
+    Viewport viewport;
+    ScissorRect scissor;
+};
+
+struct RasterStats
+{
+    uint64_t triangles; // submitted
+    uint64_t rasterizedTriangles; // survived culling and clipping (clipped ones count per piece)
+    uint64_t binnedTriangles; // triangle and tile pairs
+    uint64_t flushes;
+};
+
+// Tile based software rasterizer for the fixed pipeline the scene uses: indexed triangle lists,
+// the vertex shader's mul(pos, wvpMat) and color pass-through, back face culling with clockwise
+// front faces, a D32 depth test (less, with writes) and RGBA8 output, like the default d3d12
+// rasterizer, depth stencil and blend states.
+//
+// Draws are only queued. Flush runs them on the job system in two passes: the triangles are
+// transformed, clipped and set up in chunks, and every chunk sorts its triangles into bins of
+// 64x64 pixel tiles. Then each tile is rasterized by one job, walking the bins of all chunks
+// in submission order, so the result doesn't depend on the thread count. Coverage uses integer
+// edge functions on a 1/16 pixel grid with the top-left fill rule, 4 pixels at a time with SSE2.
+class SoftwareRasterizer
+{
+public:
+    SoftwareRasterizer();
+
+    // "jobs" runs the passes of Flush, null for single threaded. the depth buffer is allocated here
+    void Init(JobSystem* jobs, uint32_t width, uint32_t height);
+
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+
+    // rgba8 pixels, width * 4 bytes per row. flushes what was drawn into the previous one
+    void SetColorTarget(uint8_t* pixels);
+
+    // both flush the queued draws first
+    void ClearColor(const float color[4]);
+    void ClearDepth(float depth);
+
+    void Draw(const RasterDraw& draw);
+
+    // rasterize everything queued since the last flush
+    void Flush();
+
+    const float* GetDepthBuffer() const;
+
+    // use a fixed kernel instead of the best one for this cpu (for comparing the paths). the
+    // result is the same for every level
+    void SetSimdLevel(SimdLevel level);
+
+    RasterStats GetStats() const;
+
+private:
+    struct Triangle
+    {
+        int32_t minX, minY, maxX, maxY; // pixels covered by the bounding box, clipped to scissor and target
+        // pixel (x, y) is covered when edgeA[i] * x + edgeB[i] * y + edgeC[i] >= 0 for all three edges.
+        // the values are in 1/16 pixel units squared, the top-left bias is part of edgeC
+        int32_t edgeA[3];
+        int32_t edgeB[3];
+        int64_t edgeC[3];
+
+        // attributes as planes in pixel coordinates, value = base + dx * x + dy * y. depth,
+        // 1 / w and color / w, so the color is interpolated with perspective correction
+        float base[6];
+        float dx[6];
+        float dy[6];
+    };
+
+    struct Chunk
+    {
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<uint32_t> > bins; // triangles per tile, in submission order
+        uint64_t rasterized;
+        uint64_t binned;
+    };
+
+    void SetupTriangle(const RasterDraw& draw, const float* v0, const float* v1, const float* v2, Chunk* chunk) const;
+    void SetupChunk(uint32_t chunk);
+    void RasterizeTile(uint32_t tile);
+
+    JobSystem* mJobs;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mTilesX;
+    uint32_t mTilesY;
+    uint8_t* mColor;
+    std::vector<float> mDepth;
+    SimdLevel mLevel;
+
+    std::vector<RasterDraw> mDraws;
+    std::vector<uint64_t> mDrawStarts; // first triangle of each draw, counted over all queued draws
+    uint64_t mTriangleCount; // queued
+    std::vector<Chunk> mChunks;
+    uint32_t mChunkCount; // in use this flush
+
+    RasterStats mStats;
+};
@@ -0,0 +1,174 @@
+#include "SoftwareRenderBackend.h"
+
+static const uint32_t WvpMatrixSize = 64; // float4x4, also the stride of the instance buffer
+
+SoftwareRenderBackend::SoftwareRenderBackend(JobSystem* jobs)
+    : mJobs(jobs)
+{
+}
+
+bool SoftwareRenderBackend::Init(int width, int height)
+{
+    if (!NullRenderBackend::Init(width, height))
+    {
+        return false;
+    }
+    mRasterizer.Init(mJobs, (uint32_t)width, (uint32_t)height);
+    mPipelines.clear();
+    return true;
+}
+
+PipelineHandle SoftwareRenderBackend::CreatePipeline(const PipelineDesc& desc)
+{
+    PipelineHandle pipeline = NullRenderBackend::CreatePipeline(desc);
+    if (pipeline >= mPipelines.size())
+    {
+        mPipelines.resize(pipeline + 1);
+    }
+    mPipelines[pipeline] = desc;
+    return pipeline;
+}
+
+bool SoftwareRenderBackend::EndFrame()
+{
+    if (!NullRenderBackend::EndFrame())
+    {
+        return false;
+    }
+
+    // the frame is everything after the previous present, the parallel lists are already in place
+    const std::vector<RenderCommand>& commands = GetCommands();
+    uint32_t end = (uint32_t)commands.size();
+    uint32_t begin = end - 1;
+    while (begin > 0 && commands[begin - 1].type != RenderCommandType::Present)
+    {
+        --begin;
+    }
+    return Execute(commands.data() + begin, end - begin);
+}
+
+SoftwareRasterizer& SoftwareRenderBackend::GetRasterizer()
+{
+    return mRasterizer;
+}
+
+bool SoftwareRenderBackend::Execute(const RenderCommand* commands, uint32_t count)
+{
+    PipelineHandle pipeline = InvalidPipeline;
+    Viewport viewport = {};
+    ScissorRect scissor = {};
+    VertexBufferView vertexBuffer = {};
+    IndexBufferView indexBuffer = {};
+    GpuAddress constantBuffer = 0;
+    GpuAddress shaderResource = 0;
+    DescriptorIndex constantBufferTable = InvalidDescriptor;
+    uint8_t* target = nullptr;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const RenderCommand& command = commands[i];
+        switch (command.type)
+        {
+        case RenderCommandType::SetRenderTarget:
+            target = GetWritableResourceData(GetBackBuffer(command.backBufferIndex));
+            mRasterizer.SetColorTarget(target);
+            break;
+        case RenderCommandType::ClearRenderTarget:
+            // the cleared buffer doesn't have to be the bound one
+            mRasterizer.SetColorTarget(GetWritableResourceData(GetBackBuffer(command.clearRenderTarget.backBufferIndex)));
+            mRasterizer.ClearColor(command.clearRenderTarget.color);
+            mRasterizer.SetColorTarget(target);
+            break;
+        case RenderCommandType::ClearDepth:
+            mRasterizer.ClearDepth(command.depth);
+            break;
+        case RenderCommandType::SetPipeline:
+            pipeline = command.pipeline;
+            break;
+        case RenderCommandType::SetViewport:
+            viewport = command.viewport;
+            break;
+        case RenderCommandType::SetScissorRect:
+            scissor = command.scissorRect;
+            break;
+        case RenderCommandType::SetVertexBuffer:
+            vertexBuffer = command.vertexBufferView;
+            break;
+        case RenderCommandType::SetIndexBuffer:
+            indexBuffer = command.indexBufferView;
+            break;
+        case RenderCommandType::SetGraphicsRootConstantBufferView:
+            constantBuffer = command.rootConstantBufferView.bufferLocation;
+            break;
+        case RenderCommandType::SetGraphicsRootShaderResourceView:
+            shaderResource = command.rootShaderResourceView.bufferLocation;
+            break;
+        case RenderCommandType::SetGraphicsRootDescriptorTable:
+            constantBufferTable = command.rootDescriptorTable.firstDescriptor;
+            break;
+        case RenderCommandType::DrawIndexedInstanced:
+        {
+            if (pipeline >= mPipelines.size() || vertexBuffer.strideInBytes == 0)
+            {
+                return false;
+            }
+            const PipelineDesc& desc = mPipelines[pipeline];
+            const uint32_t indexSize = indexBuffer.format == IndexFormat::UInt16 ? 2 : 4;
+            const uint64_t indexEnd = ((uint64_t)command.draw.startIndexLocation + command.draw.indexCountPerInstance) * indexSize;
+            if (indexEnd > indexBuffer.sizeInBytes)
+            {
+                return false;
+            }
+
+            RasterDraw draw;
+            draw.vertexLayout = desc.vertexLayout;
+            draw.vertices = GetGpuAddressData(vertexBuffer.bufferLocation, vertexBuffer.sizeInBytes);
+            draw.vertexStride = vertexBuffer.strideInBytes;
+            draw.vertexCount = vertexBuffer.sizeInBytes / vertexBuffer.strideInBytes;
+            draw.indices = GetGpuAddressData(indexBuffer.bufferLocation + (uint64_t)command.draw.startIndexLocation * indexSize,
+                (uint64_t)command.draw.indexCountPerInstance * indexSize);
+            draw.indexFormat = indexBuffer.format;
+            draw.indexCount = command.draw.indexCountPerInstance;
+            draw.baseVertex = command.draw.baseVertexLocation;
+            draw.instanceCount = command.draw.instanceCount;
+
+            // SV_InstanceID starts at 0 whatever the start instance is, so the instance buffer is
+            // read from its beginning
+            if (desc.instanced)
+            {
+                draw.wvp = (const float*)GetGpuAddressData(shaderResource, (uint64_t)command.draw.instanceCount * WvpMatrixSize);
+                draw.wvpStride = WvpMatrixSize;
+            }
+            else if (desc.constantBufferTable)
+            {
+                // the descriptor is read when the draw runs, like on the gpu
+                const NullDescriptor* descriptor = GetDescriptor(constantBufferTable);
+                bool written = descriptor && descriptor->size >= WvpMatrixSize;
+                draw.wvp = written ? (const float*)GetGpuAddressData(descriptor->bufferLocation, WvpMatrixSize) : nullptr;
+                draw.wvpStride = 0;
+            }
+            else
+            {
+                draw.wvp = (const float*)GetGpuAddressData(constantBuffer, WvpMatrixSize);
+                draw.wvpStride = 0;
+            }
+            draw.viewport = viewport;
+            draw.scissor = scissor;
+
+            if (!draw.vertices || !draw.indices || !draw.wvp)
+            {
+                return false;
+            }
+            mRasterizer.Draw(draw);
+            break;
+        }
+        default:
+            // barriers and present don't change what is drawn, there is only one topology
+            break;
+        }
+    }
+
+    // rasterize the rest before the frame is looked at
+    mRasterizer.Flush();
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "NullRenderBackend.h"
+#include "SoftwareRasterizer.h"
+#include <vector>
+
+// Null backend that also draws, for checking the rendered output on machines without d3d12.
+// Commands are recorded like on the null backend, and EndFrame runs the frame through a
+// SoftwareRasterizer into the back buffer it presents (rgba8, GetResourceData(GetBackBuffer(i)),
+// see WritePng). Only what the scene's pipelines use is implemented: both vertex layouts, the
+// wvp matrix in a root constant buffer, in a descriptor table of one constant buffer view or,
+// instanced, in a root structured buffer.
+class SoftwareRenderBackend : public NullRenderBackend
+{
+public:
+    // the rasterizer runs on "jobs", null for single threaded
+    explicit SoftwareRenderBackend(JobSystem* jobs);
+
+    bool Init(int width, int height) override;
+    PipelineHandle CreatePipeline(const PipelineDesc& desc) override;
+
+    // false also if a draw of the frame reads memory that isn't inside a resource
+    bool EndFrame() override;
+
+    SoftwareRasterizer& GetRasterizer();
+
+private:
+    bool Execute(const RenderCommand* commands, uint32_t count);
+
+    JobSystem* mJobs;
+    SoftwareRasterizer mRasterizer;
+    std::vector<PipelineDesc> mPipelines; // by handle
+};
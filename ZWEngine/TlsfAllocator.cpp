@@ -0,0 +1,426 @@
+#include "TlsfAllocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const uint32_t NoBlock = 0xffffffff;
+
+static inline uint32_t HighestBit(uint64_t value) // value != 0
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint32_t)index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+static inline uint32_t LowestBit(uint64_t value) // value != 0
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+static inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+TlsfAllocator::TlsfAllocator()
+{
+    Init(0);
+}
+
+void TlsfAllocator::Init(uint64_t size, uint64_t granularity)
+{
+    mBlocks.clear();
+    mUnusedBlocks.clear();
+    for (uint32_t fl = 0; fl < FirstLevelCount; ++fl)
+    {
+        for (uint32_t sl = 0; sl < SecondLevelCount; ++sl)
+        {
+            mFreeLists[fl][sl] = NoBlock;
+        }
+        mSecondLevelBitmap[fl] = 0;
+    }
+    mFirstLevelBitmap = 0;
+
+    mGranularity = granularity ? granularity : 1;
+    mSize = size & ~(mGranularity - 1);
+    mUsedSize = 0;
+    mAllocationCount = 0;
+    mLastBlock = NoBlock;
+
+    if (mSize == 0)
+    {
+        return;
+    }
+
+    // one free block covering everything
+    uint32_t block = NewBlock();
+    mBlocks[block].offset = 0;
+    mBlocks[block].size = mSize;
+    mLastBlock = block;
+    InsertFree(block);
+}
+
+// the list a block of "size" bytes belongs to: sizes below SecondLevelCount each get a list of
+// first level 0, above that the first level is the power of two and the second level the next bits
+static inline void Mapping(uint64_t size, uint32_t secondLevelBits, uint32_t* fl, uint32_t* sl)
+{
+    if (size < (1ull << secondLevelBits))
+    {
+        *fl = 0;
+        *sl = (uint32_t)size;
+        return;
+    }
+    uint32_t bit = HighestBit(size);
+    *fl = bit - secondLevelBits + 1;
+    *sl = (uint32_t)(size >> (bit - secondLevelBits)) & ((1u << secondLevelBits) - 1);
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+    uint32_t block;
+    if (!mUnusedBlocks.empty())
+    {
+        block = mUnusedBlocks.back();
+        mUnusedBlocks.pop_back();
+    }
+    else
+    {
+        block = (uint32_t)mBlocks.size();
+        mBlocks.push_back(Block());
+    }
+
+    Block& b = mBlocks[block];
+    b.offset = 0;
+    b.size = 0;
+    b.alignment = 1;
+    b.prevPhysical = NoBlock;
+    b.nextPhysical = NoBlock;
+    b.prevFree = NoBlock;
+    b.nextFree = NoBlock;
+    b.free = false;
+    return block;
+}
+
+void TlsfAllocator::InsertFree(uint32_t block)
+{
+    uint32_t fl, sl;
+    Mapping(mBlocks[block].size, SecondLevelBits, &fl, &sl);
+
+    Block& b = mBlocks[block];
+    b.free = true;
+    b.prevFree = NoBlock;
+    b.nextFree = mFreeLists[fl][sl];
+    if (b.nextFree != NoBlock)
+    {
+        mBlocks[b.nextFree].prevFree = block;
+    }
+    mFreeLists[fl][sl] = block;
+    mFirstLevelBitmap |= 1ull << fl;
+    mSecondLevelBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t block)
+{
+    uint32_t fl, sl;
+    Mapping(mBlocks[block].size, SecondLevelBits, &fl, &sl);
+
+    Block& b = mBlocks[block];
+    if (b.prevFree != NoBlock)
+    {
+        mBlocks[b.prevFree].nextFree = b.nextFree;
+    }
+    else
+    {
+        mFreeLists[fl][sl] = b.nextFree;
+        if (b.nextFree == NoBlock)
+        {
+            mSecondLevelBitmap[fl] &= ~(1u << sl);
+            if (mSecondLevelBitmap[fl] == 0)
+            {
+                mFirstLevelBitmap &= ~(1ull << fl);
+            }
+        }
+    }
+    if (b.nextFree != NoBlock)
+    {
+        mBlocks[b.nextFree].prevFree = b.prevFree;
+    }
+    b.free = false;
+    b.prevFree = NoBlock;
+    b.nextFree = NoBlock;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t size) const
+{
+    // round up to the next list boundary, every block of that list and above fits
+    if (size >= SecondLevelCount)
+    {
+        uint64_t rounded = size + (1ull << (HighestBit(size) - SecondLevelBits)) - 1;
+        if (rounded < size)
+        {
+            return NoBlock;
+        }
+        size = rounded;
+    }
+    uint32_t fl, sl;
+    Mapping(size, SecondLevelBits, &fl, &sl);
+    if (fl >= FirstLevelCount)
+    {
+        return NoBlock;
+    }
+
+    uint32_t secondLevelMap = mSecondLevelBitmap[fl] & (~0u << sl);
+    if (secondLevelMap == 0)
+    {
+        uint64_t firstLevelMap = fl + 1 < 64 ? mFirstLevelBitmap & (~0ull << (fl + 1)) : 0;
+        if (firstLevelMap == 0)
+        {
+            return NoBlock;
+        }
+        fl = LowestBit(firstLevelMap);
+        secondLevelMap = mSecondLevelBitmap[fl];
+    }
+    sl = LowestBit(secondLevelMap);
+    return mFreeLists[fl][sl];
+}
+
+uint32_t TlsfAllocator::FindFreeExact(uint64_t size, uint64_t alignment) const
+{
+    // from the list "size" maps to up to the one the padded size maps to, FindFree only searched the
+    // lists after that. these may hold blocks that are too small, so check every block
+    uint32_t fl, sl, lastFl, lastSl;
+    Mapping(size, SecondLevelBits, &fl, &sl);
+    uint64_t padded = size + alignment - mGranularity;
+    if (padded < size)
+    {
+        lastFl = FirstLevelCount - 1;
+        lastSl = SecondLevelCount - 1;
+    }
+    else
+    {
+        Mapping(padded, SecondLevelBits, &lastFl, &lastSl);
+    }
+
+    for (; fl <= lastFl && fl < FirstLevelCount; ++fl, sl = 0)
+    {
+        uint32_t secondLevelMap = mSecondLevelBitmap[fl] & (~0u << sl);
+        if (fl == lastFl)
+        {
+            secondLevelMap &= (2u << lastSl) - 1;
+        }
+        while (secondLevelMap != 0)
+        {
+            uint32_t list = LowestBit(secondLevelMap);
+            secondLevelMap &= secondLevelMap - 1;
+            for (uint32_t block = mFreeLists[fl][list]; block != NoBlock; block = mBlocks[block].nextFree)
+            {
+                const Block& b = mBlocks[block];
+                if (AlignUp(b.offset, alignment) - b.offset + size <= b.size)
+                {
+                    return block;
+                }
+            }
+        }
+    }
+    return NoBlock;
+}
+
+uint32_t TlsfAllocator::SplitTail(uint32_t block, uint64_t size)
+{
+    uint32_t tail = NewBlock(); // may reallocate mBlocks, no references across this
+    Block& b = mBlocks[block];
+    Block& t = mBlocks[tail];
+    t.offset = b.offset + size;
+    t.size = b.size - size;
+    t.prevPhysical = block;
+    t.nextPhysical = b.nextPhysical;
+    if (t.nextPhysical != NoBlock)
+    {
+        mBlocks[t.nextPhysical].prevPhysical = tail;
+    }
+    else
+    {
+        mLastBlock = tail;
+    }
+    b.size = size;
+    b.nextPhysical = tail;
+    return tail;
+}
+
+bool TlsfAllocator::Allocate(uint64_t size, uint64_t alignment, TlsfAllocation* allocation)
+{
+    size = AlignUp(size ? size : 1, mGranularity);
+    alignment = alignment > mGranularity ? alignment : mGranularity;
+
+    // block offsets are granularity aligned, so at most alignment - granularity bytes of padding
+    uint32_t block = FindFree(size + alignment - mGranularity);
+    if (block == NoBlock)
+    {
+        block = FindFreeExact(size, alignment);
+        if (block == NoBlock)
+        {
+            return false;
+        }
+    }
+    RemoveFree(block);
+
+    // the padding in front stays a free block of its own. its physical neighbour before is in use,
+    // free neighbours are always merged
+    uint64_t padding = AlignUp(mBlocks[block].offset, alignment) - mBlocks[block].offset;
+    if (padding > 0)
+    {
+        uint32_t rest = SplitTail(block, padding);
+        InsertFree(block);
+        block = rest;
+    }
+    if (mBlocks[block].size > size)
+    {
+        InsertFree(SplitTail(block, size));
+    }
+
+    Block& b = mBlocks[block];
+    b.alignment = alignment;
+    mUsedSize += b.size;
+    ++mAllocationCount;
+
+    allocation->handle = block;
+    allocation->offset = b.offset;
+    allocation->size = b.size;
+    return true;
+}
+
+void TlsfAllocator::Free(TlsfHandle handle)
+{
+    if (handle >= mBlocks.size() || mBlocks[handle].free || mBlocks[handle].size == 0)
+    {
+        return;
+    }
+
+    uint32_t block = handle;
+    mUsedSize -= mBlocks[block].size;
+    --mAllocationCount;
+
+    // merge with the free neighbours, the merged away blocks' slots are recycled
+    uint32_t next = mBlocks[block].nextPhysical;
+    if (next != NoBlock && mBlocks[next].free)
+    {
+        RemoveFree(next);
+        mBlocks[block].size += mBlocks[next].size;
+        mBlocks[block].nextPhysical = mBlocks[next].nextPhysical;
+        if (mBlocks[next].nextPhysical != NoBlock)
+        {
+            mBlocks[mBlocks[next].nextPhysical].prevPhysical = block;
+        }
+        else
+        {
+            mLastBlock = block;
+        }
+        mBlocks[next].size = 0;
+        mUnusedBlocks.push_back(next);
+    }
+
+    uint32_t prev = mBlocks[block].prevPhysical;
+    if (prev != NoBlock && mBlocks[prev].free)
+    {
+        RemoveFree(prev);
+        mBlocks[prev].size += mBlocks[block].size;
+        mBlocks[prev].nextPhysical = mBlocks[block].nextPhysical;
+        if (mBlocks[block].nextPhysical != NoBlock)
+        {
+            mBlocks[mBlocks[block].nextPhysical].prevPhysical = prev;
+        }
+        else
+        {
+            mLastBlock = prev;
+        }
+        mBlocks[block].size = 0;
+        mUnusedBlocks.push_back(block);
+        block = prev;
+    }
+
+    InsertFree(block);
+}
+
+uint64_t TlsfAllocator::GetSize() const
+{
+    return mSize;
+}
+
+bool TlsfAllocator::IsEmpty() const
+{
+    return mAllocationCount == 0;
+}
+
+uint32_t TlsfAllocator::PlanDefragmentation(uint32_t maxMoves, std::vector<TlsfMove>* moves)
+{
+    // collect the allocations from the end down first, planning allocates and changes the list
+    std::vector<uint32_t> candidates;
+    for (uint32_t block = mLastBlock; block != NoBlock; block = mBlocks[block].prevPhysical)
+    {
+        if (!mBlocks[block].free)
+        {
+            candidates.push_back(block);
+        }
+    }
+
+    uint32_t moveCount = 0;
+    for (uint32_t i = 0; i < candidates.size() && moveCount < maxMoves; ++i)
+    {
+        const Block& b = mBlocks[candidates[i]];
+        TlsfAllocation source;
+        source.handle = candidates[i];
+        source.offset = b.offset;
+        source.size = b.size;
+
+        // the source stays allocated until the caller copied it, so the ranges never overlap.
+        // a spot that isn't lower doesn't help, give it back
+        TlsfMove move;
+        if (!Allocate(source.size, b.alignment, &move.destination))
+        {
+            continue;
+        }
+        if (move.destination.offset > source.offset)
+        {
+            Free(move.destination.handle);
+            continue;
+        }
+        move.source = source;
+        moves->push_back(move);
+        ++moveCount;
+    }
+    return moveCount;
+}
+
+TlsfStats TlsfAllocator::GetStats() const
+{
+    TlsfStats stats;
+    stats.size = mSize;
+    stats.usedSize = mUsedSize;
+    stats.freeSize = mSize - mUsedSize;
+    stats.allocationCount = mAllocationCount;
+    stats.freeBlockCount = 0;
+    stats.largestFreeBlock = 0;
+
+    for (uint32_t block = mLastBlock; block != NoBlock; block = mBlocks[block].prevPhysical)
+    {
+        const Block& b = mBlocks[block];
+        if (b.free)
+        {
+            ++stats.freeBlockCount;
+            stats.largestFreeBlock = b.size > stats.largestFreeBlock ? b.size : stats.largestFreeBlock;
+        }
+    }
+    stats.fragmentation = stats.freeSize ? 1.0f - (float)((double)stats.largestFreeBlock / (double)stats.freeSize) : 0.0f;
+    return stats;
+}
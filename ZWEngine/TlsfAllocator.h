@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+typedef uint32_t TlsfHandle; // one allocation of a TlsfAllocator
+
+const TlsfHandle InvalidTlsfHandle = 0xffffffff;
+
+struct TlsfAllocation
+{
+    TlsfHandle handle;
+    uint64_t offset;
+    uint64_t size; // rounded up to the granularity
+};
+
+// planned move of an allocation to a lower offset. "destination" is already allocated, the caller
+// copies the data and frees "source" once the copy is done
+struct TlsfMove
+{
+    TlsfAllocation source;
+    TlsfAllocation destination;
+};
+
+struct TlsfStats
+{
+    uint64_t size;
+    uint64_t usedSize;
+    uint64_t freeSize;
+    uint64_t largestFreeBlock;
+    uint32_t allocationCount;
+    uint32_t freeBlockCount;
+    float fragmentation; // 1 - largestFreeBlock / freeSize, 0 when all free space is in one block
+};
+
+// Two level segregated fit allocator over an abstract range [0, size), it only does the bookkeeping
+// so it can place resources in gpu heaps. Free blocks are kept in lists bucketed by the power of two
+// of their size (first level) and 16 linear steps within it (second level), with a bitmap per level,
+// so allocating and freeing are O(1): two bit scans find a list whose blocks all fit, and freed
+// blocks are merged with their free neighbours right away. Only when no such list has a block are
+// the lists below it checked block by block, so a block that fits exactly (a whole heap, the hole
+// a defragmentation move fills) is still found.
+class TlsfAllocator
+{
+public:
+    TlsfAllocator();
+
+    // manage [0, size). offsets and sizes are multiples of "granularity" (a power of two), so
+    // allocations aligned to the granularity never need padding
+    void Init(uint64_t size, uint64_t granularity = 1);
+
+    // "alignment" is a power of two. false if no free block can hold the allocation
+    bool Allocate(uint64_t size, uint64_t alignment, TlsfAllocation* allocation);
+    void Free(TlsfHandle handle);
+
+    uint64_t GetSize() const;
+    bool IsEmpty() const; // no allocations
+
+    // plan up to "maxMoves" moves of the allocations at the end of the range into free space
+    // further down, so the free space collects in one block at the end. returns the number of
+    // moves appended to "moves"
+    uint32_t PlanDefragmentation(uint32_t maxMoves, std::vector<TlsfMove>* moves);
+
+    TlsfStats GetStats() const;
+
+private:
+    static const uint32_t SecondLevelBits = 4;
+    static const uint32_t SecondLevelCount = 1 << SecondLevelBits;
+    static const uint32_t FirstLevelCount = 64 - SecondLevelBits + 1;
+
+    struct Block
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t alignment; // of the allocation, for moving it
+        uint32_t prevPhysical; // neighbours in address order
+        uint32_t nextPhysical;
+        uint32_t prevFree; // neighbours in the free list, only while free
+        uint32_t nextFree;
+        bool free;
+    };
+
+    uint32_t NewBlock();
+    void InsertFree(uint32_t block);
+    void RemoveFree(uint32_t block);
+    uint32_t FindFree(uint64_t size) const; // a free block of at least "size" bytes
+    uint32_t FindFreeExact(uint64_t size, uint64_t alignment) const; // in the lists FindFree rounds past
+    uint32_t SplitTail(uint32_t block, uint64_t size); // the free rest of "block" after "size" bytes
+
+    std::vector<Block> mBlocks;
+    std::vector<uint32_t> mUnusedBlocks; // slots of merged blocks
+    uint32_t mFreeLists[FirstLevelCount][SecondLevelCount];
+    uint64_t mFirstLevelBitmap;
+    uint32_t mSecondLevelBitmap[FirstLevelCount];
+
+    uint64_t mSize;
+    uint64_t mGranularity;
+    uint64_t mUsedSize;
+    uint32_t mAllocationCount;
+    uint32_t mLastBlock; // highest in address order
+};
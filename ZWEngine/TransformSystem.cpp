@@ -0,0 +1,187 @@
+#include "TransformSystem.h"
+#include <cmath>
+using namespace DirectX;
+
+void TransformSystem::Reserve(uint32_t count)
+{
+    mParents.reserve(count);
+    mPositions.reserve(count);
+    mRotations.reserve(count);
+    mScales.reserve(count);
+    mAngularVelocities.reserve(count);
+    mPrevPositions.reserve(count);
+    mPrevRotations.reserve(count);
+    mPrevScales.reserve(count);
+    mWorld.reserve(count);
+}
+
+void TransformSystem::Clear()
+{
+    mParents.clear();
+    mPositions.clear();
+    mRotations.clear();
+    mScales.clear();
+    mAngularVelocities.clear();
+    mPrevPositions.clear();
+    mPrevRotations.clear();
+    mPrevScales.clear();
+    mWorld.clear();
+}
+
+TransformHandle TransformSystem::Create(TransformHandle parent, const XMFLOAT3& position,
+    const XMFLOAT4& rotation, const XMFLOAT3& scale)
+{
+    if (parent != InvalidTransform && parent >= Count())
+    {
+        return InvalidTransform;
+    }
+
+    TransformHandle transform = Count();
+    mParents.push_back(parent);
+    mPositions.push_back(position);
+    mRotations.push_back(rotation);
+    mScales.push_back(scale);
+    mAngularVelocities.push_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+    mPrevPositions.push_back(position);
+    mPrevRotations.push_back(rotation);
+    mPrevScales.push_back(scale);
+
+    XMFLOAT4X4 identity;
+    XMStoreFloat4x4(&identity, XMMatrixIdentity());
+    mWorld.push_back(identity);
+    return transform;
+}
+
+uint32_t TransformSystem::Count() const
+{
+    return (uint32_t)mParents.size();
+}
+
+TransformHandle TransformSystem::GetParent(TransformHandle transform) const
+{
+    return mParents[transform];
+}
+
+const XMFLOAT3& TransformSystem::GetPosition(TransformHandle transform) const
+{
+    return mPositions[transform];
+}
+
+const XMFLOAT4& TransformSystem::GetRotation(TransformHandle transform) const
+{
+    return mRotations[transform];
+}
+
+const XMFLOAT3& TransformSystem::GetScale(TransformHandle transform) const
+{
+    return mScales[transform];
+}
+
+void TransformSystem::SetPosition(TransformHandle transform, const XMFLOAT3& position)
+{
+    mPositions[transform] = position;
+}
+
+void TransformSystem::SetRotation(TransformHandle transform, const XMFLOAT4& rotation)
+{
+    mRotations[transform] = rotation;
+}
+
+void TransformSystem::SetScale(TransformHandle transform, const XMFLOAT3& scale)
+{
+    mScales[transform] = scale;
+}
+
+const XMFLOAT3& TransformSystem::GetAngularVelocity(TransformHandle transform) const
+{
+    return mAngularVelocities[transform];
+}
+
+void TransformSystem::SetAngularVelocity(TransformHandle transform, const XMFLOAT3& angularVelocity)
+{
+    mAngularVelocities[transform] = angularVelocity;
+}
+
+XMFLOAT3* TransformSystem::Positions()
+{
+    return mPositions.data();
+}
+
+XMFLOAT4* TransformSystem::Rotations()
+{
+    return mRotations.data();
+}
+
+XMFLOAT3* TransformSystem::Scales()
+{
+    return mScales.data();
+}
+
+XMFLOAT3* TransformSystem::AngularVelocities()
+{
+    return mAngularVelocities.data();
+}
+
+void TransformSystem::BeginStep()
+{
+    mPrevPositions = mPositions;
+    mPrevRotations = mRotations;
+    mPrevScales = mScales;
+}
+
+void TransformSystem::Integrate(float deltaTime)
+{
+    const uint32_t count = Count();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const XMFLOAT3& w = mAngularVelocities[i];
+        float speedSq = w.x * w.x + w.y * w.y + w.z * w.z;
+        if (speedSq == 0.0f)
+        {
+            continue;
+        }
+
+        // turn by |w| * deltaTime around the axis w, after the current rotation (XMQuaternionMultiply(a, b)
+        // rotates by a, then by b). renormalizing every step keeps the rounding error from adding up
+        float speed = sqrtf(speedSq);
+        XMVECTOR axis = XMVectorScale(XMLoadFloat3(&w), 1.0f / speed);
+        XMVECTOR step = XMQuaternionRotationNormal(axis, speed * deltaTime);
+        XMVECTOR rotation = XMQuaternionNormalize(XMQuaternionMultiply(XMLoadFloat4(&mRotations[i]), step));
+        XMStoreFloat4(&mRotations[i], rotation);
+    }
+}
+
+void TransformSystem::UpdateWorld(float alpha)
+{
+    const uint32_t count = Count();
+    const XMVECTOR origin = XMVectorZero();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        XMVECTOR position = XMVectorLerp(XMLoadFloat3(&mPrevPositions[i]), XMLoadFloat3(&mPositions[i]), alpha);
+        XMVECTOR rotation = XMQuaternionSlerp(XMLoadFloat4(&mPrevRotations[i]), XMLoadFloat4(&mRotations[i]), alpha);
+        XMVECTOR scale = XMVectorLerp(XMLoadFloat3(&mPrevScales[i]), XMLoadFloat3(&mScales[i]), alpha);
+
+        // scale, then rotate around the local origin, then translate
+        XMMATRIX world = XMMatrixAffineTransformation(scale, origin, rotation, position);
+
+        // the parent has a lower index, so its world matrix is already up to date
+        TransformHandle parent = mParents[i];
+        if (parent != InvalidTransform)
+        {
+            world = world * XMLoadFloat4x4(&mWorld[parent]);
+        }
+        XMStoreFloat4x4(&mWorld[i], world);
+    }
+}
+
+const XMFLOAT4X4& TransformSystem::GetWorld(TransformHandle transform) const
+{
+    return mWorld[transform];
+}
+
+const XMFLOAT4X4* TransformSystem::WorldMatrices() const
+{
+    return mWorld.data();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+typedef uint32_t TransformHandle; // index into the transform arrays
+
+const TransformHandle InvalidTransform = 0xffffffff;
+
+// Position, rotation and scale of every object in structure of arrays form, relative to an
+// optional parent. A parent is always created before its children, so the arrays are in
+// hierarchy order and the world matrices are built in one linear pass without sorting or
+// recursion. The simulation writes the local values once per step; UpdateWorld interpolates
+// between the last two steps and composes world = scale * rotation * translation * parent world.
+// Rotations are unit quaternions, spinning objects integrate an angular velocity every step and
+// are renormalized so they never drift, the rotation matrix is only built in UpdateWorld.
+class TransformSystem
+{
+public:
+    void Reserve(uint32_t count);
+    void Clear();
+
+    // "parent" must already exist (or be InvalidTransform for a root)
+    TransformHandle Create(TransformHandle parent, const DirectX::XMFLOAT3& position,
+        const DirectX::XMFLOAT4& rotation, const DirectX::XMFLOAT3& scale);
+
+    uint32_t Count() const;
+    TransformHandle GetParent(TransformHandle transform) const;
+
+    // local state of the current simulation step
+    const DirectX::XMFLOAT3& GetPosition(TransformHandle transform) const;
+    const DirectX::XMFLOAT4& GetRotation(TransformHandle transform) const; // quaternion
+    const DirectX::XMFLOAT3& GetScale(TransformHandle transform) const;
+    void SetPosition(TransformHandle transform, const DirectX::XMFLOAT3& position);
+    void SetRotation(TransformHandle transform, const DirectX::XMFLOAT4& rotation);
+    void SetScale(TransformHandle transform, const DirectX::XMFLOAT3& scale);
+
+    // radians per second around the parent's x, y and z axis, 0 for transforms that don't spin
+    const DirectX::XMFLOAT3& GetAngularVelocity(TransformHandle transform) const;
+    void SetAngularVelocity(TransformHandle transform, const DirectX::XMFLOAT3& angularVelocity);
+
+    // raw arrays for systems that update many transforms at once, Count() entries each
+    DirectX::XMFLOAT3* Positions();
+    DirectX::XMFLOAT4* Rotations();
+    DirectX::XMFLOAT3* Scales();
+    DirectX::XMFLOAT3* AngularVelocities();
+
+    // call at the start of every simulation step, before the local values change
+    void BeginStep();
+
+    // rotate every spinning transform by its angular velocity for "deltaTime" seconds
+    void Integrate(float deltaTime);
+
+    // build every world matrix "alpha" (0..1) of the way from the previous to the current step
+    void UpdateWorld(float alpha);
+
+    const DirectX::XMFLOAT4X4& GetWorld(TransformHandle transform) const;
+    const DirectX::XMFLOAT4X4* WorldMatrices() const; // Count() matrices in handle order
+
+private:
+    std::vector<TransformHandle> mParents;
+
+    std::vector<DirectX::XMFLOAT3> mPositions;
+    std::vector<DirectX::XMFLOAT4> mRotations;
+    std::vector<DirectX::XMFLOAT3> mScales;
+    std::vector<DirectX::XMFLOAT3> mAngularVelocities;
+
+    // the previous simulation step, rendering interpolates from here
+    std::vector<DirectX::XMFLOAT3> mPrevPositions;
+    std::vector<DirectX::XMFLOAT4> mPrevRotations;
+    std::vector<DirectX::XMFLOAT3> mPrevScales;
+
+    std::vector<DirectX::XMFLOAT4X4> mWorld;
+};
@@ -0,0 +1,313 @@
+#include "UploadManager.h"
+#include "DdsTexture.h"
+
+static const uint32_t NoPage = 0xffffffff;
+
+static inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+UploadManager::UploadManager()
+    : mBackend(nullptr), mQueue(nullptr), mBatchSize(0), mCurrentPage(NoPage), mOffset(0), mPendingBytes(0),
+    mLastFenceValue(0), mUploads(0), mSubmittedCopies(0), mSubmittedBatches(0)
+{
+}
+
+void UploadManager::Init(RenderBackend* backend, CopyQueue* queue, uint64_t batchSize)
+{
+    mBackend = backend;
+    mQueue = queue;
+    mBatchSize = batchSize;
+    mPages.clear();
+    mInFlight.clear();
+    mFreePages.clear();
+    mCurrentPage = NoPage;
+    mOffset = 0;
+    mCopies.clear();
+    mTextureCopies.clear();
+    mPendingBytes = 0;
+    mLastFenceValue = 0;
+    mUploads = 0;
+    mSubmittedCopies = 0;
+    mSubmittedBatches = 0;
+}
+
+bool UploadManager::Upload(ResourceHandle destination, uint64_t destinationOffset, const void* data, uint64_t size)
+{
+    if (size == 0)
+    {
+        return true;
+    }
+
+    uint64_t offset;
+    if (!Allocate(size, 1, &offset))
+    {
+        return false;
+    }
+
+    // the data is one row, the packer streams it into the page when it's big. rows are 32 bits,
+    // larger uploads go in pieces
+    Page& page = mPages[mCurrentPage];
+    for (uint64_t done = 0; done < size;)
+    {
+        uint32_t rowSize = size - done > 0x80000000 ? 0x80000000 : (uint32_t)(size - done);
+        SubresourceSource source;
+        source.data = (const uint8_t*)data + done;
+        source.rowPitch = rowSize;
+        source.slicePitch = rowSize;
+
+        UploadFootprint footprint;
+        footprint.offset = offset + done;
+        footprint.rowPitch = rowSize;
+        footprint.rowSize = rowSize;
+        footprint.rowCount = 1;
+        footprint.depth = 1;
+        UploadPacker::PackSubresource(source, footprint, page.buffer.cpuAddress);
+        done += rowSize;
+    }
+
+    // continues the last copy in both buffers, extend it
+    if (!mCopies.empty())
+    {
+        BufferCopy& last = mCopies.back();
+        if (last.destination == destination && last.destinationOffset + last.size == destinationOffset &&
+            last.sourceOffset + last.size == offset)
+        {
+            last.size += size;
+            mOffset = offset + size;
+            mPendingBytes += size;
+            ++mUploads;
+            return true;
+        }
+    }
+
+    BufferCopy copy;
+    copy.destination = destination;
+    copy.destinationOffset = destinationOffset;
+    copy.sourceOffset = offset;
+    copy.size = size;
+    mCopies.push_back(copy);
+
+    mOffset = offset + size;
+    mPendingBytes += size;
+    ++mUploads;
+    return true;
+}
+
+bool GetTextureSubresourceLayout(const TextureDesc& desc, uint32_t subresource, TextureSubresourceLayout* layout)
+{
+    uint32_t blockBytes;
+    uint32_t bitsPerPixel;
+    if (!GetDxgiFormatSize(desc.format, &blockBytes, &bitsPerPixel) || subresource >= (uint64_t)desc.mipCount * desc.arraySize)
+    {
+        return false;
+    }
+
+    uint32_t mip = subresource % desc.mipCount;
+    uint32_t width = desc.width >> mip ? desc.width >> mip : 1;
+    uint32_t height = desc.height >> mip ? desc.height >> mip : 1;
+    layout->depth = desc.volume && desc.depth >> mip ? desc.depth >> mip : 1;
+    if (blockBytes)
+    {
+        layout->rowSize = (width + 3) / 4 * blockBytes;
+        layout->rowCount = (height + 3) / 4;
+        layout->width = (width + 3) & ~3u;
+        layout->height = (height + 3) & ~3u;
+    }
+    else
+    {
+        layout->rowSize = (uint32_t)(((uint64_t)width * bitsPerPixel + 7) / 8);
+        layout->rowCount = height;
+        layout->width = width;
+        layout->height = height;
+    }
+    return true;
+}
+
+bool UploadManager::UploadTexture(ResourceHandle destination, const TextureDesc& desc, uint32_t firstSubresource,
+    uint32_t count, const SubresourceSource* sources, JobSystem* jobs)
+{
+    // the rows of every subresource, as GetCopyableFootprints would describe them
+    std::vector<TextureSubresourceLayout> layouts(count);
+    std::vector<uint32_t> rowSizes(count), rowCounts(count), depths(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!GetTextureSubresourceLayout(desc, firstSubresource + i, &layouts[i]))
+        {
+            return false;
+        }
+        rowSizes[i] = layouts[i].rowSize;
+        rowCounts[i] = layouts[i].rowCount;
+        depths[i] = layouts[i].depth;
+    }
+    if (count == 0)
+    {
+        return true;
+    }
+
+    // lay them out from 0 to learn the size, then move them to where the page has room. placement
+    // alignment holds for any aligned base, the pages themselves are placed on 64KB boundaries
+    std::vector<UploadFootprint> footprints(count);
+    uint64_t size = UploadPacker::ComputeFootprints(count, rowSizes.data(), rowCounts.data(), depths.data(), 0,
+        footprints.data());
+    uint64_t offset;
+    if (!Allocate(size, TexturePlacementAlignment, &offset))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        footprints[i].offset += offset;
+    }
+    UploadPacker::PackSubresources(jobs, count, sources, footprints.data(), mPages[mCurrentPage].buffer.cpuAddress);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        TextureCopy copy;
+        copy.destination = destination;
+        copy.subresource = firstSubresource + i;
+        copy.format = desc.format;
+        copy.width = layouts[i].width;
+        copy.height = layouts[i].height;
+        copy.footprint = footprints[i];
+        mTextureCopies.push_back(copy);
+    }
+
+    mOffset = offset + size;
+    mPendingBytes += size;
+    ++mUploads;
+    return true;
+}
+
+bool UploadManager::Allocate(uint64_t size, uint64_t alignment, uint64_t* offset)
+{
+    Retire();
+
+    if (mCurrentPage == NoPage || AlignUp(mOffset, alignment) + size > mPages[mCurrentPage].buffer.size)
+    {
+        // a batch never spans pages, so the page is tagged with a known fence when it retires
+        if (!Submit() || !NextPage(size))
+        {
+            return false;
+        }
+    }
+    *offset = AlignUp(mOffset, alignment);
+    return true;
+}
+
+bool UploadManager::Submit(uint64_t* fenceValue)
+{
+    if (fenceValue)
+    {
+        *fenceValue = 0;
+    }
+    if (mCopies.empty() && mTextureCopies.empty())
+    {
+        return true;
+    }
+
+    Page& page = mPages[mCurrentPage];
+    uint64_t value;
+    if (!mQueue->Submit(page.buffer.resource, mCopies.data(), (uint32_t)mCopies.size(), mTextureCopies.data(),
+        (uint32_t)mTextureCopies.size(), &value))
+    {
+        return false;
+    }
+    page.fence = value;
+    mLastFenceValue = value;
+
+    mSubmittedCopies += mCopies.size() + mTextureCopies.size();
+    ++mSubmittedBatches;
+    mCopies.clear();
+    mTextureCopies.clear();
+    mPendingBytes = 0;
+
+    if (fenceValue)
+    {
+        *fenceValue = value;
+    }
+    return true;
+}
+
+void UploadManager::Retire()
+{
+    if (mInFlight.empty())
+    {
+        return;
+    }
+
+    // batches complete in submission order, so stop at the first page the gpu may still read
+    uint64_t completed = mQueue->GetFence()->GetCompletedValue();
+    while (!mInFlight.empty() && mPages[mInFlight.front()].fence <= completed)
+    {
+        mFreePages.push_back(mInFlight.front());
+        mInFlight.pop_front();
+    }
+}
+
+bool UploadManager::NextPage(uint64_t minSize)
+{
+    if (mCurrentPage != NoPage)
+    {
+        mInFlight.push_back(mCurrentPage);
+        mCurrentPage = NoPage;
+    }
+
+    for (uint32_t i = 0; i < mFreePages.size(); ++i)
+    {
+        if (mPages[mFreePages[i]].buffer.size >= minSize)
+        {
+            mCurrentPage = mFreePages[i];
+            mFreePages.erase(mFreePages.begin() + i);
+            mOffset = 0;
+            return true;
+        }
+    }
+
+    // nothing free (or nothing large enough): add a page. oversized uploads get a page of their own
+    Page page;
+    uint64_t size = minSize > mBatchSize ? minSize : mBatchSize;
+    if (!mBackend->CreateUploadBuffer(size, &page.buffer))
+    {
+        return false;
+    }
+    page.fence = 0;
+    mPages.push_back(page);
+    mCurrentPage = (uint32_t)mPages.size() - 1;
+    mOffset = 0;
+    return true;
+}
+
+uint64_t UploadManager::GetLastFenceValue() const
+{
+    return mLastFenceValue;
+}
+
+bool UploadManager::WaitForIdle()
+{
+    if (mLastFenceValue != 0 && !mQueue->GetFence()->WaitForValue(mLastFenceValue))
+    {
+        return false;
+    }
+    Retire();
+    return true;
+}
+
+UploadStats UploadManager::GetStats() const
+{
+    UploadStats stats;
+    stats.pendingBytes = mPendingBytes;
+    stats.pendingCopies = (uint32_t)(mCopies.size() + mTextureCopies.size());
+    stats.uploads = mUploads;
+    stats.submittedCopies = mSubmittedCopies;
+    stats.submittedBatches = mSubmittedBatches;
+    stats.stagingCapacity = 0;
+    for (uint32_t i = 0; i < mPages.size(); ++i)
+    {
+        stats.stagingCapacity += mPages[i].buffer.size;
+    }
+    stats.pageCount = (uint32_t)mPages.size();
+    stats.pagesInFlight = (uint32_t)mInFlight.size();
+    return stats;
+}
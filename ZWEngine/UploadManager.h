@@ -0,0 +1,142 @@
+#pragma once
+
+#include "FrameManager.h"
+#include "RenderBackend.h"
+#include "UploadPacker.h"
+#include <deque>
+#include <vector>
+
+// one buffer to buffer copy on the copy queue
+struct BufferCopy
+{
+    ResourceHandle destination;
+    uint64_t destinationOffset;
+    uint64_t sourceOffset; // into the staging buffer of the submission
+    uint64_t size;
+};
+
+// one subresource of a texture out of the staging buffer, like a CopyTextureRegion from a placed
+// footprint
+struct TextureCopy
+{
+    ResourceHandle destination;
+    uint32_t subresource;
+    uint32_t format; // DXGI_FORMAT
+    uint32_t width; // of the footprint in texels, whole blocks for compressed formats
+    uint32_t height;
+    UploadFootprint footprint; // offset into the staging buffer of the submission
+};
+
+// one subresource of a texture the way the copy engine reads it: "rowCount" rows (of 4x4 blocks for
+// compressed formats) of "rowSize" bytes per depth slice, and the size of its footprint in texels
+struct TextureSubresourceLayout
+{
+    uint32_t rowSize;
+    uint32_t rowCount;
+    uint32_t depth;
+    uint32_t width; // whole blocks for compressed formats
+    uint32_t height;
+};
+
+// false if "subresource" isn't one of "desc" or the format has no known size (GetDxgiFormatSize)
+bool GetTextureSubresourceLayout(const TextureDesc& desc, uint32_t subresource, TextureSubresourceLayout* layout);
+
+// A queue that only copies and runs next to the direct queue. Buffers and textures decay to the
+// common state when a copy list finished and are promoted to whatever read state the direct queue
+// uses them in, so the copies need no barriers; the direct queue only has to wait for the fence value.
+class CopyQueue
+{
+public:
+    virtual ~CopyQueue() {}
+
+    // record "copies" and "textureCopies" out of the upload buffer "source" and execute them.
+    // "fenceValue" receives the value GetFence() reaches once they are done
+    virtual bool Submit(ResourceHandle source, const BufferCopy* copies, uint32_t count, const TextureCopy* textureCopies,
+        uint32_t textureCount, uint64_t* fenceValue) = 0;
+
+    virtual GpuFence* GetFence() = 0;
+};
+
+struct UploadStats
+{
+    uint64_t pendingBytes; // staged but not submitted yet
+    uint32_t pendingCopies;
+    uint64_t uploads; // Upload and UploadTexture calls so far
+    uint64_t submittedCopies; // copies actually recorded, neighbouring uploads are merged
+    uint64_t submittedBatches;
+    uint64_t stagingCapacity; // total size of all staging pages
+    uint32_t pageCount;
+    uint32_t pagesInFlight; // full pages waiting for their last batch
+};
+
+// Streams data into gpu buffers through a CopyQueue. Uploads are staged right away into the current
+// staging page and collected into a batch; the batch goes out as one submission when it is
+// submitted explicitly (once a frame by the backends) or the next upload doesn't fit the page any
+// more. Uploads that continue the previous one in the same buffer become one copy. A page stays in
+// use until it is full and is handed out again once the fence of its last batch completed, so the
+// staging memory settles at what the batches in flight need.
+class UploadManager
+{
+public:
+    UploadManager();
+
+    // staging pages are created through "backend" with CreateUploadBuffer. "batchSize" is the page
+    // size and so the largest batch, bigger uploads get a page of their own
+    void Init(RenderBackend* backend, CopyQueue* queue, uint64_t batchSize = 4 * 1024 * 1024);
+
+    // copy "size" bytes of "data" to "destination" at "destinationOffset". "data" is staged (with
+    // UploadPacker) before this returns. false if a staging page couldn't be created or a full batch couldn't be submitted
+    bool Upload(ResourceHandle destination, uint64_t destinationOffset, const void* data, uint64_t size);
+
+    // copy "count" subresources of the texture "destination" (created from "desc") from
+    // "firstSubresource" on. they are laid out in placed footprints and packed with UploadPacker,
+    // split over "jobs" (may be null), before this returns. false if "desc" has a format without a
+    // known size or like Upload
+    bool UploadTexture(ResourceHandle destination, const TextureDesc& desc, uint32_t firstSubresource, uint32_t count,
+        const SubresourceSource* sources, JobSystem* jobs);
+
+    // submit the open batch. "fenceValue" (optional) receives its fence value, or 0 if there was nothing
+    bool Submit(uint64_t* fenceValue = nullptr);
+
+    // recycle the pages whose last batch completed, Upload does this too
+    void Retire();
+
+    uint64_t GetLastFenceValue() const; // of the last submitted batch, 0 if none
+
+    // block until every submitted batch is done
+    bool WaitForIdle();
+
+    UploadStats GetStats() const;
+
+private:
+    struct Page
+    {
+        UploadBuffer buffer;
+        uint64_t fence; // last batch that used the page
+    };
+
+    bool NextPage(uint64_t minSize);
+
+    // make room for "size" bytes at "alignment" in the current page, submitting the batch and
+    // moving to the next page if they don't fit. returns the offset, or false
+    bool Allocate(uint64_t size, uint64_t alignment, uint64_t* offset);
+
+    RenderBackend* mBackend;
+    CopyQueue* mQueue;
+    uint64_t mBatchSize;
+
+    std::vector<Page> mPages; // every page ever created
+    std::deque<uint32_t> mInFlight; // full pages in the order they filled up
+    std::vector<uint32_t> mFreePages;
+    uint32_t mCurrentPage;
+    uint64_t mOffset; // bump offset into the current page
+
+    std::vector<BufferCopy> mCopies; // the open batch
+    std::vector<TextureCopy> mTextureCopies;
+    uint64_t mPendingBytes;
+    uint64_t mLastFenceValue;
+
+    uint64_t mUploads;
+    uint64_t mSubmittedCopies;
+    uint64_t mSubmittedBatches;
+};
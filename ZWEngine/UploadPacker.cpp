@@ -0,0 +1,205 @@
+#include "UploadPacker.h"
+#include <cstring>
+#include <vector>
+
+#if defined(ZW_SIMD_X86)
+#include <emmintrin.h>
+#endif
+
+// below this a row isn't worth the streaming setup, and a batch isn't worth a job. a copy in one
+// piece streams from StreamingCopySize on, smaller ones are likely read again from the cache
+static const uint32_t StreamingRowSize = 64;
+static const uint64_t StreamingCopySize = 64 * 1024;
+static const uint64_t JobBytes = 256 * 1024;
+
+static inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+#if defined(ZW_SIMD_X86)
+
+// the bytes up to the first 16 byte boundary of "dst" are copied normally, the rest is streamed
+static void CopyStreaming(uint8_t* dst, const uint8_t* src, uint64_t size)
+{
+    uint64_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+    head = head < size ? head : size;
+    memcpy(dst, src, (size_t)head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    uint64_t i = 0;
+    for (; i + 64 <= size; i += 64)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i + 0));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+        __m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+        _mm_stream_si128((__m128i*)(dst + i + 0), a);
+        _mm_stream_si128((__m128i*)(dst + i + 16), b);
+        _mm_stream_si128((__m128i*)(dst + i + 32), c);
+        _mm_stream_si128((__m128i*)(dst + i + 48), d);
+    }
+    for (; i + 16 <= size; i += 16)
+    {
+        _mm_stream_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    }
+    if (i < size)
+    {
+        memcpy(dst + i, src + i, (size_t)(size - i));
+    }
+}
+
+#endif
+
+uint64_t UploadPacker::ComputeFootprints(uint32_t count, const uint32_t* rowSizes, const uint32_t* rowCounts,
+    const uint32_t* depths, uint64_t baseOffset, UploadFootprint* footprints)
+{
+    uint64_t offset = AlignUp(baseOffset, TexturePlacementAlignment);
+    uint64_t end = baseOffset;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        UploadFootprint& footprint = footprints[i];
+        footprint.offset = offset;
+        footprint.rowSize = rowSizes[i];
+        footprint.rowPitch = (uint32_t)AlignUp(rowSizes[i], TextureRowPitchAlignment);
+        footprint.rowCount = rowCounts[i];
+        footprint.depth = depths[i];
+
+        // the last row doesn't need its padding, same as GetCopyableFootprints' total size
+        uint64_t rows = (uint64_t)footprint.rowCount * footprint.depth;
+        if (rows != 0)
+        {
+            end = offset + (rows - 1) * footprint.rowPitch + footprint.rowSize;
+            offset = AlignUp(end, TexturePlacementAlignment);
+        }
+    }
+    return end - baseOffset;
+}
+
+// rows [rowBegin, rowEnd) of the subresource, counting through all depth slices
+static void PackRows(const SubresourceSource& source, const UploadFootprint& footprint, uint8_t* staging,
+    SimdLevel level, uint64_t rowBegin, uint64_t rowEnd)
+{
+    if (rowBegin >= rowEnd)
+    {
+        return;
+    }
+
+    const uint8_t* src = (const uint8_t*)source.data;
+    uint8_t* dst = staging + footprint.offset;
+    uint64_t dstSlicePitch = (uint64_t)footprint.rowPitch * footprint.rowCount;
+
+    // same layout on both sides (always for buffers and for rows that are already 256 byte multiples)
+    if (source.rowPitch == footprint.rowPitch && (footprint.depth == 1 || source.slicePitch == dstSlicePitch))
+    {
+        uint64_t offset = rowBegin * footprint.rowPitch;
+        uint64_t size = (rowEnd - rowBegin - 1) * footprint.rowPitch + footprint.rowSize;
+#if defined(ZW_SIMD_X86)
+        if (level != SimdLevel::Scalar && size >= StreamingCopySize)
+        {
+            CopyStreaming(dst + offset, src + offset, size);
+            _mm_sfence();
+            return;
+        }
+#endif
+        memcpy(dst + offset, src + offset, (size_t)size);
+        return;
+    }
+
+#if defined(ZW_SIMD_X86)
+    bool streaming = level != SimdLevel::Scalar && footprint.rowSize >= StreamingRowSize;
+#else
+    (void)level;
+#endif
+
+    for (uint64_t row = rowBegin; row < rowEnd; ++row)
+    {
+        uint64_t z = row / footprint.rowCount;
+        uint64_t y = row % footprint.rowCount;
+        uint8_t* dstRow = dst + z * dstSlicePitch + y * footprint.rowPitch;
+        const uint8_t* srcRow = src + z * source.slicePitch + y * source.rowPitch;
+#if defined(ZW_SIMD_X86)
+        if (streaming)
+        {
+            CopyStreaming(dstRow, srcRow, footprint.rowSize);
+            continue;
+        }
+#endif
+        memcpy(dstRow, srcRow, footprint.rowSize);
+    }
+
+#if defined(ZW_SIMD_X86)
+    if (streaming)
+    {
+        // streaming stores are weakly ordered, they have to land before the copy is submitted
+        _mm_sfence();
+    }
+#endif
+}
+
+void UploadPacker::PackSubresource(const SubresourceSource& source, const UploadFootprint& footprint, uint8_t* staging)
+{
+    PackSubresource(source, footprint, staging, GetSimdLevel());
+}
+
+void UploadPacker::PackSubresource(const SubresourceSource& source, const UploadFootprint& footprint, uint8_t* staging,
+    SimdLevel level)
+{
+    PackRows(source, footprint, staging, level, 0, (uint64_t)footprint.rowCount * footprint.depth);
+}
+
+void UploadPacker::PackSubresources(JobSystem* jobs, uint32_t count, const SubresourceSource* sources,
+    const UploadFootprint* footprints, uint8_t* staging)
+{
+    SimdLevel level = GetSimdLevel();
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        total += (uint64_t)footprints[i].rowSize * footprints[i].rowCount * footprints[i].depth;
+    }
+
+    if (!jobs || jobs->GetThreadCount() == 1 || total < JobBytes)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            PackSubresource(sources[i], footprints[i], staging, level);
+        }
+        return;
+    }
+
+    // mip 0 is three quarters of a chain, so big subresources are split into row ranges of about
+    // JobBytes and the small mips are a job each
+    struct Range
+    {
+        uint32_t subresource;
+        uint64_t rowBegin;
+        uint64_t rowEnd;
+    };
+    std::vector<Range> ranges;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const UploadFootprint& footprint = footprints[i];
+        uint64_t rows = (uint64_t)footprint.rowCount * footprint.depth;
+        uint64_t rowsPerRange = footprint.rowSize ? JobBytes / footprint.rowSize : rows;
+        rowsPerRange = rowsPerRange ? rowsPerRange : 1;
+        for (uint64_t row = 0; row < rows; row += rowsPerRange)
+        {
+            Range range;
+            range.subresource = i;
+            range.rowBegin = row;
+            range.rowEnd = rows - row > rowsPerRange ? row + rowsPerRange : rows;
+            ranges.push_back(range);
+        }
+    }
+
+    jobs->ParallelFor((uint32_t)ranges.size(), 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const Range& range = ranges[i];
+            PackRows(sources[range.subresource], footprints[range.subresource], staging, level, range.rowBegin, range.rowEnd);
+        }
+    });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include <cstdint>
+
+const uint32_t TextureRowPitchAlignment = 256; // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+const uint32_t TexturePlacementAlignment = 512; // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+// tightly packed source of one subresource, like D3D12_SUBRESOURCE_DATA
+struct SubresourceSource
+{
+    const void* data;
+    uint64_t rowPitch; // bytes between rows
+    uint64_t slicePitch; // bytes between depth slices
+};
+
+// where one subresource goes in the staging buffer, like D3D12_PLACED_SUBRESOURCE_FOOTPRINT plus
+// the row count and row size GetCopyableFootprints returns separately. a buffer is a single row of
+// its size, at any offset and with rowPitch == rowSize
+struct UploadFootprint
+{
+    uint64_t offset; // TexturePlacementAlignment aligned
+    uint32_t rowPitch; // TextureRowPitchAlignment aligned
+    uint32_t rowSize; // bytes of data in a row
+    uint32_t rowCount; // rows per depth slice (block rows for compressed formats)
+    uint32_t depth;
+};
+
+// Lays subresources out the way the copy engine reads them from a buffer and fills the buffer.
+// This is what GetRequiredIntermediateSize + UpdateSubresources do, without asking the device for
+// the footprints and without MemcpySubresource's memcpy per row: subresources whose pitch already
+// matches (buffers always do) are copied in one piece, the others row by row, both with non
+// temporal stores once they're big enough (the staging memory is write combined and never read
+// back by the cpu), and big batches are split across the job system.
+class UploadPacker
+{
+public:
+    // "rowSizes", "rowCounts" and "depths" describe "count" subresources. writes their footprints
+    // from "baseOffset" on and returns the bytes needed from there, the intermediate size
+    static uint64_t ComputeFootprints(uint32_t count, const uint32_t* rowSizes, const uint32_t* rowCounts,
+        const uint32_t* depths, uint64_t baseOffset, UploadFootprint* footprints);
+
+    // copy one subresource to "staging" (the start of the buffer the footprint offsets refer to)
+    static void PackSubresource(const SubresourceSource& source, const UploadFootprint& footprint, uint8_t* staging);
+    static void PackSubresource(const SubresourceSource& source, const UploadFootprint& footprint, uint8_t* staging,
+        SimdLevel level);
+
+    // copy "count" subresources, spread over "jobs" (may be null) when it's worth it
+    static void PackSubresources(JobSystem* jobs, uint32_t count, const SubresourceSource* sources,
+        const UploadFootprint* footprints, uint8_t* staging);
+};
@@ -0,0 +1,116 @@
+#include "UploadRingAllocator.h"
+
+static const uint32_t NoPage = 0xffffffff;
+
+UploadRingAllocator::UploadRingAllocator()
+    : mBackend(nullptr), mPageSize(0), mCurrentPage(NoPage), mOffset(0), mFrameFence(0),
+    mFrameBytes(0), mLastFrameBytes(0), mPeakFrameBytes(0)
+{
+}
+
+void UploadRingAllocator::Init(RenderBackend* backend, uint64_t pageSize)
+{
+    mBackend = backend;
+    mPageSize = pageSize;
+    mPages.clear();
+    mInFlight.clear();
+    mFreePages.clear();
+    mCurrentPage = NoPage;
+    mOffset = 0;
+    mFrameFence = 0;
+    mFrameBytes = 0;
+    mLastFrameBytes = 0;
+    mPeakFrameBytes = 0;
+}
+
+void UploadRingAllocator::BeginFrame(uint64_t frameFence, uint64_t completedFence)
+{
+    // pages retire in submission order, so stop at the first one the gpu may still read
+    while (!mInFlight.empty() && mPages[mInFlight.front()].fence <= completedFence)
+    {
+        mFreePages.push_back(mInFlight.front());
+        mInFlight.pop_front();
+    }
+
+    mLastFrameBytes = mFrameBytes;
+    mFrameBytes = 0;
+    mFrameFence = frameFence;
+}
+
+bool UploadRingAllocator::NextPage(uint64_t minSize)
+{
+    if (mCurrentPage != NoPage)
+    {
+        mInFlight.push_back(mCurrentPage);
+        mCurrentPage = NoPage;
+    }
+
+    for (uint32_t i = 0; i < mFreePages.size(); ++i)
+    {
+        if (mPages[mFreePages[i]].buffer.size >= minSize)
+        {
+            mCurrentPage = mFreePages[i];
+            mFreePages.erase(mFreePages.begin() + i);
+            mOffset = 0;
+            return true;
+        }
+    }
+
+    // nothing free (or nothing large enough): grow the ring. oversized requests get a page of their own
+    Page page;
+    uint64_t size = minSize > mPageSize ? minSize : mPageSize;
+    if (!mBackend->CreateUploadBuffer(size, &page.buffer))
+    {
+        return false;
+    }
+    page.fence = 0;
+    mPages.push_back(page);
+    mCurrentPage = (uint32_t)mPages.size() - 1;
+    mOffset = 0;
+    return true;
+}
+
+bool UploadRingAllocator::Allocate(uint64_t size, uint64_t alignment, UploadAllocation* allocation)
+{
+    uint64_t offset = (mOffset + alignment - 1) & ~(alignment - 1);
+    if (mCurrentPage == NoPage || offset + size > mPages[mCurrentPage].buffer.size)
+    {
+        // page offsets start at 0 and pages are 64KB aligned, so a fresh page satisfies any alignment up to that
+        if (!NextPage(size))
+        {
+            return false;
+        }
+        offset = 0;
+    }
+
+    Page& page = mPages[mCurrentPage];
+    page.fence = mFrameFence;
+
+    allocation->cpuAddress = page.buffer.cpuAddress + offset;
+    allocation->gpuAddress = page.buffer.gpuAddress + offset;
+    allocation->size = size;
+
+    mFrameBytes += offset + size - mOffset;
+    if (mFrameBytes > mPeakFrameBytes)
+    {
+        mPeakFrameBytes = mFrameBytes;
+    }
+    mOffset = offset + size;
+    return true;
+}
+
+UploadRingStats UploadRingAllocator::GetStats() const
+{
+    UploadRingStats stats;
+    stats.frameBytes = mFrameBytes;
+    stats.lastFrameBytes = mLastFrameBytes;
+    stats.peakFrameBytes = mPeakFrameBytes;
+    stats.capacity = 0;
+    for (uint32_t i = 0; i < mPages.size(); ++i)
+    {
+        stats.capacity += mPages[i].buffer.size;
+    }
+    stats.pageCount = (uint32_t)mPages.size();
+    stats.pagesInFlight = (uint32_t)mInFlight.size();
+    return stats;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "RenderBackend.h"
+#include <deque>
+#include <vector>
+
+// one suballocation of an upload page, cpuAddress and gpuAddress point at the same bytes
+struct UploadAllocation
+{
+    uint8_t* cpuAddress;
+    GpuAddress gpuAddress;
+    uint64_t size;
+};
+
+struct UploadRingStats
+{
+    uint64_t frameBytes; // bytes handed out in the current frame (including alignment padding)
+    uint64_t lastFrameBytes; // bytes handed out in the previous frame
+    uint64_t peakFrameBytes; // largest frame so far
+    uint64_t capacity; // total size of all pages
+    uint32_t pageCount;
+    uint32_t pagesInFlight; // full pages waiting for the gpu
+};
+
+// Linear allocator over a growable ring of persistently mapped upload pages. Allocations are
+// bumped out of the current page; a full page is tagged with the fence of the frame that used it
+// last and only handed out again once the gpu completed that frame. When no page is free a new one
+// is created, so the ring grows to whatever the frames in flight need instead of overflowing.
+class UploadRingAllocator
+{
+public:
+    UploadRingAllocator();
+
+    // pages are created through "backend" with CreateUploadBuffer
+    void Init(RenderBackend* backend, uint64_t pageSize = 64 * 1024);
+
+    // start a frame. allocations made until the next BeginFrame belong to "frameFence", pages
+    // whose last frame is <= completedFence are recycled
+    void BeginFrame(uint64_t frameFence, uint64_t completedFence);
+
+    // allocate "size" bytes aligned to "alignment" (a power of two), false if a page could not be created
+    bool Allocate(uint64_t size, uint64_t alignment, UploadAllocation* allocation);
+
+    UploadRingStats GetStats() const;
+
+private:
+    struct Page
+    {
+        UploadBuffer buffer;
+        uint64_t fence; // last frame that allocated from this page
+    };
+
+    bool NextPage(uint64_t minSize);
+
+    RenderBackend* mBackend;
+    uint64_t mPageSize;
+
+    std::vector<Page> mPages; // every page ever created
+    std::deque<uint32_t> mInFlight; // full pages in the order they were retired
+    std::vector<uint32_t> mFreePages;
+    uint32_t mCurrentPage;
+    uint64_t mOffset; // bump offset into the current page
+
+    uint64_t mFrameFence;
+    uint64_t mFrameBytes;
+    uint64_t mLastFrameBytes;
+    uint64_t mPeakFrameBytes;
+};
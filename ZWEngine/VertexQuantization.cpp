@@ -0,0 +1,215 @@
+#include "VertexQuantization.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(ZW_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+static const float SnormMax = 32767.0f;
+static const float UnormMax = 255.0f;
+
+// written like _mm_max_ps and _mm_min_ps, so nan turns into the bound the same way on every path
+static inline float Max(float value, float bound)
+{
+    return value > bound ? value : bound;
+}
+
+static inline float Min(float value, float bound)
+{
+    return value < bound ? value : bound;
+}
+
+// snorm steps per unit of distance from the center, a flat axis stores 0
+static void GetQuantizationScale(const float extent[3], float scale[3])
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        scale[axis] = extent[axis] > 0.0f ? SnormMax / extent[axis] : 0.0f;
+    }
+}
+
+// lrintf rounds to nearest even in the default rounding mode, like _mm_cvtps_epi32
+static void QuantizeVerticesScalar(QuantizedVertex* destination, const float* positions, uint32_t positionStride,
+    const float* colors, uint32_t colorStride, uint32_t count, const float center[3], const float scale[3])
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float* position = (const float*)((const uint8_t*)positions + (uint64_t)i * positionStride);
+        const float* color = (const float*)((const uint8_t*)colors + (uint64_t)i * colorStride);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float value = Min(Max((position[axis] - center[axis]) * scale[axis], -SnormMax), SnormMax);
+            destination[i].position[axis] = (int16_t)lrintf(value);
+        }
+        destination[i].position[3] = (int16_t)SnormMax;
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            destination[i].color[channel] = (uint8_t)lrintf(Min(Max(color[channel], 0.0f), 1.0f) * UnormMax);
+        }
+    }
+}
+
+static void DequantizeVerticesScalar(float* positions, uint32_t positionStride, float* colors, uint32_t colorStride,
+    const QuantizedVertex* vertices, uint32_t count, const float center[3], const float extent[3])
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float* position = (float*)((uint8_t*)positions + (uint64_t)i * positionStride);
+        float* color = (float*)((uint8_t*)colors + (uint64_t)i * colorStride);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            position[axis] = Max((float)vertices[i].position[axis] / SnormMax, -1.0f) * extent[axis] + center[axis];
+        }
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            color[channel] = (float)vertices[i].color[channel] / UnormMax;
+        }
+    }
+}
+
+#if defined(ZW_SIMD_X86)
+
+// one vertex per iteration: both attributes are converted in one register each, and a single pack
+// narrows them together
+static void QuantizeVerticesSSE2(QuantizedVertex* destination, const float* positions, uint32_t positionStride,
+    const float* colors, uint32_t colorStride, uint32_t count, const float center[3], const float scale[3])
+{
+    const __m128 centerV = _mm_setr_ps(center[0], center[1], center[2], 0.0f);
+    const __m128 scaleV = _mm_setr_ps(scale[0], scale[1], scale[2], 0.0f);
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 w = _mm_setr_ps(0.0f, 0.0f, 0.0f, SnormMax);
+    const __m128 snormMax = _mm_set1_ps(SnormMax);
+    const __m128 snormMin = _mm_set1_ps(-SnormMax);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 unormMax = _mm_set1_ps(UnormMax);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float* position = (const float*)((const uint8_t*)positions + (uint64_t)i * positionStride);
+        const float* color = (const float*)((const uint8_t*)colors + (uint64_t)i * colorStride);
+
+        // a 16 byte load reads into the next vertex, which is only there before the last one
+        __m128 p = i + 1 < count ? _mm_loadu_ps(position) : _mm_setr_ps(position[0], position[1], position[2], 0.0f);
+        p = _mm_mul_ps(_mm_sub_ps(p, centerV), scaleV);
+        p = _mm_or_ps(_mm_and_ps(p, xyzMask), w);
+        p = _mm_min_ps(_mm_max_ps(p, snormMin), snormMax);
+
+        __m128 c = _mm_loadu_ps(color);
+        c = _mm_mul_ps(_mm_min_ps(_mm_max_ps(c, zero), one), unormMax);
+
+        // x y z w r g b a as int16, then the colors once more as uint8
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(p), _mm_cvtps_epi32(c));
+        _mm_storel_epi64((__m128i*)destination[i].position, packed);
+        int colorBits = _mm_cvtsi128_si32(_mm_srli_si128(_mm_packus_epi16(packed, packed), 4));
+        memcpy(destination[i].color, &colorBits, sizeof(colorBits));
+    }
+}
+
+static void DequantizeVerticesSSE2(float* positions, uint32_t positionStride, float* colors, uint32_t colorStride,
+    const QuantizedVertex* vertices, uint32_t count, const float center[3], const float extent[3])
+{
+    const __m128 centerV = _mm_setr_ps(center[0], center[1], center[2], 0.0f);
+    const __m128 extentV = _mm_setr_ps(extent[0], extent[1], extent[2], 0.0f);
+    const __m128 snormMax = _mm_set1_ps(SnormMax);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 unormMax = _mm_set1_ps(UnormMax);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float* position = (float*)((uint8_t*)positions + (uint64_t)i * positionStride);
+        float* color = (float*)((uint8_t*)colors + (uint64_t)i * colorStride);
+
+        // sign extend the int16 values to int32
+        __m128i q = _mm_loadl_epi64((const __m128i*)vertices[i].position);
+        q = _mm_srai_epi32(_mm_unpacklo_epi16(q, q), 16);
+        __m128 p = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(q), snormMax), minusOne);
+        p = _mm_add_ps(_mm_mul_ps(p, extentV), centerV);
+
+        // only 12 bytes belong to the position
+        _mm_storel_pi((__m64*)position, p);
+        _mm_store_ss(position + 2, _mm_movehl_ps(p, p));
+
+        int colorBits;
+        memcpy(&colorBits, vertices[i].color, sizeof(colorBits));
+        __m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(colorBits), zero);
+        c = _mm_unpacklo_epi16(c, zero);
+        _mm_storeu_ps(color, _mm_div_ps(_mm_cvtepi32_ps(c), unormMax));
+    }
+}
+
+#endif
+
+void QuantizeVertices(QuantizedVertex* destination, const float* positions, uint32_t positionStride,
+    const float* colors, uint32_t colorStride, uint32_t count, const float center[3], const float extent[3],
+    SimdLevel level)
+{
+    if (level > GetSimdLevel())
+    {
+        level = GetSimdLevel();
+    }
+
+    float scale[3];
+    GetQuantizationScale(extent, scale);
+
+    switch (level)
+    {
+#if defined(ZW_SIMD_X86)
+    case SimdLevel::AVX2: // one vertex fills an sse register, there is nothing to gain from wider ones
+    case SimdLevel::SSE2:
+        QuantizeVerticesSSE2(destination, positions, positionStride, colors, colorStride, count, center, scale);
+        break;
+#endif
+    default:
+        QuantizeVerticesScalar(destination, positions, positionStride, colors, colorStride, count, center, scale);
+        break;
+    }
+}
+
+void DequantizeVertices(float* positions, uint32_t positionStride, float* colors, uint32_t colorStride,
+    const QuantizedVertex* vertices, uint32_t count, const float center[3], const float extent[3],
+    SimdLevel level)
+{
+    if (level > GetSimdLevel())
+    {
+        level = GetSimdLevel();
+    }
+
+    switch (level)
+    {
+#if defined(ZW_SIMD_X86)
+    case SimdLevel::AVX2:
+    case SimdLevel::SSE2:
+        DequantizeVerticesSSE2(positions, positionStride, colors, colorStride, vertices, count, center, extent);
+        break;
+#endif
+    default:
+        DequantizeVerticesScalar(positions, positionStride, colors, colorStride, vertices, count, center, extent);
+        break;
+    }
+}
+
+void QuantizeVertices(QuantizedVertex* destination, const float* positions, uint32_t positionStride,
+    const float* colors, uint32_t colorStride, uint32_t count, const float center[3], const float extent[3])
+{
+    QuantizeVertices(destination, positions, positionStride, colors, colorStride, count, center, extent, GetSimdLevel());
+}
+
+void DequantizeVertices(float* positions, uint32_t positionStride, float* colors, uint32_t colorStride,
+    const QuantizedVertex* vertices, uint32_t count, const float center[3], const float extent[3])
+{
+    DequantizeVertices(positions, positionStride, colors, colorStride, vertices, count, center, extent, GetSimdLevel());
+}
+
+void GetDequantizationMatrix(const float center[3], const float extent[3], float matrix[16])
+{
+    memset(matrix, 0, 16 * sizeof(float));
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        matrix[axis * 4 + axis] = extent[axis];
+        matrix[12 + axis] = center[axis];
+    }
+    matrix[15] = 1.0f;
+}
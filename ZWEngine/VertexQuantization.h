@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <cstdint>
+
+// Compressed vertices for the PositionColorQuantized layout. Positions are stored relative to the
+// bounds of their mesh as 16 bit snorm, (p - center) / extent, so the error is at most extent / 32767
+// per axis, and colors as 8 bit unorm. The input assembler turns both back into floats for free,
+// the position is still relative to the bounds though: GetDequantizationMatrix goes in front of the
+// world matrix to undo that.
+
+// 12 bytes instead of the 28 of float3 position + float4 color
+struct QuantizedVertex
+{
+    int16_t position[4]; // snorm x, y, z and w, w is always 32767 so the shader reads 1.0
+    uint8_t color[4]; // unorm r, g, b, a
+};
+
+// "positions" are 3 floats, "colors" 4 floats, "positionStride" and "colorStride" bytes apart.
+// "center" and "extent" are the mesh bounds (see ComputeAabb), everything outside is clamped to them.
+// colors are clamped to 0..1
+void QuantizeVertices(QuantizedVertex* destination, const float* positions, uint32_t positionStride,
+    const float* colors, uint32_t colorStride, uint32_t count, const float center[3], const float extent[3]);
+
+// the other way around, the values the shader sees
+void DequantizeVertices(float* positions, uint32_t positionStride, float* colors, uint32_t colorStride,
+    const QuantizedVertex* vertices, uint32_t count, const float center[3], const float extent[3]);
+
+// same, but with a fixed kernel instead of the best one for this cpu (for comparing the paths).
+// the result is the same for every level
+void QuantizeVertices(QuantizedVertex* destination, const float* positions, uint32_t positionStride,
+    const float* colors, uint32_t colorStride, uint32_t count, const float center[3], const float extent[3],
+    SimdLevel level);
+void DequantizeVertices(float* positions, uint32_t positionStride, float* colors, uint32_t colorStride,
+    const QuantizedVertex* vertices, uint32_t count, const float center[3], const float extent[3],
+    SimdLevel level);
+
+// scale by "extent" and move to "center": takes the decoded snorm positions back to mesh space.
+// 16 floats in the row-vector layout, multiply it in front of the world matrix
+void GetDequantizationMatrix(const float center[3], const float extent[3], float matrix[16]);
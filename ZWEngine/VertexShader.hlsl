@@ -10,13 +10,21 @@ struct VS_OUTPUT
 	float4 color: COLOR;
 };
 
+#ifdef INSTANCED
+// one wvp matrix per instance, all copies of the mesh are drawn with one call
+StructuredBuffer<float4x4> instanceWvp : register(t0);
+#else
 cbuffer ConstantBuffer : register(b0)
 {
 	float4x4 wvpMat;
 };
+#endif
 
-VS_OUTPUT main(VS_INPUT input)
+VS_OUTPUT main(VS_INPUT input, uint instanceID : SV_InstanceID)
 {
+#ifdef INSTANCED
+	float4x4 wvpMat = instanceWvp[instanceID];
+#endif
 	VS_OUTPUT output;
 	output.pos = mul(input.pos, wvpMat);
 	output.color = input.color;
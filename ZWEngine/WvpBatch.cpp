@@ -0,0 +1,214 @@
+#include "WvpBatch.h"
+
+#if defined(ZW_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+static inline const float* WorldMatrix(const float* world, const uint32_t* indices, uint32_t i)
+{
+    return world + 16 * (indices ? indices[i] : i);
+}
+
+// local * world into "out", the rows of the world matrix weighted by the local rows. returns the
+// matrix to continue with
+static inline const float* ApplyLocalScalar(const float* local, const float* world, float* out)
+{
+    if (!local)
+    {
+        return world;
+    }
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            out[row * 4 + col] = local[row * 4 + 0] * world[0 * 4 + col] + local[row * 4 + 1] * world[1 * 4 + col] +
+                local[row * 4 + 2] * world[2 * 4 + col] + local[row * 4 + 3] * world[3 * 4 + col];
+        }
+    }
+    return out;
+}
+
+static void ComputeWvpScalar(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float localWorld[16];
+        const float* w = ApplyLocalScalar(local, WorldMatrix(world, indices, i), localWorld);
+        float* out = (float*)(output + (uint64_t)i * outputStride);
+
+        // out[col][row] = sum(w[row][k] * viewProj[k][col])
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                out[col * 4 + row] = w[row * 4 + 0] * viewProj[0 * 4 + col] + w[row * 4 + 1] * viewProj[1 * 4 + col] +
+                    w[row * 4 + 2] * viewProj[2 * 4 + col] + w[row * 4 + 3] * viewProj[3 * 4 + col];
+            }
+        }
+    }
+}
+
+#if defined(ZW_SIMD_X86)
+
+static inline const float* ApplyLocalSSE2(const float* local, const float* world, float* out)
+{
+    if (!local)
+    {
+        return world;
+    }
+    const __m128 w0 = _mm_loadu_ps(world + 0);
+    const __m128 w1 = _mm_loadu_ps(world + 4);
+    const __m128 w2 = _mm_loadu_ps(world + 8);
+    const __m128 w3 = _mm_loadu_ps(world + 12);
+    for (int row = 0; row < 4; ++row)
+    {
+        __m128 x = _mm_mul_ps(_mm_set1_ps(local[row * 4 + 0]), w0);
+        __m128 y = _mm_mul_ps(_mm_set1_ps(local[row * 4 + 1]), w1);
+        __m128 z = _mm_mul_ps(_mm_set1_ps(local[row * 4 + 2]), w2);
+        __m128 v = _mm_mul_ps(_mm_set1_ps(local[row * 4 + 3]), w3);
+        _mm_storeu_ps(out + row * 4, _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, v)));
+    }
+    return out;
+}
+
+static void ComputeWvpSSE2(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride)
+{
+    const __m128 vp0 = _mm_loadu_ps(viewProj + 0);
+    const __m128 vp1 = _mm_loadu_ps(viewProj + 4);
+    const __m128 vp2 = _mm_loadu_ps(viewProj + 8);
+    const __m128 vp3 = _mm_loadu_ps(viewProj + 12);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float localWorld[16];
+        const float* w = ApplyLocalSSE2(local, WorldMatrix(world, indices, i), localWorld);
+        float* out = (float*)(output + (uint64_t)i * outputStride);
+
+        // every row of the product is the view projection rows weighted by one world row
+        __m128 rows[4];
+        for (int row = 0; row < 4; ++row)
+        {
+            __m128 r = _mm_loadu_ps(w + row * 4);
+            __m128 x = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0)), vp0);
+            __m128 y = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1)), vp1);
+            __m128 z = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2)), vp2);
+            __m128 v = _mm_mul_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)), vp3);
+            rows[row] = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, v));
+        }
+
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        _mm_storeu_ps(out + 0, rows[0]);
+        _mm_storeu_ps(out + 4, rows[1]);
+        _mm_storeu_ps(out + 8, rows[2]);
+        _mm_storeu_ps(out + 12, rows[3]);
+    }
+}
+
+ZW_TARGET_AVX2
+static void ComputeWvpAVX2(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride)
+{
+    // every view projection row in both 128 bit lanes, so two world rows are done at once
+    const __m256 vp0 = _mm256_broadcast_ps((const __m128*)(viewProj + 0));
+    const __m256 vp1 = _mm256_broadcast_ps((const __m128*)(viewProj + 4));
+    const __m256 vp2 = _mm256_broadcast_ps((const __m128*)(viewProj + 8));
+    const __m256 vp3 = _mm256_broadcast_ps((const __m128*)(viewProj + 12));
+
+    // local * (world * viewProj) is applied last, in registers: going through memory like the sse2
+    // path stores 128 bits at a time and loads 256, which can't be forwarded and stalls every matrix.
+    // local01[k] holds local[0][k] in the low lane and local[1][k] in the high one
+    __m256 local01[4], local23[4];
+    if (local)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            local01[k] = _mm256_setr_ps(local[0 + k], local[0 + k], local[0 + k], local[0 + k],
+                local[4 + k], local[4 + k], local[4 + k], local[4 + k]);
+            local23[k] = _mm256_setr_ps(local[8 + k], local[8 + k], local[8 + k], local[8 + k],
+                local[12 + k], local[12 + k], local[12 + k], local[12 + k]);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float* w = WorldMatrix(world, indices, i);
+        float* out = (float*)(output + (uint64_t)i * outputStride);
+
+        __m256 w01 = _mm256_loadu_ps(w + 0); // world rows 0 | 1
+        __m256 w23 = _mm256_loadu_ps(w + 8); // world rows 2 | 3
+
+        __m256 r01 = _mm256_mul_ps(_mm256_permute_ps(w01, 0x00), vp0);
+        r01 = _mm256_fmadd_ps(_mm256_permute_ps(w01, 0x55), vp1, r01);
+        r01 = _mm256_fmadd_ps(_mm256_permute_ps(w01, 0xAA), vp2, r01);
+        r01 = _mm256_fmadd_ps(_mm256_permute_ps(w01, 0xFF), vp3, r01);
+
+        __m256 r23 = _mm256_mul_ps(_mm256_permute_ps(w23, 0x00), vp0);
+        r23 = _mm256_fmadd_ps(_mm256_permute_ps(w23, 0x55), vp1, r23);
+        r23 = _mm256_fmadd_ps(_mm256_permute_ps(w23, 0xAA), vp2, r23);
+        r23 = _mm256_fmadd_ps(_mm256_permute_ps(w23, 0xFF), vp3, r23);
+
+        if (local)
+        {
+            // every row of the product weighted by the local rows, each row in both lanes first
+            __m256 p0 = _mm256_permute2f128_ps(r01, r01, 0x00);
+            __m256 p1 = _mm256_permute2f128_ps(r01, r01, 0x11);
+            __m256 p2 = _mm256_permute2f128_ps(r23, r23, 0x00);
+            __m256 p3 = _mm256_permute2f128_ps(r23, r23, 0x11);
+
+            r01 = _mm256_mul_ps(local01[0], p0);
+            r01 = _mm256_fmadd_ps(local01[1], p1, r01);
+            r01 = _mm256_fmadd_ps(local01[2], p2, r01);
+            r01 = _mm256_fmadd_ps(local01[3], p3, r01);
+
+            r23 = _mm256_mul_ps(local23[0], p0);
+            r23 = _mm256_fmadd_ps(local23[1], p1, r23);
+            r23 = _mm256_fmadd_ps(local23[2], p2, r23);
+            r23 = _mm256_fmadd_ps(local23[3], p3, r23);
+        }
+
+        // transpose the 4x4 held as rows 0 | 1 and rows 2 | 3
+        __m256 lo = _mm256_unpacklo_ps(r01, r23); // r0.x r2.x r0.y r2.y | r1.x r3.x r1.y r3.y
+        __m256 hi = _mm256_unpackhi_ps(r01, r23); // r0.z r2.z r0.w r2.w | r1.z r3.z r1.w r3.w
+        __m256 a = _mm256_permute2f128_ps(lo, hi, 0x20); // r0.x r2.x r0.y r2.y | r0.z r2.z r0.w r2.w
+        __m256 b = _mm256_permute2f128_ps(lo, hi, 0x31); // r1.x r3.x r1.y r3.y | r1.z r3.z r1.w r3.w
+        __m256 c02 = _mm256_unpacklo_ps(a, b); // column x | column z
+        __m256 c13 = _mm256_unpackhi_ps(a, b); // column y | column w
+
+        _mm256_storeu_ps(out + 0, _mm256_permute2f128_ps(c02, c13, 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(c02, c13, 0x31));
+    }
+}
+
+#endif
+
+void ComputeWvpBatch(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride, SimdLevel level)
+{
+    if (level > GetSimdLevel())
+    {
+        level = GetSimdLevel();
+    }
+
+    switch (level)
+    {
+#if defined(ZW_SIMD_X86)
+    case SimdLevel::AVX2:
+        ComputeWvpAVX2(world, indices, count, local, viewProj, output, outputStride);
+        break;
+    case SimdLevel::SSE2:
+        ComputeWvpSSE2(world, indices, count, local, viewProj, output, outputStride);
+        break;
+#endif
+    default:
+        ComputeWvpScalar(world, indices, count, local, viewProj, output, outputStride);
+        break;
+    }
+}
+
+void ComputeWvpBatch(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride)
+{
+    ComputeWvpBatch(world, indices, count, local, viewProj, output, outputStride, GetSimdLevel());
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <cstdint>
+
+// Batched world * view * projection for constant buffers. Matrices are 16 floats in the
+// DirectXMath row-vector layout (XMFLOAT4X4), and every result is stored transposed, the way
+// the shaders expect it, so the output can go straight into mapped upload memory.
+//
+// world:      array of world matrices
+// indices:    which of them to use, nullptr for world[0] .. world[count - 1]
+// local:      applied to the vertices before the world matrix, the same for every result (e.g. the
+//             dequantization of compressed positions, see VertexQuantization.h), nullptr for none
+// viewProj:   view * projection
+// output:     first result, result i is written to output + i * outputStride bytes
+// outputStride must be a multiple of 16 bytes
+void ComputeWvpBatch(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride);
+
+// same, but with a fixed kernel instead of the best one for this cpu (for comparing the paths).
+// asking for a level the cpu doesn't have runs the best one it has
+void ComputeWvpBatch(const float* world, const uint32_t* indices, uint32_t count, const float* local,
+    const float* viewProj, uint8_t* output, uint32_t outputStride, SimdLevel level);
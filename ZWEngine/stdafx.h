@@ -5,17 +5,12 @@
 #endif
 
 #include <windows.h>
-#include <d3d12.h>
-#include <dxgi1_4.h>
-#include <D3Dcompiler.h>
-#include <DirectXMath.h>
-#include "d3dx12.h"
 #include <string>
-
-using namespace DirectX;
-
-// this will only call release if an object exists (prevents exceptions calling release on non existant objects)
-#define SAFE_RELEASE(p) { if ( (p) ) { (p)->Release(); (p) = 0; } }
+#include "D3D12RenderBackend.h"
+#include "Scene.h"
+#include "GameTimer.h"
+#include "FixedTimestep.h"
+#include "JobSystem.h"
 
 // Handle to the window
 HWND hwnd = NULL;
@@ -33,9 +28,24 @@ int Height = 600;
 // is window full screen?
 bool FullScreen = false;
 
+// how many frames the cpu may record ahead of the gpu (1 to frameBufferCount)
+uint32_t FramesInFlight = 2;
+
+// the two spinning cubes drawn instanced from compressed vertices, with no extra grid cubes and no texture
+SceneSettings sceneSettings = { 0, true, false, 0, true, nullptr, nullptr };
+
 // we will exit the program when this becomes false
 bool Running = true;
 
+// measures the time between frames
+GameTimer timer;
+
+// timer.TotalTime() when the frame times were last shown in the title bar
+float lastTitleUpdate = 0.0f;
+
+// the simulation advances in fixed 120 Hz steps, rendering runs as fast as it can and interpolates
+FixedTimestep simulationClock(1.0 / 120.0);
+
 // create a window
 bool InitializeWindow(HINSTANCE hInstance,
 	int ShowWnd,
@@ -50,100 +60,21 @@ LRESULT CALLBACK WndProc(HWND hWnd,
 	WPARAM wParam,
 	LPARAM lParam);
 
-// direct3d stuff
-const int frameBufferCount = 3; // number of buffers we want, 2 for double buffering, 3 for tripple buffering
-
-ID3D12Device* device; // direct3d device
-
-IDXGISwapChain3* swapChain; // swapchain used to switch between render targets
-
-ID3D12CommandQueue* commandQueue; // container for command lists
-
-ID3D12DescriptorHeap* rtvDescriptorHeap; // a descriptor heap to hold resources like the render targets
+// rendering backend the frame loop draws through (d3d12 in the windows build)
+RenderBackend* renderer;
 
-ID3D12Resource* renderTargets[frameBufferCount]; // number of render targets equal to buffer count
-
-ID3D12CommandAllocator* commandAllocator[frameBufferCount]; // we want enough allocators for each buffer * number of threads (we only have one thread)
-
-ID3D12GraphicsCommandList* commandList; // a command list we can record commands into, then execute them to render the frame
-
-ID3D12Fence* fence[frameBufferCount];    // an object that is locked while our command list is being executed by the gpu. We need as many 
-//as we have allocators (more if we want to know when the gpu is finished with an asset)
-
-HANDLE fenceEvent; // a handle to an event when our fence is unlocked by the gpu
-
-UINT64 fenceValue[frameBufferCount]; // this value is incremented each frame. each fence will have its own value
-
-int frameIndex; // current rtv we are on
-
-int rtvDescriptorSize; // size of the rtv descriptor on the device (all front and back buffers will be the same size)
+// worker threads shared by everything that runs in parallel (one per core, this thread included)
+JobSystem* jobSystem;
 
 // function declarations
 bool InitD3D(); // initializes direct3d 12
 
-void Update(); // update the game logic
+void Update(); // interpolate the game state and write this frame's constant buffers
 
 void UpdatePipeline(); // update the direct3d pipeline (update command lists)
 
 void Render(); // execute the command list
 
-void Cleanup(); // release com ojects and clean up memory
-
-void WaitForPreviousFrame(); // wait until gpu is finished with command list
-
-ID3D12PipelineState* pipelineStateObject; // pso containing a pipeline state
-
-ID3D12RootSignature* rootSignature; // root signature defines data shaders will access
+void UpdateWindowTitle(); // show the frame time percentiles in the title bar
 
-D3D12_VIEWPORT viewport; // area that output from rasterizer will be stretched to.
-
-D3D12_RECT scissorRect; // the area to draw in. pixels outside that area will not be drawn onto
-
-ID3D12Resource* vertexBuffer; // a default buffer in GPU memory that we will load vertex data for our triangle into
-
-D3D12_VERTEX_BUFFER_VIEW vertexBufferView; // a structure containing a pointer to the vertex data in gpu memory
-// the total size of the buffer, and the size of each element (vertex)
-
-ID3D12Resource* indexBuffer; // a default buffer in GPU memory that we will load index data for our triangle into
-
-D3D12_INDEX_BUFFER_VIEW indexBufferView; // a structure holding information about the index buffer
-
-ID3D12Resource* depthStencilBuffer; // This is the memory for our depth buffer. it will also be used for a stencil buffer in a later tutorial
-ID3D12DescriptorHeap* dsDescriptorHeap; // This is a heap for our depth/stencil buffer descriptor
-
-
-struct ConstantBufferPerObject {
-	XMFLOAT4X4 wvpMat;
-};
-
-//ÿconstantbuffer֮256λƫ
-int ConstantBufferPerObjectAlignedSize = (sizeof(ConstantBufferPerObject) + 255) & ~255;
-
-ConstantBufferPerObject cbPerObject; // this is the constant buffer data we will send to the gpu 
-// (which will be placed in the resource we created above)
-
-
-ID3D12DescriptorHeap* mainDescriptorHeap[frameBufferCount]; // this heap will store the descripor to our constant buffer
-//ID3D12Resource* constantBufferUploadHeap[frameBufferCount]; // this is the memory on the gpu where our constant buffer will be placed.
-
-
-ID3D12Resource* constantBufferUploadHeaps[frameBufferCount]; // this is the memory on the gpu where constant buffers for each frame will be placed
-
-UINT8* cbvGPUAddress[frameBufferCount]; // this is a pointer to each of the constant buffer resource heaps
-
-XMFLOAT4X4 cameraProjMat; // this will store our projection matrix
-XMFLOAT4X4 cameraViewMat; // this will store our view matrix
-
-XMFLOAT4 cameraPosition; // this is our cameras position vector
-XMFLOAT4 cameraTarget; // a vector describing the point in space our camera is looking at
-XMFLOAT4 cameraUp; // the worlds up vector
-
-XMFLOAT4X4 cube1WorldMat; // our first cubes world matrix (transformation matrix)
-XMFLOAT4X4 cube1RotMat; // this will keep track of our rotation for the first cube
-XMFLOAT4 cube1Position; // our first cubes position in space
-
-XMFLOAT4X4 cube2WorldMat; // our first cubes world matrix (transformation matrix)
-XMFLOAT4X4 cube2RotMat; // this will keep track of our rotation for the second cube
-XMFLOAT4 cube2PositionOffset; // our second cube will rotate around the first cube, so this is the position offset from the first cube
-
-int numCubeIndices; // the number of indices to draw the cube
\ No newline at end of file
+void Cleanup(); // release com ojects and clean up memory